@@ -1,29 +1,88 @@
-#include <cassert>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include "Lexer.h"
 #include "Parser.h"
+#include "SourceManager.h"
+#include "compiler/CompileServer.h"
 #include "compiler/Compiler.h"
 #include "config.h"
 #include "lsp/LanguageServer.h"
 
 using namespace std::literals;
 
-void printHelp(const std::string &program)
+void printHelp(const std::string &program, std::ostream &stream = std::cout)
 {
-    std::cout << "Usage: " + program + " [options] file...\n";
-    std::cout << "Options:\n";
-    std::cout << "  --run\t\t\tRuns the compiled program\n";
-    std::cout << "  --debug\t\tCreates a debug build\n";
-    std::cout << "  --release\t\tCreates a release build\n";
-    std::cout << "  --rtl\t\t\tsets the path for the rtl (run time library)\n";
-    std::cout << "  --output\t\tsets the output / build directory\n";
-    std::cout << "  --llvm-ir\t\tOutputs the LLVM-IR to the standard error output\n";
-    std::cout << "  --help\t\tOutputs the program help\n";
-    std::cout << "  --version\t\tPrints the current version of the compiler\n";
-    std::cout << "  --lsp\t\t\tStarts the compiler in the language server mode\n";
+    stream << "Usage: " + program + " [options] file...\n";
+    stream << "Options:\n";
+    stream << "  --run\t\t\tRuns the compiled program\n";
+    stream << "  --debug\t\tCreates a debug build\n";
+    stream << "  --release\t\tCreates a release build\n";
+    stream << "  --rtl\t\t\tsets the path for the rtl (run time library)\n";
+    stream << "  --output\t\tsets the output / build directory\n";
+    stream << "  --llvm-ir\t\tOutputs the LLVM-IR to the standard error output\n";
+    stream << "  --help\t\tOutputs the program help\n";
+    stream << "  --version\t\tPrints the current version of the compiler\n";
+    stream << "  --lsp\t\t\tStarts the compiler in the language server mode\n";
+    stream << "  -O<level>\t\tSets the optimization level (0, 1, 2, 3 or s)\n";
+    stream << "  --emit-llvm\t\tWrites the optimized LLVM-IR into the output directory\n";
+    stream << "  --cpu=<name>\t\tGenerates code for the given cpu, native uses the cpu of the host\n";
+    stream << "  --features=<list>\tEnables (+) or disables (-) target features, e.g. +avx2\n";
+    stream << "  --jit\t\t\tCompiles the program in memory and runs it directly\n";
+    stream << "  --linker=<name>\tlld links in process (default), any other value names the linking compiler driver\n";
+    stream << "  --codegen-threads=N\tSplits the code generation across N threads, 0 uses all cores\n";
+    stream << "  --separate-units\tCompiles every imported unit into its own cached object file\n";
+    stream << "  --time-report[=json]\tReports the time and memory of the compiler phases, json writes a report file\n";
+    stream << "  --server\t\tRuns a compile server, later invocations forward their compilation to it\n";
+    stream << "  --no-server\t\tCompiles in process even if a compile server is running\n";
+    stream << "  --stop-server\t\tShuts the running compile server down\n";
+    stream << "  --server-socket=<path>\tSets the socket of the compile server\n";
+    stream << "  -j N\t\t\tCompiles N of the input files in parallel, 0 uses all cores\n";
+    stream << "  -DNAME[=value]\tDefines a macro for {$ifdef} and {$if}, a macro without a value is 1\n";
+}
+
+/// compiles or runs the program of the command line, the compile server calls it for every request of its clients
+static int run_compiler(std::vector<std::string> argList, const std::filesystem::path &workingDirectory,
+                        std::ostream &outputStream, std::ostream &errorStream)
+{
+    const auto program = argList[0];
+    CompilerOptions options = parseCompilerOptions(argList, workingDirectory);
+
+    std::filesystem::path programPath(program);
+    options.rtlDirectories.push_back(workingDirectory / programPath.parent_path() / "rtl");
+    options.listWrittenFiles = true;
+
+    if (argList.empty())
+    {
+        errorStream << "input file is missing\n";
+        printHelp(program, errorStream);
+        return 1;
+    }
+    std::vector<std::filesystem::path> inputFiles;
+    for (const auto &argument: argList)
+    {
+        const auto inputFile = workingDirectory / argument;
+        if (!std::filesystem::exists(inputFile))
+        {
+            errorStream << argument << " is not a valid input file\n";
+            return 1;
+        }
+        inputFiles.push_back(inputFile);
+    }
+    switch (options.option)
+    {
+        case CompileOption::COMPILE:
+            return compile_files(options, inputFiles, outputStream, outputStream) ? 0 : 1;
+        case CompileOption::JIT:
+            for (const auto &inputFile: inputFiles)
+            {
+                if (const auto exitCode = jit_file(options, inputFile, errorStream, outputStream); exitCode != 0)
+                    return exitCode;
+            }
+            break;
+    }
+    return 0;
 }
 
 int main(int args, char **argv)
@@ -51,6 +110,7 @@ int main(int args, char **argv)
         }
     }
 
+    const auto arguments = argList;
     CompilerOptions options = parseCompilerOptions(argList);
 
     std::filesystem::path programPath(program);
@@ -58,35 +118,35 @@ int main(int args, char **argv)
 
     if (options.lsp)
     {
+        SourceManager::instance().setFilesMayChange(true);
         LanguageServer languageServer(options);
         languageServer.handleRequest();
         return 0;
     }
 
-    std::ifstream file;
-    std::istringstream is;
-    std::string s;
-    std::string group;
-    if (argList.empty())
-    {
-        std::cerr << "input file is missing\n";
-        printHelp(program);
-        return 1;
-    }
-    std::filesystem::path file_path(argList[0]);
-    if (!std::filesystem::exists(file_path))
-    {
-        std::cerr << "the first argument is not a valid input file\n";
-        return 1;
-    }
-    init_compiler();
-    switch (options.option)
+    switch (options.serverMode)
     {
-        case CompileOption::COMPILE:
-            compile_file(options, file_path, std::cout, std::cout);
+        case CompileServerMode::Serve:
+            SourceManager::instance().setFilesMayChange(true);
+            init_compiler();
+            return run_compile_server(options.serverSocket, run_compiler, std::cerr);
+        case CompileServerMode::Stop:
+            if (!stop_compile_server(options.serverSocket))
+            {
+                std::cerr << "no compile server is listening on " << options.serverSocket.string() << "\n";
+                return 1;
+            }
+            return 0;
+        case CompileServerMode::Auto:
+            if (const auto exitCode = forward_to_compile_server(options.serverSocket, arguments, std::cout, std::cerr))
+            {
+                return *exitCode;
+            }
+            break;
+        case CompileServerMode::Disabled:
             break;
-        case CompileOption::JIT:
-            assert(false && "JIT compiler is not implemented yet.");
     }
-    return 0;
+
+    init_compiler();
+    return run_compiler(arguments, std::filesystem::current_path(), std::cout, std::cerr);
 }
@@ -0,0 +1,73 @@
+#include "IdentifierTable.h"
+
+#include <cassert>
+#include <mutex>
+#include "Lexer.h"
+
+/// folds the identifier into a buffer of the calling thread, so lookups of known identifiers do not allocate
+static std::string_view fold_case(const std::string_view identifier)
+{
+    thread_local std::string buffer;
+    buffer.resize(identifier.size());
+    for (size_t i = 0; i < identifier.size(); ++i)
+    {
+        const char ch = identifier[i];
+        buffer[i] = ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch + ('a' - 'A')) : ch;
+    }
+    return buffer;
+}
+
+IdentifierTable::IdentifierTable()
+{
+    // the empty spelling belongs to noSymbol
+    m_spellings.emplace_back();
+    for (const auto keyword: Lexer::keywords)
+    {
+        [[maybe_unused]] const auto symbol = intern(keyword);
+        assert(symbol == Lexer::keywordSymbol(keyword));
+    }
+}
+
+IdentifierTable &IdentifierTable::instance()
+{
+    static IdentifierTable identifierTable;
+    return identifierTable;
+}
+
+SymbolId IdentifierTable::intern(const std::string_view identifier)
+{
+    const auto folded = fold_case(identifier);
+    {
+        std::shared_lock lock(m_mutex);
+        if (const auto it = m_symbols.find(folded); it != m_symbols.end())
+            return it->second;
+    }
+
+    std::unique_lock lock(m_mutex);
+    // another thread might have added the identifier in the meantime
+    if (const auto it = m_symbols.find(folded); it != m_symbols.end())
+        return it->second;
+    const auto symbol = static_cast<SymbolId>(m_spellings.size());
+    m_symbols.emplace(m_spellings.emplace_back(folded), symbol);
+    return symbol;
+}
+
+SymbolId IdentifierTable::find(const std::string_view identifier) const
+{
+    const auto folded = fold_case(identifier);
+    std::shared_lock lock(m_mutex);
+    const auto it = m_symbols.find(folded);
+    return it != m_symbols.end() ? it->second : noSymbol;
+}
+
+std::string_view IdentifierTable::spelling(const SymbolId symbol) const
+{
+    std::shared_lock lock(m_mutex);
+    return m_spellings.at(symbol);
+}
+
+size_t IdentifierTable::size() const
+{
+    std::shared_lock lock(m_mutex);
+    return m_spellings.size();
+}
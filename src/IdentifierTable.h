@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/// the interned, case folded spelling of an identifier
+using SymbolId = uint32_t;
+
+/// Interns the case folded spelling of every identifier, so identifiers which only differ in their case share a
+/// symbol and comparing two symbols replaces the case insensitive comparison of their names. The keywords are
+/// interned first, the symbol of a keyword is its index in the keyword list of the lexer plus one.
+class IdentifierTable
+{
+public:
+    /// the symbol of tokens which are no identifiers
+    static constexpr SymbolId noSymbol = 0;
+
+    static IdentifierTable &instance();
+
+    /// returns the symbol of the identifier, identifiers which were not seen before are added
+    SymbolId intern(std::string_view identifier);
+    /// returns the symbol of the identifier or noSymbol if the identifier was never interned
+    [[nodiscard]] SymbolId find(std::string_view identifier) const;
+    /// returns the lower case spelling of the symbol
+    [[nodiscard]] std::string_view spelling(SymbolId symbol) const;
+
+    [[nodiscard]] size_t size() const;
+
+private:
+    IdentifierTable();
+
+    mutable std::shared_mutex m_mutex;
+    /// a deque never moves its elements, the keys of the map refer to the spellings
+    std::deque<std::string> m_spellings;
+    std::unordered_map<std::string_view, SymbolId> m_symbols;
+};
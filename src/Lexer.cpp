@@ -1,412 +1,478 @@
 #include "Lexer.h"
-#include <iostream>
-#include "compare.h"
-
-inline std::vector<std::string> possible_tokens = {"program",   "unit",         "uses",
-                                                   "begin",     "end",          "procedure",
-                                                   "function",  "var",          "if",
-                                                   "then",      "else",         "while",
-                                                   "do",        "for",          "to",
-                                                   "break",     "repeat",       "until",
-                                                   "type",      "array",        "of",
-                                                   "const",     "true",         "false",
-                                                   "and",       "or",           "not",
-                                                   "record",    "external",     "name",
-                                                   "mod",       "inline",       "implementation",
-                                                   "interface", "finalization", "initialization",
-                                                   "div",       "downto",       "file",
-                                                   "case",      "in",           "nil"};
-
-inline std::vector<std::string> macro_token{"ifdef", "else", "endif"};
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include "compiler/TimeReport.h"
+#include "scan.h"
+
+/// the names of the compiler directives, they are lexed as macro keywords inside of a directive
+static constexpr std::array<std::string_view, 10> macroKeywords = {
+        "ifdef", "ifndef", "if", "elseif", "else", "endif", "define", "undef", "include", "i"};
+
+constexpr char lower_ascii(const char value)
+{
+    return value >= 'A' && value <= 'Z' ? static_cast<char>(value + ('a' - 'A')) : value;
+}
 
-Lexer::Lexer() {}
+constexpr bool equals_lower_case(const std::string_view identifier, const std::string_view lowerCaseWord)
+{
+    if (identifier.size() != lowerCaseWord.size())
+        return false;
+    for (size_t i = 0; i < identifier.size(); ++i)
+    {
+        if (lower_ascii(identifier[i]) != lowerCaseWord[i])
+            return false;
+    }
+    return true;
+}
 
-Lexer::~Lexer() {}
+/// hashes the length, the first two and the last character of a word with at least two characters
+constexpr size_t keyword_hash(const std::string_view word, const size_t multiplier)
+{
+    size_t hash = word.size();
+    hash = hash * multiplier + static_cast<unsigned char>(lower_ascii(word[0]));
+    hash = hash * multiplier + static_cast<unsigned char>(lower_ascii(word[1]));
+    hash = hash * multiplier + static_cast<unsigned char>(lower_ascii(word.back()));
+    return hash;
+}
+
+static constexpr size_t keywordTableSize = 256;
 
-constexpr bool validStartNameChar(const char value)
+/// searches the smallest multiplier for which the keywords do not collide in the keyword table
+constexpr size_t find_keyword_multiplier()
 {
-    return (value >= 'A' && value <= 'Z') || (value >= 'a' && value <= 'z') || value == '_';
+    for (size_t multiplier = 1; multiplier < 1024; ++multiplier)
+    {
+        std::array<bool, keywordTableSize> used{};
+        bool collision = false;
+        for (const auto keyword: Lexer::keywords)
+        {
+            auto &slot = used[keyword_hash(keyword, multiplier) % keywordTableSize];
+            collision |= slot;
+            slot = true;
+        }
+        if (!collision)
+            return multiplier;
+    }
+    return 0;
 }
 
-constexpr bool validNameChar(const char value) { return validStartNameChar(value) || (value >= '0' && value <= '9'); }
+static constexpr size_t keywordMultiplier = find_keyword_multiplier();
+static_assert(keywordMultiplier != 0, "no perfect hash was found for the keywords");
 
-std::vector<Token> Lexer::tokenize(const std::string &filename, const std::string &content)
+static constexpr auto keywordTable = []
 {
-    std::vector<Token> tokens;
-    tokens.reserve(1000); // reserve space for 1000 tokens, this is a guess, but should be enough for most files
+    std::array<int8_t, keywordTableSize> table{};
+    table.fill(-1);
+    for (size_t i = 0; i < Lexer::keywords.size(); ++i)
+        table[keyword_hash(Lexer::keywords[i], keywordMultiplier) % keywordTableSize] = static_cast<int8_t>(i);
+    return table;
+}();
+
+static constexpr size_t maxKeywordLength = []
+{
+    size_t length = 0;
+    for (const auto keyword: Lexer::keywords)
+        length = std::max(length, keyword.size());
+    return length;
+}();
+
+/// the kind of a token is decided by its first character
+enum class CharacterClass : uint8_t
+{
+    Other,
+    Name,
+    Digit,
+    Blank,
+    Single,
+};
+
+static constexpr auto characterClasses = []
+{
+    std::array<CharacterClass, 256> classes{};
+    for (int ch = 'a'; ch <= 'z'; ++ch)
+        classes[ch] = CharacterClass::Name;
+    for (int ch = 'A'; ch <= 'Z'; ++ch)
+        classes[ch] = CharacterClass::Name;
+    classes['_'] = CharacterClass::Name;
+    for (int ch = '0'; ch <= '9'; ++ch)
+        classes[ch] = CharacterClass::Digit;
+    for (const unsigned char ch: std::string_view(" \t\r\n"))
+        classes[ch] = CharacterClass::Blank;
+    for (const unsigned char ch: std::string_view("+*()[]=<>,;:.^!@}"))
+        classes[ch] = CharacterClass::Single;
+    return classes;
+}();
+
+constexpr CharacterClass character_class(const char value)
+{
+    return characterClasses[static_cast<unsigned char>(value)];
+}
 
-    size_t row = 1;
-    size_t column = 1;
-    const auto contentPtr = std::make_shared<std::string>(content);
-    bool parseMacros = false;
-    for (size_t i = 0; i < content.size(); ++i)
-    {
+constexpr bool isNameChar(const char value)
+{
+    const auto characterClass = character_class(value);
+    return characterClass == CharacterClass::Name || characterClass == CharacterClass::Digit;
+}
 
-        auto ch = content[i];
-        size_t endPosition = i;
+constexpr bool isNumber(const char c) { return c >= '0' && c <= '9'; }
 
-        bool found = (content[i] == '{' && content[i + 1] == '$');
-        if (found)
-        {
-            constexpr size_t offset = 2;
-            endPosition = i + 2;
-            SourceLocation source_location = {
-                    .filename = filename, .source = contentPtr, .byte_offset = i, .num_bytes = offset};
-            tokens.emplace_back(source_location, row, column, TokenType::MACRO_START);
-            i = endPosition - 1;
-            column += offset;
-            parseMacros = true;
-            continue;
-        }
+constexpr bool isNumberStart(const char c) { return isNumber(c) || c == '-'; }
 
-        found = find_comment(content, i, &endPosition);
-        if (found)
-        {
-            // count lines
-            for (size_t start = i; start < endPosition; start++)
-            {
-                if (content[start] == '\n')
-                    row++;
-            }
-            size_t offset = endPosition - i;
-            i = endPosition;
-            column += offset + 1;
-            continue;
-        }
+constexpr TokenType single_char_token(const char value)
+{
+    switch (value)
+    {
+        case '+':
+            return TokenType::PLUS;
+        case '*':
+            return TokenType::MUL;
+        case '(':
+            return TokenType::LEFT_CURLY;
+        case ')':
+            return TokenType::RIGHT_CURLY;
+        case '[':
+            return TokenType::LEFT_SQUAR;
+        case ']':
+            return TokenType::RIGHT_SQUAR;
+        case '=':
+            return TokenType::EQUAL;
+        case '<':
+            return TokenType::LESS;
+        case '>':
+            return TokenType::GREATER;
+        case ',':
+            return TokenType::COMMA;
+        case ';':
+            return TokenType::SEMICOLON;
+        case ':':
+            return TokenType::COLON;
+        case '.':
+            return TokenType::DOT;
+        case '^':
+            return TokenType::CARET;
+        case '!':
+            return TokenType::BANG;
+        case '@':
+            return TokenType::AT;
+        default:
+            return TokenType::MACRO_END;
+    }
+}
 
-        found = parseMacros && find_macro_keyword(content, i, &endPosition);
-        if (found)
-        {
-            const size_t offset = endPosition - i;
-            SourceLocation source_location = {
-                    .filename = filename, .source = contentPtr, .byte_offset = i, .num_bytes = offset};
-            tokens.emplace_back(source_location, row, column, TokenType::MACROKEYWORD);
-            i = endPosition - 1;
-            column += offset;
-            continue;
-        }
+Lexer::Lexer() {}
 
-        found = find_fixed_token(content, i, &endPosition);
-        if (found)
-        {
-            const size_t offset = endPosition - i;
-            SourceLocation source_location = {
-                    .filename = filename, .source = contentPtr, .byte_offset = i, .num_bytes = offset};
-            tokens.emplace_back(source_location, row, column, TokenType::KEYWORD);
-            i = endPosition - 1;
-            column += offset;
-            continue;
-        }
+Lexer::~Lexer() {}
 
-        found = find_token(content, i, &endPosition);
-        if (found)
-        {
-            const size_t offset = endPosition - i + 1;
-            SourceLocation source_location = {
-                    .filename = filename, .source = contentPtr, .byte_offset = i, .num_bytes = offset};
-            tokens.emplace_back(source_location, row, column, TokenType::NAMEDTOKEN);
-            i = endPosition;
-            column += offset;
-            continue;
-        }
+bool Lexer::isKeyword(const std::string_view identifier) { return keywordSymbol(identifier) != IdentifierTable::noSymbol; }
 
-        endPosition = i;
-        found = find_string(content, i, &endPosition);
-        if (found)
-        {
-            size_t offset = endPosition - i;
-            auto string_length = (offset - 1);
-            SourceLocation source_location = {
-                    .filename = filename, .source = contentPtr, .byte_offset = i + 1, .num_bytes = string_length};
-            if (string_length != 1)
-                tokens.emplace_back(source_location, row, column, TokenType::STRING);
-            else
-                tokens.emplace_back(source_location, row, column, TokenType::CHAR);
-            i = endPosition;
-            column += offset + 1;
-            continue;
-        }
+SymbolId Lexer::keywordSymbol(const std::string_view identifier)
+{
+    if (identifier.size() < 2 || identifier.size() > maxKeywordLength)
+        return IdentifierTable::noSymbol;
+    const auto index = keywordTable[keyword_hash(identifier, keywordMultiplier) % keywordTableSize];
+    if (index < 0 || !equals_lower_case(identifier, keywords[index]))
+        return IdentifierTable::noSymbol;
+    return static_cast<SymbolId>(index + 1);
+}
 
-        found = find_escape_sequence(content, i, &endPosition);
-        if (found)
-        {
-            size_t offset = endPosition - i;
-            auto string_length = (offset);
-
-            SourceLocation source_location = {
-                    .filename = filename, .source = contentPtr, .byte_offset = i, .num_bytes = string_length};
-            if (string_length != 1)
-                tokens.emplace_back(source_location, row, column, TokenType::ESCAPED_STRING);
-            else
-                tokens.emplace_back(source_location, row, column, TokenType::CHAR);
-            i = endPosition - 1;
-            column += offset;
-            continue;
-        }
+static bool is_macro_keyword(const std::string_view identifier)
+{
+    return std::ranges::any_of(macroKeywords,
+                               [identifier](const std::string_view keyword)
+                               { return equals_lower_case(identifier, keyword); });
+}
 
-        endPosition = i;
-        found = find_number(content, i, &endPosition);
-        if (found)
+std::vector<Token> Lexer::tokenize(const std::string &filename, const std::string &content)
+{
+    return tokenize(SourceManager::instance().addFile(filename, content));
+}
+
+std::vector<Token> Lexer::tokenize(const FileId fileId)
+{
+    TimeReport::Phase phase("lex", SourceManager::instance().filename(fileId));
+    std::vector<Token> tokens;
+    // roughly one token per six characters of source, the vector grows if the guess is too small
+    tokens.reserve(SourceManager::instance().content(fileId).size() / 6 + 16);
+    Scanner scanner(fileId);
+    do
+        tokens.push_back(scanner.next());
+    while (tokens.back().tokenType() != TokenType::T_EOF);
+    TimeReport::count("tokens", tokens.size());
+    return tokens;
+}
+
+/// returns the index of a token at or in front of the index at which a scanner can start again, at 0 the scanner starts
+/// at the start of the file. The text of a string starts in front of the offset of its token and the tokens of a
+/// directive depend on the start of the directive.
+static size_t restart_index(const std::vector<Token> &tokens, size_t index)
+{
+    while (index > 0)
+    {
+        const auto tokenType = tokens[index].tokenType();
+        if (tokenType == TokenType::STRING || tokenType == TokenType::CHAR)
         {
-            const size_t offset = endPosition - i + 1;
-            SourceLocation source_location = {
-                    .filename = filename, .source = contentPtr, .byte_offset = i, .num_bytes = offset};
-            tokens.emplace_back(source_location, row, column, TokenType::NUMBER);
-            i = endPosition;
-            column += offset;
+            --index;
             continue;
         }
-        // TokenType tokenType;
-        SourceLocation source_location = {.filename = filename, .source = contentPtr, .byte_offset = i, .num_bytes = 1};
-        switch (ch)
-        {
-            case '\n':
-                column = 1;
-                row++;
-                continue;
-            case '+':
-                tokens.emplace_back(source_location, row, column, TokenType::PLUS);
-                break;
-            case '-':
-                tokens.emplace_back(source_location, row, column, TokenType::MINUS);
-                break;
-            case '*':
-                tokens.emplace_back(source_location, row, column, TokenType::MUL);
-                break;
-            case '/':
-                tokens.emplace_back(source_location, row, column, TokenType::DIV);
-                break;
-            case '(':
-                tokens.emplace_back(source_location, row, column, TokenType::LEFT_CURLY);
-                break;
-            case ')':
-                tokens.emplace_back(source_location, row, column, TokenType::RIGHT_CURLY);
-                break;
-            case '[':
-                tokens.emplace_back(source_location, row, column, TokenType::LEFT_SQUAR);
-                break;
-            case ']':
-                tokens.emplace_back(source_location, row, column, TokenType::RIGHT_SQUAR);
-                break;
-            case '=':
-                tokens.emplace_back(source_location, row, column, TokenType::EQUAL);
-                break;
-            case '<':
-                tokens.emplace_back(source_location, row, column, TokenType::LESS);
-                break;
-            case '>':
-                tokens.emplace_back(source_location, row, column, TokenType::GREATER);
-                break;
-            case ',':
-                tokens.emplace_back(source_location, row, column, TokenType::COMMA);
-                break;
-            case ';':
-                tokens.emplace_back(source_location, row, column, TokenType::SEMICOLON);
-                break;
-            case ':':
-                tokens.emplace_back(source_location, row, column, TokenType::COLON);
-                break;
-            case '.':
-                tokens.emplace_back(source_location, row, column, TokenType::DOT);
-                break;
-            case '^':
-                tokens.emplace_back(source_location, row, column, TokenType::CARET);
-                break;
-            case '!':
-                tokens.emplace_back(source_location, row, column, TokenType::BANG);
-                break;
-            case '@':
-                tokens.emplace_back(source_location, row, column, TokenType::AT);
-                break;
-            case '}':
-                tokens.emplace_back(source_location, row, column, TokenType::MACRO_END);
-                parseMacros = false;
-                break;
-            default:
-                break;
-        }
-        column++;
+        size_t previous = index;
+        while (previous > 0 && tokens[previous - 1].tokenType() != TokenType::MACRO_START &&
+               tokens[previous - 1].tokenType() != TokenType::MACRO_END)
+            --previous;
+        if (previous == 0 || tokens[previous - 1].tokenType() == TokenType::MACRO_END)
+            return index;
+        index = previous - 1;
     }
-    SourceLocation source_location = {
-            .filename = filename, .source = contentPtr, .byte_offset = content.size(), .num_bytes = 0};
-    tokens.emplace_back(source_location, row, column, TokenType::T_EOF);
-    return tokens;
+    return 0;
 }
 
-bool Lexer::find_escape_sequence(const std::string &content, size_t start, size_t *endPosition)
+void Lexer::relex(std::vector<Token> &tokens, const FileId fileId, const TextEdit &edit)
 {
-    char current = content[start];
-    if (current != '#')
-        return false;
-
-    *endPosition = start + 1;
-    current = content[start + 1];
+    TimeReport::Phase phase("relex", SourceManager::instance().filename(fileId));
+    // the token in front of the first token reaching the edit is lexed again, the edit may extend it
+    const auto firstChanged = static_cast<size_t>(
+            std::ranges::partition_point(tokens, [&edit](const Token &token)
+                                         { return token.byteOffset + token.length < edit.begin; }) -
+            tokens.begin());
+    const auto restart = restart_index(tokens, firstChanged > 0 ? firstChanged - 1 : 0);
+    const auto delta = static_cast<int64_t>(edit.newEnd) - static_cast<int64_t>(edit.oldEnd);
+    // the offset of a previous token in the new file, the tokens inside of the edit are moved to its new end
+    const auto moved = [&edit, delta](const Token &token)
+    {
+        return token.byteOffset >= edit.oldEnd ? static_cast<int64_t>(token.byteOffset) + delta
+                                               : static_cast<int64_t>(std::min<size_t>(token.byteOffset, edit.newEnd));
+    };
+
+    // the scanner is back in step with the previous tokens at a token behind the edit which starts at the same place
+    // in the same state, every following token is the same. Strings are skipped, their offset is not their start.
+    Scanner scanner(fileId, restart > 0 ? tokens[restart].byteOffset : 0);
+    std::vector<Token> relexed;
+    size_t previous = restart;
+    bool previousInDirective = false;
     while (true)
     {
-        if (current == '#')
+        const bool inDirective = scanner.inDirective();
+        const auto token = scanner.next();
+        for (; previous < tokens.size() && moved(tokens[previous]) < static_cast<int64_t>(token.byteOffset); ++previous)
         {
-            *endPosition += 1;
-            current = content[*endPosition];
+            if (tokens[previous].tokenType() == TokenType::MACRO_START)
+                previousInDirective = true;
+            else if (tokens[previous].tokenType() == TokenType::MACRO_END)
+                previousInDirective = false;
         }
-        else if (content[*endPosition] >= '0' && content[*endPosition] <= '9')
+        if (previous < tokens.size())
         {
-            *endPosition += 1;
-            current = content[*endPosition];
-            continue;
+            const auto &old = tokens[previous];
+            if (old.byteOffset >= edit.oldEnd && moved(old) == token.byteOffset &&
+                old.tokenType() == token.tokenType() && old.length == token.length &&
+                token.tokenType() != TokenType::STRING && token.tokenType() != TokenType::CHAR &&
+                inDirective == previousInDirective)
+                break;
         }
-        else
+        relexed.push_back(token);
+        if (token.tokenType() == TokenType::T_EOF)
         {
+            previous = tokens.size();
             break;
         }
     }
-    return true;
-}
-bool Lexer::find_macro_keyword(const std::string &content, size_t start, size_t *endPosition)
-{
-    char current = content[start];
-    *endPosition = start + 1;
-    if (!validStartNameChar(current))
-        return false;
 
-    while (validNameChar(current))
+    TimeReport::count("tokens", relexed.size());
+    const auto replaced = static_cast<std::ptrdiff_t>(previous - restart);
+    const auto inserted = static_cast<std::ptrdiff_t>(relexed.size());
+    const auto first = tokens.begin() + static_cast<std::ptrdiff_t>(restart);
+    if (inserted <= replaced)
     {
-
-        *endPosition += 1;
-        current = content[*endPosition];
+        std::ranges::copy(relexed, first);
+        tokens.erase(first + inserted, first + replaced);
     }
-
-    const auto tmp = content.substr(start, *endPosition - start);
-    for (const auto &token: macro_token)
+    else
     {
-        if (iequals(tmp, token))
-        {
-            return true;
-        }
+        std::ranges::copy(relexed.begin(), relexed.begin() + replaced, first);
+        tokens.insert(first + replaced, relexed.begin() + replaced, relexed.end());
     }
+    for (size_t i = 0; i < restart; ++i)
+        tokens[i].fileId = fileId;
+    for (size_t i = restart + relexed.size(); i < tokens.size(); ++i)
+    {
+        tokens[i].fileId = fileId;
+        tokens[i].byteOffset = static_cast<uint32_t>(tokens[i].byteOffset + delta);
+    }
+}
 
-    return false;
+/// returns the end of the comment which starts at the offset, the closing brace belongs to the comment, the line
+/// break of a line comment does not
+static size_t comment_end(const char *data, const size_t size, const size_t offset)
+{
+    const bool lineComment = data[offset] == '/';
+    const size_t start = std::min(offset + (lineComment ? 2 : 1), size);
+    const size_t end = static_cast<size_t>(find_byte(data + start, data + size, lineComment ? '\n' : '}') - data);
+    return !lineComment && end < size ? end + 1 : end;
 }
 
-bool Lexer::find_string(const std::string &content, size_t start, size_t *endPosition)
+/// returns the offset of the closing quote of the string which starts after the offset or the size of the content
+/// if the string is not closed, two quotes inside of a string are an escaped quote
+static size_t string_end(const char *data, const size_t size, const size_t offset)
 {
-    char current = content[start];
-    if (current != '\'')
-        return false;
-    *endPosition = start + 1;
-    current = content[start + 1];
+    size_t end = offset;
     while (true)
     {
-        if (current == '\'')
-        {
-            if (content.size() - 1 > *endPosition + 1 && content[*endPosition + 1] == '\'')
-            {
-                *endPosition += 2;
-                current = content[*endPosition];
-            }
-            else
-            {
-                break;
-            }
-        }
-
-        *endPosition += 1;
-        current = content[*endPosition];
+        end = static_cast<size_t>(find_byte(data + end, data + size, '\'') - data);
+        if (end >= size || data[end + 1] != '\'')
+            return end;
+        end += 2;
     }
-    return true;
 }
-constexpr bool isNumber(const char c) { return (c >= '0' && c <= '9'); }
-
-constexpr bool isNumberStart(const char c) { return isNumber(c) || c == '-'; }
-
 
-bool Lexer::find_number(const std::string &content, const size_t start, size_t *endPosition)
+Scanner::Scanner(const FileId fileId) : m_fileId(fileId)
 {
-    int index = 0;
-    char current = content[start];
-    if (current == '-' && !isNumberStart(content[start + 1]))
-        return false;
-    if (!isNumberStart(current))
-        return false;
-    while (isNumber(current) or (index == 0 and current == '-') or
-           (current == '.' and isNumber(content[*endPosition + 1])))
-    {
-
-        *endPosition += 1;
-        current = content[*endPosition];
-        index++;
-    }
-    if (current < '0' || current > '9')
-        *endPosition -= 1;
-    return true;
+    const auto content = SourceManager::instance().content(fileId);
+    m_data = content.data();
+    m_size = content.size();
+    m_symbols.reserve(content.size() / 64 + 16);
 }
 
-bool Lexer::find_token(const std::string &content, const size_t start, size_t *endPosition)
+Scanner::Scanner(const FileId fileId, const size_t position) : Scanner(fileId) { m_position = position; }
+Scanner::Scanner(const FileId fileId, const size_t position, const size_t end) : Scanner(fileId, position)
 {
-    char current = content[start];
-    *endPosition = start;
-    if (!validStartNameChar(current))
-        return false;
-
-    while (validNameChar(current))
-    {
-
-        *endPosition += 1;
-        current = content[*endPosition];
-    }
-    while (!validNameChar(current))
-    {
-        *endPosition -= 1;
-        current = content[*endPosition];
-    }
-    return true;
+    m_size = std::min(m_size, end);
 }
 
-bool Lexer::find_fixed_token(const std::string &content, const size_t start, size_t *endPosition)
+SymbolId Scanner::intern(const std::string_view identifier)
 {
+    auto [it, inserted] = m_symbols.try_emplace(identifier, IdentifierTable::noSymbol);
+    if (inserted)
+        it->second = IdentifierTable::instance().intern(identifier);
+    return it->second;
+}
 
-    char current = content[start];
-    *endPosition = start + 1;
-    if (!validStartNameChar(current))
-        return false;
-
-    while (validNameChar(current))
-    {
-
-        *endPosition += 1;
-        current = content[*endPosition];
-    }
-
-    const auto tmp = std::string_view(content.data() + start, *endPosition - start);
-    return std::ranges::any_of(possible_tokens, [tmp](const std::string &token) { return iequals(tmp, token); });
+Token Scanner::token(const size_t start, const size_t length, const TokenType tokenType, const SymbolId symbol) const
+{
+    if (length > Token::maxLength)
+        return Token(m_fileId, start, 0, TokenType::TOO_LONG);
+    return Token(m_fileId, start, length, tokenType, symbol);
 }
 
-bool Lexer::find_comment(const std::string &content, const size_t start, size_t *endPosition)
+Token Scanner::next()
 {
-    if (content[start] == '{')
+    const char *data = m_data;
+    size_t &i = m_position;
+    while (i < m_size)
     {
-        char current = content[start];
-        *endPosition = start + 1;
-
-        while (current != '}' && current != 0)
+        const char ch = data[i];
+        switch (character_class(ch))
         {
-            *endPosition += 1;
-            current = content[*endPosition];
+            case CharacterClass::Name:
+            {
+                size_t end = i + 1;
+                while (isNameChar(data[end]))
+                    ++end;
+                if (end - i > Token::maxLength)
+                {
+                    const size_t start = std::exchange(i, end);
+                    return token(start, end - start, TokenType::NAMEDTOKEN);
+                }
+                const std::string_view identifier(data + i, end - i);
+                TokenType tokenType = TokenType::NAMEDTOKEN;
+                SymbolId symbol = Lexer::keywordSymbol(identifier);
+                if (m_parseMacros && is_macro_keyword(identifier))
+                    tokenType = TokenType::MACROKEYWORD;
+                else if (symbol != IdentifierTable::noSymbol)
+                    tokenType = TokenType::KEYWORD;
+                if (symbol == IdentifierTable::noSymbol)
+                    symbol = intern(identifier);
+                const size_t start = std::exchange(i, end);
+                return Token(m_fileId, start, end - start, tokenType, symbol);
+            }
+            case CharacterClass::Digit:
+                break;
+            case CharacterClass::Blank:
+                // single blanks between tokens are the common case, longer runs like indentation are skipped in bulk
+                if (character_class(data[i + 1]) != CharacterClass::Blank)
+                    ++i;
+                else
+                    i = static_cast<size_t>(skip_blanks(data + i + 2, data + m_size) - data);
+                continue;
+            case CharacterClass::Single:
+                if (ch == '}')
+                    m_parseMacros = false;
+                return Token(m_fileId, i++, 1, single_char_token(ch));
+            case CharacterClass::Other:
+                if (ch == '{' && data[i + 1] == '$')
+                {
+                    m_parseMacros = true;
+                    i += 2;
+                    return Token(m_fileId, i - 2, 2, TokenType::MACRO_START);
+                }
+                if (ch == '{' || (ch == '/' && data[i + 1] == '/'))
+                {
+                    // comments are skipped
+                    i = comment_end(data, m_size, i);
+                    continue;
+                }
+                if (ch == '\'')
+                {
+                    const size_t end = string_end(data, m_size, i + 1);
+                    const size_t stringLength = end - i - 1;
+                    const Token string =
+                            token(i + 1, stringLength, stringLength != 1 ? TokenType::STRING : TokenType::CHAR);
+                    i = end + 1;
+                    return string;
+                }
+                if (ch == '#')
+                {
+                    size_t end = i + 1;
+                    while (data[end] == '#' || isNumber(data[end]))
+                        ++end;
+                    const size_t length = end - i;
+                    const Token string = token(i, length, length != 1 ? TokenType::ESCAPED_STRING : TokenType::CHAR);
+                    i = end;
+                    return string;
+                }
+                if (ch == '-' && isNumberStart(data[i + 1]))
+                    break;
+                ++i;
+                if (ch == '-' || ch == '/')
+                    return Token(m_fileId, i - 1, 1, ch == '-' ? TokenType::MINUS : TokenType::DIV);
+                continue;
         }
-        return true;
-    }
-    if (content[start] == '/' && content[start + 1] == '/')
-    {
-        char current = content[start];
-        *endPosition = start + 3;
 
-        while (current != '\n' && current != 0)
+        // numbers may start with a minus, a dot only belongs to the number if a digit follows
+        size_t end = i;
+        size_t index = 0;
+        char current = data[end];
+        while (isNumber(current) || (index == 0 && current == '-') || (current == '.' && isNumber(data[end + 1])))
         {
-            *endPosition += 1;
-            current = content[*endPosition];
+            current = data[++end];
+            index++;
         }
-        *endPosition -= 1;
-        return true;
+        const size_t start = std::exchange(i, end);
+        return token(start, end - start, TokenType::NUMBER);
     }
+    // an unterminated string ends behind the end of the content
+    i = m_size;
+    return Token(m_fileId, m_size, 0, TokenType::T_EOF);
+}
 
+bool Scanner::skipToDirective()
+{
+    m_parseMacros = false;
+    const char *data = m_data;
+    size_t &i = m_position;
+    while (i < m_size)
+    {
+        const char ch = data[i];
+        if (ch == '{' && data[i + 1] == '$')
+            return true;
+        if (ch == '{' || (ch == '/' && data[i + 1] == '/'))
+            i = comment_end(data, m_size, i);
+        else if (ch == '\'')
+            i = string_end(data, m_size, i + 1) + 1;
+        else
+            ++i;
+    }
+    i = m_size;
     return false;
 }
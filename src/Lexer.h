@@ -1,24 +1,93 @@
 #pragma once
+#include <array>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 #include "Token.h"
 
 
-class Lexer
+/// a replaced range of a file: the text from begin to oldEnd of the previous version is the text from begin to newEnd
+/// of the new version, the text in front of and behind the range is unchanged
+struct TextEdit
 {
-private:
-    static bool find_fixed_token(const std::string &content, size_t start, size_t *endPosition);
-    static bool find_token(const std::string &content, size_t start, size_t *endPosition);
-
-    static bool find_string(const std::string &content, size_t start, size_t *endPosition);
-    static bool find_number(const std::string &content, size_t start, size_t *endPosition);
-    static bool find_comment(const std::string &content, size_t start, size_t *endPosition);
-    static bool find_escape_sequence(const std::string &content, size_t start, size_t *endPosition);
-    static bool find_macro_keyword(const std::string &content, size_t start, size_t *endPosition);
+    size_t begin;
+    size_t oldEnd;
+    size_t newEnd;
+};
 
+/// Splits a source file into tokens in a single pass. The scanner dispatches on the first character of every token,
+/// keywords are recognized with a perfect hash over the lower case keyword list. Identifiers and keywords are interned
+/// into the identifier table while they are lexed.
+class Lexer
+{
 public:
+    static constexpr std::array<std::string_view, 42> keywords = {
+            "program",       "unit",          "uses",
+            "begin",         "end",           "procedure",
+            "function",      "var",           "if",
+            "then",          "else",          "while",
+            "do",            "for",           "to",
+            "break",         "repeat",        "until",
+            "type",          "array",         "of",
+            "const",         "true",          "false",
+            "and",           "or",            "not",
+            "record",        "external",      "name",
+            "mod",           "inline",        "implementation",
+            "interface",     "finalization",  "initialization",
+            "div",           "downto",        "file",
+            "case",          "in",            "nil"};
+
     Lexer();
     ~Lexer();
 
     std::vector<Token> tokenize(const std::string &filename, const std::string &content);
+    /// tokenizes a file of the source manager, its content is not copied
+    std::vector<Token> tokenize(FileId fileId);
+    /// updates the tokens of the previous version of a file to the file after the edit. Only the tokens around the edit
+    /// are lexed again, from a token in front of it until the tokens match the previous tokens again. The other tokens
+    /// are moved to the new file in place.
+    void relex(std::vector<Token> &tokens, FileId fileId, const TextEdit &edit);
+
+    /// returns true if the identifier is a keyword of the language, the comparison ignores the case
+    static bool isKeyword(std::string_view identifier);
+    /// returns the symbol of a keyword without a lookup in the identifier table, noSymbol for all other identifiers
+    static SymbolId keywordSymbol(std::string_view identifier);
+};
+
+/// Scans the tokens of one file of the source manager one at a time, so a consumer can pull the tokens while it
+/// parses them instead of tokenizing the whole file up front.
+class Scanner
+{
+public:
+    explicit Scanner(FileId fileId);
+    /// starts at the byte offset, it has to be the start of a token which is not part of a directive
+    Scanner(FileId fileId, size_t position);
+    /// scans the text from the position up to the end offset only, the end has to be the end of a token
+    Scanner(FileId fileId, size_t position, size_t end);
+
+    /// returns the next token, every call after the end of the file returns a T_EOF token
+    Token next();
+    /// skips the text up to the next compiler directive without producing tokens, e.g. an inactive region of a
+    /// conditional. Comments and strings are skipped as a whole, a directive inside of them is not found. Returns
+    /// false if the file ends before the next directive.
+    bool skipToDirective();
+
+    [[nodiscard]] FileId fileId() const { return m_fileId; }
+    /// true inside of a compiler directive, the names of the directives are lexed as macro keywords there
+    [[nodiscard]] bool inDirective() const { return m_parseMacros; }
+
+private:
+    FileId m_fileId;
+    /// the content is zero terminated, so the scanner can look one character past the end
+    const char *m_data;
+    size_t m_size;
+    size_t m_position = 0;
+    bool m_parseMacros = false;
+    /// identifiers repeat a lot, the symbols of the spellings of this file are looked up without the shared table
+    std::unordered_map<std::string_view, SymbolId> m_symbols;
+
+    SymbolId intern(std::string_view identifier);
+    /// a token which does not fit into the length of a token becomes a TOO_LONG token without any text
+    [[nodiscard]] Token token(size_t start, size_t length, TokenType tokenType,
+                              SymbolId symbol = IdentifierTable::noSymbol) const;
 };
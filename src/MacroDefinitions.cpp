@@ -0,0 +1,36 @@
+#include "MacroDefinitions.h"
+
+#include <compare.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/xxhash.h>
+
+void MacroDefinitions::define(const std::string_view name, std::string value)
+{
+    m_values[to_lower(std::string(name))] = std::move(value);
+}
+
+void MacroDefinitions::undefine(const std::string_view name) { m_values.erase(to_lower(std::string(name))); }
+
+bool MacroDefinitions::isDefined(const std::string_view name) const
+{
+    return m_values.contains(to_lower(std::string(name)));
+}
+
+std::optional<std::string_view> MacroDefinitions::value(const std::string_view name) const
+{
+    if (const auto it = m_values.find(to_lower(std::string(name))); it != m_values.end())
+        return it->second;
+    return std::nullopt;
+}
+
+std::map<std::string, std::string> MacroDefinitions::sorted() const { return {m_values.begin(), m_values.end()}; }
+
+uint64_t MacroDefinitions::hash() const
+{
+    std::string content;
+    for (const auto &[name, value]: sorted())
+    {
+        content += name + "=" + value + ";";
+    }
+    return llvm::xxh3_64bits(llvm::arrayRefFromStringRef(content));
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/// The macros of the conditional compilation. The names ignore the case like all identifiers of the language, a macro
+/// which is defined without a value has the value 1.
+class MacroDefinitions
+{
+public:
+    void define(std::string_view name, std::string value = "1");
+    void undefine(std::string_view name);
+    [[nodiscard]] bool isDefined(std::string_view name) const;
+    /// returns the value of the macro or nothing if it is not defined
+    [[nodiscard]] std::optional<std::string_view> value(std::string_view name) const;
+    /// the lower case names and the values ordered by the name
+    [[nodiscard]] std::map<std::string, std::string> sorted() const;
+    /// hash of the sorted definitions, it is the same in every process and for every order of the definitions
+    [[nodiscard]] uint64_t hash() const;
+
+private:
+    std::unordered_map<std::string, std::string> m_values;
+};
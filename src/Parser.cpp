@@ -1,12 +1,15 @@
 #include "Parser.h"
 
-#include <MacroParser.h>
 #include <ast/AddressNode.h>
 #include <ast/ArrayInitialisationNode.h>
+#include <algorithm>
 #include <cmath>
-#include <fstream>
 #include <iostream>
+#include <llvm/ADT/StringExtras.h>
 #include <llvm/IR/InstrTypes.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/xxhash.h>
+#include <mutex>
 
 #include "ast/ArrayAccessNode.h"
 #include "ast/ArrayAssignmentNode.h"
@@ -41,14 +44,100 @@
 #include "ast/types/StringType.h"
 #include "ast/types/ValueRangeType.h"
 #include "compare.h"
+#include "compiler/TimeReport.h"
 #include "magic_enum/magic_enum.hpp"
 
 
-static std::unordered_map<std::string, std::unique_ptr<UnitNode>> unitCache;
+/// modification time and content hash of a source file, a cached unit is only reused while its stamps match
+struct SourceStamp
+{
+    std::filesystem::path path;
+    std::filesystem::file_time_type modified;
+    uint64_t hash;
+};
+
+struct CachedUnit
+{
+    std::unique_ptr<UnitNode> unit;
+    /// the stamps of the unit source, of its included files and of the sources of all transitive imports
+    std::vector<SourceStamp> sources;
+    /// the number of stamps at the front which belong to the unit source and its included files
+    size_t ownSources = 1;
+};
+
+/// the unit cache is shared by all compilation jobs of the process, every access has to hold the mutex. The cached
+/// units themselves are not changed anymore, so they can be used after the mutex is released.
+static std::mutex unitCacheMutex;
+static std::unordered_map<std::string, std::shared_ptr<CachedUnit>> unitCache;
+
+static SourceStamp source_stamp(const std::filesystem::path &path, const std::filesystem::file_time_type modified,
+                                const std::string_view source)
+{
+    return SourceStamp{.path = path, .modified = modified, .hash = llvm::xxh3_64bits(source)};
+}
+
+/// the included file was loaded by the token stream, its content is the content which was lexed
+static SourceStamp included_source_stamp(const FileId file)
+{
+    const std::filesystem::path path = SourceManager::instance().filename(file);
+    std::error_code ec;
+    const auto modified = std::filesystem::last_write_time(path, ec);
+    return source_stamp(path, ec ? std::filesystem::file_time_type::min() : modified,
+                        SourceManager::instance().content(file));
+}
+
+/// the modification time is checked first, the content is only hashed again if the file was touched
+static bool is_source_unchanged(SourceStamp &stamp)
+{
+    std::error_code ec;
+    const auto modified = std::filesystem::last_write_time(stamp.path, ec);
+    if (ec)
+        return false;
+    if (modified == stamp.modified)
+        return true;
+    // the file is only hashed, so it is not added to the source manager
+    const auto source = llvm::MemoryBuffer::getFile(stamp.path.string(), false, false, true);
+    if (!source || llvm::xxh3_64bits((*source)->getBuffer()) != stamp.hash)
+        return false;
+    stamp.modified = modified;
+    return true;
+}
+
+/// a long running process (language server, compile server) sees edits of the units between two compilations
+static bool is_cached_unit_valid(CachedUnit &cachedUnit)
+{
+    return std::ranges::all_of(cachedUnit.sources, is_source_unchanged);
+}
+
+/// returns the cached unit if its sources are unchanged, changed units are removed from the cache
+static std::shared_ptr<CachedUnit> find_cached_unit(const std::string &cacheName)
+{
+    std::scoped_lock lock(unitCacheMutex);
+    const auto it = unitCache.find(cacheName);
+    if (it == unitCache.end())
+        return nullptr;
+    if (!is_cached_unit_valid(*it->second))
+    {
+        unitCache.erase(it);
+        return nullptr;
+    }
+    return it->second;
+}
+
+/// units which were loaded from an interface have no function bodies, so they are cached apart from parsed units. The
+/// macro definitions select the code of the unit, a unit is cached once for every set of definitions.
+static std::string cached_unit_name(const std::filesystem::path &path, const bool fromInterface,
+                                    const MacroDefinitions &definitions)
+{
+    return path.string() + (fromInterface ? "#interface#" : "#") + llvm::utohexstr(definitions.hash(), true);
+}
 
 Parser::Parser(const std::vector<std::filesystem::path> &rtlDirectories, std::filesystem::path path,
-               const std::unordered_map<std::string, bool> &definitions, const std::vector<Token> &tokens) :
-    m_rtlDirectories(rtlDirectories), m_file_path(std::move(path)), m_tokens(tokens), m_definitions(definitions)
+               const MacroDefinitions &definitions, const FileId file,
+               std::shared_ptr<const std::vector<Token>> tokens) :
+    m_rtlDirectories(rtlDirectories), m_file_path(std::move(path)),
+    m_tokens(file, definitions, &m_errors, std::move(tokens)),
+    m_definitions(definitions)
 {
     m_typeDefinitions.registerType("shortint", VariableType::getInteger(8));
     m_typeDefinitions.registerType("byte", VariableType::getInteger(8));
@@ -66,6 +155,14 @@ Parser::Parser(const std::vector<std::filesystem::path> &rtlDirectories, std::fi
     m_typeDefinitions.registerType("real", VariableType::getDouble());
     m_typeDefinitions.registerType("single", VariableType::getSingle());
     m_typeDefinitions.registerType("file", FileType::getFileType());
+    m_tokens.setIncludeDirectories(rtlDirectories);
+}
+
+Parser::~Parser()
+{
+    // the tokens of the included files are referenced by the nodes and the errors of the parser
+    for (const auto file: m_tokens.includedFiles())
+        adoptFile(file);
 }
 bool Parser::hasError() const
 {
@@ -82,13 +179,13 @@ void Parser::printErrors(std::ostream &outputStream, const bool printColor) cons
 }
 
 
-Token Parser::next()
+const Token &Parser::next()
 {
     ++m_current;
     return current();
 }
-Token Parser::current() { return m_tokens[m_current]; }
-bool Parser::hasNext() const { return m_current < m_tokens.size(); }
+const Token &Parser::current() { return m_tokens[m_current]; }
+bool Parser::hasNext() { return m_tokens.hasToken(m_current); }
 bool Parser::consume(const TokenType tokenType)
 {
     if (canConsume(tokenType))
@@ -101,7 +198,7 @@ bool Parser::consume(const TokenType tokenType)
 
             .token = m_tokens[m_current + 1],
             .message = "expected token '" + std::string(magic_enum::enum_name(tokenType)) + "' but found " +
-                       std::string(magic_enum::enum_name(m_tokens[m_current + 1].tokenType)) + "!"});
+                       std::string(magic_enum::enum_name(m_tokens[m_current + 1].tokenType())) + "!"});
     throw ParserException(m_errors);
 
     return false;
@@ -115,10 +212,10 @@ bool Parser::tryConsume(const TokenType tokenType)
     }
     return false;
 }
-bool Parser::canConsume(const TokenType tokenType) const { return canConsume(tokenType, 1); }
-bool Parser::canConsume(const TokenType tokenType, const size_t next) const
+bool Parser::canConsume(const TokenType tokenType) { return canConsume(tokenType, 1); }
+bool Parser::canConsume(const TokenType tokenType, const size_t next)
 {
-    return hasNext() && m_tokens[m_current + next].tokenType == tokenType;
+    return hasNext() && m_tokens[m_current + next].tokenType() == tokenType;
 }
 
 bool Parser::consumeKeyWord(const std::string &keyword)
@@ -133,9 +230,9 @@ bool Parser::consumeKeyWord(const std::string &keyword)
     throw ParserException(m_errors);
 }
 
-bool Parser::canConsumeKeyWord(const std::string &keyword) const
+bool Parser::canConsumeKeyWord(const std::string &keyword)
 {
-    return canConsume(TokenType::KEYWORD) && iequals(m_tokens[m_current + 1].lexical(), keyword);
+    return canConsume(TokenType::KEYWORD) && m_tokens[m_current + 1].symbol == Lexer::keywordSymbol(keyword);
 }
 
 bool Parser::tryConsumeKeyWord(const std::string &keyword)
@@ -150,12 +247,8 @@ bool Parser::tryConsumeKeyWord(const std::string &keyword)
 
 std::optional<std::shared_ptr<VariableType>> Parser::determinVariableTypeByName(const std::string &name) const
 {
-    for (const auto &[defName, definition]: m_typeDefinitions)
-    {
-        if (iequals(defName, name))
-            return definition;
-    }
-
+    if (auto definition = m_typeDefinitions.findType(name))
+        return definition;
     return std::nullopt;
 }
 
@@ -163,20 +256,20 @@ std::shared_ptr<ASTNode> Parser::parseEscapedString(const Token &token)
 {
     auto result = std::string{};
     size_t x = 1;
-    while (x < token.sourceLocation.num_bytes)
+    while (x < token.length)
     {
         auto next = token.lexical().find('#', x);
         if (next == std::string::npos)
-            next = token.sourceLocation.num_bytes;
+            next = token.length;
         auto tmp = token.lexical().substr(x, next - x);
         result += static_cast<char>(std::atoi(tmp.data()));
         x = next + 1;
     }
     if (result.size() == 1)
     {
-        return std::make_shared<CharConstantNode>(token, result);
+        return makeNode<CharConstantNode>(token, result);
     }
-    return std::make_shared<StringConstantNode>(token, result);
+    return makeNode<StringConstantNode>(token, result);
 }
 
 std::shared_ptr<ASTNode> Parser::parseNumber()
@@ -186,24 +279,24 @@ std::shared_ptr<ASTNode> Parser::parseNumber()
     if (token.lexical().find('.') != std::string::npos)
     {
         auto value = std::atof(token.lexical().data());
-        return std::make_shared<DoubleNode>(token, value);
+        return makeNode<DoubleNode>(token, value);
     }
 
     auto value = std::atoll(token.lexical().data());
     auto base = 1 + static_cast<int>(std::log2(value));
     base = (base > 32) ? 64 : 32;
-    return std::make_shared<NumberNode>(token, value, base);
+    return makeNode<NumberNode>(token, value, base);
 }
 bool Parser::isVariableDefined(const std::string_view &name, const size_t scope)
 {
-    return std::ranges::any_of(m_known_variable_definitions, [name, scope](const VariableDefinition &def)
-                               { return iequals(def.variableName, name) && def.scopeId <= scope; });
+    const auto definition = m_knownVariables.find(name);
+    return definition && definition->scopeId <= scope;
 }
 
 bool Parser::isConstantDefined(const std::string_view &name, const size_t scope)
 {
-    return std::ranges::any_of(m_known_variable_definitions, [name, scope](const VariableDefinition &def)
-                               { return iequals(def.variableName, name) && def.scopeId <= scope && def.constant; });
+    const auto definition = m_knownVariables.find(name);
+    return definition && definition->scopeId <= scope && definition->constant;
 }
 
 
@@ -239,27 +332,21 @@ std::optional<std::shared_ptr<VariableType>> Parser::parseVariableType(size_t sc
             consume(TokenType::DOT);
             consume(TokenType::DOT);
             const auto endConstant = parseRangeElement(scope);
-            if (const auto startNumber = std::dynamic_pointer_cast<NumberNode>(startConstant))
+            if (const auto startNumber = dyn_cast<NumberNode>(startConstant))
             {
-                if (const auto endNumber = std::dynamic_pointer_cast<NumberNode>(endConstant))
+                if (const auto endNumber = dyn_cast<NumberNode>(endConstant))
                 {
                     return std::make_shared<ValueRangeType>(typeName, startNumber->getValue(), endNumber->getValue());
                 }
-                else if (const auto accessNode = std::dynamic_pointer_cast<VariableAccessNode>(endConstant))
+                else if (const auto accessNode = dyn_cast<VariableAccessNode>(endConstant))
                 {
                     const auto varName = accessNode->expressionToken().lexical();
-                    for (auto &var: m_known_variable_definitions)
+                    if (const auto var = m_knownVariables.find(varName); var && var->constant)
                     {
-                        if (iequals(var.variableName, varName))
+                        if (const auto valueNode = dyn_cast<NumberNode>(var->value))
                         {
-                            if (var.constant)
-                            {
-                                if (const auto valueNode = std::dynamic_pointer_cast<NumberNode>(var.value))
-                                {
-                                    return std::make_shared<ValueRangeType>(typeName, startNumber->getValue(),
-                                                                            valueNode->getValue());
-                                }
-                            }
+                            return std::make_shared<ValueRangeType>(typeName, startNumber->getValue(),
+                                                                    valueNode->getValue());
                         }
                     }
                 }
@@ -306,7 +393,7 @@ std::optional<std::shared_ptr<VariableType>> Parser::parseVariableType(size_t sc
                 enumType->addEnumValue(current().lexical(), startValue);
                 if (tryConsume(TokenType::EQUAL))
                 {
-                    const auto number = std::dynamic_pointer_cast<NumberNode>(parseNumber());
+                    const auto number = dyn_cast<NumberNode>(parseNumber());
                     startValue = number->getValue();
                 }
                 tryConsume(TokenType::COMMA);
@@ -318,10 +405,10 @@ std::optional<std::shared_ptr<VariableType>> Parser::parseVariableType(size_t sc
         }
         else if (canConsume(TokenType::NUMBER))
         {
-            const auto startNumber = std::dynamic_pointer_cast<NumberNode>(parseNumber());
+            const auto startNumber = dyn_cast<NumberNode>(parseNumber());
             consume(TokenType::DOT);
             consume(TokenType::DOT);
-            const auto endNumber = std::dynamic_pointer_cast<NumberNode>(parseNumber());
+            const auto endNumber = dyn_cast<NumberNode>(parseNumber());
             consume(TokenType::RIGHT_CURLY);
             return std::make_shared<ValueRangeType>(typeName, startNumber->getValue(), endNumber->getValue());
         }
@@ -353,7 +440,7 @@ std::shared_ptr<ArrayType> Parser::parseArray(size_t scope)
     {
 
         const auto arrayStartNode = parseToken(scope);
-        if (const auto node = std::dynamic_pointer_cast<NumberNode>(arrayStartNode))
+        if (const auto node = dyn_cast<NumberNode>(arrayStartNode))
         {
             arrayStart = node->getValue();
         }
@@ -361,24 +448,18 @@ std::shared_ptr<ArrayType> Parser::parseArray(size_t scope)
         consume(TokenType::DOT);
 
         const auto arrayEndNode = parseToken(scope);
-        if (const auto node = std::dynamic_pointer_cast<NumberNode>(arrayEndNode))
+        if (const auto node = dyn_cast<NumberNode>(arrayEndNode))
         {
             arrayEnd = node->getValue();
         }
-        else if (const auto accessNode = std::dynamic_pointer_cast<VariableAccessNode>(arrayEndNode))
+        else if (const auto accessNode = dyn_cast<VariableAccessNode>(arrayEndNode))
         {
             const auto varName = accessNode->expressionToken().lexical();
-            for (auto &var: m_known_variable_definitions)
+            if (const auto var = m_knownVariables.find(varName); var && var->constant)
             {
-                if (iequals(var.variableName, varName))
+                if (const auto valueNode = dyn_cast<NumberNode>(var->value))
                 {
-                    if (var.constant)
-                    {
-                        if (const auto valueNode = std::dynamic_pointer_cast<NumberNode>(var.value))
-                        {
-                            arrayEnd = valueNode->getValue();
-                        }
-                    }
+                    arrayEnd = valueNode->getValue();
                 }
             }
         }
@@ -466,7 +547,7 @@ std::shared_ptr<ASTNode> Parser::parseArrayConstructor(size_t size)
         tryConsume(TokenType::COMMA);
     }
     consume(TokenType::RIGHT_SQUAR);
-    return std::make_shared<ArrayInitialisationNode>(startToken, arguments);
+    return makeNode<ArrayInitialisationNode>(startToken, arguments);
 }
 std::vector<VariableDefinition> Parser::parseVariableDefinitions(const size_t scope)
 {
@@ -574,7 +655,7 @@ std::shared_ptr<ASTNode> Parser::parseLogicalExpression(const size_t scope, std:
         consumeKeyWord("not");
         auto token = current();
         auto rhs = parseExpression(scope);
-        return parseExpression(scope, std::make_shared<LogicalExpressionNode>(token, LogicalOperator::NOT, rhs));
+        return parseExpression(scope, makeNode<LogicalExpressionNode>(token, LogicalOperator::NOT, rhs));
     }
 
     if (!lhs)
@@ -585,14 +666,14 @@ std::shared_ptr<ASTNode> Parser::parseLogicalExpression(const size_t scope, std:
         consumeKeyWord("or");
         auto token = current();
         auto rhs = parseExpression(scope);
-        return parseExpression(scope, std::make_shared<LogicalExpressionNode>(token, LogicalOperator::OR, lhs, rhs));
+        return parseExpression(scope, makeNode<LogicalExpressionNode>(token, LogicalOperator::OR, lhs, rhs));
     }
     if (canConsumeKeyWord("and"))
     {
         consumeKeyWord("and");
         auto token = current();
         auto rhs = parseExpression(scope);
-        return parseExpression(scope, std::make_shared<LogicalExpressionNode>(token, LogicalOperator::AND, lhs, rhs));
+        return parseExpression(scope, makeNode<LogicalExpressionNode>(token, LogicalOperator::AND, lhs, rhs));
     }
     return lhs;
 }
@@ -604,7 +685,7 @@ void Parser::checkLhsExists(const std::shared_ptr<ASTNode> &lhs, const Token &to
         m_errors.push_back(ParserError{
 
                 .token = token,
-                .message = "unexpected token " + std::string(magic_enum::enum_name(token.tokenType)) + "!"});
+                .message = "unexpected token " + std::string(magic_enum::enum_name(token.tokenType())) + "!"});
     }
 }
 /*
@@ -632,7 +713,7 @@ std::shared_ptr<ASTNode> Parser::parseBaseExpression(const size_t scope, const s
             rhs = parseBaseExpression(scope, rhs, false);
         }
 
-        return parseExpression(scope, std::make_shared<BinaryOperationNode>(operatorToken, Operator::PLUS, lhs, rhs));
+        return parseExpression(scope, makeNode<BinaryOperationNode>(operatorToken, Operator::PLUS, lhs, rhs));
     }
     if (tryConsume(TokenType::MINUS))
     {
@@ -644,21 +725,21 @@ std::shared_ptr<ASTNode> Parser::parseBaseExpression(const size_t scope, const s
             rhs = parseBaseExpression(scope, rhs, false);
         }
 
-        return parseExpression(scope, std::make_shared<BinaryOperationNode>(operatorToken, Operator::MINUS, lhs, rhs));
+        return parseExpression(scope, makeNode<BinaryOperationNode>(operatorToken, Operator::MINUS, lhs, rhs));
     }
     if (tryConsume(TokenType::MUL))
     {
         Token operatorToken = current();
         checkLhsExists(lhs, operatorToken);
         auto rhs = parseToken(scope);
-        return parseExpression(scope, std::make_shared<BinaryOperationNode>(operatorToken, Operator::MUL, lhs, rhs));
+        return parseExpression(scope, makeNode<BinaryOperationNode>(operatorToken, Operator::MUL, lhs, rhs));
     }
     if (tryConsume(TokenType::DIV))
     {
         Token operatorToken = current();
         checkLhsExists(lhs, operatorToken);
         auto rhs = parseToken(scope);
-        return parseExpression(scope, std::make_shared<BinaryOperationNode>(operatorToken, Operator::DIV, lhs, rhs));
+        return parseExpression(scope, makeNode<BinaryOperationNode>(operatorToken, Operator::DIV, lhs, rhs));
     }
     if (canConsumeKeyWord("mod"))
     {
@@ -666,7 +747,7 @@ std::shared_ptr<ASTNode> Parser::parseBaseExpression(const size_t scope, const s
         checkLhsExists(lhs, operatorToken);
         consumeKeyWord("mod");
         auto rhs = parseToken(scope);
-        return parseExpression(scope, std::make_shared<BinaryOperationNode>(operatorToken, Operator::MOD, lhs, rhs));
+        return parseExpression(scope, makeNode<BinaryOperationNode>(operatorToken, Operator::MOD, lhs, rhs));
     }
     if (canConsumeKeyWord("div"))
     {
@@ -674,17 +755,17 @@ std::shared_ptr<ASTNode> Parser::parseBaseExpression(const size_t scope, const s
         checkLhsExists(lhs, operatorToken);
         consumeKeyWord("div");
         auto rhs = parseToken(scope);
-        return parseExpression(scope, std::make_shared<BinaryOperationNode>(operatorToken, Operator::IDIV, lhs, rhs));
+        return parseExpression(scope, makeNode<BinaryOperationNode>(operatorToken, Operator::IDIV, lhs, rhs));
     }
     if (canConsume(TokenType::LEFT_CURLY))
     {
         consume(TokenType::LEFT_CURLY);
         auto result = parseExpression(scope, nullptr);
         consume(TokenType::RIGHT_CURLY);
-        if (auto binOp = std::dynamic_pointer_cast<BinaryOperationNode>(lhs))
+        if (auto binOp = dyn_cast<BinaryOperationNode>(lhs))
         {
-            result = std::make_shared<BinaryOperationNode>(binOp->expressionToken(), binOp->binoperator(), binOp->lhs(),
-                                                           result);
+            result = makeNode<BinaryOperationNode>(binOp->expressionToken(), binOp->binoperator(), binOp->lhs(),
+                                                   result);
         }
         return parseExpression(scope, result);
     }
@@ -700,11 +781,11 @@ std::shared_ptr<ASTNode> Parser::parseBaseExpression(const size_t scope, const s
             {
                 consume(TokenType::EQUAL);
                 auto rhs = parseBaseExpression(scope);
-                return std::make_shared<ComparrisionNode>(operatorToken, CMPOperator::GREATER_EQUAL, lhs, rhs);
+                return makeNode<ComparrisionNode>(operatorToken, CMPOperator::GREATER_EQUAL, lhs, rhs);
             }
             auto rhs = parseBaseExpression(scope);
             return parseExpression(scope,
-                                   std::make_shared<ComparrisionNode>(operatorToken, CMPOperator::GREATER, lhs, rhs));
+                                   makeNode<ComparrisionNode>(operatorToken, CMPOperator::GREATER, lhs, rhs));
         }
 
         if (canConsume(TokenType::LESS))
@@ -716,18 +797,18 @@ std::shared_ptr<ASTNode> Parser::parseBaseExpression(const size_t scope, const s
             {
                 consume(TokenType::EQUAL);
                 auto rhs = parseBaseExpression(scope);
-                return std::make_shared<ComparrisionNode>(operatorToken, CMPOperator::LESS_EQUAL, lhs, rhs);
+                return makeNode<ComparrisionNode>(operatorToken, CMPOperator::LESS_EQUAL, lhs, rhs);
             }
             else if (canConsume(TokenType::GREATER))
             {
                 consume(TokenType::GREATER);
                 auto rhs = parseBaseExpression(scope);
                 return parseExpression(
-                        scope, std::make_shared<ComparrisionNode>(operatorToken, CMPOperator::NOT_EQUALS, lhs, rhs));
+                        scope, makeNode<ComparrisionNode>(operatorToken, CMPOperator::NOT_EQUALS, lhs, rhs));
             }
             auto rhs = parseBaseExpression(scope);
             return parseExpression(scope,
-                                   std::make_shared<ComparrisionNode>(operatorToken, CMPOperator::LESS, lhs, rhs));
+                                   makeNode<ComparrisionNode>(operatorToken, CMPOperator::LESS, lhs, rhs));
         }
 
         if (canConsume(TokenType::BANG) && canConsume(TokenType::EQUAL, 2))
@@ -738,7 +819,7 @@ std::shared_ptr<ASTNode> Parser::parseBaseExpression(const size_t scope, const s
             checkLhsExists(lhs, operatorToken);
             auto rhs = parseBaseExpression(scope);
             return parseExpression(
-                    scope, std::make_shared<ComparrisionNode>(operatorToken, CMPOperator::NOT_EQUALS, lhs, rhs));
+                    scope, makeNode<ComparrisionNode>(operatorToken, CMPOperator::NOT_EQUALS, lhs, rhs));
         }
 
         if (canConsume(TokenType::EQUAL))
@@ -748,7 +829,7 @@ std::shared_ptr<ASTNode> Parser::parseBaseExpression(const size_t scope, const s
             checkLhsExists(lhs, operatorToken);
             auto rhs = parseBaseExpression(scope);
             return parseExpression(scope,
-                                   std::make_shared<ComparrisionNode>(operatorToken, CMPOperator::EQUALS, lhs, rhs));
+                                   makeNode<ComparrisionNode>(operatorToken, CMPOperator::EQUALS, lhs, rhs));
         }
     }
 
@@ -799,7 +880,7 @@ std::shared_ptr<ASTNode> Parser::parseVariableAssignment(size_t scope)
 
         // parse expression
         auto expression = parseExpression(scope);
-        return std::make_shared<VariableAssignmentNode>(variableNameToken, expression, dereference);
+        return makeNode<VariableAssignmentNode>(variableNameToken, expression, dereference);
     }
     else if (canConsume(TokenType::DOT))
     {
@@ -831,7 +912,7 @@ std::shared_ptr<ASTNode> Parser::parseVariableAssignment(size_t scope)
 
         auto variable = currentToken;
         auto field = fieldName;
-        return std::make_shared<FieldAssignmentNode>(variable, field, expression);
+        return makeNode<FieldAssignmentNode>(variable, field, expression);
     }
     else
     {
@@ -853,19 +934,13 @@ std::shared_ptr<ASTNode> Parser::parseVariableAssignment(size_t scope)
             return nullptr;
         }
         auto expression = parseExpression(scope);
-        return std::make_shared<ArrayAssignmentNode>(variableNameToken, index, expression);
+        return makeNode<ArrayAssignmentNode>(variableNameToken, index, expression);
     }
 }
 std::optional<std::shared_ptr<EnumType>> Parser::tryGetEnumTypeByValue(const std::string &enumKey) const
 {
-    for (const auto &[typeName, type]: m_typeDefinitions)
-    {
-        if (auto enumType = std::dynamic_pointer_cast<EnumType>(type))
-        {
-            if (enumType->hasEnumKey(enumKey))
-                return enumType;
-        }
-    }
+    if (auto enumType = m_typeDefinitions.findEnumByValue(enumKey))
+        return enumType;
     return std::nullopt;
 }
 
@@ -879,12 +954,12 @@ std::shared_ptr<ASTNode> Parser::parseRangeElement(const size_t scope)
     {
         consume(TokenType::STRING);
 
-        return std::make_shared<StringConstantNode>(current(), std::string(current().lexical()));
+        return makeNode<StringConstantNode>(current(), std::string(current().lexical()));
     }
     if (canConsume(TokenType::CHAR))
     {
         consume(TokenType::CHAR);
-        return std::make_shared<CharConstantNode>(current(), std::string(current().lexical()));
+        return makeNode<CharConstantNode>(current(), std::string(current().lexical()));
     }
     if (canConsume(TokenType::ESCAPED_STRING))
     {
@@ -898,28 +973,22 @@ std::shared_ptr<ASTNode> Parser::parseRangeElement(const size_t scope)
     }
     if (tryConsumeKeyWord("true"))
     {
-        return std::make_shared<BooleanNode>(current(), true);
+        return makeNode<BooleanNode>(current(), true);
     }
     if (tryConsumeKeyWord("false"))
     {
-        return std::make_shared<BooleanNode>(current(), false);
+        return makeNode<BooleanNode>(current(), false);
     }
     if (canConsume(TokenType::MINUS) && canConsume(TokenType::NAMEDTOKEN, 2))
     {
         consume(TokenType::MINUS);
         const auto constAccessNode = parseConstantAccess(scope);
         const auto varName = constAccessNode->expressionToken().lexical();
-        for (auto &var: m_known_variable_definitions)
+        if (const auto var = m_knownVariables.find(varName); var && var->constant)
         {
-            if (iequals(var.variableName, varName))
+            if (dyn_cast<NumberNode>(var->value))
             {
-                if (var.constant)
-                {
-                    if (const auto valueNode = std::dynamic_pointer_cast<NumberNode>(var.value))
-                    {
-                        return std::make_shared<MinusNode>(current(), var.value);
-                    }
-                }
+                return makeNode<MinusNode>(current(), var->value);
             }
         }
     }
@@ -934,7 +1003,7 @@ std::shared_ptr<ASTNode> Parser::parseConstantAccess(const size_t scope)
 
     if (auto enumType = tryGetEnumTypeByValue(token.lexical()))
     {
-        return std::make_shared<EnumAccessNode>(token, enumType.value());
+        return makeNode<EnumAccessNode>(token, enumType.value());
     }
     if (!isConstantDefined(token.lexical(), scope))
     {
@@ -944,7 +1013,7 @@ std::shared_ptr<ASTNode> Parser::parseConstantAccess(const size_t scope)
     }
     auto dereference = tryConsume(TokenType::CARET);
 
-    return std::make_shared<VariableAccessNode>(token, dereference);
+    return makeNode<VariableAccessNode>(token, dereference);
 }
 
 std::shared_ptr<ASTNode> Parser::parseVariableAccess(const size_t scope)
@@ -965,7 +1034,7 @@ std::shared_ptr<ASTNode> Parser::parseVariableAccess(const size_t scope)
         consume(TokenType::LEFT_SQUAR);
         auto indexNode = parseExpression(scope);
         consume(TokenType::RIGHT_SQUAR);
-        return std::make_shared<ArrayAccessNode>(arrayName, indexNode);
+        return makeNode<ArrayAccessNode>(arrayName, indexNode);
     }
     if (canConsume(TokenType::DOT))
     {
@@ -979,12 +1048,12 @@ std::shared_ptr<ASTNode> Parser::parseVariableAccess(const size_t scope)
                                 .message = "A variable with the name '" + token.lexical() + "' is not yet defined!"});
             return nullptr;
         }
-        return std::make_shared<FieldAccessNode>(token, field);
+        return makeNode<FieldAccessNode>(token, field);
     }
 
     if (auto enumType = tryGetEnumTypeByValue(token.lexical()))
     {
-        return std::make_shared<EnumAccessNode>(token, enumType.value());
+        return makeNode<EnumAccessNode>(token, enumType.value());
     }
     if (!isVariableDefined(token.lexical(), scope))
     {
@@ -994,7 +1063,7 @@ std::shared_ptr<ASTNode> Parser::parseVariableAccess(const size_t scope)
     }
     auto dereference = tryConsume(TokenType::CARET);
 
-    return std::make_shared<VariableAccessNode>(token, dereference);
+    return makeNode<VariableAccessNode>(token, dereference);
 }
 std::shared_ptr<ASTNode> Parser::parseToken(const size_t scope)
 {
@@ -1006,12 +1075,12 @@ std::shared_ptr<ASTNode> Parser::parseToken(const size_t scope)
     {
         consume(TokenType::STRING);
 
-        return std::make_shared<StringConstantNode>(current(), std::string(current().lexical()));
+        return makeNode<StringConstantNode>(current(), std::string(current().lexical()));
     }
     if (canConsume(TokenType::CHAR))
     {
         consume(TokenType::CHAR);
-        return std::make_shared<CharConstantNode>(current(), std::string(current().lexical()));
+        return makeNode<CharConstantNode>(current(), std::string(current().lexical()));
     }
     if (canConsume(TokenType::ESCAPED_STRING))
     {
@@ -1023,7 +1092,7 @@ std::shared_ptr<ASTNode> Parser::parseToken(const size_t scope)
         consume(TokenType::AT);
         consume(TokenType::NAMEDTOKEN);
         Token field = current();
-        return std::make_shared<AddressNode>(field);
+        return makeNode<AddressNode>(field);
     }
     if (canConsume(TokenType::NAMEDTOKEN))
     {
@@ -1037,21 +1106,21 @@ std::shared_ptr<ASTNode> Parser::parseToken(const size_t scope)
     }
     if (tryConsumeKeyWord("true"))
     {
-        return std::make_shared<BooleanNode>(current(), true);
+        return makeNode<BooleanNode>(current(), true);
     }
     if (tryConsumeKeyWord("false"))
     {
-        return std::make_shared<BooleanNode>(current(), false);
+        return makeNode<BooleanNode>(current(), false);
     }
     if (tryConsumeKeyWord("nil"))
     {
-        return std::make_shared<NilPointerNode>(current());
+        return makeNode<NilPointerNode>(current());
     }
     if (canConsume(TokenType::MINUS) && canConsume(TokenType::NAMEDTOKEN, 2))
     {
         consume(TokenType::MINUS);
         auto valueNode = parseToken(scope);
-        return std::make_shared<MinusNode>(current(), valueNode);
+        return makeNode<MinusNode>(current(), valueNode);
     }
     return nullptr;
 }
@@ -1060,7 +1129,7 @@ std::shared_ptr<ASTNode> Parser::parseRangeElementOrType(const size_t scope)
 
     if (auto type = parseVariableType(scope, false); type.has_value())
     {
-        return std::make_shared<TypeNode>(current(), type.value());
+        return makeNode<TypeNode>(current(), type.value());
     }
 
     if (auto token = parseRangeElement(scope))
@@ -1074,7 +1143,7 @@ std::shared_ptr<FunctionDefinitionNode> Parser::parseFunctionDeclaration(size_t
     consume(TokenType::NAMEDTOKEN);
     auto functionNameToken = current();
     auto functionName = current().lexical();
-    m_known_function_names.push_back(functionName);
+    m_knownFunctions.define(functionName, functionName);
     std::string libName;
     std::string externalName = functionName;
 
@@ -1084,11 +1153,11 @@ std::shared_ptr<FunctionDefinitionNode> Parser::parseFunctionDeclaration(size_t
     auto token = next();
     std::vector<FunctionArgument> functionParams;
     std::vector<FunctionAttribute> functionAttributes;
-    while (token.tokenType != TokenType::RIGHT_CURLY)
+    while (token.tokenType() != TokenType::RIGHT_CURLY)
     {
 
         bool isReference = false;
-        if (token.tokenType == TokenType::KEYWORD && iequals(token.lexical(), "var"))
+        if (token.tokenType() == TokenType::KEYWORD && token.symbol == Lexer::keywordSymbol("var"))
         {
             next();
             isReference = true;
@@ -1206,15 +1275,17 @@ std::shared_ptr<FunctionDefinitionNode> Parser::parseFunctionDeclaration(size_t
     }
 
 
-    return std::make_shared<FunctionDefinitionNode>(functionNameToken, functionName, externalName, libName,
-                                                    functionParams, !isFunction, returnType);
+    return makeNode<FunctionDefinitionNode>(functionNameToken, functionName, externalName, libName, functionParams,
+                                            !isFunction, returnType);
 }
 std::shared_ptr<FunctionDefinitionNode> Parser::parseFunctionDefinition(size_t scope, bool isFunction)
 {
+    const auto definitionBegin = current().byteOffset;
     consume(TokenType::NAMEDTOKEN);
     auto functionNameToken = current();
     auto functionName = current().lexical();
-    m_known_function_names.push_back(functionName);
+    m_knownFunctions.define(functionName, functionName);
+    m_knownVariables.enterScope();
     bool isExternalFunction = false;
     std::string libName;
     std::string externalName = functionName;
@@ -1225,11 +1296,11 @@ std::shared_ptr<FunctionDefinitionNode> Parser::parseFunctionDefinition(size_t s
     auto token = next();
     std::vector<FunctionArgument> functionParams;
     std::vector<FunctionAttribute> functionAttributes;
-    while (token.tokenType != TokenType::RIGHT_CURLY)
+    while (token.tokenType() != TokenType::RIGHT_CURLY)
     {
 
         bool isReference = false;
-        if (token.tokenType == TokenType::KEYWORD && iequals(token.lexical(), "var"))
+        if (token.tokenType() == TokenType::KEYWORD && token.symbol == Lexer::keywordSymbol("var"))
         {
             next();
             isReference = true;
@@ -1269,10 +1340,10 @@ std::shared_ptr<FunctionDefinitionNode> Parser::parseFunctionDefinition(size_t s
                 else
                 {
 
-                    m_known_variable_definitions.push_back(VariableDefinition{.variableType = type.value(),
-                                                                              .variableName = param.lexical(),
-                                                                              .token = param,
-                                                                              .scopeId = scope});
+                    m_knownVariables.define(param.lexical(), VariableDefinition{.variableType = type.value(),
+                                                                                .variableName = param.lexical(),
+                                                                                .token = param,
+                                                                                .scopeId = scope});
 
                     functionParams.push_back(FunctionArgument{.type = type.value(),
                                                               .argumentName = param.lexical(),
@@ -1317,12 +1388,14 @@ std::shared_ptr<FunctionDefinitionNode> Parser::parseFunctionDefinition(size_t s
             returnType = type.value();
         }
 
-        m_known_variable_definitions.push_back(VariableDefinition{.variableType = returnType,
-                                                                  .variableName = functionName,
-                                                                  .token = functionNameToken,
-                                                                  .scopeId = scope});
-        m_known_variable_definitions.push_back(VariableDefinition{
-                .variableType = returnType, .variableName = "result", .token = functionNameToken, .scopeId = scope});
+        m_knownVariables.define(functionName, VariableDefinition{.variableType = returnType,
+                                                                 .variableName = functionName,
+                                                                 .token = functionNameToken,
+                                                                 .scopeId = scope});
+        m_knownVariables.define("result", VariableDefinition{.variableType = returnType,
+                                                             .variableName = "result",
+                                                             .token = functionNameToken,
+                                                             .scopeId = scope});
     }
     consume(TokenType::SEMICOLON);
 
@@ -1349,8 +1422,8 @@ std::shared_ptr<FunctionDefinitionNode> Parser::parseFunctionDefinition(size_t s
     // parse function body
     if (isExternalFunction)
     {
-        functionDefinition = std::make_shared<FunctionDefinitionNode>(functionNameToken, functionName, externalName,
-                                                                      libName, functionParams, !isFunction, returnType);
+        functionDefinition = makeNode<FunctionDefinitionNode>(functionNameToken, functionName, externalName, libName,
+                                                              functionParams, !isFunction, returnType);
     }
     else
     {
@@ -1366,35 +1439,21 @@ std::shared_ptr<FunctionDefinitionNode> Parser::parseFunctionDefinition(size_t s
                                                                    .value = nullptr,
                                                                    .constant = false});
         }
-        functionDefinition = std::make_shared<FunctionDefinitionNode>(functionNameToken, functionName, functionParams,
-                                                                      functionBody, !isFunction, returnType);
+        functionDefinition = makeNode<FunctionDefinitionNode>(functionNameToken, functionName, functionParams,
+                                                              functionBody, !isFunction, returnType);
         for (auto attribute: functionAttributes)
             functionDefinition->addAttribute(attribute);
-
-        for (auto &def: functionBody->getVariableDefinitions())
+        if (functionDefinition->hasAttribute(FunctionAttribute::Inline) &&
+            functionNameToken.filename() == m_file_path.string())
         {
-            m_known_variable_definitions.erase(
-                    std::ranges::remove_if(m_known_variable_definitions, [def](const VariableDefinition &value)
-                                           { return def.variableName == value.variableName; })
-                            .begin());
-            if (!def.alias.empty())
-            {
-                m_known_variable_definitions.erase(std::ranges::remove_if(m_known_variable_definitions,
-                                                                          [def](const VariableDefinition &value)
-                                                                          { return def.alias == value.variableName; })
-                                                           .begin());
-            }
+            const auto &endToken = current();
+            m_inlineFunctionSources[functionDefinition.get()] =
+                    SourceRange{.begin = definitionBegin, .end = endToken.byteOffset + endToken.length};
         }
     }
 
-
-    for (auto &param: functionParams)
-    {
-        m_known_variable_definitions.erase(std::ranges::remove_if(m_known_variable_definitions,
-                                                                  [param](const VariableDefinition &value)
-                                                                  { return param.argumentName == value.variableName; })
-                                                   .begin());
-    }
+    // the parameters, the result and the local variables are not visible behind the function
+    m_knownVariables.exitScope();
     return functionDefinition;
 }
 
@@ -1423,7 +1482,7 @@ std::shared_ptr<ASTNode> Parser::parseStatement(size_t scope, bool withSemicolon
         m_errors.push_back(
                 ParserError{.token = m_tokens[m_current + 1],
                             .message = "unexpected token found " +
-                                       std::string(magic_enum::enum_name(m_tokens[m_current + 1].tokenType)) + "!"});
+                                       std::string(magic_enum::enum_name(m_tokens[m_current + 1].tokenType())) + "!"});
     }
 
     return result;
@@ -1440,7 +1499,7 @@ void Parser::parseConstantDefinitions(size_t scope, std::vector<VariableDefiniti
             if (definition.has_value())
             {
                 variable_definitions.push_back(definition.value());
-                m_known_variable_definitions.push_back(definition.value());
+                m_knownVariables.define(definition->variableName, definition.value());
             }
         }
     }
@@ -1459,7 +1518,7 @@ std::shared_ptr<BlockNode> Parser::parseBlock(const size_t scope)
             for (auto &definition: def)
             {
                 variable_definitions.push_back(definition);
-                m_known_variable_definitions.push_back(definition);
+                m_knownVariables.define(definition.variableName, definition);
             }
         }
     }
@@ -1482,7 +1541,7 @@ std::shared_ptr<BlockNode> Parser::parseBlock(const size_t scope)
         }
     }
 
-    return std::make_shared<BlockNode>(beginToken, variable_definitions, expressions);
+    return makeNode<BlockNode>(beginToken, variable_definitions, expressions);
 }
 std::shared_ptr<ASTNode> Parser::parseKeyword(size_t scope, bool withSemicolon)
 {
@@ -1521,7 +1580,7 @@ std::shared_ptr<ASTNode> Parser::parseKeyword(size_t scope, bool withSemicolon)
             consume(TokenType::SEMICOLON);
         }
 
-        return std::make_shared<IfConditionNode>(ifToken, condition, ifStatements, elseStatements);
+        return makeNode<IfConditionNode>(ifToken, condition, ifStatements, elseStatements);
     }
 
     if (tryConsumeKeyWord("for"))
@@ -1548,7 +1607,7 @@ std::shared_ptr<ASTNode> Parser::parseKeyword(size_t scope, bool withSemicolon)
             {
                 forNodes.emplace_back(parseStatement(scope));
             }
-            return std::make_shared<ForEachNode>(forToken, loopVariableToken, loopExpression, forNodes);
+            return makeNode<ForEachNode>(forToken, loopVariableToken, loopExpression, forNodes);
         }
 
         consume(TokenType::COLON);
@@ -1588,7 +1647,7 @@ std::shared_ptr<ASTNode> Parser::parseKeyword(size_t scope, bool withSemicolon)
         }
 
 
-        return std::make_shared<ForNode>(forToken, loopVariable, loopStart, loopEnd, forNodes, increment);
+        return makeNode<ForNode>(forToken, loopVariable, loopStart, loopEnd, forNodes, increment);
     }
     if (tryConsumeKeyWord("while"))
     {
@@ -1610,7 +1669,7 @@ std::shared_ptr<ASTNode> Parser::parseKeyword(size_t scope, bool withSemicolon)
                 consume(TokenType::SEMICOLON);
         }
 
-        return std::make_shared<WhileNode>(whileToken, expression, whileNodes);
+        return makeNode<WhileNode>(whileToken, expression, whileNodes);
     }
 
     if (tryConsumeKeyWord("repeat"))
@@ -1633,14 +1692,14 @@ std::shared_ptr<ASTNode> Parser::parseKeyword(size_t scope, bool withSemicolon)
         if (withSemicolon)
             tryConsume(TokenType::SEMICOLON);
 
-        return std::make_shared<RepeatUntilNode>(repeatToken, expression, whileNodes);
+        return makeNode<RepeatUntilNode>(repeatToken, expression, whileNodes);
     }
 
     if (tryConsumeKeyWord("break"))
     {
         if (withSemicolon)
             tryConsume(TokenType::SEMICOLON);
-        return std::make_shared<BreakNode>(current());
+        return makeNode<BreakNode>(current());
     }
 
     if (tryConsumeKeyWord("case"))
@@ -1681,7 +1740,7 @@ std::shared_ptr<ASTNode> Parser::parseKeyword(size_t scope, bool withSemicolon)
         if (withSemicolon)
             tryConsume(TokenType::SEMICOLON);
 
-        return std::make_shared<CaseNode>(token, identifier, selectors, elseExpressions);
+        return makeNode<CaseNode>(token, identifier, selectors, elseExpressions);
     }
 
     m_errors.push_back(
@@ -1695,7 +1754,7 @@ std::shared_ptr<ASTNode> Parser::parseFunctionCall(const size_t scope)
     consume(TokenType::NAMEDTOKEN);
     auto nameToken = current();
     auto functionName = current().lexical();
-    const bool isSysCall = isKnownSystemCall(functionName);
+    const bool isSysCall = isKnownSystemCall(nameToken.symbol);
     if (!isSysCall && !isFunctionDeclared(functionName))
     {
         m_errors.push_back(ParserError{
@@ -1720,50 +1779,109 @@ std::shared_ptr<ASTNode> Parser::parseFunctionCall(const size_t scope)
     consume(TokenType::RIGHT_CURLY);
     if (isSysCall)
     {
-        return std::make_shared<SystemFunctionCallNode>(nameToken, functionName, callArgs);
+        return makeNode<SystemFunctionCallNode>(nameToken, functionName, callArgs);
     }
-    return std::make_shared<FunctionCallNode>(nameToken, functionName, callArgs);
+    return makeNode<FunctionCallNode>(nameToken, functionName, callArgs);
 }
 
 bool Parser::importUnit(const Token &token, const std::string &filename, bool includeSystem)
 {
-    auto path = this->m_file_path.parent_path() / filename;
-    auto it = m_rtlDirectories.begin();
-    while (!std::filesystem::exists(path))
-    {
-        if (m_rtlDirectories.end() == it)
-            break;
-        path = *it / filename;
-        ++it;
-    }
-    if (!unitCache.contains(path.string()))
+    return importUnitFile(token, find_source_file(m_file_path.parent_path(), filename, m_rtlDirectories),
+                          includeSystem);
+}
+
+bool Parser::importUnitFile(const Token &token, const std::filesystem::path &path, bool includeSystem)
+{
+    const auto cacheName = cached_unit_name(path, !m_unitInterfaceDirectory.empty(), m_definitions);
+    auto cachedUnit = find_cached_unit(cacheName);
+    if (!cachedUnit)
     {
-        std::ifstream file;
-        std::istringstream is;
-        file.open(path, std::ios::in);
-        if (!file.is_open())
+        std::error_code ec;
+        const auto modified = std::filesystem::last_write_time(path, ec);
+        const auto sourceFile = SourceManager::instance().loadFile(path);
+        if (ec || !sourceFile)
         {
+            if (sourceFile)
+                SourceManager::instance().releaseFile(*sourceFile);
             m_errors.push_back(ParserError{.token = token, .message = path.string() + " is not a valid unit"});
             return true;
         }
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        Lexer lexer;
-        auto tokens = lexer.tokenize(path.string(), buffer.str());
-        MacroParser macroParser(m_definitions);
-        Parser parser(m_rtlDirectories, path, m_definitions, macroParser.parseFile(tokens));
-        if (auto unit = parser.parseUnit(includeSystem))
-            unitCache[path.string()] = std::move(unit);
-        for (auto &error: parser.m_errors)
+        const auto source = SourceManager::instance().content(*sourceFile);
+
+        std::unique_ptr<UnitNode> unit;
+        std::vector<SourceStamp> includeStamps;
+        if (!m_unitInterfaceDirectory.empty())
+        {
+            TimeReport::Phase phase("load interface", path.string());
+            unit = loadUnitInterface(token, path, *sourceFile);
+        }
+        if (!unit)
         {
-            m_errors.push_back(error);
+            TimeReport::Phase phase("parse unit", path.string());
+            Parser parser(m_rtlDirectories, path, m_definitions, *sourceFile);
+            parser.m_unitInterfaceDirectory = m_unitInterfaceDirectory;
+            unit = parser.parseUnit(includeSystem);
+            for (const auto includedFile: parser.m_tokens.includedFiles())
+                includeStamps.push_back(included_source_stamp(includedFile));
+            // the interface only records the unit source and the imports, units with included files are parsed again
+            if (unit && !m_unitInterfaceDirectory.empty() && !parser.hasError() && includeStamps.empty())
+            {
+                write_unit_interface(unit_interface_file(m_unitInterfaceDirectory, path), path, source,
+                                     m_definitions, *unit, parser.m_inlineFunctionSources);
+            }
+            for (auto &error: parser.m_errors)
+            {
+                m_errors.push_back(error);
+            }
+            // the errors refer to the files of the unit which failed, they are released together with this parser
+            if (!unit)
+                m_arenas.insert(m_arenas.end(), parser.m_arenas.begin(), parser.m_arenas.end());
+        }
+        // the source of a unit which failed is kept for the errors of this parser
+        if (!unit)
+            adoptFile(*sourceFile);
+        if (unit)
+        {
+            unit->arenas().front()->adoptFile(*sourceFile);
+            auto newUnit = std::make_shared<CachedUnit>(
+                    CachedUnit{.unit = std::move(unit), .sources = {source_stamp(path, modified, source)}});
+            newUnit->sources.insert(newUnit->sources.end(), includeStamps.begin(), includeStamps.end());
+            newUnit->ownSources = newUnit->sources.size();
+            std::scoped_lock lock(unitCacheMutex);
+            for (const auto &importedUnit: newUnit->unit->importedUnits())
+            {
+                // the imports were cached just before, so their stamps describe the sources which were parsed
+                if (const auto importIt = unitCache.find(
+                            cached_unit_name(importedUnit, !m_unitInterfaceDirectory.empty(), m_definitions));
+                    importIt != unitCache.end())
+                {
+                    const auto &importSources = importIt->second->sources;
+                    newUnit->sources.insert(newUnit->sources.end(), importSources.begin(),
+                                            importSources.begin() +
+                                                    static_cast<std::ptrdiff_t>(importIt->second->ownSources));
+                }
+            }
+            // another job might have imported the unit in the meantime, all jobs continue with the same instance
+            cachedUnit = unitCache.try_emplace(cacheName, std::move(newUnit)).first->second;
         }
-        if (!m_errors.empty())
+        if (!m_errors.empty() || !cachedUnit)
         {
             return true;
         }
     }
-    for (auto &[typeName, newType]: unitCache[path.string()]->getTypeDefinitions())
+    for (const auto &transitiveImport: cachedUnit->unit->importedUnits())
+    {
+        addImportedUnit(transitiveImport);
+    }
+    // the functions and variables of the unit are shared, so its arenas have to live as long as the nodes of this unit
+    for (const auto &arena: cachedUnit->unit->arenas())
+    {
+        if (std::ranges::find(m_arenas, arena) == m_arenas.end())
+            m_arenas.push_back(arena);
+    }
+    addImportedUnit(path);
+
+    for (auto &[typeName, newType]: cachedUnit->unit->getTypeDefinitions())
     {
         if (!m_typeDefinitions.hasType(typeName))
         {
@@ -1771,47 +1889,115 @@ bool Parser::importUnit(const Token &token, const std::string &filename, bool in
         }
     }
 
-    for (auto &definition: unitCache[path.string()]->getFunctionDefinitions())
+    for (auto &definition: cachedUnit->unit->getFunctionDefinitions())
     {
-        bool functionExists = false;
-        for (auto &function: m_functionDefinitions)
-        {
-
-            if (function->functionSignature() == definition->functionSignature())
-            {
-                functionExists = true;
-                break;
-            }
-        }
-        if (!functionExists)
+        // the units share their imports, a function of a unit which was imported before is already known
+        if (m_overloads.add(definition))
         {
             m_functionDefinitions.push_back(definition);
-            m_known_function_names.push_back(definition->name());
+            m_knownFunctions.define(definition->name(), definition->name());
         }
     }
 
 
     return false;
 }
-bool Parser::isFunctionDeclared(const std::string &name) const
+std::unique_ptr<UnitNode> Parser::loadUnitInterface(const Token &token, const std::filesystem::path &path,
+                                                    const FileId sourceFile)
 {
-    for (const auto &function: m_functionDefinitions)
+    auto reader = UnitInterfaceReader::open(unit_interface_file(m_unitInterfaceDirectory, path), sourceFile,
+                                            m_definitions);
+    if (!reader)
+        return nullptr;
+
+    Parser parser(m_rtlDirectories, path, m_definitions, SourceManager::noFile);
+    parser.m_unitInterfaceDirectory = m_unitInterfaceDirectory;
+    for (const auto &importedUnit: reader->importedUnits())
+    {
+        if (parser.importUnitFile(token, importedUnit, true))
+            return nullptr;
+    }
+
+    auto unitInterface = reader->read(parser.m_typeDefinitions, *parser.m_arenas.front());
+    if (!unitInterface)
+        return nullptr;
+    for (auto &[typeName, type]: unitInterface->typeDefinitions)
+    {
+        if (!parser.m_typeDefinitions.hasType(typeName))
+            parser.m_typeDefinitions.registerType(typeName, type);
+    }
+    const auto firstFunction = parser.m_functionDefinitions.size();
+    for (auto &function: unitInterface->functionDefinitions)
     {
-        if (iequals(function->name(), name))
+        parser.addFunctionDefinition(function);
+        parser.m_knownFunctions.define(function->name(), function->name());
+    }
+
+    // the bodies of inline functions are parsed again, only the tokens of the definition are scanned from the unit
+    // source, so that their positions match it
+    try
+    {
+        for (const auto &[index, range]: unitInterface->inlineFunctions)
         {
-            return true;
+            parser.m_tokens.reset(sourceFile, m_definitions, range.begin, range.end);
+            parser.m_current = 0;
+            auto &function = parser.m_functionDefinitions[firstFunction + index];
+            auto definition = parser.parseFunctionDefinition(0, !function->isProcedure());
+            if (parser.hasError() || definition->overloadKey() != function->overloadKey())
+                return nullptr;
+            function = definition;
         }
     }
-    for (const auto &function_name: m_known_function_names)
+    catch (ParserException &)
+    {
+        return nullptr;
+    }
+
+    auto unit = std::make_unique<UnitNode>(unitInterface->unitToken, UnitType::UNIT, unitInterface->unitName,
+                                           parser.m_functionDefinitions, parser.m_typeDefinitions, nullptr);
+    unit->setImportedUnits(parser.m_importedUnits);
+    unit->setArenas(parser.m_arenas);
+    return unit;
+}
+
+void Parser::clearUnitCache()
+{
+    std::scoped_lock lock(unitCacheMutex);
+    unitCache.clear();
+}
+
+void Parser::addImportedUnit(const std::filesystem::path &path)
+{
+    if (std::ranges::find(m_importedUnits, path) == m_importedUnits.end())
+        m_importedUnits.push_back(path);
+}
+
+std::vector<std::pair<std::filesystem::path, uint64_t>> Parser::unitSources(const std::filesystem::path &unitPath,
+                                                                           const MacroDefinitions &definitions)
+{
+    std::scoped_lock lock(unitCacheMutex);
+    for (const auto fromInterface: {true, false})
     {
-        if (iequals(function_name, name))
+        if (const auto it = unitCache.find(cached_unit_name(unitPath, fromInterface, definitions));
+            it != unitCache.end())
         {
-            return true;
+            std::vector<std::pair<std::filesystem::path, uint64_t>> sources;
+            for (const auto &stamp: it->second->sources)
+                sources.emplace_back(stamp.path, stamp.hash);
+            return sources;
         }
     }
-    return false;
+    return {};
+}
+
+void Parser::addFunctionDefinition(const std::shared_ptr<FunctionDefinitionNode> &function)
+{
+    m_functionDefinitions.push_back(function);
+    m_overloads.add(function);
 }
 
+bool Parser::isFunctionDeclared(const std::string &name) const { return m_knownFunctions.contains(name); }
+
 void Parser::parseInterfaceSection()
 {
     if (tryConsumeKeyWord("uses"))
@@ -1848,7 +2034,7 @@ void Parser::parseInterfaceSection()
 
                     .token = m_tokens[m_current + 1],
                     .message = "unexpected token found " +
-                               std::string(magic_enum::enum_name(m_tokens[m_current + 1].tokenType)) + "!"});
+                               std::string(magic_enum::enum_name(m_tokens[m_current + 1].tokenType())) + "!"});
             break;
         }
     }
@@ -1878,11 +2064,11 @@ void Parser::parseImplementationSection(bool includeSystem)
         }
         else if (tryConsumeKeyWord("procedure"))
         {
-            m_functionDefinitions.emplace_back(parseFunctionDefinition(0, false));
+            addFunctionDefinition(parseFunctionDefinition(0, false));
         }
         else if (tryConsumeKeyWord("function"))
         {
-            m_functionDefinitions.emplace_back(parseFunctionDefinition(0, true));
+            addFunctionDefinition(parseFunctionDefinition(0, true));
         }
         else if (!canConsumeKeyWord("end") && !canConsumeKeyWord("initialization"))
         {
@@ -1890,7 +2076,7 @@ void Parser::parseImplementationSection(bool includeSystem)
 
                     .token = m_tokens[m_current + 1],
                     .message = "unexpected token found " +
-                               std::string(magic_enum::enum_name(m_tokens[m_current + 1].tokenType)) + "!"});
+                               std::string(magic_enum::enum_name(m_tokens[m_current + 1].tokenType())) + "!"});
             break;
         }
     }
@@ -1939,7 +2125,7 @@ std::unique_ptr<UnitNode> Parser::parseUnit(bool includeSystem)
 
                         .token = m_tokens[m_current + 1],
                         .message = "unexpected token found " +
-                                   std::string(magic_enum::enum_name(m_tokens[m_current + 1].tokenType)) + "!"});
+                                   std::string(magic_enum::enum_name(m_tokens[m_current + 1].tokenType())) + "!"});
                 break;
             }
         }
@@ -1951,24 +2137,19 @@ std::unique_ptr<UnitNode> Parser::parseUnit(bool includeSystem)
 
         for (const auto &declaration: m_functionDeclarations)
         {
-            bool found = false;
-            for (const auto &def: m_functionDefinitions)
-            {
-                if (def->functionSignature() == declaration->functionSignature())
-                {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found)
+            // declarations of the interface which the implementation section does not define
+            if (m_overloads.add(declaration))
             {
                 m_functionDefinitions.emplace_back(declaration);
             }
         }
 
 
-        return std::make_unique<UnitNode>(unitNameToken, unitType, unitName, m_functionDefinitions, m_typeDefinitions,
-                                          blockNode);
+        auto unit = std::make_unique<UnitNode>(unitNameToken, unitType, unitName, m_functionDefinitions,
+                                               m_typeDefinitions, blockNode);
+        unit->setImportedUnits(m_importedUnits);
+        unit->setArenas(m_arenas);
+        return unit;
     }
     catch (ParserException &e)
     {
@@ -1996,8 +2177,8 @@ std::unique_ptr<UnitNode> Parser::parseProgram()
                 consume(TokenType::NAMEDTOKEN);
                 auto paramName = current().lexical();
                 paramNames.emplace_back(paramName);
-                m_known_variable_definitions.push_back(
-                        VariableDefinition{.variableType = m_typeDefinitions.getType("file"),
+                m_knownVariables.define(
+                        paramName, VariableDefinition{.variableType = m_typeDefinitions.getType("file"),
                                            .variableName = paramName,
                                            .token = current(),
                                            .scopeId = 0});
@@ -2036,7 +2217,7 @@ std::unique_ptr<UnitNode> Parser::parseProgram()
                     for (auto &definition: def)
                     {
                         variable_definitions.push_back(definition);
-                        m_known_variable_definitions.push_back(definition);
+                        m_knownVariables.define(definition.variableName, definition);
                     }
                 }
             }
@@ -2055,11 +2236,11 @@ std::unique_ptr<UnitNode> Parser::parseProgram()
             }
             else if (tryConsumeKeyWord("procedure"))
             {
-                m_functionDefinitions.emplace_back(parseFunctionDefinition(scope, false));
+                addFunctionDefinition(parseFunctionDefinition(scope, false));
             }
             else if (tryConsumeKeyWord("function"))
             {
-                m_functionDefinitions.emplace_back(parseFunctionDefinition(scope, true));
+                addFunctionDefinition(parseFunctionDefinition(scope, true));
             }
             else if (canConsumeKeyWord("const") || canConsumeKeyWord("var") || canConsumeKeyWord("begin"))
             {
@@ -2076,7 +2257,7 @@ std::unique_ptr<UnitNode> Parser::parseProgram()
 
                         .token = m_tokens[m_current + 1],
                         .message = "unexpected token found " +
-                                   std::string(magic_enum::enum_name(m_tokens[m_current + 1].tokenType)) + "!"});
+                                   std::string(magic_enum::enum_name(m_tokens[m_current + 1].tokenType())) + "!"});
                 break;
             }
         }
@@ -2090,8 +2271,11 @@ std::unique_ptr<UnitNode> Parser::parseProgram()
             blockNode->addVariableDefinition(var);
         }
 
-        return std::make_unique<UnitNode>(unitNameToken, unitType, unitName, paramNames, m_functionDefinitions,
-                                          m_typeDefinitions, blockNode);
+        auto unit = std::make_unique<UnitNode>(unitNameToken, unitType, unitName, paramNames, m_functionDefinitions,
+                                               m_typeDefinitions, blockNode);
+        unit->setImportedUnits(m_importedUnits);
+        unit->setArenas(m_arenas);
+        return unit;
     }
     catch (ParserException &e)
     {
@@ -2102,8 +2286,10 @@ std::unique_ptr<UnitNode> Parser::parseProgram()
 
 std::unique_ptr<UnitNode> Parser::parseFile()
 {
-    const bool isProgram = current().tokenType == TokenType::KEYWORD && iequals(current().lexical(), "program");
-    const bool isUnit = current().tokenType == TokenType::KEYWORD && iequals(current().lexical(), "unit");
+    TimeReport::Phase phase("parse", m_file_path.string());
+    // keyword tokens carry the symbol of their keyword, so the symbols are enough to tell the keywords apart
+    const bool isProgram = current().symbol == Lexer::keywordSymbol("program");
+    const bool isUnit = current().symbol == Lexer::keywordSymbol("unit");
 
     if (isProgram)
         return parseProgram();
@@ -2112,7 +2298,7 @@ std::unique_ptr<UnitNode> Parser::parseFile()
 
     m_errors.push_back(ParserError{.token = m_tokens[m_current + 1],
                                    .message = "unexpected expected token found " +
-                                              std::string(magic_enum::enum_name(m_tokens[m_current + 1].tokenType)) +
+                                              std::string(magic_enum::enum_name(m_tokens[m_current + 1].tokenType())) +
                                               "!"});
     throw ParserException(m_errors);
 }
@@ -2,9 +2,14 @@
 #include <filesystem>
 #include <map>
 #include <memory>
+#include <utility>
 #include <vector>
 #include "Lexer.h"
+#include "SymbolTable.h"
+#include "TokenStream.h"
 #include "ast/ASTNode.h"
+#include "ast/NodeArena.h"
+#include "ast/OverloadIndex.h"
 #include "ast/UnitNode.h"
 #include "ast/VariableDefinition.h"
 #include "ast/types/VariableType.h"
@@ -14,6 +19,7 @@
 
 #include "ast/types/ArrayType.h"
 #include "ast/types/TypeRegistry.h"
+#include "UnitInterface.h"
 
 
 class EnumType;
@@ -21,33 +27,49 @@ class EnumType;
 
 class Parser
 {
+    /// the arena of the nodes of the unit followed by the arenas of the imported units, whose nodes the unit shares.
+    /// They are declared first, so that they are released after every node the parser refers to.
+    std::vector<std::shared_ptr<NodeArena>> m_arenas = {std::make_shared<NodeArena>()};
     std::vector<std::filesystem::path> m_rtlDirectories;
     std::filesystem::path m_file_path;
     size_t m_current = 0;
-    std::vector<Token> m_tokens;
     std::vector<ParserError> m_errors;
+    TokenStream m_tokens;
     TypeRegistry m_typeDefinitions;
-    std::vector<VariableDefinition> m_known_variable_definitions;
-    std::vector<std::string> m_known_function_names;
+    /// the variables and constants which are visible at the current position, every function has its own scope
+    SymbolTable<VariableDefinition> m_knownVariables;
+    /// the names of all declared functions and procedures in their declared spelling
+    SymbolTable<std::string> m_knownFunctions;
     std::vector<std::shared_ptr<FunctionDefinitionNode>> m_functionDeclarations;
     std::vector<std::shared_ptr<FunctionDefinitionNode>> m_functionDefinitions;
-    std::vector<std::shared_ptr<ASTNode>> m_nodes;
-    std::unordered_map<std::string, bool> m_definitions;
+    /// the first function of m_functionDefinitions for every overload key
+    OverloadIndex m_overloads;
+    MacroDefinitions m_definitions;
     bool m_includeSystem = false;
-
-    Token next();
-    Token current();
+    std::vector<std::filesystem::path> m_importedUnits;
+    std::filesystem::path m_unitInterfaceDirectory;
+    std::unordered_map<const FunctionDefinitionNode *, SourceRange> m_inlineFunctionSources;
+
+    /// creates a node of the unit in the arena of the parser
+    template<typename T, typename... Args>
+    std::shared_ptr<T> makeNode(Args &&...args)
+    {
+        return make_node<T>(*m_arenas.front(), std::forward<Args>(args)...);
+    }
+
+    const Token &next();
+    [[nodiscard]] const Token &current();
     [[nodiscard]] bool isConstantDefined(const std::string_view &name, const size_t scope);
 
     [[nodiscard]] bool isVariableDefined(const std::string_view &name, size_t scope);
-    [[nodiscard]] bool hasNext() const;
+    [[nodiscard]] bool hasNext();
     bool consume(TokenType tokenType);
     bool tryConsume(TokenType tokenType);
-    [[nodiscard]] bool canConsume(TokenType tokenType) const;
-    [[nodiscard]] bool canConsume(TokenType tokenType, size_t next) const;
+    [[nodiscard]] bool canConsume(TokenType tokenType);
+    [[nodiscard]] bool canConsume(TokenType tokenType, size_t next);
     bool consumeKeyWord(const std::string &keyword);
     bool tryConsumeKeyWord(const std::string &keyword);
-    [[nodiscard]] bool canConsumeKeyWord(const std::string &keyword) const;
+    [[nodiscard]] bool canConsumeKeyWord(const std::string &keyword);
     [[nodiscard]] std::optional<std::shared_ptr<VariableType>>
     determinVariableTypeByName(const std::string &name) const;
     std::shared_ptr<ASTNode> parseEscapedString(const Token &token);
@@ -79,9 +101,14 @@ class Parser
 
     std::shared_ptr<FunctionDefinitionNode> parseFunctionDeclaration(size_t scope, bool isFunction);
     std::shared_ptr<FunctionDefinitionNode> parseFunctionDefinition(size_t scope, bool isFunction);
+    void addFunctionDefinition(const std::shared_ptr<FunctionDefinitionNode> &function);
 
     std::unique_ptr<UnitNode> parseUnit(bool includeSystem);
     bool importUnit(const Token &token, const std::string &filename, bool includeSystem = true);
+    bool importUnitFile(const Token &token, const std::filesystem::path &path, bool includeSystem);
+    std::unique_ptr<UnitNode> loadUnitInterface(const Token &token, const std::filesystem::path &path,
+                                                FileId sourceFile);
+    void addImportedUnit(const std::filesystem::path &path);
 
     bool isFunctionDeclared(const std::string &name) const;
 
@@ -93,13 +120,29 @@ class Parser
     void checkLhsExists(const std::shared_ptr<ASTNode> &lhs, const Token &token);
 
 public:
+    /// the tokens of the file can be passed if they were already lexed, e.g. by the language server
     Parser(const std::vector<std::filesystem::path> &rtlDirectories, std::filesystem::path path,
-           const std::unordered_map<std::string, bool> &definitions, const std::vector<Token> &tokens);
-    ~Parser() = default;
+           const MacroDefinitions &definitions, FileId file,
+           std::shared_ptr<const std::vector<Token>> tokens = nullptr);
+    ~Parser();
     [[nodiscard]] bool hasError() const;
     [[nodiscard]] bool hasMessages() const;
     void printErrors(std::ostream &outputStream, bool printColor) const;
 
     [[nodiscard]] std::unique_ptr<UnitNode> parseFile();
+    /// the file is released together with the nodes of the parser, e.g. the source which was loaded for it
+    void adoptFile(FileId file) { m_arenas.front()->adoptFile(file); }
     std::vector<ParserError> getErrors() { return m_errors; }
+
+    /// imported units are loaded from precompiled interface files in the directory, missing or outdated interfaces
+    /// are written after the unit was parsed
+    void setUnitInterfaceDirectory(const std::filesystem::path &directory) { m_unitInterfaceDirectory = directory; }
+
+    /// drops all units which were imported by earlier parsers of the process
+    static void clearUnitCache();
+
+    /// returns the paths and the content hashes of the sources of a unit which was already imported with the macro
+    /// definitions: the unit itself, its included files and the sources of its transitive imports
+    static std::vector<std::pair<std::filesystem::path, uint64_t>> unitSources(const std::filesystem::path &unitPath,
+                                                                               const MacroDefinitions &definitions);
 };
@@ -1,5 +0,0 @@
-//
-// Created by stefan on 26.12.24.
-//
-
-#include "SourceLocation.h"
@@ -0,0 +1,212 @@
+#include "SourceManager.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/xxhash.h>
+#include "scan.h"
+
+SourceManager::SourceManager() { addFile("", std::string_view{}); }
+
+SourceManager::~SourceManager() = default;
+
+SourceManager &SourceManager::instance()
+{
+    static SourceManager sourceManager;
+    return sourceManager;
+}
+
+FileId SourceManager::addFile(const std::string &filename, const std::string_view content)
+{
+    return addFile(filename, std::string(content));
+}
+
+FileId SourceManager::addFile(const std::string &filename, std::string &&content)
+{
+    auto sourceFile = std::make_unique<SourceFile>();
+    sourceFile->filename = filename;
+    sourceFile->ownedContent = std::move(content);
+    sourceFile->content = sourceFile->ownedContent;
+    return insertFile(std::move(sourceFile));
+}
+
+std::optional<FileId> SourceManager::loadFile(const std::filesystem::path &path)
+{
+    // small files and files which may change are read, llvm only maps files of at least a few pages
+    auto buffer = llvm::MemoryBuffer::getFile(path.string(), false, true, m_filesMayChange);
+    if (!buffer)
+        return std::nullopt;
+    auto sourceFile = std::make_unique<SourceFile>();
+    sourceFile->filename = path.string();
+    sourceFile->buffer = std::move(*buffer);
+    const auto content = sourceFile->buffer->getBuffer();
+    sourceFile->content = std::string_view(content.data(), content.size());
+    return insertFile(std::move(sourceFile));
+}
+
+void SourceManager::setFilesMayChange(const bool filesMayChange) { m_filesMayChange = filesMayChange; }
+
+static uint64_t content_hash(const std::string_view content)
+{
+    return llvm::xxh3_64bits(llvm::ArrayRef(reinterpret_cast<const uint8_t *>(content.data()), content.size()));
+}
+
+FileId SourceManager::insertFile(std::unique_ptr<SourceFile> sourceFile)
+{
+    const auto content = sourceFile->content;
+    if (content.size() >= std::numeric_limits<uint32_t>::max())
+        throw std::length_error("the source file " + sourceFile->filename + " is larger than 4 GiB");
+
+    const auto hash = content_hash(content);
+
+    std::lock_guard lock(m_mutex);
+    const auto [begin, end] = m_filesByHash.equal_range(hash);
+    for (auto it = begin; it != end; ++it)
+    {
+        auto &existing = *(*m_chunks[it->second / chunkSize])[it->second % chunkSize];
+        if (existing.filename == sourceFile->filename && existing.content == content)
+        {
+            ++existing.references;
+            return it->second;
+        }
+    }
+
+    FileId id;
+    if (!m_freeIds.empty())
+    {
+        id = m_freeIds.back();
+        m_freeIds.pop_back();
+    }
+    else
+    {
+        id = static_cast<FileId>(m_fileCount);
+        auto &chunk = m_chunks.at(id / chunkSize);
+        if (!chunk)
+            chunk = std::make_unique<Chunk>();
+        ++m_fileCount;
+    }
+    (*m_chunks[id / chunkSize])[id % chunkSize] = std::move(sourceFile);
+    m_filesByHash.emplace(hash, id);
+    return id;
+}
+
+void SourceManager::releaseFile(const FileId id)
+{
+    if (id == noFile)
+        return;
+    // the content is freed after the mutex is released
+    std::unique_ptr<SourceFile> released;
+    std::lock_guard lock(m_mutex);
+    auto &slot = (*m_chunks[id / chunkSize])[id % chunkSize];
+    if (--slot->references > 0)
+        return;
+    const auto [begin, end] = m_filesByHash.equal_range(content_hash(slot->content));
+    for (auto it = begin; it != end; ++it)
+    {
+        if (it->second == id)
+        {
+            m_filesByHash.erase(it);
+            break;
+        }
+    }
+    released = std::move(slot);
+    m_freeIds.push_back(id);
+}
+
+void SourceManager::retainFile(const FileId id)
+{
+    if (id == noFile)
+        return;
+    std::lock_guard lock(m_mutex);
+    ++(*m_chunks[id / chunkSize])[id % chunkSize]->references;
+}
+
+const SourceManager::SourceFile &SourceManager::file(const FileId id) const
+{
+    return *(*m_chunks[id / chunkSize])[id % chunkSize];
+}
+
+const std::string &SourceManager::filename(const FileId id) const { return file(id).filename; }
+
+std::string_view SourceManager::content(const FileId id) const { return file(id).content; }
+
+const std::vector<uint32_t> &SourceManager::lineStarts(const SourceFile &sourceFile) const
+{
+    std::call_once(sourceFile.lineTableBuilt,
+                   [&sourceFile]
+                   {
+                       const auto &content = sourceFile.content;
+                       auto &lines = sourceFile.lineStarts;
+                       const char *data = content.data();
+                       const char *end = data + content.size();
+                       lines.reserve(count_byte(data, end, '\n') + 1);
+                       lines.push_back(0);
+                       for (const char *it = find_byte(data, end, '\n'); it != end; it = find_byte(it + 1, end, '\n'))
+                           lines.push_back(static_cast<uint32_t>(it - data + 1));
+                   });
+    return sourceFile.lineStarts;
+}
+
+std::pair<size_t, size_t> SourceManager::position(const FileId id, const size_t byteOffset) const
+{
+    if (id == noFile)
+        return {0, 0};
+    const auto &lines = lineStarts(file(id));
+    const auto line = std::ranges::upper_bound(lines, byteOffset) - lines.begin();
+    return {line, byteOffset - lines[line - 1] + 1};
+}
+
+size_t SourceManager::lineStart(const FileId id, const size_t byteOffset) const
+{
+    const auto &lines = lineStarts(file(id));
+    return *(std::ranges::upper_bound(lines, byteOffset) - 1);
+}
+
+/// returns the offset of the line break at the end of the line or the size of the content for the last line
+static size_t line_end(const std::vector<uint32_t> &lines, const size_t line, const std::string_view content)
+{
+    return line < lines.size() ? lines[line] - 1 : content.size();
+}
+
+std::string_view SourceManager::sourceline(const FileId id, const size_t byteOffset) const
+{
+    const auto &sourceFile = file(id);
+    const auto &lines = lineStarts(sourceFile);
+    const auto line = static_cast<size_t>(std::ranges::upper_bound(lines, byteOffset) - lines.begin());
+    const auto start = lines[line - 1];
+    return sourceFile.content.substr(start, line_end(lines, line, sourceFile.content) - start);
+}
+
+size_t SourceManager::byteOffset(const FileId id, const size_t row, const size_t col) const
+{
+    const auto &sourceFile = file(id);
+    const auto &lines = lineStarts(sourceFile);
+    if (row == 0)
+        return 0;
+    if (row > lines.size())
+        return sourceFile.content.size();
+    const size_t start = lines[row - 1];
+    return std::min(start + std::max<size_t>(col, 1) - 1, line_end(lines, row, sourceFile.content));
+}
+
+size_t SourceManager::lineCount(const FileId id) const { return lineStarts(file(id)).size(); }
+
+size_t SourceManager::fileCount() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_fileCount - m_freeIds.size();
+}
+
+std::filesystem::path find_source_file(const std::filesystem::path &directory, const std::string &filename,
+                                       const std::vector<std::filesystem::path> &searchDirectories)
+{
+    auto path = directory / filename;
+    auto it = searchDirectories.begin();
+    while (!std::filesystem::exists(path) && it != searchDirectories.end())
+    {
+        path = *it / filename;
+        ++it;
+    }
+    return path;
+}
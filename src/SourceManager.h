@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace llvm
+{
+    class MemoryBuffer;
+}
+
+/// the index of a file in the file table of the source manager
+using FileId = uint32_t;
+
+/// Owns the content of every source file the compiler reads. Tokens only store the id of their file, the file name,
+/// the text and the line and column of a token are resolved here. An id stays valid until the file is released and
+/// can be resolved from every thread without a lock. The nodes of a unit keep the files of their tokens until the unit
+/// is released. Files on disk are mapped into memory instead of being copied, the content of every file is followed by
+/// a zero byte.
+class SourceManager
+{
+public:
+    /// the id of the empty file without a name, default constructed tokens belong to it
+    static constexpr FileId noFile = 0;
+
+    static SourceManager &instance();
+
+    /// adds the content of a file to the table, a file which was already added with the same content keeps its id
+    FileId addFile(const std::string &filename, std::string_view content);
+    /// takes over the content of a file without copying it, e.g. the text of a document of the language server
+    FileId addFile(const std::string &filename, std::string &&content);
+    /// maps a file into memory and adds it to the table, returns nothing if the file can not be read
+    std::optional<FileId> loadFile(const std::filesystem::path &path);
+    /// releases one addition of the file, e.g. an outdated version of a document of the language server. The file is
+    /// removed after its last addition was released and its id is reused, no token of the file may be used anymore.
+    void releaseFile(FileId id);
+    /// adds another addition of a file which is in the table, it has to be released separately
+    void retainFile(FileId id);
+
+    /// long running processes see edits of the files they have loaded, so the files are read instead of mapped.
+    /// Otherwise a file which is changed in place would change the text of the tokens which refer to it.
+    void setFilesMayChange(bool filesMayChange);
+
+    [[nodiscard]] const std::string &filename(FileId id) const;
+    [[nodiscard]] std::string_view content(FileId id) const;
+
+    /// returns the 1 based row and column of a byte offset, the line table of a file is built on the first query
+    [[nodiscard]] std::pair<size_t, size_t> position(FileId id, size_t byteOffset) const;
+    /// returns the byte offset of the first character of the line containing the byte offset
+    [[nodiscard]] size_t lineStart(FileId id, size_t byteOffset) const;
+    /// returns the line containing the byte offset without the line break
+    [[nodiscard]] std::string_view sourceline(FileId id, size_t byteOffset) const;
+    /// returns the byte offset of a 1 based row and column, the inverse of position. Positions past the end of a
+    /// line or of the file are clamped to it, e.g. for the cursor positions of the language server.
+    [[nodiscard]] size_t byteOffset(FileId id, size_t row, size_t col) const;
+    [[nodiscard]] size_t lineCount(FileId id) const;
+
+    [[nodiscard]] size_t fileCount() const;
+
+private:
+    SourceManager();
+    ~SourceManager();
+
+    struct SourceFile
+    {
+        std::string filename;
+        /// the content is either owned by the string or by the buffer of a mapped file
+        std::string_view content;
+        std::string ownedContent;
+        std::unique_ptr<llvm::MemoryBuffer> buffer;
+        /// the number of additions of the file which were not released, guarded by the mutex of the source manager
+        size_t references = 1;
+        mutable std::once_flag lineTableBuilt;
+        /// byte offset of the first character of every line
+        mutable std::vector<uint32_t> lineStarts;
+    };
+
+    FileId insertFile(std::unique_ptr<SourceFile> sourceFile);
+    const SourceFile &file(FileId id) const;
+    const std::vector<uint32_t> &lineStarts(const SourceFile &sourceFile) const;
+
+    /// the files are stored in chunks which are never moved, readers of a published id do not need the mutex
+    static constexpr size_t chunkSize = 1024;
+    static constexpr size_t maxChunks = 4096;
+    using Chunk = std::array<std::unique_ptr<SourceFile>, chunkSize>;
+
+    mutable std::mutex m_mutex;
+    std::array<std::unique_ptr<Chunk>, maxChunks> m_chunks;
+    size_t m_fileCount = 0;
+    /// the ids of released files, they are given to the next added files
+    std::vector<FileId> m_freeIds;
+    std::unordered_multimap<uint64_t, FileId> m_filesByHash;
+    std::atomic<bool> m_filesMayChange = false;
+};
+
+/// returns the path of a file which is imported or included from a file in the directory, the directory is searched
+/// first and the search directories afterwards. If the file does not exist the last candidate is returned.
+std::filesystem::path find_source_file(const std::filesystem::path &directory, const std::string &filename,
+                                       const std::vector<std::filesystem::path> &searchDirectories);
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "IdentifierTable.h"
+
+/// A stack of lexical scopes which map names to their definitions. The names are keyed by the symbol of their case
+/// folded spelling in the identifier table, so a lookup is one hash lookup per scope instead of a case insensitive
+/// comparison with every known name. Entering a scope pushes an empty map and leaving it drops the map with all of its
+/// definitions. The outermost scope is the global scope, it is never left.
+template<typename T>
+class SymbolTable
+{
+public:
+    SymbolTable() : m_scopes(1) {}
+
+    void enterScope() { m_scopes.emplace_back(); }
+    void exitScope()
+    {
+        if (m_scopes.size() > 1)
+            m_scopes.pop_back();
+    }
+    /// the number of scopes which were entered and not left yet, 0 in the global scope
+    [[nodiscard]] size_t depth() const { return m_scopes.size() - 1; }
+
+    /// defines the name in the innermost scope, a definition of the same name in this scope is replaced
+    T &define(const std::string_view name, T value)
+    {
+        return m_scopes.back().insert_or_assign(IdentifierTable::instance().intern(name), std::move(value)).first->second;
+    }
+
+    /// returns the definition of the innermost scope which defines the name or nullptr
+    [[nodiscard]] T *find(const std::string_view name)
+    {
+        return const_cast<T *>(static_cast<const SymbolTable *>(this)->find(name));
+    }
+    [[nodiscard]] const T *find(const std::string_view name) const
+    {
+        // a name which was never interned can not be defined
+        const auto symbol = IdentifierTable::instance().find(name);
+        if (symbol == IdentifierTable::noSymbol)
+            return nullptr;
+        for (auto scope = m_scopes.rbegin(); scope != m_scopes.rend(); ++scope)
+        {
+            if (const auto it = scope->find(symbol); it != scope->end())
+                return &it->second;
+        }
+        return nullptr;
+    }
+    [[nodiscard]] bool contains(const std::string_view name) const { return find(name) != nullptr; }
+
+private:
+    std::vector<std::unordered_map<SymbolId, T>> m_scopes;
+};
@@ -1,9 +1,14 @@
 #pragma once
-#include <filesystem>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <string>
 #include <string_view>
 #include <utility>
-#include "SourceLocation.h"
-enum class TokenType : uint16_t
+#include "IdentifierTable.h"
+#include "SourceManager.h"
+
+enum class TokenType : uint8_t
 {
     NUMBER,
     STRING,
@@ -34,32 +39,59 @@ enum class TokenType : uint16_t
     AT,
     MACRO_START,
     MACRO_END,
+    /// a token which is longer than Token::maxLength, the token stream reports it as an error
+    TOO_LONG,
 };
 
 
+/// A token only references its text in the source manager: file id, byte offset, length, kind and the symbol of
+/// identifiers and keywords fit into 16 bytes. The row and the column are computed from the line table of the file
+/// when they are needed.
 struct Token
 {
-    SourceLocation sourceLocation;
-    size_t row{};
-    size_t col{};
-    TokenType tokenType;
+    /// tokens can be at most 16 MiB long, the remaining bits of the length store the kind. The scanner turns longer
+    /// tokens into TOO_LONG tokens.
+    static constexpr uint32_t maxLength = (1u << 24) - 1;
+
+    FileId fileId = SourceManager::noFile;
+    uint32_t byteOffset = 0;
+    /// both bit fields have the same underlying type, otherwise MSVC does not pack them into one 32 bit unit
+    uint32_t length : 24 = 0;
+    uint32_t kind : 8 = static_cast<uint32_t>(TokenType::T_EOF);
+    SymbolId symbol = IdentifierTable::noSymbol;
 
-    Token() : sourceLocation(), tokenType(TokenType::T_EOF) {}
+    Token() = default;
 
-    Token(const SourceLocation &sourceLocation, const size_t row, const size_t col, const TokenType tokenType) :
-        sourceLocation(sourceLocation), row(row), col(col), tokenType(tokenType)
+    Token(const FileId fileId, const size_t byteOffset, const size_t length, const TokenType tokenType,
+          const SymbolId symbol = IdentifierTable::noSymbol) :
+        fileId(fileId), byteOffset(static_cast<uint32_t>(byteOffset)),
+        length(static_cast<uint32_t>(length)), kind(static_cast<uint32_t>(tokenType)), symbol(symbol)
     {
+        assert(length <= maxLength);
     }
 
-    Token(const Token &other) = default;
-    Token(Token &&other) = default;
-
-    Token &operator=(const Token &other) = default;
+    [[nodiscard]] TokenType tokenType() const { return static_cast<TokenType>(kind); }
 
-    [[nodiscard]] std::string lexical() const { return sourceLocation.text(); }
-    bool operator==(const Token &other) const
+    [[nodiscard]] std::string_view text() const
+    {
+        return SourceManager::instance().content(fileId).substr(byteOffset, length);
+    }
+    [[nodiscard]] std::string lexical() const { return std::string(text()); }
+    [[nodiscard]] const std::string &filename() const { return SourceManager::instance().filename(fileId); }
+    /// returns the row and the column of the token, use it instead of row() and col() if both are needed
+    [[nodiscard]] std::pair<size_t, size_t> position() const
     {
-        return sourceLocation == other.sourceLocation && row == other.row && col == other.col &&
-               tokenType == other.tokenType;
+        return SourceManager::instance().position(fileId, byteOffset);
     }
+    [[nodiscard]] size_t row() const { return SourceManager::instance().position(fileId, byteOffset).first; }
+    [[nodiscard]] size_t col() const { return SourceManager::instance().position(fileId, byteOffset).second; }
+    [[nodiscard]] size_t lineStart() const { return SourceManager::instance().lineStart(fileId, byteOffset); }
+    [[nodiscard]] std::string_view sourceline() const
+    {
+        return SourceManager::instance().sourceline(fileId, byteOffset);
+    }
+
+    bool operator==(const Token &other) const = default;
 };
+
+static_assert(sizeof(Token) == 16, "tokens are copied a lot, keep them small");
@@ -0,0 +1,642 @@
+#include "TokenStream.h"
+
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <compare.h>
+#include <compiler/TimeReport.h>
+#include <magic_enum/magic_enum.hpp>
+#include <mutex>
+#include <unordered_map>
+
+static double seconds_since(const TimeReport::Clock::time_point start)
+{
+    return std::chrono::duration<double>(TimeReport::Clock::now() - start).count();
+}
+
+static std::string_view trim_blanks(const std::string_view text)
+{
+    const auto first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos)
+        return {};
+    return text.substr(first, text.find_last_not_of(" \t\r\n") - first + 1);
+}
+
+struct CachedInclude
+{
+    FileId file = SourceManager::noFile;
+    std::shared_ptr<const std::vector<Token>> tokens;
+};
+
+/// the tokens of the included files are shared by all token streams of the process, so a file which is included by
+/// many units is only lexed once per compilation and once for all jobs of the compile server. The directives are
+/// evaluated while the tokens are streamed, so the tokens do not depend on the macro definitions. The source manager
+/// only gives a file a new id if its content changed, the tokens of the old content are replaced then. The cache holds
+/// the files of its tokens, so the id of a cached file is not given to another file.
+static std::mutex includeCacheMutex;
+static std::unordered_map<std::string, CachedInclude> includeCache;
+
+static std::shared_ptr<const std::vector<Token>> included_tokens(const FileId file)
+{
+    const auto &filename = SourceManager::instance().filename(file);
+    {
+        std::scoped_lock lock(includeCacheMutex);
+        if (const auto it = includeCache.find(filename); it != includeCache.end() && it->second.file == file)
+            return it->second.tokens;
+    }
+    // the file is lexed without holding the lock, another stream may lex it at the same time
+    auto tokens = std::make_shared<const std::vector<Token>>(Lexer().tokenize(file));
+    std::scoped_lock lock(includeCacheMutex);
+    auto &cachedInclude = includeCache[filename];
+    if (cachedInclude.file == file)
+        return cachedInclude.tokens;
+    SourceManager::instance().retainFile(file);
+    if (cachedInclude.tokens)
+        SourceManager::instance().releaseFile(cachedInclude.file);
+    cachedInclude = CachedInclude{.file = file, .tokens = tokens};
+    return tokens;
+}
+
+namespace
+{
+    /// Evaluates the condition of an {$if} directive. The operands are integers, a macro has its value and an
+    /// undefined macro is 0. The operators are the comparisons, not, and, or and defined(NAME), a comparison is 1 if
+    /// it is true.
+    class ConditionParser
+    {
+    public:
+        ConditionParser(const std::vector<Token> &tokens, const MacroDefinitions &definitions) :
+            m_tokens(tokens), m_definitions(definitions)
+        {
+        }
+
+        /// returns the value of the condition or nothing if it is malformed
+        std::optional<int64_t> parse()
+        {
+            const auto value = parseOr();
+            if (value && m_index < m_tokens.size())
+                return fail("unexpected token " + m_tokens[m_index].lexical() + " in the condition!");
+            return value;
+        }
+
+        [[nodiscard]] const std::string &error() const { return m_error; }
+        /// the token of the error, the end of the condition if it is incomplete
+        [[nodiscard]] size_t errorIndex() const { return m_index; }
+
+    private:
+        const std::vector<Token> &m_tokens;
+        const MacroDefinitions &m_definitions;
+        size_t m_index = 0;
+        std::string m_error;
+
+        std::optional<int64_t> fail(std::string message)
+        {
+            if (m_error.empty())
+                m_error = std::move(message);
+            return std::nullopt;
+        }
+
+        [[nodiscard]] bool canConsume(const TokenType tokenType, const size_t next = 0) const
+        {
+            return m_index + next < m_tokens.size() && m_tokens[m_index + next].tokenType() == tokenType;
+        }
+
+        bool tryConsumeKeyWord(const std::string_view keyword)
+        {
+            if (!canConsume(TokenType::KEYWORD) || m_tokens[m_index].symbol != Lexer::keywordSymbol(keyword))
+                return false;
+            ++m_index;
+            return true;
+        }
+
+        std::optional<int64_t> parseOr()
+        {
+            auto lhs = parseAnd();
+            while (lhs && tryConsumeKeyWord("or"))
+            {
+                const auto rhs = parseAnd();
+                if (!rhs)
+                    return std::nullopt;
+                lhs = *lhs != 0 || *rhs != 0;
+            }
+            return lhs;
+        }
+
+        std::optional<int64_t> parseAnd()
+        {
+            auto lhs = parseNot();
+            while (lhs && tryConsumeKeyWord("and"))
+            {
+                const auto rhs = parseNot();
+                if (!rhs)
+                    return std::nullopt;
+                lhs = *lhs != 0 && *rhs != 0;
+            }
+            return lhs;
+        }
+
+        std::optional<int64_t> parseNot()
+        {
+            if (!tryConsumeKeyWord("not"))
+                return parseComparison();
+            const auto value = parseNot();
+            if (!value)
+                return std::nullopt;
+            return *value == 0;
+        }
+
+        std::optional<int64_t> parseComparison()
+        {
+            const auto lhs = parsePrimary();
+            if (!lhs)
+                return std::nullopt;
+            // the lexer splits the two character operators into single characters
+            if (canConsume(TokenType::LESS) && canConsume(TokenType::GREATER, 1))
+                return compare(2, *lhs, [](const int64_t a, const int64_t b) { return a != b; });
+            if (canConsume(TokenType::LESS) && canConsume(TokenType::EQUAL, 1))
+                return compare(2, *lhs, [](const int64_t a, const int64_t b) { return a <= b; });
+            if (canConsume(TokenType::GREATER) && canConsume(TokenType::EQUAL, 1))
+                return compare(2, *lhs, [](const int64_t a, const int64_t b) { return a >= b; });
+            if (canConsume(TokenType::LESS))
+                return compare(1, *lhs, [](const int64_t a, const int64_t b) { return a < b; });
+            if (canConsume(TokenType::GREATER))
+                return compare(1, *lhs, [](const int64_t a, const int64_t b) { return a > b; });
+            if (canConsume(TokenType::EQUAL))
+                return compare(1, *lhs, [](const int64_t a, const int64_t b) { return a == b; });
+            return lhs;
+        }
+
+        std::optional<int64_t> compare(const size_t operatorLength, const int64_t lhs,
+                                       bool (*comparison)(int64_t, int64_t))
+        {
+            m_index += operatorLength;
+            const auto rhs = parsePrimary();
+            if (!rhs)
+                return std::nullopt;
+            return comparison(lhs, *rhs);
+        }
+
+        std::optional<int64_t> parseInteger(const std::string_view text, const std::string &what)
+        {
+            int64_t value = 0;
+            const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+            if (error != std::errc() || end != text.data() + text.size())
+                return fail(what + " is not an integer!");
+            return value;
+        }
+
+        std::optional<int64_t> parsePrimary()
+        {
+            if (m_index >= m_tokens.size())
+                return fail("the condition is incomplete!");
+            const auto &token = m_tokens[m_index++];
+            switch (token.tokenType())
+            {
+                case TokenType::NUMBER:
+                    return parseInteger(token.text(), "the number " + token.lexical());
+                case TokenType::LEFT_CURLY:
+                {
+                    const auto value = parseOr();
+                    if (value && !canConsume(TokenType::RIGHT_CURLY))
+                        return fail("expected token ')' in the condition!");
+                    ++m_index;
+                    return value;
+                }
+                case TokenType::KEYWORD:
+                    if (token.symbol == Lexer::keywordSymbol("true"))
+                        return 1;
+                    if (token.symbol == Lexer::keywordSymbol("false"))
+                        return 0;
+                    break;
+                case TokenType::NAMEDTOKEN:
+                {
+                    if (iequals(token.text(), "defined"))
+                    {
+                        // defined(NAME) or defined NAME
+                        const bool parenthesized = canConsume(TokenType::LEFT_CURLY);
+                        m_index += parenthesized ? 1 : 0;
+                        if (!canConsume(TokenType::NAMEDTOKEN))
+                            return fail("expected the name of a macro after defined!");
+                        const bool defined = m_definitions.isDefined(m_tokens[m_index++].text());
+                        if (parenthesized && !canConsume(TokenType::RIGHT_CURLY))
+                            return fail("expected token ')' in the condition!");
+                        m_index += parenthesized ? 1 : 0;
+                        return defined;
+                    }
+                    const auto value = m_definitions.value(token.text());
+                    if (!value)
+                        return 0;
+                    return parseInteger(*value, "the value of the macro " + token.lexical());
+                }
+                default:
+                    break;
+            }
+            --m_index;
+            return fail("unexpected token " + token.lexical() + " in the condition!");
+        }
+    };
+} // namespace
+
+TokenStream::TokenStream(const FileId fileId, MacroDefinitions definitions, std::vector<ParserError> *errors,
+                         std::shared_ptr<const std::vector<Token>> lexedTokens) :
+    m_scanner(fileId), m_lexedFile{.tokens = std::move(lexedTokens)}, m_definitions(std::move(definitions)),
+    m_errors(errors),
+    m_timed(TimeReport::current() != nullptr)
+{
+}
+
+TokenStream::~TokenStream() { report(); }
+
+void TokenStream::reset(const FileId fileId, MacroDefinitions definitions, const size_t begin, const size_t end)
+{
+    report();
+    m_scanner = Scanner(fileId, begin, end);
+    m_lexedFile = {};
+    m_definitions = std::move(definitions);
+    m_conditionals.clear();
+    m_includes.clear();
+    m_produced = 0;
+    m_end.reset();
+    m_scannedTokens = 0;
+    m_seconds = 0;
+    m_preprocessSeconds = 0;
+    m_timed = TimeReport::current() != nullptr;
+    m_reported = false;
+}
+
+void TokenStream::setIncludeDirectories(std::vector<std::filesystem::path> directories)
+{
+    m_includeDirectories = std::move(directories);
+}
+
+const Token &TokenStream::operator[](const size_t index)
+{
+    if (index >= m_produced && !m_end)
+        produce(std::max(index + 1 - m_produced, batchSize));
+    if (m_end && index >= *m_end)
+        return m_window[*m_end % capacity];
+    assert(index + capacity >= m_produced && "the token already left the window of the token stream");
+    return m_window[index % capacity];
+}
+
+bool TokenStream::hasToken(const size_t index)
+{
+    (*this)[index];
+    return !m_end || index <= *m_end;
+}
+
+const Token &TokenStream::front()
+{
+    if (m_produced == 0)
+        produce(batchSize);
+    return m_first;
+}
+
+void TokenStream::produce(const size_t count)
+{
+    const auto start = m_timed ? TimeReport::Clock::now() : TimeReport::Clock::time_point{};
+    for (size_t i = 0; i < count && !m_end; ++i)
+    {
+        const auto token = nextToken();
+        if (m_produced == 0)
+            m_first = token;
+        if (token.tokenType() == TokenType::T_EOF)
+            m_end = m_produced;
+        m_window[m_produced++ % capacity] = token;
+    }
+    if (m_timed)
+        m_seconds += seconds_since(start);
+    if (m_end)
+        report();
+}
+
+Token TokenStream::scan()
+{
+    ++m_scannedTokens;
+    while (!m_includes.empty())
+    {
+        auto &include = m_includes.back();
+        const auto &token = (*include.tokens)[include.next];
+        if (token.tokenType() != TokenType::T_EOF)
+        {
+            ++include.next;
+            return token;
+        }
+        // the including file continues behind the directive
+        m_includes.pop_back();
+    }
+    if (m_lexedFile.tokens)
+    {
+        const auto &token = (*m_lexedFile.tokens)[m_lexedFile.next];
+        if (token.tokenType() != TokenType::T_EOF)
+            ++m_lexedFile.next;
+        return token;
+    }
+    return m_scanner.next();
+}
+
+/// skips the lexed tokens up to the next directive, returns false if the tokens end before
+static bool skip_to_directive(const std::vector<Token> &tokens, size_t &next)
+{
+    while (tokens[next].tokenType() != TokenType::MACRO_START && tokens[next].tokenType() != TokenType::T_EOF)
+        ++next;
+    return tokens[next].tokenType() == TokenType::MACRO_START;
+}
+
+bool TokenStream::skipToDirective()
+{
+    while (!m_includes.empty())
+    {
+        auto &include = m_includes.back();
+        if (skip_to_directive(*include.tokens, include.next))
+            return true;
+        m_includes.pop_back();
+    }
+    if (m_lexedFile.tokens)
+        return skip_to_directive(*m_lexedFile.tokens, m_lexedFile.next);
+    return m_scanner.skipToDirective();
+}
+
+Token TokenStream::nextToken()
+{
+    while (true)
+    {
+        const auto token = scan();
+        switch (token.tokenType())
+        {
+            case TokenType::MACRO_START:
+                parseDirective(token);
+                skipInactiveRegions();
+                continue;
+            case TokenType::MACRO_END:
+                // a closing brace outside of a directive has no meaning
+                continue;
+            case TokenType::TOO_LONG:
+                addError(token, "the token is longer than 16 MiB!");
+                continue;
+            case TokenType::T_EOF:
+                for (const auto &conditional: m_conditionals)
+                    addError(conditional.directive, "the conditional is not closed by an {$endif}!");
+                m_conditionals.clear();
+                return token;
+            default:
+                return token;
+        }
+    }
+}
+
+void TokenStream::parseDirective(const Token &start)
+{
+    const auto begin = m_timed ? TimeReport::Clock::now() : TimeReport::Clock::time_point{};
+    const auto keyword = scan();
+    const auto name = keyword.text();
+    if (keyword.tokenType() != TokenType::MACROKEYWORD)
+    {
+        // other directives are ignored
+        skipDirective(keyword);
+    }
+    else if (iequals(name, "ifdef") || iequals(name, "ifndef") || iequals(name, "if"))
+    {
+        openConditional(start, keyword);
+    }
+    else if (iequals(name, "elseif") || iequals(name, "else"))
+    {
+        if (m_conditionals.empty() || m_conditionals.back().inElse)
+        {
+            addError(keyword, "unexpected {$" + keyword.lexical() + "} without an open conditional!");
+            skipDirective(keyword);
+        }
+        else if (iequals(name, "else"))
+        {
+            auto &conditional = m_conditionals.back();
+            if (expect(TokenType::MACRO_END))
+            {
+                conditional.active = !conditional.taken;
+                conditional.taken = true;
+                conditional.inElse = true;
+            }
+        }
+        else
+        {
+            // once a branch was taken the condition of a later branch is not evaluated
+            auto &conditional = m_conditionals.back();
+            if (conditional.taken)
+            {
+                skipDirective(keyword);
+                conditional.active = false;
+            }
+            else
+            {
+                conditional.active = evaluateCondition(keyword);
+                conditional.taken = conditional.active;
+            }
+        }
+    }
+    else if (iequals(name, "endif"))
+    {
+        if (expect(TokenType::MACRO_END))
+        {
+            if (m_conditionals.empty())
+                addError(keyword, "unexpected {$endif} without an open conditional!");
+            else
+                m_conditionals.pop_back();
+        }
+    }
+    else if (!isActive())
+    {
+        // definitions of inactive regions are not evaluated
+        skipDirective(keyword);
+    }
+    else if (iequals(name, "define"))
+    {
+        parseDefine(keyword);
+    }
+    else if (iequals(name, "undef"))
+    {
+        if (const auto macroName = expect(TokenType::NAMEDTOKEN); macroName && expect(TokenType::MACRO_END))
+            m_definitions.undefine(macroName->text());
+    }
+    else if (iequals(name, "include") || iequals(name, "i"))
+    {
+        parseInclude(keyword);
+    }
+    if (m_timed)
+        m_preprocessSeconds += seconds_since(begin);
+}
+
+void TokenStream::parseDefine(const Token &keyword)
+{
+    auto token = scan();
+    // {$ define(NAME) }
+    const bool parenthesized = token.tokenType() == TokenType::LEFT_CURLY;
+    if (parenthesized)
+        token = scan();
+    if (token.tokenType() != TokenType::NAMEDTOKEN)
+    {
+        addError(token, "expected the name of a macro after {$" + keyword.lexical() + "} but found " +
+                                std::string(magic_enum::enum_name(token.tokenType())) + "!");
+        skipDirective(token);
+        return;
+    }
+    const auto macroName = token;
+    if (parenthesized && !expect(TokenType::RIGHT_CURLY))
+        return;
+
+    // {$define NAME := value}, the value is the text up to the end of the directive
+    token = scan();
+    std::string value = "1";
+    if (!parenthesized && token.tokenType() == TokenType::COLON)
+    {
+        const auto colon = token;
+        if (!expect(TokenType::EQUAL))
+            return;
+        token = scan();
+        const auto valueStart = token.byteOffset;
+        while (token.tokenType() != TokenType::MACRO_END && token.tokenType() != TokenType::T_EOF)
+            token = scan();
+        const auto content = SourceManager::instance().content(colon.fileId);
+        const auto text = trim_blanks(content.substr(valueStart, token.byteOffset - valueStart));
+        if (text.empty())
+        {
+            addError(colon, "the macro " + macroName.lexical() + " has no value!");
+            return;
+        }
+        value = std::string(text);
+    }
+    if (token.tokenType() != TokenType::MACRO_END)
+    {
+        addError(token, "expected token 'MACRO_END' but found " +
+                                std::string(magic_enum::enum_name(token.tokenType())) + "!");
+        skipDirective(token);
+        return;
+    }
+    m_definitions.define(macroName.text(), std::move(value));
+}
+
+void TokenStream::parseInclude(const Token &keyword)
+{
+    // the file name is the text up to the end of the directive, a name with blanks is quoted
+    auto token = scan();
+    while (token.tokenType() != TokenType::MACRO_END && token.tokenType() != TokenType::T_EOF)
+        token = scan();
+    if (token.tokenType() != TokenType::MACRO_END)
+    {
+        addError(keyword, "the directive {$" + keyword.lexical() + "} is not closed!");
+        return;
+    }
+    const auto nameStart = keyword.byteOffset + keyword.length;
+    auto filename =
+            trim_blanks(SourceManager::instance().content(keyword.fileId).substr(nameStart, token.byteOffset - nameStart));
+    if (filename.size() >= 2 && filename.front() == '\'' && filename.back() == '\'')
+        filename = filename.substr(1, filename.size() - 2);
+    // {$I+} and {$I-} switch the i/o checks in other compilers, they are ignored
+    if (filename == "+" || filename == "-")
+        return;
+    if (filename.empty())
+    {
+        addError(keyword, "expected the name of a file after {$" + keyword.lexical() + "}!");
+        return;
+    }
+    if (m_includes.size() >= maxIncludeDepth)
+    {
+        addError(keyword, "the include files are nested too deeply!");
+        return;
+    }
+
+    const auto path = find_source_file(std::filesystem::path(keyword.filename()).parent_path(), std::string(filename),
+                                       m_includeDirectories);
+    const auto file = SourceManager::instance().loadFile(path);
+    if (!file)
+    {
+        addError(keyword, "the file " + path.string() + " can not be included!");
+        return;
+    }
+    m_includes.push_back(LexedFile{.tokens = included_tokens(*file)});
+    if (std::ranges::find(m_includedFiles, *file) == m_includedFiles.end())
+        m_includedFiles.push_back(*file);
+    else
+        SourceManager::instance().releaseFile(*file);
+}
+
+void TokenStream::openConditional(const Token &start, const Token &keyword)
+{
+    // a conditional inside of an inactive region stays inactive in all of its branches
+    if (!isActive())
+    {
+        skipDirective(keyword);
+        m_conditionals.push_back(Conditional{.directive = start, .active = false, .taken = true});
+        return;
+    }
+    bool active = false;
+    if (iequals(keyword.text(), "if"))
+    {
+        active = evaluateCondition(keyword);
+    }
+    else
+    {
+        const auto macroName = expect(TokenType::NAMEDTOKEN);
+        if (macroName && expect(TokenType::MACRO_END))
+            active = m_definitions.isDefined(macroName->text()) == iequals(keyword.text(), "ifdef");
+    }
+    m_conditionals.push_back(Conditional{.directive = start, .active = active, .taken = active});
+}
+
+bool TokenStream::evaluateCondition(const Token &keyword)
+{
+    std::vector<Token> condition;
+    auto token = scan();
+    while (token.tokenType() != TokenType::MACRO_END && token.tokenType() != TokenType::T_EOF)
+    {
+        condition.push_back(token);
+        token = scan();
+    }
+    ConditionParser parser(condition, m_definitions);
+    const auto value = parser.parse();
+    if (!value)
+    {
+        const auto index = parser.errorIndex();
+        addError(index < condition.size() ? condition[index] : token, parser.error());
+        return false;
+    }
+    if (token.tokenType() != TokenType::MACRO_END)
+        addError(keyword, "the condition is not closed!");
+    return *value != 0;
+}
+
+void TokenStream::skipInactiveRegions()
+{
+    while (!isActive() && skipToDirective())
+        parseDirective(scan());
+}
+
+std::optional<Token> TokenStream::expect(const TokenType tokenType)
+{
+    const auto token = scan();
+    if (token.tokenType() == tokenType)
+        return token;
+    addError(token, "expected token '" + std::string(magic_enum::enum_name(tokenType)) + "' but found " +
+                            std::string(magic_enum::enum_name(token.tokenType())) + "!");
+    skipDirective(token);
+    return std::nullopt;
+}
+
+void TokenStream::skipDirective(Token token)
+{
+    while (token.tokenType() != TokenType::MACRO_END && token.tokenType() != TokenType::T_EOF)
+        token = scan();
+}
+
+void TokenStream::addError(const Token &token, std::string message)
+{
+    m_errors->push_back(ParserError{.token = token, .message = std::move(message)});
+}
+
+void TokenStream::report()
+{
+    if (m_reported || !m_timed)
+        return;
+    m_reported = true;
+    const auto &filename = SourceManager::instance().filename(m_scanner.fileId());
+    TimeReport::record("lex", filename, m_seconds - m_preprocessSeconds, "tokens", m_scannedTokens);
+    TimeReport::record("preprocess", filename, m_preprocessSeconds, "tokens", m_produced);
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include <array>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "Lexer.h"
+#include "MacroDefinitions.h"
+#include "Token.h"
+#include "exceptions/CompilerException.h"
+
+/// The tokens of a file as the parser sees them. The tokens are pulled from the scanner while the parser consumes
+/// them and the compiler directives ({$define}, {$undef}, {$ifdef}, {$ifndef}, {$if}, {$elseif}, {$else} and
+/// {$endif}) are evaluated on the way, the text of an inactive region is skipped without being tokenized. The tokens of
+/// a file included by {$I file} or {$include file} are inserted in place of the directive. Only a small window of tokens
+/// is kept, so the memory does not depend on the size of the file.
+class TokenStream
+{
+public:
+    /// the number of tokens before the furthest requested token which stay accessible
+    static constexpr size_t lookbehind = 32;
+
+    /// the errors of malformed directives are added to the errors, the vector has to outlive the stream. If the tokens
+    /// of the file were already lexed, e.g. the tokens of a document of the language server, they are streamed instead
+    /// of scanning the file again.
+    TokenStream(FileId fileId, MacroDefinitions definitions, std::vector<ParserError> *errors,
+                std::shared_ptr<const std::vector<Token>> lexedTokens = nullptr);
+    ~TokenStream();
+    TokenStream(const TokenStream &) = delete;
+    TokenStream &operator=(const TokenStream &) = delete;
+
+    /// starts over with another file, e.g. to parse the body of an inline function of a unit interface again. Only the
+    /// tokens from the begin to the end offset are streamed, the begin has to be the start and the end the end of a
+    /// token which is not part of a directive.
+    void reset(FileId fileId, MacroDefinitions definitions, size_t begin = 0,
+               size_t end = std::numeric_limits<size_t>::max());
+
+    /// returns the token at the index, every index after the end of the file returns the T_EOF token
+    const Token &operator[](size_t index);
+    /// returns true if the index is not behind the T_EOF token
+    bool hasToken(size_t index);
+    /// returns the first token of the file, it stays accessible when it left the window
+    const Token &front();
+
+    [[nodiscard]] const MacroDefinitions &definitions() const { return m_definitions; }
+
+    /// included files are searched in the directory of the including file first and in the directories afterwards
+    void setIncludeDirectories(std::vector<std::filesystem::path> directories);
+    /// the files which were included since the stream was created, every file is only listed once. The stream holds one
+    /// addition of every included file in the source manager, the owner of the tokens releases them.
+    [[nodiscard]] const std::vector<FileId> &includedFiles() const { return m_includedFiles; }
+
+private:
+    static constexpr size_t capacity = 64;
+    static constexpr size_t batchSize = capacity - lookbehind;
+    /// a file which includes itself ends at this depth
+    static constexpr size_t maxIncludeDepth = 16;
+
+    struct Conditional
+    {
+        Token directive;
+        /// tokens of the current branch are passed on
+        bool active;
+        /// one of the branches was already taken
+        bool taken;
+        bool inElse = false;
+    };
+
+    /// the tokens of a file which were lexed in advance, the tokens of an included file are shared with every stream
+    /// which includes it
+    struct LexedFile
+    {
+        std::shared_ptr<const std::vector<Token>> tokens;
+        size_t next = 0;
+    };
+
+    Scanner m_scanner;
+    /// replaces the scanner if the tokens of the file of the stream were lexed in advance
+    LexedFile m_lexedFile;
+    MacroDefinitions m_definitions;
+    std::vector<ParserError> *m_errors;
+    std::vector<Conditional> m_conditionals;
+    std::vector<std::filesystem::path> m_includeDirectories;
+    /// the included files which are streamed at the moment, the innermost file is the last one
+    std::vector<LexedFile> m_includes;
+    std::vector<FileId> m_includedFiles;
+    /// the window of tokens is a ring buffer, the token at an index is stored at the index modulo the capacity
+    std::array<Token, capacity> m_window;
+    size_t m_produced = 0;
+    /// the index of the T_EOF token once it was produced
+    std::optional<size_t> m_end;
+    Token m_first;
+    size_t m_scannedTokens = 0;
+    /// the time of the stream including the preprocessing
+    double m_seconds = 0;
+    double m_preprocessSeconds = 0;
+    /// the time is only measured if a time report is active
+    bool m_timed;
+    bool m_reported = false;
+
+    void produce(size_t count);
+    /// returns the next token which is passed on to the parser
+    Token nextToken();
+    /// returns the next token of the innermost included file or of the file of the stream
+    Token scan();
+    /// skips to the next directive, returns false if the file of the stream ends before
+    bool skipToDirective();
+    void parseDirective(const Token &start);
+    void parseDefine(const Token &keyword);
+    void parseInclude(const Token &keyword);
+    /// opens a conditional, the condition is only evaluated if the enclosing region is active
+    void openConditional(const Token &start, const Token &keyword);
+    /// evaluates the condition of an {$if} or {$elseif}, a malformed condition is reported and is false
+    bool evaluateCondition(const Token &keyword);
+    /// skips directives and inactive regions until the current region is active again or the file ends
+    void skipInactiveRegions();
+    [[nodiscard]] bool isActive() const { return m_conditionals.empty() || m_conditionals.back().active; }
+    /// scans the next token of a directive, if it does not have the expected type an error is reported and the rest
+    /// of the directive is skipped
+    std::optional<Token> expect(TokenType tokenType);
+    void skipDirective(Token token);
+    void addError(const Token &token, std::string message);
+    void report();
+};
@@ -0,0 +1,746 @@
+#include "UnitInterface.h"
+
+#include <cstring>
+#include <functional>
+#include <map>
+#include <ranges>
+#include <typeinfo>
+
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Support/xxhash.h>
+
+#include "ast/types/ArrayType.h"
+#include "ast/types/EnumType.h"
+#include "ast/types/FileType.h"
+#include "ast/types/RecordType.h"
+#include "ast/types/StringType.h"
+#include "ast/types/ValueRangeType.h"
+#include "config.h"
+
+namespace
+{
+    constexpr char interfaceMagic[4] = {'W', 'X', 'U', 'I'};
+    constexpr uint32_t interfaceFormatVersion = 3;
+
+    enum class TypeKind : uint8_t
+    {
+        Plain,
+        Integer,
+        String,
+        Pointer,
+        Array,
+        Record,
+        Enum,
+        ValueRange,
+        File
+    };
+
+    /// tokens of the unit refer into its source, all other tokens carry their file, position and text
+    enum class TokenOrigin : uint8_t
+    {
+        None,
+        Unit,
+        Foreign
+    };
+
+    uint64_t source_hash(const llvm::StringRef source) { return llvm::xxh3_64bits(llvm::arrayRefFromStringRef(source)); }
+
+    std::optional<uint64_t> file_hash(const std::filesystem::path &path)
+    {
+        const auto buffer = llvm::MemoryBuffer::getFile(path.string(), false, false);
+        if (!buffer)
+            return std::nullopt;
+        return source_hash((*buffer)->getBuffer());
+    }
+
+    std::string compiler_version()
+    {
+        return std::to_string(WIRTHX_VERSION_MAJOR) + "." + std::to_string(WIRTHX_VERSION_MINOR) + "." +
+               std::to_string(WIRTHX_VERSION_PATCH);
+    }
+
+    std::optional<TypeKind> type_kind(const VariableType &type)
+    {
+        const auto &typeId = typeid(type);
+        if (typeId == typeid(VariableType))
+            return TypeKind::Plain;
+        if (typeId == typeid(IntegerType))
+            return TypeKind::Integer;
+        if (typeId == typeid(StringType))
+            return TypeKind::String;
+        if (typeId == typeid(PointerType))
+            return TypeKind::Pointer;
+        if (typeId == typeid(ArrayType))
+            return TypeKind::Array;
+        if (typeId == typeid(RecordType))
+            return TypeKind::Record;
+        if (typeId == typeid(EnumType))
+            return TypeKind::Enum;
+        if (typeId == typeid(ValueRangeType))
+            return TypeKind::ValueRange;
+        if (typeId == typeid(FileType))
+            return TypeKind::File;
+        return std::nullopt;
+    }
+
+    class InterfaceWriter
+    {
+        std::string m_data;
+
+    public:
+        template<typename T>
+        void write(const T value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            m_data.append(reinterpret_cast<const char *>(&value), sizeof(T));
+        }
+
+        void writeString(const std::string_view value)
+        {
+            write<uint64_t>(value.size());
+            m_data.append(value);
+        }
+
+        void writeToken(const Token &token, const std::string &unitFile)
+        {
+            if (token.fileId == SourceManager::noFile)
+            {
+                write(TokenOrigin::None);
+                return;
+            }
+            const bool isUnitToken = token.filename() == unitFile;
+            write(isUnitToken ? TokenOrigin::Unit : TokenOrigin::Foreign);
+            if (!isUnitToken)
+                writeString(token.filename());
+            write<uint64_t>(token.byteOffset);
+            write<uint64_t>(token.length);
+            if (!isUnitToken)
+                writeString(token.text());
+            write(token.tokenType());
+        }
+
+        [[nodiscard]] const std::string &data() const { return m_data; }
+    };
+
+    class InterfaceCursor
+    {
+        llvm::StringRef m_data;
+        size_t &m_position;
+        bool m_valid = true;
+
+    public:
+        InterfaceCursor(const llvm::StringRef data, size_t &position) : m_data(data), m_position(position) {}
+
+        [[nodiscard]] bool valid() const { return m_valid; }
+
+        template<typename T>
+        T read()
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            T value{};
+            if (!m_valid || m_position + sizeof(T) > m_data.size())
+            {
+                m_valid = false;
+                return value;
+            }
+            std::memcpy(&value, m_data.data() + m_position, sizeof(T));
+            m_position += sizeof(T);
+            return value;
+        }
+
+        std::string readString()
+        {
+            const auto length = read<uint64_t>();
+            if (!m_valid || length > m_data.size() - m_position)
+            {
+                m_valid = false;
+                return {};
+            }
+            std::string value = m_data.substr(m_position, length).str();
+            m_position += length;
+            return value;
+        }
+
+        Token readToken(const FileId unitFile)
+        {
+            const auto origin = read<TokenOrigin>();
+            if (origin == TokenOrigin::None)
+                return {};
+            if (origin != TokenOrigin::Unit && origin != TokenOrigin::Foreign)
+            {
+                m_valid = false;
+                return {};
+            }
+            const auto filename = origin == TokenOrigin::Foreign ? readString() : std::string{};
+            auto byteOffset = read<uint64_t>();
+            const auto length = read<uint64_t>();
+            auto fileId = unitFile;
+            if (origin == TokenOrigin::Foreign)
+                fileId = foreignFile(filename, readString(), byteOffset);
+            const auto tokenType = read<TokenType>();
+            const auto content = SourceManager::instance().content(fileId);
+            if (byteOffset + length > content.size())
+                m_valid = false;
+            if (!m_valid)
+                return {};
+            // the symbols are only valid in this process, so identifiers are interned again
+            auto symbol = IdentifierTable::noSymbol;
+            if (tokenType == TokenType::NAMEDTOKEN || tokenType == TokenType::KEYWORD)
+                symbol = IdentifierTable::instance().intern(content.substr(byteOffset, length));
+            return {fileId, byteOffset, length, tokenType, symbol};
+        }
+
+    private:
+        /// the file of a foreign token is only used if the token still has the same text in it, otherwise the token
+        /// refers to a file which only contains its text and its position is lost
+        FileId foreignFile(const std::string &filename, const std::string &text, uint64_t &byteOffset)
+        {
+            auto [it, inserted] = m_foreignFiles.try_emplace(filename, SourceManager::noFile);
+            if (inserted)
+            {
+                if (auto buffer = llvm::MemoryBuffer::getFile(filename, false, false))
+                    it->second = SourceManager::instance().addFile(filename, (*buffer)->getBuffer());
+            }
+            const auto content = SourceManager::instance().content(it->second);
+            if (byteOffset + text.size() <= content.size() && content.substr(byteOffset, text.size()) == text)
+                return it->second;
+            byteOffset = 0;
+            return SourceManager::instance().addFile(filename, text);
+        }
+
+        std::unordered_map<std::string, FileId> m_foreignFiles;
+    };
+
+    /// numbers all types which are reachable from the unit, types refer to each other by their number
+    class TypeTable
+    {
+        std::vector<std::shared_ptr<VariableType>> m_types;
+        std::unordered_map<const VariableType *, int64_t> m_indices;
+
+    public:
+        void add(const std::shared_ptr<VariableType> &type)
+        {
+            if (!type || m_indices.contains(type.get()))
+                return;
+            m_indices[type.get()] = static_cast<int64_t>(m_types.size());
+            m_types.push_back(type);
+
+            if (const auto pointerType = std::dynamic_pointer_cast<PointerType>(type))
+            {
+                add(pointerType->pointerBase);
+            }
+            else if (const auto arrayType = std::dynamic_pointer_cast<ArrayType>(type))
+            {
+                add(arrayType->arrayBase);
+            }
+            else if (const auto recordType = std::dynamic_pointer_cast<RecordType>(type))
+            {
+                for (size_t i = 0; i < recordType->size(); ++i)
+                    add(recordType->getField(i).variableType);
+            }
+            else if (const auto fileType = std::dynamic_pointer_cast<FileType>(type))
+            {
+                if (fileType->childType())
+                    add(fileType->childType().value());
+            }
+        }
+
+        [[nodiscard]] int64_t index(const std::shared_ptr<VariableType> &type) const
+        {
+            return type ? m_indices.at(type.get()) : -1;
+        }
+
+        [[nodiscard]] const std::vector<std::shared_ptr<VariableType>> &types() const { return m_types; }
+    };
+
+    bool write_type(InterfaceWriter &writer, const TypeTable &table, const std::shared_ptr<VariableType> &type,
+                    const std::string &unitFile)
+    {
+        const auto kind = type_kind(*type);
+        if (!kind)
+            return false;
+        writer.write(kind.value());
+        writer.writeString(type->typeName);
+        writer.write(type->baseType);
+        switch (kind.value())
+        {
+            case TypeKind::Plain:
+            case TypeKind::String:
+                break;
+            case TypeKind::Integer:
+                writer.write<uint64_t>(std::static_pointer_cast<IntegerType>(type)->length);
+                break;
+            case TypeKind::Pointer:
+                writer.write(table.index(std::static_pointer_cast<PointerType>(type)->pointerBase));
+                break;
+            case TypeKind::Array:
+            {
+                const auto arrayType = std::static_pointer_cast<ArrayType>(type);
+                writer.write<uint64_t>(arrayType->low);
+                writer.write<uint64_t>(arrayType->high);
+                writer.write(arrayType->isDynArray);
+                writer.write(table.index(arrayType->arrayBase));
+                break;
+            }
+            case TypeKind::Record:
+            {
+                const auto recordType = std::static_pointer_cast<RecordType>(type);
+                writer.write<uint64_t>(recordType->size());
+                for (size_t i = 0; i < recordType->size(); ++i)
+                {
+                    const auto field = recordType->getField(i);
+                    writer.writeString(field.variableName);
+                    writer.writeToken(field.token, unitFile);
+                    writer.write(table.index(field.variableType));
+                }
+                break;
+            }
+            case TypeKind::Enum:
+            {
+                const auto &values = std::static_pointer_cast<EnumType>(type)->values();
+                writer.write<uint64_t>(values.size());
+                for (const auto &[name, value]: values)
+                {
+                    writer.writeString(name);
+                    writer.write(value);
+                }
+                break;
+            }
+            case TypeKind::ValueRange:
+            {
+                const auto rangeType = std::static_pointer_cast<ValueRangeType>(type);
+                writer.write(rangeType->startValue());
+                writer.write(rangeType->endValue());
+                break;
+            }
+            case TypeKind::File:
+            {
+                const auto &childType = std::static_pointer_cast<FileType>(type)->childType();
+                writer.write(childType ? table.index(childType.value()) : int64_t{-1});
+                break;
+            }
+        }
+        return true;
+    }
+
+    /// type as it is stored in the interface, references to other types are resolved after all types were read
+    struct TypeRecord
+    {
+        TypeKind kind;
+        std::string typeName;
+        VariableBaseType baseType;
+        uint64_t length = 0;
+        uint64_t low = 0;
+        uint64_t high = 0;
+        bool isDynArray = false;
+        int64_t reference = -1;
+        std::vector<std::tuple<std::string, Token, int64_t>> fields;
+        std::vector<std::pair<std::string, int64_t>> enumValues;
+        int64_t startValue = 0;
+        int64_t endValue = 0;
+    };
+
+    TypeRecord read_type(InterfaceCursor &cursor, const FileId unitFile)
+    {
+        TypeRecord record{.kind = cursor.read<TypeKind>()};
+        record.typeName = cursor.readString();
+        record.baseType = cursor.read<VariableBaseType>();
+        switch (record.kind)
+        {
+            case TypeKind::Integer:
+                record.length = cursor.read<uint64_t>();
+                break;
+            case TypeKind::Pointer:
+            case TypeKind::File:
+                record.reference = cursor.read<int64_t>();
+                break;
+            case TypeKind::Array:
+                record.low = cursor.read<uint64_t>();
+                record.high = cursor.read<uint64_t>();
+                record.isDynArray = cursor.read<bool>();
+                record.reference = cursor.read<int64_t>();
+                break;
+            case TypeKind::Record:
+                for (auto count = cursor.read<uint64_t>(); cursor.valid() && count > 0; --count)
+                {
+                    auto name = cursor.readString();
+                    auto token = cursor.readToken(unitFile);
+                    record.fields.emplace_back(std::move(name), std::move(token), cursor.read<int64_t>());
+                }
+                break;
+            case TypeKind::Enum:
+                for (auto count = cursor.read<uint64_t>(); cursor.valid() && count > 0; --count)
+                {
+                    auto name = cursor.readString();
+                    record.enumValues.emplace_back(std::move(name), cursor.read<int64_t>());
+                }
+                break;
+            case TypeKind::ValueRange:
+                record.startValue = cursor.read<int64_t>();
+                record.endValue = cursor.read<int64_t>();
+                break;
+            default:
+                break;
+        }
+        return record;
+    }
+
+    /// returns the shared instance of a plain type, only unknown plain types are created
+    std::shared_ptr<VariableType> plain_type(const TypeRecord &record)
+    {
+        for (const auto &type: {VariableType::getCharacter(), VariableType::getSingle(), VariableType::getDouble(),
+                                VariableType::getBoolean(), VariableType::getPointer()})
+        {
+            if (type->baseType == record.baseType && type->typeName == record.typeName)
+                return type;
+        }
+        return std::make_shared<VariableType>(record.baseType, record.typeName);
+    }
+
+    /// creates the types which do not refer to other types and the records, whose fields are added afterwards
+    std::shared_ptr<VariableType> create_type(const TypeRecord &record)
+    {
+        switch (record.kind)
+        {
+            case TypeKind::Plain:
+                return plain_type(record);
+            case TypeKind::Integer:
+                return VariableType::getInteger(record.length);
+            case TypeKind::String:
+                return StringType::getString();
+            case TypeKind::Record:
+                return std::make_shared<RecordType>(std::vector<VariableDefinition>{}, record.typeName);
+            case TypeKind::Enum:
+            {
+                auto enumType = EnumType::getEnum(record.typeName);
+                for (const auto &[name, value]: record.enumValues)
+                    enumType->addEnumValue(name, value);
+                return enumType;
+            }
+            case TypeKind::ValueRange:
+                return std::make_shared<ValueRangeType>(record.typeName, record.startValue, record.endValue);
+            default:
+                return nullptr;
+        }
+    }
+} // namespace
+
+UnitInterfaceReader::UnitInterfaceReader(std::unique_ptr<llvm::MemoryBuffer> buffer, const FileId sourceFile) :
+    m_buffer(std::move(buffer)), m_sourceFile(sourceFile)
+{
+}
+
+UnitInterfaceReader::~UnitInterfaceReader() = default;
+
+UnitInterfaceReader::UnitInterfaceReader(UnitInterfaceReader &&other) noexcept = default;
+
+std::optional<UnitInterfaceReader> UnitInterfaceReader::open(const std::filesystem::path &interfaceFile,
+                                                             const FileId sourceFile,
+                                                             const MacroDefinitions &definitions)
+{
+    // the interface is only read, so it can be mapped into memory instead of being copied
+    auto buffer = llvm::MemoryBuffer::getFile(interfaceFile.string(), false, false);
+    if (!buffer)
+        return std::nullopt;
+
+    const auto &unitPath = SourceManager::instance().filename(sourceFile);
+    const auto source = SourceManager::instance().content(sourceFile);
+    UnitInterfaceReader reader(std::move(*buffer), sourceFile);
+    const auto data = reader.m_buffer->getBuffer();
+    if (!data.starts_with(llvm::StringRef(interfaceMagic, sizeof(interfaceMagic))))
+        return std::nullopt;
+    reader.m_position = sizeof(interfaceMagic);
+
+    InterfaceCursor cursor(data, reader.m_position);
+    if (cursor.read<uint32_t>() != interfaceFormatVersion || cursor.readString() != compiler_version() ||
+        cursor.readString() != unitPath || cursor.read<uint64_t>() != definitions.hash() ||
+        cursor.read<uint64_t>() != source_hash(source))
+        return std::nullopt;
+
+    for (auto count = cursor.read<uint64_t>(); cursor.valid() && count > 0; --count)
+    {
+        std::filesystem::path importedUnit = cursor.readString();
+        if (cursor.read<uint64_t>() != file_hash(importedUnit))
+            return std::nullopt;
+        reader.m_importedUnits.push_back(importedUnit);
+    }
+    if (!cursor.valid())
+        return std::nullopt;
+    return reader;
+}
+
+std::optional<UnitInterface> UnitInterfaceReader::read(const TypeRegistry &knownTypes, NodeArena &arena)
+{
+    InterfaceCursor cursor(m_buffer->getBuffer(), m_position);
+    UnitInterface unitInterface;
+    unitInterface.unitToken = cursor.readToken(m_sourceFile);
+    unitInterface.unitName = cursor.readString();
+
+    std::vector<TypeRecord> records;
+    for (auto count = cursor.read<uint64_t>(); cursor.valid() && count > 0; --count)
+    {
+        records.emplace_back(read_type(cursor, m_sourceFile));
+    }
+    std::vector<std::pair<std::string, int64_t>> registeredTypes;
+    for (auto count = cursor.read<uint64_t>(); cursor.valid() && count > 0; --count)
+    {
+        auto typeName = cursor.readString();
+        registeredTypes.emplace_back(std::move(typeName), cursor.read<int64_t>());
+    }
+    if (!cursor.valid())
+        return std::nullopt;
+
+    const auto validReference = [&records](const int64_t reference)
+    { return reference >= -1 && reference < static_cast<int64_t>(records.size()); };
+
+    // named types which are already known (e.g. from the imported units) keep their identity
+    std::vector<std::shared_ptr<VariableType>> types(records.size());
+    std::vector<bool> created(records.size(), false);
+    for (const auto &[typeName, index]: registeredTypes)
+    {
+        if (index < 0 || !validReference(index))
+            return std::nullopt;
+        if (knownTypes.hasType(typeName))
+            types[index] = knownTypes.getType(typeName);
+    }
+    const auto isDerived = [](const TypeKind kind)
+    { return kind == TypeKind::Pointer || kind == TypeKind::Array || kind == TypeKind::File; };
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        if (!types[i] && !isDerived(records[i].kind))
+        {
+            types[i] = create_type(records[i]);
+            created[i] = true;
+        }
+        if (!validReference(records[i].reference))
+            return std::nullopt;
+    }
+    // pointers, arrays and files are shared instances of the type context, so they are created after the type they
+    // refer to. Every cycle of types goes through a record, which exists already.
+    std::vector<bool> deriving(records.size(), false);
+    const std::function<bool(size_t)> derive = [&](const size_t i)
+    {
+        if (types[i])
+            return true;
+        if (deriving[i])
+            return false;
+        deriving[i] = true;
+        const auto &record = records[i];
+        std::shared_ptr<VariableType> base;
+        if (record.reference >= 0)
+        {
+            if (!derive(static_cast<size_t>(record.reference)))
+                return false;
+            base = types[record.reference];
+        }
+        if (record.kind == TypeKind::Pointer)
+            types[i] = PointerType::getPointerTo(base);
+        else if (record.kind == TypeKind::File)
+            types[i] = FileType::getFileType(base ? std::optional(base) : std::nullopt);
+        else if (base)
+            types[i] = record.isDynArray ? ArrayType::getDynArray(base)
+                                         : ArrayType::getFixedArray(record.low, record.high, base);
+        return types[i] != nullptr;
+    };
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        if (isDerived(records[i].kind) && !derive(i))
+            return std::nullopt;
+    }
+    const auto resolve = [&types](const int64_t reference) -> std::shared_ptr<VariableType>
+    { return reference < 0 ? nullptr : types[reference]; };
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        if (!types[i])
+            return std::nullopt;
+        if (!created[i] || records[i].kind != TypeKind::Record)
+            continue;
+        const auto recordType = std::static_pointer_cast<RecordType>(types[i]);
+        for (const auto &[fieldName, token, reference]: records[i].fields)
+        {
+            if (!validReference(reference))
+                return std::nullopt;
+            recordType->addField(
+                    VariableDefinition{.variableType = resolve(reference), .variableName = fieldName, .token = token});
+        }
+    }
+    for (const auto &[typeName, index]: registeredTypes)
+    {
+        unitInterface.typeDefinitions.registerType(typeName, types[index]);
+    }
+
+    for (auto count = cursor.read<uint64_t>(); cursor.valid() && count > 0; --count)
+    {
+        auto token = cursor.readToken(m_sourceFile);
+        auto name = cursor.readString();
+        auto externalName = cursor.readString();
+        auto libName = cursor.readString();
+        const auto isProcedure = cursor.read<bool>();
+        const auto hasBody = cursor.read<bool>();
+        const auto isInline = cursor.read<bool>();
+        const auto returnType = cursor.read<int64_t>();
+        std::vector<FunctionArgument> params;
+        for (auto paramCount = cursor.read<uint64_t>(); cursor.valid() && paramCount > 0; --paramCount)
+        {
+            FunctionArgument param;
+            param.argumentName = cursor.readString();
+            param.token = cursor.readToken(m_sourceFile);
+            const auto paramType = cursor.read<int64_t>();
+            param.isReference = cursor.read<bool>();
+            if (paramType < 0 || !validReference(paramType))
+                return std::nullopt;
+            param.type = types[paramType];
+            params.push_back(std::move(param));
+        }
+        if (!cursor.valid() || !validReference(returnType))
+            return std::nullopt;
+
+        auto function = make_node<FunctionDefinitionNode>(arena, token, name, externalName, libName, params,
+                                                          isProcedure, resolve(returnType));
+        if (isInline)
+        {
+            SourceRange range{};
+            range.begin = cursor.read<uint64_t>();
+            range.end = cursor.read<uint64_t>();
+            if (range.begin > range.end || range.end > SourceManager::instance().content(m_sourceFile).size())
+                return std::nullopt;
+            function->addAttribute(FunctionAttribute::Inline);
+            unitInterface.inlineFunctions.emplace_back(unitInterface.functionDefinitions.size(), range);
+        }
+        else if (hasBody)
+        {
+            function->setPrecompiled();
+        }
+        unitInterface.functionDefinitions.push_back(function);
+    }
+    if (!cursor.valid() || m_position != m_buffer->getBufferSize())
+        return std::nullopt;
+    return unitInterface;
+}
+
+std::filesystem::path unit_interface_file(const std::filesystem::path &directory, const std::filesystem::path &unitPath)
+{
+    return directory /
+           (unitPath.stem().string() + "-" + llvm::utohexstr(source_hash(unitPath.string()), true) + ".wxi");
+}
+
+bool write_unit_interface(const std::filesystem::path &interfaceFile, const std::filesystem::path &unitPath,
+                          const std::string_view source, const MacroDefinitions &definitions,
+                          UnitNode &unit,
+                          const std::unordered_map<const FunctionDefinitionNode *, SourceRange> &inlineFunctions)
+{
+    const auto unitFile = unitPath.string();
+    InterfaceWriter writer;
+    for (const char ch: interfaceMagic)
+        writer.write(ch);
+    writer.write(interfaceFormatVersion);
+    writer.writeString(compiler_version());
+    writer.writeString(unitFile);
+    writer.write(definitions.hash());
+    writer.write(source_hash(source));
+
+    writer.write<uint64_t>(unit.importedUnits().size());
+    for (const auto &importedUnit: unit.importedUnits())
+    {
+        const auto hash = file_hash(importedUnit);
+        if (!hash)
+            return false;
+        writer.writeString(importedUnit.string());
+        writer.write(hash.value());
+    }
+
+    writer.writeToken(unit.expressionToken(), unitFile);
+    writer.writeString(unit.getUnitName());
+
+    // only the functions of the unit itself are stored, the functions of the imports come from their own interfaces
+    std::vector<std::shared_ptr<FunctionDefinitionNode>> functions;
+    for (const auto &function: unit.getFunctionDefinitions())
+    {
+        if (function->expressionToken().filename() == unitFile)
+            functions.push_back(function);
+    }
+
+    TypeTable table;
+    const auto &typeDefinitions = unit.getTypeDefinitions();
+    for (const auto &type: typeDefinitions | std::views::values)
+    {
+        table.add(type);
+    }
+    for (const auto &function: functions)
+    {
+        table.add(function->returnType());
+        for (const auto &param: function->params())
+            table.add(param.type);
+    }
+
+    writer.write<uint64_t>(table.types().size());
+    for (const auto &type: table.types())
+    {
+        if (!write_type(writer, table, type, unitFile))
+            return false;
+    }
+    writer.write<uint64_t>(std::distance(typeDefinitions.begin(), typeDefinitions.end()));
+    for (const auto &[typeName, type]: typeDefinitions)
+    {
+        writer.writeString(typeName);
+        writer.write(table.index(type));
+    }
+
+    writer.write<uint64_t>(functions.size());
+    for (const auto &function: functions)
+    {
+        const bool isInline = function->hasAttribute(FunctionAttribute::Inline);
+        writer.writeToken(function->expressionToken(), unitFile);
+        writer.writeString(function->name());
+        writer.writeString(function->externalName());
+        writer.writeString(function->libName());
+        writer.write(function->isProcedure());
+        writer.write(function->body() != nullptr);
+        writer.write(isInline);
+        writer.write(table.index(function->returnType()));
+        writer.write<uint64_t>(function->params().size());
+        for (const auto &param: function->params())
+        {
+            writer.writeString(param.argumentName);
+            writer.writeToken(param.token, unitFile);
+            writer.write(table.index(param.type));
+            writer.write(param.isReference);
+        }
+        if (isInline)
+        {
+            // the body of an inline function is generated into every program which calls it
+            const auto range = inlineFunctions.find(function.get());
+            if (range == inlineFunctions.end())
+                return false;
+            writer.write<uint64_t>(range->second.begin);
+            writer.write<uint64_t>(range->second.end);
+        }
+    }
+
+    // the interface is written into a temporary file first, so that concurrent compilers never read a partial file
+    std::error_code ec;
+    std::filesystem::create_directories(interfaceFile.parent_path(), ec);
+    auto temporaryFile = llvm::sys::fs::TempFile::create(interfaceFile.string() + ".%%%%%%%%.tmp");
+    if (!temporaryFile)
+    {
+        llvm::consumeError(temporaryFile.takeError());
+        return false;
+    }
+    bool written;
+    {
+        llvm::raw_fd_ostream stream(temporaryFile->FD, false);
+        stream << writer.data();
+        stream.flush();
+        written = !stream.has_error();
+        stream.clear_error();
+    }
+    if (auto error = written ? temporaryFile->keep(interfaceFile.string()) : temporaryFile->discard())
+    {
+        llvm::consumeError(std::move(error));
+        return false;
+    }
+    return written;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "MacroDefinitions.h"
+#include "ast/FunctionDefinitionNode.h"
+#include "ast/NodeArena.h"
+#include "ast/UnitNode.h"
+#include "ast/types/TypeRegistry.h"
+
+namespace llvm
+{
+    class MemoryBuffer;
+}
+
+/// byte range of a function definition inside of the source of its unit
+struct SourceRange
+{
+    size_t begin;
+    size_t end;
+};
+
+/// declarations of a unit which were loaded from its precompiled interface file
+struct UnitInterface
+{
+    Token unitToken;
+    std::string unitName;
+    TypeRegistry typeDefinitions;
+    /// functions which are defined by the unit itself, functions of imported units are not part of the interface
+    std::vector<std::shared_ptr<FunctionDefinitionNode>> functionDefinitions;
+    /// source ranges of the inline functions, their bodies have to be parsed again to be generated into the program
+    std::vector<std::pair<size_t, SourceRange>> inlineFunctions;
+};
+
+/// A precompiled unit interface stores the types and function headers of a unit in a binary format, so that the
+/// unit can be imported without lexing and parsing it again. The interface is only valid as long as the sources of
+/// the unit and of all of its imports are unchanged.
+class UnitInterfaceReader
+{
+private:
+    std::unique_ptr<llvm::MemoryBuffer> m_buffer;
+    FileId m_sourceFile;
+    std::vector<std::filesystem::path> m_importedUnits;
+    size_t m_position = 0;
+
+    UnitInterfaceReader(std::unique_ptr<llvm::MemoryBuffer> buffer, FileId sourceFile);
+
+public:
+    ~UnitInterfaceReader();
+    UnitInterfaceReader(UnitInterfaceReader &&other) noexcept;
+
+    /// maps the interface file and checks that it belongs to the current sources and macro definitions, the source
+    /// file of the unit is the file of the source manager the tokens of the unit refer to
+    static std::optional<UnitInterfaceReader> open(const std::filesystem::path &interfaceFile, FileId sourceFile,
+                                                   const MacroDefinitions &definitions);
+
+    /// the transitive imports of the unit, they have to be imported before the interface is read
+    [[nodiscard]] const std::vector<std::filesystem::path> &importedUnits() const { return m_importedUnits; }
+
+    /// reads the declarations of the unit, named types which are already known are shared with the known types. The
+    /// function nodes are created in the arena of the unit.
+    std::optional<UnitInterface> read(const TypeRegistry &knownTypes, NodeArena &arena);
+};
+
+/// path of the interface file of the unit inside of the interface directory
+std::filesystem::path unit_interface_file(const std::filesystem::path &directory,
+                                          const std::filesystem::path &unitPath);
+
+/// writes the interface of a parsed unit, returns false if the unit contains declarations which can not be stored
+bool write_unit_interface(const std::filesystem::path &interfaceFile, const std::filesystem::path &unitPath,
+                          std::string_view source, const MacroDefinitions &definitions,
+                          UnitNode &unit,
+                          const std::unordered_map<const FunctionDefinitionNode *, SourceRange> &inlineFunctions);
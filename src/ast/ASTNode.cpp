@@ -1,13 +1,26 @@
 #include "ASTNode.h"
 
 #include <compiler/Context.h>
+#include <compiler/TimeReport.h>
 #include <llvm/IR/Function.h>
 
 #include "UnitNode.h"
 
-ASTNode::ASTNode(const Token &token) : m_token(token) {}
+ASTNode::ASTNode(const NodeKind kind, const Token &token) : m_kind(kind), m_token(token)
+{
+    TimeReport::count("ast nodes", 1);
+}
+
+std::shared_ptr<VariableType> ASTNode::resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode)
+{
+    if (!unit)
+        return computeType(unit, parentNode);
+    if (auto type = unit->annotatedType(this, parentNode))
+        return type;
+    return unit->annotateType(this, parentNode, computeType(unit, parentNode));
+}
 
-std::shared_ptr<VariableType> ASTNode::resolveType([[maybe_unused]] const std::unique_ptr<UnitNode> &unit,
+std::shared_ptr<VariableType> ASTNode::computeType([[maybe_unused]] const std::unique_ptr<UnitNode> &unit,
                                                    ASTNode *parentNode)
 {
     return std::make_shared<VariableType>();
@@ -1,4 +1,5 @@
 #pragma once
+#include <cassert>
 #include <memory>
 #include <optional>
 #include "types/VariableType.h"
@@ -13,14 +14,58 @@ class Context;
 
 class UnitNode;
 
+/// the concrete class of a node. A class with subclasses owns the range from its own kind to the kind of its last
+/// subclass, so a check for the class is a range check.
+enum class NodeKind
+{
+    Address,
+    ArrayAccess,
+    ArrayAssignment,
+    ArrayInitialisation,
+    BinaryOperation,
+    Block,
+    Boolean,
+    Break,
+    Case,
+    CharConstant,
+    Comparrision,
+    Double,
+    EnumAccess,
+    FieldAccess,
+    FieldAssignment,
+    ForEach,
+    For,
+    FunctionCall,
+    SystemFunctionCall,
+    LastFunctionCall = SystemFunctionCall,
+    FunctionDefinition,
+    IfCondition,
+    LogicalExpression,
+    Number,
+    Minus,
+    LastNumber = Minus,
+    NilPointer,
+    RepeatUntil,
+    Return,
+    StringConstant,
+    Type,
+    Unit,
+    VariableAccess,
+    VariableAssignment,
+    While,
+};
+
 class ASTNode
 {
+    NodeKind m_kind;
     Token m_token;
 
 public:
-    explicit ASTNode(const Token &token);
+    ASTNode(NodeKind kind, const Token &token);
     virtual ~ASTNode() = default;
 
+    [[nodiscard]] NodeKind kind() const { return m_kind; }
+
     virtual void print() = 0;
     virtual llvm::Value *codegen(std::unique_ptr<Context> &context) = 0;
     virtual llvm::Value *codegenForTargetType(std::unique_ptr<Context> &context,
@@ -29,7 +74,11 @@ public:
         return codegen(context);
     }
 
-    virtual std::shared_ptr<VariableType> resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode);
+    /// returns the type of the expression. The type is computed once and annotated in the unit, later calls during the
+    /// type check and the codegen read the annotation.
+    std::shared_ptr<VariableType> resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode);
+    /// determines the type of the expression, the nodes resolve the types of their sub expressions with resolveType
+    virtual std::shared_ptr<VariableType> computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode);
     virtual std::optional<std::shared_ptr<ASTNode>> block() { return std::nullopt; }
     virtual void typeCheck(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) {};
 
@@ -37,3 +86,47 @@ public:
     static ASTNode *resolveParent(const std::unique_ptr<Context> &context);
     [[nodiscard]] virtual bool tokenIsPartOfNode(const Token &token) const { return m_token == token; }
 };
+
+/// returns true if the node is a T. The node classes implement classof with the kind of the node, so the check needs
+/// no rtti.
+template<typename T>
+bool isa(const ASTNode *node)
+{
+    return node != nullptr && T::classof(node);
+}
+template<typename T, typename From>
+bool isa(const std::shared_ptr<From> &node)
+{
+    return isa<T>(node.get());
+}
+
+/// returns the node as a T or nullptr if it is no T
+template<typename T>
+T *dyn_cast(ASTNode *node)
+{
+    return isa<T>(node) ? static_cast<T *>(node) : nullptr;
+}
+template<typename T>
+const T *dyn_cast(const ASTNode *node)
+{
+    return isa<T>(node) ? static_cast<const T *>(node) : nullptr;
+}
+template<typename T, typename From>
+std::shared_ptr<T> dyn_cast(const std::shared_ptr<From> &node)
+{
+    return isa<T>(node.get()) ? std::static_pointer_cast<T>(node) : nullptr;
+}
+
+/// returns the node as a T, the node has to be a T
+template<typename T>
+T *cast(ASTNode *node)
+{
+    assert(isa<T>(node) && "cast to a node of another kind");
+    return static_cast<T *>(node);
+}
+template<typename T, typename From>
+std::shared_ptr<T> cast(const std::shared_ptr<From> &node)
+{
+    assert(isa<T>(node.get()) && "cast to a node of another kind");
+    return std::static_pointer_cast<T>(node);
+}
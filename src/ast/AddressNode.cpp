@@ -5,7 +5,7 @@
 #include "UnitNode.h"
 #include "VariableAccessNode.h"
 
-AddressNode::AddressNode(const Token &token) : ASTNode(token), m_variableName(token.lexical()) {}
+AddressNode::AddressNode(const Token &token) : ASTNode(NodeKind::Address, token), m_variableName(token.lexical()) {}
 
 void AddressNode::print() {}
 
@@ -20,7 +20,7 @@ llvm::Value *AddressNode::codegen(std::unique_ptr<Context> &context)
     // Load the value.
     return allocatedValue.value();
 }
-std::shared_ptr<VariableType> AddressNode::resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode)
+std::shared_ptr<VariableType> AddressNode::computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode)
 {
     VariableAccessNode node(this->expressionToken(), false);
     const auto nodeType = node.resolveType(unit, parentNode);
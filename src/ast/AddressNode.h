@@ -10,11 +10,12 @@ private:
 public:
     explicit AddressNode(const Token &token);
     ~AddressNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::Address; }
 
     void print() override;
 
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
 
-    std::shared_ptr<VariableType> resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
+    std::shared_ptr<VariableType> computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
     void typeCheck(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
 };
@@ -13,55 +13,31 @@
 
 
 ArrayAccessNode::ArrayAccessNode(Token arrayName, const std::shared_ptr<ASTNode> &indexNode) :
-    ASTNode(arrayName), m_arrayNameToken(std::move(arrayName)), m_indexNode(indexNode)
+    ASTNode(NodeKind::ArrayAccess, arrayName), m_arrayNameToken(std::move(arrayName)), m_indexNode(indexNode)
 {
 }
 
 void ArrayAccessNode::print() {}
 
 
-std::shared_ptr<VariableType> ArrayAccessNode::resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode)
+std::shared_ptr<VariableType> ArrayAccessNode::variableType(const std::unique_ptr<UnitNode> &unit,
+                                                            ASTNode *parentNode) const
 {
-    std::shared_ptr<VariableType> varType = nullptr;
-
-    if (parentNode)
+    if (const auto functionDefinition = dyn_cast<FunctionDefinitionNode>(parentNode))
     {
-        if (auto func = dynamic_cast<FunctionDefinitionNode *>(parentNode))
-        {
-            if (const auto param = func->getParam(m_arrayNameToken.lexical()))
-            {
-                varType = param.value().type;
-            }
-            else if (const auto variableDef = func->body()->getVariableDefinition(m_arrayNameToken.lexical()))
-            {
-                varType = variableDef->variableType;
-            }
-        }
-    }
-
-    if (!varType)
-    {
-        if (const auto definition = unit->getVariableDefinition(m_arrayNameToken.lexical()); !definition)
-        {
-            if (const auto functionDefinition = dynamic_cast<FunctionDefinitionNode *>(parentNode))
-            {
-                if (const auto param = functionDefinition->getParam(m_arrayNameToken.lexical()))
-                {
-                    varType = param.value().type;
-                }
-                else if (const auto variableDef =
-                                 functionDefinition->body()->getVariableDefinition(m_arrayNameToken.lexical()))
-                {
-                    varType = variableDef->variableType;
-                }
-            }
-        }
-        else
-        {
-            varType = definition->variableType;
-        }
+        if (const auto param = functionDefinition->getParam(m_arrayNameToken.lexical()))
+            return param.value().type;
+        if (const auto variableDef = functionDefinition->body()->getVariableDefinition(m_arrayNameToken.lexical()))
+            return variableDef->variableType;
     }
+    if (const auto definition = unit->getVariableDefinition(m_arrayNameToken.lexical()))
+        return definition->variableType;
+    return nullptr;
+}
 
+std::shared_ptr<VariableType> ArrayAccessNode::computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode)
+{
+    const auto varType = variableType(unit, parentNode);
     if (varType)
     {
         if (const auto array = std::dynamic_pointer_cast<ArrayType>(varType))
@@ -73,11 +49,11 @@ std::shared_ptr<VariableType> ArrayAccessNode::resolveType(const std::unique_ptr
 }
 Token ArrayAccessNode::expressionToken()
 {
-    const auto start = m_arrayNameToken.sourceLocation.byte_offset;
-    const auto end = m_indexNode->expressionToken().sourceLocation.byte_offset;
+    const auto start = m_arrayNameToken.byteOffset;
+    const auto end = m_indexNode->expressionToken().byteOffset;
     Token token = m_arrayNameToken;
-    token.sourceLocation.num_bytes = end - start + m_indexNode->expressionToken().sourceLocation.num_bytes + 1;
-    token.sourceLocation.byte_offset = start;
+    token.length = end - start + m_indexNode->expressionToken().length + 1;
+    token.byteOffset = start;
     return token;
 }
 
@@ -87,27 +63,7 @@ llvm::Value *ArrayAccessNode::codegen(std::unique_ptr<Context> &context)
     if (!context->findValue(m_arrayNameToken.lexical()))
         return LogErrorV("Unknown variable for array access: " + m_arrayNameToken.lexical());
 
-    const auto parent = resolveParent(context);
-
-    const auto arrayDef = context->programUnit()->getVariableDefinition(m_arrayNameToken.lexical());
-    std::shared_ptr<VariableType> arrayDefType = nullptr;
-    if (arrayDef)
-    {
-        arrayDefType = arrayDef->variableType;
-    }
-
-    if (const auto functionDefinition = dynamic_cast<FunctionDefinitionNode *>(parent))
-    {
-        if (const auto param = functionDefinition->getParam(m_arrayNameToken.lexical()))
-        {
-            arrayDefType = param.value().type;
-        }
-        else if (const auto variableDef = functionDefinition->body()->getVariableDefinition(m_arrayNameToken.lexical()))
-        {
-            arrayDefType = variableDef->variableType;
-        }
-    }
-
+    const auto arrayDefType = variableType(context->programUnit(), resolveParent(context));
     if (!arrayDefType)
     {
         return LogErrorV("Unknown variable for array access: " + m_arrayNameToken.lexical());
@@ -115,7 +71,6 @@ llvm::Value *ArrayAccessNode::codegen(std::unique_ptr<Context> &context)
     if (const auto fieldAccessType = std::dynamic_pointer_cast<FieldAccessableType>(arrayDefType))
     {
         Token token = expressionToken();
-        std::vector<std::shared_ptr<ASTNode>> args = {std::make_shared<VariableAccessNode>(m_arrayNameToken, false)};
 
         auto index = m_indexNode->codegen(context);
         constexpr unsigned maxBitWith = 64;
@@ -9,13 +9,18 @@ private:
     Token m_arrayNameToken;
     std::shared_ptr<ASTNode> m_indexNode;
 
+    /// the type of the accessed variable, a parameter or a local variable of the function shadows a global variable
+    [[nodiscard]] std::shared_ptr<VariableType> variableType(const std::unique_ptr<UnitNode> &unit,
+                                                             ASTNode *parentNode) const;
+
 public:
     ArrayAccessNode(Token arrayName, const std::shared_ptr<ASTNode> &indexNode);
     ~ArrayAccessNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::ArrayAccess; }
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
 
-    std::shared_ptr<VariableType> resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
+    std::shared_ptr<VariableType> computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
 
     Token expressionToken() override;
 };
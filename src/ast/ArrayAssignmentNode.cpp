@@ -13,8 +13,8 @@
 
 ArrayAssignmentNode::ArrayAssignmentNode(const Token &arrayToken, const std::shared_ptr<ASTNode> &indexNode,
                                          const std::shared_ptr<ASTNode> &expression) :
-    ASTNode(arrayToken), m_arrayToken(arrayToken), m_variableName(std::string(arrayToken.lexical())),
-    m_indexNode(indexNode), m_expression(expression)
+    ASTNode(NodeKind::ArrayAssignment, arrayToken), m_arrayToken(arrayToken),
+    m_variableName(std::string(arrayToken.lexical())), m_indexNode(indexNode), m_expression(expression)
 {
 }
 
@@ -170,11 +170,10 @@ llvm::Value *ArrayAssignmentNode::codegen(std::unique_ptr<Context> &context)
 }
 Token ArrayAssignmentNode::expressionToken()
 {
-    auto start = m_arrayToken.sourceLocation.byte_offset;
-    auto end = m_expression->expressionToken().sourceLocation.byte_offset +
-               m_expression->expressionToken().sourceLocation.num_bytes;
+    auto start = m_arrayToken.byteOffset;
+    auto end = m_expression->expressionToken().byteOffset + m_expression->expressionToken().length;
     Token token = m_arrayToken;
-    token.sourceLocation.num_bytes = end - start;
-    token.sourceLocation.byte_offset = start;
+    token.length = end - start;
+    token.byteOffset = start;
     return token;
 }
@@ -16,6 +16,7 @@ public:
     ArrayAssignmentNode(const Token &arrayToken, const std::shared_ptr<ASTNode> &indexNode,
                         const std::shared_ptr<ASTNode> &expression);
     ~ArrayAssignmentNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::ArrayAssignment; }
     void print() override;
 
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
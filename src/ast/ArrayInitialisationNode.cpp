@@ -7,7 +7,7 @@
 #include <llvm/IR/DerivedTypes.h>
 ArrayInitialisationNode::ArrayInitialisationNode(const Token &token,
                                                  const std::vector<std::shared_ptr<ASTNode>> &arguments) :
-    ASTNode(token), m_arguments(arguments)
+    ASTNode(NodeKind::ArrayInitialisation, token), m_arguments(arguments)
 {
 }
 void ArrayInitialisationNode::print() {}
@@ -10,6 +10,7 @@ private:
 
 public:
     explicit ArrayInitialisationNode(const Token &token, const std::vector<std::shared_ptr<ASTNode>> &arguments);
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::ArrayInitialisation; }
 
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
@@ -10,7 +10,8 @@
 
 BinaryOperationNode::BinaryOperationNode(const Token &operatorToken, const Operator op,
                                          const std::shared_ptr<ASTNode> &lhs, const std::shared_ptr<ASTNode> &rhs) :
-    ASTNode(operatorToken), m_operatorToken(operatorToken), m_lhs(lhs), m_rhs(rhs), m_operator(op)
+    ASTNode(NodeKind::BinaryOperation, operatorToken), m_operatorToken(operatorToken), m_lhs(lhs), m_rhs(rhs),
+    m_operator(op)
 {
 }
 
@@ -296,7 +297,7 @@ llvm::Value *BinaryOperationNode::codegen(std::unique_ptr<Context> &context)
     return nullptr;
 }
 
-std::shared_ptr<VariableType> BinaryOperationNode::resolveType(const std::unique_ptr<UnitNode> &unit,
+std::shared_ptr<VariableType> BinaryOperationNode::computeType(const std::unique_ptr<UnitNode> &unit,
                                                                ASTNode *parentNode)
 {
     if (auto type = m_lhs->resolveType(unit, parentNode))
@@ -332,11 +333,10 @@ void BinaryOperationNode::typeCheck(const std::unique_ptr<UnitNode> &unit, ASTNo
 }
 Token BinaryOperationNode::expressionToken()
 {
-    const auto start = m_lhs->expressionToken().sourceLocation.byte_offset;
-    const auto end =
-            m_rhs->expressionToken().sourceLocation.byte_offset + m_rhs->expressionToken().sourceLocation.num_bytes;
+    const auto start = m_lhs->expressionToken().byteOffset;
+    const auto end = m_rhs->expressionToken().byteOffset + m_rhs->expressionToken().length;
     Token token = ASTNode::expressionToken();
-    token.sourceLocation.num_bytes = end - start;
-    token.sourceLocation.byte_offset = start;
+    token.length = end - start;
+    token.byteOffset = start;
     return token;
 }
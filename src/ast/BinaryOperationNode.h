@@ -26,11 +26,12 @@ public:
     BinaryOperationNode(const Token &operatorToken, Operator op, const std::shared_ptr<ASTNode> &lhs,
                         const std::shared_ptr<ASTNode> &rhs);
     ~BinaryOperationNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::BinaryOperation; }
 
     void print() override;
     llvm::Value *generateForStringPlusChar(llvm::Value *lhs, llvm::Value *rhs, std::unique_ptr<Context> &context);
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
-    std::shared_ptr<VariableType> resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
+    std::shared_ptr<VariableType> computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
 
     void typeCheck(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
 
@@ -9,8 +9,19 @@
 
 BlockNode::BlockNode(const Token &token, const std::vector<VariableDefinition> &variableDefinitions,
                      const std::vector<std::shared_ptr<ASTNode>> &expressions) :
-    ASTNode(token), m_expressions(expressions), m_variableDefinitions(variableDefinitions)
+    ASTNode(NodeKind::Block, token), m_expressions(expressions), m_variableDefinitions(variableDefinitions)
 {
+    for (size_t index = 0; index < m_variableDefinitions.size(); ++index)
+        indexVariableDefinition(index);
+}
+
+void BlockNode::indexVariableDefinition(const size_t index)
+{
+    const auto &definition = m_variableDefinitions[index];
+    if (!m_variableIndex.contains(definition.variableName))
+        m_variableIndex.define(definition.variableName, index);
+    if (!definition.alias.empty() && !m_variableIndex.contains(definition.alias))
+        m_variableIndex.define(definition.alias, index);
 }
 
 void BlockNode::print()
@@ -129,12 +140,9 @@ llvm::Value *BlockNode::codegen(std::unique_ptr<Context> &context)
 
 std::optional<VariableDefinition> BlockNode::getVariableDefinition(const std::string &name) const
 {
-    for (const auto &def: m_variableDefinitions)
+    if (const auto index = m_variableIndex.find(name))
     {
-        if (iequals(def.variableName, name) or iequals(def.alias, name))
-        {
-            return def;
-        }
+        return m_variableDefinitions[*index];
     }
     for (auto &node: m_expressions)
     {
@@ -143,7 +151,7 @@ std::optional<VariableDefinition> BlockNode::getVariableDefinition(const std::st
         {
             continue;
         }
-        if (const auto &b = std::dynamic_pointer_cast<BlockNode>(block.value()))
+        if (const auto &b = dyn_cast<BlockNode>(block.value()))
         {
             if (auto result = b->getVariableDefinition(name))
             {
@@ -154,7 +162,11 @@ std::optional<VariableDefinition> BlockNode::getVariableDefinition(const std::st
     return std::nullopt;
 }
 
-void BlockNode::addVariableDefinition(VariableDefinition definition) { m_variableDefinitions.emplace_back(definition); }
+void BlockNode::addVariableDefinition(VariableDefinition definition)
+{
+    m_variableDefinitions.emplace_back(definition);
+    indexVariableDefinition(m_variableDefinitions.size() - 1);
+}
 
 
 void BlockNode::appendExpression(const std::shared_ptr<ASTNode> &node) { m_expressions.push_back(node); }
@@ -174,7 +186,7 @@ std::optional<std::shared_ptr<ASTNode>> BlockNode::getNodeByToken(const Token &t
         {
             return node;
         }
-        if (const auto block = std::dynamic_pointer_cast<BlockNode>(node))
+        if (const auto block = dyn_cast<BlockNode>(node))
         {
 
             if (auto result = block->getNodeByToken(token))
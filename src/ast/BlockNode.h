@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "ASTNode.h"
+#include "SymbolTable.h"
 #include "ast/VariableDefinition.h"
 
 class BlockNode : public ASTNode
@@ -10,12 +11,17 @@ class BlockNode : public ASTNode
 private:
     std::vector<std::shared_ptr<ASTNode>> m_expressions;
     std::vector<VariableDefinition> m_variableDefinitions;
+    /// the index of the first definition of a name or alias in m_variableDefinitions
+    SymbolTable<size_t> m_variableIndex;
     std::string m_blockname;
 
+    void indexVariableDefinition(size_t index);
+
 public:
     BlockNode(const Token &token, const std::vector<VariableDefinition> &variableDefinitions,
               const std::vector<std::shared_ptr<ASTNode>> &expressions);
     ~BlockNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::Block; }
 
     void print() override;
     void setBlockName(const std::string &name);
@@ -4,7 +4,7 @@
 #include "llvm/IR/IRBuilder.h"
 
 
-BooleanNode::BooleanNode(const Token &token, const bool value) : ASTNode(token), m_value(value) {}
+BooleanNode::BooleanNode(const Token &token, const bool value) : ASTNode(NodeKind::Boolean, token), m_value(value) {}
 
 void BooleanNode::print()
 {
@@ -22,7 +22,7 @@ llvm::Value *BooleanNode::codegen(std::unique_ptr<Context> &context)
     return context->builder()->getFalse();
 }
 
-std::shared_ptr<VariableType> BooleanNode::resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode)
+std::shared_ptr<VariableType> BooleanNode::computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode)
 {
     return VariableType::getBoolean();
 }
@@ -10,9 +10,10 @@ private:
 public:
     BooleanNode(const Token &token, bool value);
     ~BooleanNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::Boolean; }
 
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
 
-    std::shared_ptr<VariableType> resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
+    std::shared_ptr<VariableType> computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
 };
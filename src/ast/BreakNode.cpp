@@ -2,7 +2,7 @@
 #include "compiler/Context.h"
 #include "llvm/IR/IRBuilder.h"
 
-BreakNode::BreakNode(const Token &token) : ASTNode(token) {}
+BreakNode::BreakNode(const Token &token) : ASTNode(NodeKind::Break, token) {}
 
 
 void BreakNode::print() {}
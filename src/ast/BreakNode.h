@@ -9,6 +9,7 @@ private:
 public:
     BreakNode(const Token &token);
     ~BreakNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::Break; }
 
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
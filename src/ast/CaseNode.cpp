@@ -10,7 +10,7 @@
 
 CaseNode::CaseNode(const Token &token, std::shared_ptr<ASTNode> selector, std::vector<Selector> selectors,
                    std::vector<std::shared_ptr<ASTNode>> elseExpressions) :
-    ASTNode(token), m_selector(std::move(selector)), m_selectors(std::move(selectors)),
+    ASTNode(NodeKind::Case, token), m_selector(std::move(selector)), m_selectors(std::move(selectors)),
     m_elseExpressions(std::move(elseExpressions))
 {
 }
@@ -34,6 +34,7 @@ public:
     explicit CaseNode(const Token &token, std::shared_ptr<ASTNode> selector, std::vector<Selector> selectors,
                       std::vector<std::shared_ptr<ASTNode>> elseExpressions);
     ~CaseNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::Case; }
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
     std::optional<std::shared_ptr<ASTNode>> block() override;
@@ -3,7 +3,7 @@
 #include "llvm/IR/Constants.h"
 
 CharConstantNode::CharConstantNode(const Token &token, std::string_view literal) :
-    ASTNode(token), m_literal(literal.at(0))
+    ASTNode(NodeKind::CharConstant, token), m_literal(literal.at(0))
 {
 }
 
@@ -13,7 +13,7 @@ llvm::Value *CharConstantNode::codegen(std::unique_ptr<Context> &context)
     return llvm::ConstantInt::get(*context->context(), llvm::APInt(8, m_literal));
 }
 
-std::shared_ptr<VariableType> CharConstantNode::resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode)
+std::shared_ptr<VariableType> CharConstantNode::computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode)
 {
     return VariableType::getCharacter();
 }
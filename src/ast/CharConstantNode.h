@@ -10,7 +10,8 @@ private:
 public:
     CharConstantNode(const Token &token, std::string_view literal);
     ~CharConstantNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::CharConstant; }
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
-    std::shared_ptr<VariableType> resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
+    std::shared_ptr<VariableType> computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
 };
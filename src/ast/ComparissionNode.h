@@ -23,11 +23,12 @@ public:
     ComparrisionNode(const Token &operatorToken, CMPOperator op, const std::shared_ptr<ASTNode> &lhs,
                      const std::shared_ptr<ASTNode> &rhs);
     ~ComparrisionNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::Comparrision; }
 
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
     void typeCheck(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
-    std::shared_ptr<VariableType> resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
+    std::shared_ptr<VariableType> computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
 
     Token expressionToken() override;
 };
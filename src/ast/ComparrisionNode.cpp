@@ -8,7 +8,8 @@
 
 ComparrisionNode::ComparrisionNode(const Token &operatorToken, const CMPOperator op,
                                    const std::shared_ptr<ASTNode> &lhs, const std::shared_ptr<ASTNode> &rhs) :
-    ASTNode(operatorToken), m_operatorToken(operatorToken), m_lhs(lhs), m_rhs(rhs), m_operator(op)
+    ASTNode(NodeKind::Comparrision, operatorToken), m_operatorToken(operatorToken), m_lhs(lhs), m_rhs(rhs),
+    m_operator(op)
 {
 }
 
@@ -200,18 +201,18 @@ void ComparrisionNode::typeCheck(const std::unique_ptr<UnitNode> &unit, ASTNode
                                                        "\" is not possible because the types are not the same"});
     }
 }
-std::shared_ptr<VariableType> ComparrisionNode::resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode)
+std::shared_ptr<VariableType> ComparrisionNode::computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode)
 {
     return VariableType::getBoolean();
 }
 Token ComparrisionNode::expressionToken()
 {
-    const auto start = m_lhs->expressionToken().sourceLocation.byte_offset;
-    const auto end = m_rhs->expressionToken().sourceLocation.byte_offset;
+    const auto start = m_lhs->expressionToken().byteOffset;
+    const auto end = m_rhs->expressionToken().byteOffset;
     if (start == end)
         return m_operatorToken;
     Token token = ASTNode::expressionToken();
-    token.sourceLocation.num_bytes = end - start + m_rhs->expressionToken().sourceLocation.num_bytes;
-    token.sourceLocation.byte_offset = start;
+    token.length = end - start + m_rhs->expressionToken().length;
+    token.byteOffset = start;
     return token;
 }
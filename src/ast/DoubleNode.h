@@ -9,8 +9,9 @@ private:
 public:
     DoubleNode(const Token &token, double value);
     ~DoubleNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::Double; }
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
-    std::shared_ptr<VariableType> resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
+    std::shared_ptr<VariableType> computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
     double getValue() const;
 };
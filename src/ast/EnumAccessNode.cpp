@@ -9,7 +9,7 @@
 
 #include "compiler/Context.h"
 EnumAccessNode::EnumAccessNode(const Token &token, std::shared_ptr<EnumType> enumType) :
-    ASTNode(token), m_enumType(std::move(enumType))
+    ASTNode(NodeKind::EnumAccess, token), m_enumType(std::move(enumType))
 {
 }
 void EnumAccessNode::print() {}
@@ -32,7 +32,7 @@ llvm::Value *EnumAccessNode::codegen(std::unique_ptr<Context> &context)
     // return context->builder()->CreateLoad(valueType, globalVar, enumName);
     return llvm::ConstantInt::get(valueType, m_enumType->getValue(enumName));
 }
-std::shared_ptr<VariableType> EnumAccessNode::resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode)
+std::shared_ptr<VariableType> EnumAccessNode::computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode)
 {
     return m_enumType;
 }
@@ -15,9 +15,10 @@ private:
 
 public:
     explicit EnumAccessNode(const Token &token, std::shared_ptr<EnumType> enumType);
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::EnumAccess; }
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
-    std::shared_ptr<VariableType> resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
+    std::shared_ptr<VariableType> computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
 };
 
 
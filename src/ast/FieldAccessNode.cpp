@@ -10,7 +10,8 @@
 
 
 FieldAccessNode::FieldAccessNode(const Token &element, const Token &field) :
-    ASTNode(element), m_element(element), m_elementName(element.lexical()), m_field(field), m_fieldName(field.lexical())
+    ASTNode(NodeKind::FieldAccess, element), m_element(element), m_elementName(element.lexical()), m_field(field),
+    m_fieldName(field.lexical())
 {
 }
 
@@ -96,9 +97,9 @@ llvm::Value *FieldAccessNode::codegen(std::unique_ptr<Context> &context)
     }
 }
 
-std::shared_ptr<VariableType> FieldAccessNode::resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode)
+std::shared_ptr<VariableType> FieldAccessNode::computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode)
 {
-    if (auto functionDefinition = dynamic_cast<FunctionDefinitionNode *>(parentNode))
+    if (auto functionDefinition = dyn_cast<FunctionDefinitionNode>(parentNode))
     {
         if (auto param = functionDefinition->getParam(m_elementName))
         {
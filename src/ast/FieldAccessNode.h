@@ -16,8 +16,9 @@ private:
 public:
     FieldAccessNode(const Token &element, const Token &field);
     ~FieldAccessNode() = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::FieldAccess; }
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
 
-    std::shared_ptr<VariableType> resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
+    std::shared_ptr<VariableType> computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
 };
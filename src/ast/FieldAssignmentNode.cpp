@@ -9,8 +9,9 @@
 
 FieldAssignmentNode::FieldAssignmentNode(const Token &variable, const Token &field,
                                          const std::shared_ptr<ASTNode> &expression) :
-    ASTNode(variable), m_variable(variable), m_variableName(std::string(m_variable.lexical())), m_field(field),
-    m_fieldName(std::string(m_field.lexical())), m_expression(expression)
+    ASTNode(NodeKind::FieldAssignment, variable), m_variable(variable),
+    m_variableName(std::string(m_variable.lexical())), m_field(field), m_fieldName(std::string(m_field.lexical())),
+    m_expression(expression)
 {
 }
 
@@ -15,6 +15,7 @@ private:
 public:
     FieldAssignmentNode(const Token &variable, const Token &field, const std::shared_ptr<ASTNode> &expression);
     ~FieldAssignmentNode() = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::FieldAssignment; }
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
 };
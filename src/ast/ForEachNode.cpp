@@ -8,7 +8,7 @@
 #include "types/RangeType.h"
 ForEachNode::ForEachNode(const Token &token, const Token &loopVariable, const std::shared_ptr<ASTNode> &loopExpression,
                          const std::vector<std::shared_ptr<ASTNode>> &body) :
-    ASTNode(token), m_loopVariable(loopVariable), m_loopExpression(loopExpression), m_body(body)
+    ASTNode(NodeKind::ForEach, token), m_loopVariable(loopVariable), m_loopExpression(loopExpression), m_body(body)
 {
 }
 void ForEachNode::print() {}
@@ -112,7 +112,7 @@ std::optional<std::shared_ptr<ASTNode>> ForEachNode::block()
 {
     for (auto &exp: m_body)
     {
-        if (auto block = std::dynamic_pointer_cast<BlockNode>(exp))
+        if (auto block = dyn_cast<BlockNode>(exp))
         {
             return block;
         }
@@ -14,6 +14,7 @@ public:
     ForEachNode(const Token &token, const Token &loopVariable, const std::shared_ptr<ASTNode> &loopExpression,
                 const std::vector<std::shared_ptr<ASTNode>> &body);
     ~ForEachNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::ForEach; }
 
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
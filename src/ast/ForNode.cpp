@@ -12,7 +12,7 @@
 ForNode::ForNode(const Token &token, std::string loopVariable, const std::shared_ptr<ASTNode> &startExpression,
                  const std::shared_ptr<ASTNode> &endExpression, const std::vector<std::shared_ptr<ASTNode>> &body,
                  int increment) :
-    ASTNode(token), m_loopVariable(std::move(loopVariable)), m_startExpression(startExpression),
+    ASTNode(NodeKind::For, token), m_loopVariable(std::move(loopVariable)), m_startExpression(startExpression),
     m_endExpression(endExpression), m_body(body), m_increment(increment)
 {
 }
@@ -121,7 +121,7 @@ std::optional<std::shared_ptr<ASTNode>> ForNode::block()
 {
     for (auto &exp: m_body)
     {
-        if (auto block = std::dynamic_pointer_cast<BlockNode>(exp))
+        if (auto block = dyn_cast<BlockNode>(exp))
         {
             return block;
         }
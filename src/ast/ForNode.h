@@ -17,6 +17,7 @@ public:
             const std::shared_ptr<ASTNode> &endExpression, const std::vector<std::shared_ptr<ASTNode>> &body,
             int increment);
     ~ForNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::For; }
 
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
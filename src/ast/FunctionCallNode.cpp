@@ -12,7 +12,12 @@
 
 FunctionCallNode::FunctionCallNode(const Token &token, std::string name,
                                    const std::vector<std::shared_ptr<ASTNode>> &args) :
-    ASTNode(token), m_name(std::move(name)), m_args(args)
+    FunctionCallNode(NodeKind::FunctionCall, token, std::move(name), args)
+{
+}
+FunctionCallNode::FunctionCallNode(const NodeKind kind, const Token &token, std::string name,
+                                   const std::vector<std::shared_ptr<ASTNode>> &args) :
+    ASTNode(kind, token), m_name(std::move(name)), m_args(args)
 {
 }
 
@@ -27,22 +32,20 @@ void FunctionCallNode::print()
     std::cout << ");\n";
 }
 
-std::string FunctionCallNode::callSignature(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) const
+OverloadKey FunctionCallNode::callKey(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) const
 {
     ASTNode *parent = unit.get();
     if (parentNode != nullptr)
     {
         parent = parentNode;
     }
-    std::string result = to_lower(m_name) + "(";
-    for (size_t i = 0; i < m_args.size(); ++i)
+    std::vector<SymbolId> argumentTypes;
+    argumentTypes.reserve(m_args.size());
+    for (const auto &arg: m_args)
     {
-        const auto arg = m_args.at(i)->resolveType(unit, parent);
-
-        result += arg->typeName + ((i < m_args.size() - 1) ? "," : "");
+        argumentTypes.push_back(OverloadKey::typeId(*arg->resolveType(unit, parent)));
     }
-    result += ")";
-    return result;
+    return OverloadKey(m_name, std::move(argumentTypes));
 }
 
 llvm::Value *FunctionCallNode::codegen(std::unique_ptr<Context> &context)
@@ -50,10 +53,15 @@ llvm::Value *FunctionCallNode::codegen(std::unique_ptr<Context> &context)
     // Look up the name in the global module table.
     ASTNode *parent = resolveParent(context);
 
-    std::string functionName = callSignature(context->programUnit(), parent);
+    std::string functionName = m_name;
 
-    llvm::Function *CalleeF = context->module()->getFunction(functionName);
-    auto functionDefinition = context->programUnit()->getFunctionDefinition(functionName);
+    llvm::Function *CalleeF = nullptr;
+    auto functionDefinition = context->programUnit()->getFunctionDefinition(callKey(context->programUnit(), parent));
+    if (functionDefinition)
+    {
+        functionName = functionDefinition.value()->functionSignature();
+        CalleeF = context->module()->getFunction(functionName);
+    }
     if (!CalleeF)
     {
         functionDefinition = context->programUnit()->getFunctionDefinition(m_name);
@@ -163,10 +171,10 @@ llvm::Value *FunctionCallNode::codegen(std::unique_ptr<Context> &context)
     return callInst;
 }
 
-std::shared_ptr<VariableType> FunctionCallNode::resolveType(const std::unique_ptr<UnitNode> &unitNode,
+std::shared_ptr<VariableType> FunctionCallNode::computeType(const std::unique_ptr<UnitNode> &unitNode,
                                                             ASTNode *parentNode)
 {
-    auto functionDefinition = unitNode->getFunctionDefinition(callSignature(unitNode, parentNode));
+    auto functionDefinition = unitNode->getFunctionDefinition(callKey(unitNode, parentNode));
     if (!functionDefinition)
     {
         functionDefinition = unitNode->getFunctionDefinition(m_name);
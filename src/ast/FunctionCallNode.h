@@ -3,20 +3,29 @@
 #include <string>
 #include <vector>
 #include "ASTNode.h"
+#include "OverloadIndex.h"
 
 class FunctionCallNode : public ASTNode
 {
 protected:
     std::string m_name;
     std::vector<std::shared_ptr<ASTNode>> m_args;
-    std::string callSignature(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) const;
+    /// the name of the function and the types of the arguments
+    OverloadKey callKey(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) const;
+
+    FunctionCallNode(NodeKind kind, const Token &token, std::string name,
+                     const std::vector<std::shared_ptr<ASTNode>> &args);
 
 public:
     FunctionCallNode(const Token &token, std::string name, const std::vector<std::shared_ptr<ASTNode>> &args);
     ~FunctionCallNode() override = default;
+    static bool classof(const ASTNode *node)
+    {
+        return node->kind() >= NodeKind::FunctionCall && node->kind() <= NodeKind::LastFunctionCall;
+    }
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
-    std::shared_ptr<VariableType> resolveType(const std::unique_ptr<UnitNode> &unitNode, ASTNode *parentNode) override;
+    std::shared_ptr<VariableType> computeType(const std::unique_ptr<UnitNode> &unitNode, ASTNode *parentNode) override;
 
     std::string name();
 
@@ -1,4 +1,5 @@
 #include "FunctionDefinitionNode.h"
+#include <algorithm>
 #include <iostream>
 #include <llvm/IR/IRBuilder.h>
 #include <utility>
@@ -11,21 +12,36 @@
 #include "llvm/IR/Verifier.h"
 #include "types/RecordType.h"
 
+static std::vector<SymbolId> parameter_types(const std::vector<FunctionArgument> &params)
+{
+    std::vector<SymbolId> types;
+    types.reserve(params.size());
+    for (const auto &param: params)
+        types.push_back(OverloadKey::typeId(*param.type));
+    return types;
+}
 
 FunctionDefinitionNode::FunctionDefinitionNode(const Token &token, std::string name,
                                                std::vector<FunctionArgument> params, std::shared_ptr<BlockNode> body,
                                                const bool isProcedure, std::shared_ptr<VariableType> returnType) :
-    ASTNode(token), m_name(std::move(name)), m_externalName(m_name), m_params(std::move(params)),
-    m_body(std::move(body)), m_isProcedure(isProcedure), m_returnType(std::move(returnType))
+    ASTNode(NodeKind::FunctionDefinition, token), m_name(std::move(name)), m_externalName(m_name),
+    m_params(std::move(params)), m_body(std::move(body)), m_isProcedure(isProcedure),
+    m_returnType(std::move(returnType)), m_overloadKey(m_name, parameter_types(m_params))
 {
+    // the definitions of cached units are shared by the compilation jobs, so nothing is changed during the codegen
+    m_functionSignature = createFunctionSignature();
+    if (m_body)
+        m_body->setBlockName(m_name + "_block");
 }
 
 FunctionDefinitionNode::FunctionDefinitionNode(const Token &token, std::string name, std::string externalName,
                                                std::string libName, std::vector<FunctionArgument> params,
                                                const bool isProcedure, std::shared_ptr<VariableType> returnType) :
-    ASTNode(token), m_name(std::move(name)), m_externalName(std::move(externalName)), m_libName(std::move(libName)),
-    m_params(std::move(params)), m_body(nullptr), m_isProcedure(isProcedure), m_returnType(std::move(returnType))
+    ASTNode(NodeKind::FunctionDefinition, token), m_name(std::move(name)), m_externalName(std::move(externalName)),
+    m_libName(std::move(libName)), m_params(std::move(params)), m_body(nullptr), m_isProcedure(isProcedure),
+    m_returnType(std::move(returnType)), m_overloadKey(m_name, parameter_types(m_params))
 {
+    m_functionSignature = createFunctionSignature();
 }
 
 void FunctionDefinitionNode::print()
@@ -57,7 +73,8 @@ void FunctionDefinitionNode::print()
     {
         std::cout << ": " << m_returnType->typeName << ";\n";
     }
-    m_body->print();
+    if (m_body)
+        m_body->print();
 
     // std::cout << "end;\n";
 }
@@ -96,7 +113,11 @@ llvm::Value *FunctionDefinitionNode::codegen(std::unique_ptr<Context> &context)
     }
     llvm::FunctionType *FT = llvm::FunctionType::get(resultType, params, false);
     auto linkage = llvm::Function::ExternalLinkage;
-    if (!m_libName.empty())
+    // functions of separately compiled units are shared between the object files, inline functions are generated
+    // into every object file which uses them
+    const bool isShared = m_precompiled ||
+                          (context->options().separateUnits && m_body && !hasAttribute(FunctionAttribute::Inline));
+    if (!m_libName.empty() || isShared)
     {
         linkage = llvm::Function::ExternalLinkage;
     }
@@ -133,6 +154,7 @@ llvm::Value *FunctionDefinitionNode::codegen(std::unique_ptr<Context> &context)
         llvm::AttrBuilder b(*context->context());
         b.addAttribute("frame-pointer", "all");
         functionDefinition->addFnAttrs(b);
+        context->addTargetAttributes(functionDefinition);
     }
     for (const auto attribute: m_attributes)
     {
@@ -149,10 +171,9 @@ llvm::Value *FunctionDefinitionNode::codegen(std::unique_ptr<Context> &context)
     // Create a new basic block to start insertion into.
 
     context->setCurrentFunction(functionDefinition);
-    if (m_body)
+    if (m_body && !context->isExternalFunction(functionSignature()))
     {
         context->explicitReturn = false;
-        m_body->setBlockName(m_name + "_block");
         m_body->codegen(context);
         if (m_isProcedure)
         {
@@ -181,6 +202,10 @@ void FunctionDefinitionNode::typeCheck(const std::unique_ptr<UnitNode> &unit, AS
         m_body->typeCheck(unit, this);
 }
 void FunctionDefinitionNode::addAttribute(FunctionAttribute attribute) { m_attributes.emplace_back(attribute); }
+bool FunctionDefinitionNode::hasAttribute(FunctionAttribute attribute) const
+{
+    return std::ranges::find(m_attributes, attribute) != m_attributes.end();
+}
 
 std::optional<FunctionArgument> FunctionDefinitionNode::getParam(const std::string &paramName) const
 {
@@ -206,25 +231,23 @@ std::optional<FunctionArgument> FunctionDefinitionNode::getParam(const size_t in
 std::shared_ptr<BlockNode> FunctionDefinitionNode::body() const { return m_body; }
 
 
-std::string FunctionDefinitionNode::functionSignature()
+std::string FunctionDefinitionNode::createFunctionSignature() const
 {
     if (!m_libName.empty())
         return m_externalName;
 
-    if (m_functionSignature.empty())
+    std::stringstream stream;
+    stream << to_lower(m_name) << "(";
+    for (size_t i = 0; i < m_params.size(); ++i)
     {
-        std::stringstream stream;
-        stream << to_lower(m_name) << "(";
-        for (size_t i = 0; i < m_params.size(); ++i)
-        {
-            stream << m_params[i].type->typeName << ((i < m_params.size() - 1) ? "," : "");
-        }
-        stream << ")";
-        m_functionSignature = stream.str();
+        stream << m_params[i].type->typeName << ((i < m_params.size() - 1) ? "," : "");
     }
-    return m_functionSignature;
+    stream << ")";
+    return stream.str();
 }
 
+std::string FunctionDefinitionNode::functionSignature() { return m_functionSignature; }
+
 std::string &FunctionDefinitionNode::externalName() { return m_externalName; }
 
 std::string &FunctionDefinitionNode::libName() { return m_libName; }
@@ -4,6 +4,7 @@
 #include <vector>
 #include "ASTNode.h"
 #include "BlockNode.h"
+#include "OverloadIndex.h"
 
 struct FunctionArgument
 {
@@ -31,6 +32,10 @@ private:
     std::shared_ptr<VariableType> m_returnType;
     std::vector<FunctionAttribute> m_attributes;
     std::string m_functionSignature;
+    OverloadKey m_overloadKey;
+    bool m_precompiled = false;
+
+    [[nodiscard]] std::string createFunctionSignature() const;
 
 public:
     FunctionDefinitionNode(const Token &token, std::string name, std::vector<FunctionArgument> params,
@@ -40,8 +45,11 @@ public:
                            std::vector<FunctionArgument> params, bool isProcedure,
                            std::shared_ptr<VariableType> returnType = std::make_shared<VariableType>());
     ~FunctionDefinitionNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::FunctionDefinition; }
     void print() override;
     std::string functionSignature();
+    /// the interned name and parameter types, functions and calls are matched by this key
+    [[nodiscard]] const OverloadKey &overloadKey() const { return m_overloadKey; }
     std::string &name();
     std::string &externalName();
     std::string &libName();
@@ -49,8 +57,14 @@ public:
     std::optional<FunctionArgument> getParam(const std::string &paramName) const;
     std::optional<FunctionArgument> getParam(const size_t index);
     std::shared_ptr<BlockNode> body() const;
+    [[nodiscard]] bool isProcedure() const { return m_isProcedure; }
+    [[nodiscard]] const std::vector<FunctionArgument> &params() const { return m_params; }
+    /// the function was loaded from a precompiled unit interface, its code is part of the object file of the unit
+    void setPrecompiled() { m_precompiled = true; }
+    [[nodiscard]] bool isPrecompiled() const { return m_precompiled; }
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
 
     void typeCheck(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
     void addAttribute(FunctionAttribute attribute);
+    [[nodiscard]] bool hasAttribute(FunctionAttribute attribute) const;
 };
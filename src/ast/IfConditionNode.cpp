@@ -10,7 +10,8 @@
 IfConditionNode::IfConditionNode(const Token &token, const std::shared_ptr<ASTNode> &conditionNode,
                                  const std::vector<std::shared_ptr<ASTNode>> &ifExpressions,
                                  const std::vector<std::shared_ptr<ASTNode>> &elseExpressions) :
-    ASTNode(token), m_conditionNode(conditionNode), m_ifExpressions(ifExpressions), m_elseExpressions(elseExpressions)
+    ASTNode(NodeKind::IfCondition, token), m_conditionNode(conditionNode), m_ifExpressions(ifExpressions),
+    m_elseExpressions(elseExpressions)
 {
 }
 
@@ -155,7 +156,7 @@ bool IfConditionNode::tokenIsPartOfNode(const Token &token) const
         {
             return true;
         }
-        if (const auto block = std::dynamic_pointer_cast<BlockNode>(node))
+        if (const auto block = dyn_cast<BlockNode>(node))
         {
 
             if (auto result = block->getNodeByToken(token))
@@ -171,7 +172,7 @@ bool IfConditionNode::tokenIsPartOfNode(const Token &token) const
         {
             return true;
         }
-        if (const auto block = std::dynamic_pointer_cast<BlockNode>(node))
+        if (const auto block = dyn_cast<BlockNode>(node))
         {
 
             if (auto result = block->getNodeByToken(token))
@@ -17,6 +17,7 @@ public:
                     const std::vector<std::shared_ptr<ASTNode>> &ifExpressions,
                     const std::vector<std::shared_ptr<ASTNode>> &elseExpressions);
     ~IfConditionNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::IfCondition; }
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
 
@@ -7,13 +7,13 @@
 
 LogicalExpressionNode::LogicalExpressionNode(const Token &token, LogicalOperator op,
                                              const std::shared_ptr<ASTNode> &lhs, const std::shared_ptr<ASTNode> &rhs) :
-    ASTNode(token), m_lhs(lhs), m_rhs(rhs), m_operator(op)
+    ASTNode(NodeKind::LogicalExpression, token), m_lhs(lhs), m_rhs(rhs), m_operator(op)
 {
 }
 
 LogicalExpressionNode::LogicalExpressionNode(const Token &token, LogicalOperator op,
                                              const std::shared_ptr<ASTNode> &rhs) :
-    ASTNode(token), m_lhs(nullptr), m_rhs(rhs), m_operator(op)
+    ASTNode(NodeKind::LogicalExpression, token), m_lhs(nullptr), m_rhs(rhs), m_operator(op)
 {
 }
 
@@ -63,19 +63,19 @@ llvm::Value *LogicalExpressionNode::codegen(std::unique_ptr<Context> &context)
     }
     return nullptr;
 }
-std::shared_ptr<VariableType> LogicalExpressionNode::resolveType(const std::unique_ptr<UnitNode> &unit,
+std::shared_ptr<VariableType> LogicalExpressionNode::computeType(const std::unique_ptr<UnitNode> &unit,
                                                                  ASTNode *parentNode)
 {
     return VariableType::getBoolean();
 }
 Token LogicalExpressionNode::expressionToken()
 {
-    auto start = m_lhs->expressionToken().sourceLocation.byte_offset;
-    auto end = m_rhs->expressionToken().sourceLocation.byte_offset;
+    auto start = m_lhs->expressionToken().byteOffset;
+    auto end = m_rhs->expressionToken().byteOffset;
     if (start == end)
         return m_lhs->expressionToken();
     Token token = ASTNode::expressionToken();
-    token.sourceLocation.num_bytes = end - start;
-    token.sourceLocation.byte_offset = start;
+    token.length = end - start;
+    token.byteOffset = start;
     return token;
 }
@@ -19,11 +19,12 @@ public:
                           const std::shared_ptr<ASTNode> &rhs);
     LogicalExpressionNode(const Token &token, LogicalOperator op, const std::shared_ptr<ASTNode> &rhs);
     ~LogicalExpressionNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::LogicalExpression; }
 
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
 
-    std::shared_ptr<VariableType> resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
+    std::shared_ptr<VariableType> computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
 
     Token expressionToken() override;
 };
@@ -8,7 +8,8 @@
 #include "ast/NumberNode.h"
 #include "compiler/Context.h"
 
-MinusNode::MinusNode(const Token &token, const std::shared_ptr<ASTNode> &node) : NumberNode(token, 0, 64), m_node(node)
+MinusNode::MinusNode(const Token &token, const std::shared_ptr<ASTNode> &node) :
+    NumberNode(NodeKind::Minus, token, 0, 64), m_node(node)
 {
 }
 
@@ -23,14 +24,14 @@ llvm::Value *MinusNode::codegen(std::unique_ptr<Context> &context)
 
         case VariableBaseType::Integer:
         {
-            if (const auto intNode = std::dynamic_pointer_cast<NumberNode>(m_node))
+            if (const auto intNode = dyn_cast<NumberNode>(m_node))
             {
                 return llvm::ConstantInt::get(*context->context(), llvm::APInt(64, -intNode->getValue()));
             }
         }
         case VariableBaseType::Double:
         case VariableBaseType::Float:
-            if (const auto doubleNode = std::dynamic_pointer_cast<DoubleNode>(m_node))
+            if (const auto doubleNode = dyn_cast<DoubleNode>(m_node))
             {
                 return llvm::ConstantFP::get(context->builder()->getDoubleTy(), -doubleNode->getValue());
             }
@@ -43,7 +44,7 @@ llvm::Value *MinusNode::codegen(std::unique_ptr<Context> &context)
     assert(false);
     return nullptr;
 }
-std::shared_ptr<VariableType> MinusNode::resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode)
+std::shared_ptr<VariableType> MinusNode::computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode)
 {
     return m_node->resolveType(unit, parentNode);
 }
@@ -53,11 +54,11 @@ void MinusNode::typeCheck(const std::unique_ptr<UnitNode> &unit, ASTNode *parent
 }
 int64_t MinusNode::getValue() const
 {
-    if (const auto intNode = std::dynamic_pointer_cast<NumberNode>(m_node))
+    if (const auto intNode = dyn_cast<NumberNode>(m_node))
     {
         return -intNode->getValue();
     }
-    if (const auto doubleNode = std::dynamic_pointer_cast<DoubleNode>(m_node))
+    if (const auto doubleNode = dyn_cast<DoubleNode>(m_node))
     {
         return -doubleNode->getValue();
     }
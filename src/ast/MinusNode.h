@@ -11,9 +11,10 @@ private:
 public:
     MinusNode(const Token &token, const std::shared_ptr<ASTNode> &node);
     ~MinusNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::Minus; }
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
-    std::shared_ptr<VariableType> resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
+    std::shared_ptr<VariableType> computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
     void typeCheck(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
 
     int64_t getValue() const override;
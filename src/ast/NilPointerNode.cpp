@@ -2,13 +2,13 @@
 #include <llvm/IR/Constants.h>
 #include "compiler/Context.h"
 
-NilPointerNode::NilPointerNode(const Token &token) : ASTNode(token) {}
+NilPointerNode::NilPointerNode(const Token &token) : ASTNode(NodeKind::NilPointer, token) {}
 void NilPointerNode::print() {}
 llvm::Value *NilPointerNode::codegen(std::unique_ptr<Context> &context)
 {
     return llvm::ConstantPointerNull::get(llvm::PointerType::getUnqual(*context->context()));
 }
-std::shared_ptr<VariableType> NilPointerNode::resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode)
+std::shared_ptr<VariableType> NilPointerNode::computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode)
 {
     return VariableType::getPointer();
 }
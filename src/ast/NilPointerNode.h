@@ -6,7 +6,8 @@ class NilPointerNode final : public ASTNode
 {
 public:
     explicit NilPointerNode(const Token &token);
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::NilPointer; }
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
-    std::shared_ptr<VariableType> resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
+    std::shared_ptr<VariableType> computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
 };
@@ -0,0 +1,42 @@
+#include "NodeArena.h"
+
+#include <cstdint>
+
+static size_t padding_for(const std::byte *address, const size_t alignment)
+{
+    return (alignment - reinterpret_cast<uintptr_t>(address) % alignment) % alignment;
+}
+
+NodeArena::~NodeArena()
+{
+    for (const auto file: m_files)
+        SourceManager::instance().releaseFile(file);
+}
+
+void NodeArena::adoptFile(const FileId file)
+{
+    if (file != SourceManager::noFile)
+        m_files.push_back(file);
+}
+
+void *NodeArena::allocate(const size_t size, const size_t alignment)
+{
+    if (size + alignment > blockSize)
+    {
+        // a node which does not fit into a block gets a block of its own, the current block stays in use
+        auto &block = m_blocks.emplace_back(std::make_unique_for_overwrite<std::byte[]>(size + alignment));
+        m_bytesAllocated += size + alignment;
+        return block.get() + padding_for(block.get(), alignment);
+    }
+    auto padding = padding_for(m_current, alignment);
+    if (m_current == nullptr || padding + size > static_cast<size_t>(m_end - m_current))
+    {
+        m_current = m_blocks.emplace_back(std::make_unique_for_overwrite<std::byte[]>(blockSize)).get();
+        m_end = m_current + blockSize;
+        padding = padding_for(m_current, alignment);
+    }
+    auto *result = m_current + padding;
+    m_current = result + size;
+    m_bytesAllocated += padding + size;
+    return result;
+}
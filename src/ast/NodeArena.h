@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "SourceManager.h"
+
+/// Bump allocator for the nodes of one unit. The nodes of a unit are placed next to each other in a few large blocks,
+/// so a walk over the tree touches few cache lines and parsing a unit needs few allocations. Single nodes are never
+/// freed, the blocks are released together with the arena. The arena also holds the source files of the tokens of its
+/// nodes, they are released after the nodes.
+class NodeArena
+{
+public:
+    NodeArena() = default;
+    ~NodeArena();
+    NodeArena(const NodeArena &) = delete;
+    NodeArena &operator=(const NodeArena &) = delete;
+
+    void *allocate(size_t size, size_t alignment);
+    /// takes over one addition of the file from the source manager, it is released together with the arena
+    void adoptFile(FileId file);
+    /// the bytes of all allocations including the padding for their alignment
+    [[nodiscard]] size_t bytesAllocated() const { return m_bytesAllocated; }
+
+private:
+    static constexpr size_t blockSize = 64 * 1024;
+
+    std::vector<std::unique_ptr<std::byte[]>> m_blocks;
+    std::byte *m_current = nullptr;
+    std::byte *m_end = nullptr;
+    size_t m_bytesAllocated = 0;
+    std::vector<FileId> m_files;
+};
+
+/// Allocator which places the nodes and their control blocks in an arena. The allocator does not own the arena, the
+/// unit which owns the nodes keeps it alive together with the arenas of the imported units whose nodes it shares.
+template<typename T>
+class NodeAllocator
+{
+public:
+    using value_type = T;
+
+    explicit NodeAllocator(NodeArena &arena) : m_arena(&arena) {}
+    template<typename U>
+    NodeAllocator(const NodeAllocator<U> &other) : m_arena(other.arena())
+    {
+    }
+
+    T *allocate(const size_t count) { return static_cast<T *>(m_arena->allocate(count * sizeof(T), alignof(T))); }
+    void deallocate(T *, size_t) {}
+
+    [[nodiscard]] NodeArena *arena() const { return m_arena; }
+
+    template<typename U>
+    bool operator==(const NodeAllocator<U> &other) const
+    {
+        return m_arena == other.arena();
+    }
+
+private:
+    NodeArena *m_arena;
+};
+
+/// creates a node in the arena, the arena has to outlive the node
+template<typename T, typename... Args>
+std::shared_ptr<T> make_node(NodeArena &arena, Args &&...args)
+{
+    return std::allocate_shared<T>(NodeAllocator<T>(arena), std::forward<Args>(args)...);
+}
@@ -6,7 +6,11 @@
 
 
 NumberNode::NumberNode(const Token &token, int64_t value, size_t numBits) :
-    ASTNode(token), m_value(value), m_numBits(numBits)
+    NumberNode(NodeKind::Number, token, value, numBits)
+{
+}
+NumberNode::NumberNode(const NodeKind kind, const Token &token, int64_t value, size_t numBits) :
+    ASTNode(kind, token), m_value(value), m_numBits(numBits)
 {
 }
 
@@ -17,7 +21,7 @@ llvm::Value *NumberNode::codegen(std::unique_ptr<Context> &context)
     return llvm::ConstantInt::get(*context->context(), llvm::APInt(static_cast<unsigned>(m_numBits), m_value));
 }
 
-std::shared_ptr<VariableType> NumberNode::resolveType([[maybe_unused]] const std::unique_ptr<UnitNode> &unit,
+std::shared_ptr<VariableType> NumberNode::computeType([[maybe_unused]] const std::unique_ptr<UnitNode> &unit,
                                                       ASTNode *parentNode)
 {
     return VariableType::getInteger(m_numBits);
@@ -7,11 +7,18 @@ private:
     int64_t m_value;
     size_t m_numBits;
 
+protected:
+    NumberNode(NodeKind kind, const Token &token, int64_t value, size_t numBits);
+
 public:
     NumberNode(const Token &token, int64_t value, size_t numBits);
     ~NumberNode() override = default;
+    static bool classof(const ASTNode *node)
+    {
+        return node->kind() >= NodeKind::Number && node->kind() <= NodeKind::LastNumber;
+    }
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
-    std::shared_ptr<VariableType> resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
+    std::shared_ptr<VariableType> computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
     virtual int64_t getValue() const;
 };
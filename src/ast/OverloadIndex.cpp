@@ -0,0 +1,41 @@
+#include "OverloadIndex.h"
+
+#include <utility>
+
+#include "FunctionDefinitionNode.h"
+#include "types/VariableType.h"
+
+OverloadKey::OverloadKey(const std::string_view name, std::vector<SymbolId> parameterTypes) :
+    m_name(IdentifierTable::instance().intern(name)), m_parameterTypes(std::move(parameterTypes)), m_hash(m_name)
+{
+    for (const auto type: m_parameterTypes)
+        m_hash = m_hash * 31 + type;
+}
+
+SymbolId OverloadKey::typeId(const VariableType &type) { return IdentifierTable::instance().intern(type.typeName); }
+
+bool OverloadIndex::add(const std::shared_ptr<FunctionDefinitionNode> &function)
+{
+    const auto &key = function->overloadKey();
+    auto &candidates = m_overloads[key.name()];
+    for (const auto &candidate: candidates)
+    {
+        if (candidate->overloadKey() == key)
+            return false;
+    }
+    candidates.push_back(function);
+    return true;
+}
+
+std::shared_ptr<FunctionDefinitionNode> OverloadIndex::find(const OverloadKey &key) const
+{
+    const auto it = m_overloads.find(key.name());
+    if (it == m_overloads.end())
+        return nullptr;
+    for (const auto &candidate: it->second)
+    {
+        if (candidate->overloadKey() == key)
+            return candidate;
+    }
+    return nullptr;
+}
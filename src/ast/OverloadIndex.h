@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "IdentifierTable.h"
+
+class FunctionDefinitionNode;
+class VariableType;
+
+/// The name and the parameter types of a function or a call. The name and the names of the types are interned, so
+/// the key is compared without building or comparing strings. The hash is computed once when the key is created.
+class OverloadKey
+{
+public:
+    OverloadKey(std::string_view name, std::vector<SymbolId> parameterTypes);
+
+    /// the interned name of the type which identifies it in a signature
+    static SymbolId typeId(const VariableType &type);
+
+    [[nodiscard]] SymbolId name() const { return m_name; }
+    [[nodiscard]] const std::vector<SymbolId> &parameterTypes() const { return m_parameterTypes; }
+    [[nodiscard]] size_t hash() const { return m_hash; }
+
+    bool operator==(const OverloadKey &other) const
+    {
+        return m_hash == other.m_hash && m_name == other.m_name && m_parameterTypes == other.m_parameterTypes;
+    }
+
+private:
+    SymbolId m_name;
+    std::vector<SymbolId> m_parameterTypes;
+    size_t m_hash;
+};
+
+/// Maps the name of a function to all of its overloads, so resolving a call or merging the functions of an imported
+/// unit only compares the keys of the functions with the same name.
+class OverloadIndex
+{
+public:
+    /// adds the function, returns false and keeps the known function if a function with the same key was added before
+    bool add(const std::shared_ptr<FunctionDefinitionNode> &function);
+    /// returns the function with the key or nullptr if there is none
+    [[nodiscard]] std::shared_ptr<FunctionDefinitionNode> find(const OverloadKey &key) const;
+
+private:
+    std::unordered_map<SymbolId, std::vector<std::shared_ptr<FunctionDefinitionNode>>> m_overloads;
+};
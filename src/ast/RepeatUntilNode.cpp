@@ -8,7 +8,7 @@
 
 RepeatUntilNode::RepeatUntilNode(const Token &token, std::shared_ptr<ASTNode> loopCondition,
                                  std::vector<std::shared_ptr<ASTNode>> nodes) :
-    ASTNode(token), m_loopCondition(std::move(loopCondition)), m_nodes(std::move(nodes))
+    ASTNode(NodeKind::RepeatUntil, token), m_loopCondition(std::move(loopCondition)), m_nodes(std::move(nodes))
 {
 }
 void RepeatUntilNode::print() {}
@@ -13,6 +13,7 @@ public:
     RepeatUntilNode(const Token &token, std::shared_ptr<ASTNode> loopCondition,
                     std::vector<std::shared_ptr<ASTNode>> nodes);
     ~RepeatUntilNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::RepeatUntil; }
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
     void typeCheck(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
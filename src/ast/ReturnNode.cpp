@@ -5,7 +5,7 @@
 #include "compiler/Context.h"
 
 ReturnNode::ReturnNode(const Token &token, std::shared_ptr<ASTNode> expression) :
-    ASTNode(token), m_expression(expression)
+    ASTNode(NodeKind::Return, token), m_expression(expression)
 {
 }
 
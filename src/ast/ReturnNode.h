@@ -12,6 +12,7 @@ private:
 public:
     ReturnNode(const Token &token, std::shared_ptr<ASTNode> expression);
     ~ReturnNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::Return; }
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
 };
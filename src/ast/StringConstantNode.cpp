@@ -8,7 +8,7 @@
 
 
 StringConstantNode::StringConstantNode(const Token &token, const std::string &literal) :
-    ASTNode(token), m_literal(literal)
+    ASTNode(NodeKind::StringConstant, token), m_literal(literal)
 {
 }
 
@@ -102,7 +102,7 @@ llvm::Value *StringConstantNode::codegenForTargetType(std::unique_ptr<Context> &
     return LogErrorV("cannot convert string constant to target type");
 }
 
-std::shared_ptr<VariableType> StringConstantNode::resolveType([[maybe_unused]] const std::unique_ptr<UnitNode> &unit,
+std::shared_ptr<VariableType> StringConstantNode::computeType([[maybe_unused]] const std::unique_ptr<UnitNode> &unit,
                                                               ASTNode *parentNode)
 {
     return StringType::getString();
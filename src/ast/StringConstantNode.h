@@ -14,10 +14,11 @@ private:
 public:
     StringConstantNode(const Token &token, const std::string &literal);
     ~StringConstantNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::StringConstant; }
     void print() override;
 
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
     llvm::Value *codegenForTargetType(std::unique_ptr<Context> &context,
                                       const std::shared_ptr<VariableType> &targetType) override;
-    std::shared_ptr<VariableType> resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
+    std::shared_ptr<VariableType> computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
 };
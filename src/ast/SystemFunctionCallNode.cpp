@@ -4,9 +4,10 @@
 #include <iostream>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/TargetParser/Triple.h>
+#include <array>
+#include <unordered_map>
 #include <utility>
 #include <vector>
-#include "../compare.h"
 #include "UnitNode.h"
 #include "compiler/Context.h"
 #include "types/ArrayType.h"
@@ -16,24 +17,48 @@
 #include "types/ValueRangeType.h"
 
 
-static std::vector<std::string> knownSystemCalls = {"writeln", "write",     "printf",     "exit",   "low",
-                                                    "high",    "setlength", "length",     "pchar",  "new",
-                                                    "halt",    "assert",    "assignfile", "readln", "closefile",
-                                                    "reset",   "rewrite",   "ord",        "chr",    "strdispose"};
-
-bool isKnownSystemCall(const std::string &name)
+static constexpr std::array<std::pair<std::string_view, SystemCall>, 20> knownSystemCalls = {{
+        {"writeln", SystemCall::Writeln},
+        {"write", SystemCall::Write},
+        {"printf", SystemCall::Printf},
+        {"exit", SystemCall::Exit},
+        {"low", SystemCall::Low},
+        {"high", SystemCall::High},
+        {"setlength", SystemCall::SetLength},
+        {"length", SystemCall::Length},
+        {"pchar", SystemCall::PChar},
+        {"new", SystemCall::New},
+        {"halt", SystemCall::Halt},
+        {"assert", SystemCall::Assert},
+        {"assignfile", SystemCall::AssignFile},
+        {"readln", SystemCall::ReadLn},
+        {"closefile", SystemCall::CloseFile},
+        {"reset", SystemCall::Reset},
+        {"rewrite", SystemCall::Rewrite},
+        {"ord", SystemCall::Ord},
+        {"chr", SystemCall::Chr},
+        {"strdispose", SystemCall::StrDispose},
+}};
+
+SystemCall system_call(const SymbolId symbol)
 {
-    for (const auto &call: knownSystemCalls)
-    {
-        if (iequals(call, name))
-            return true;
-    }
-    return false;
+    static const auto systemCalls = []
+    {
+        std::unordered_map<SymbolId, SystemCall> calls;
+        for (const auto &[name, call]: knownSystemCalls)
+            calls.emplace(IdentifierTable::instance().intern(name), call);
+        return calls;
+    }();
+    const auto it = systemCalls.find(symbol);
+    return it != systemCalls.end() ? it->second : SystemCall::Unknown;
 }
 
+bool isKnownSystemCall(const SymbolId symbol) { return system_call(symbol) != SystemCall::Unknown; }
+
 SystemFunctionCallNode::SystemFunctionCallNode(const Token &token, std::string name,
                                                const std::vector<std::shared_ptr<ASTNode>> &args) :
-    FunctionCallNode(token, std::move(name), args)
+    FunctionCallNode(NodeKind::SystemFunctionCall, token, std::move(name), args),
+    m_call(system_call(IdentifierTable::instance().intern(m_name)))
 {
 }
 
@@ -410,8 +435,8 @@ llvm::Value *SystemFunctionCallNode::codegen_assert(std::unique_ptr<Context> &co
                 const auto token = argument->expressionToken();
                 ArgsV.push_back(ctx->builder()->CreateGlobalString(assertation, "assertion"));
                 ArgsV.push_back(
-                        ctx->builder()->CreateGlobalString(token.sourceLocation.filename, "assertion_source_file"));
-                ArgsV.push_back(ctx->builder()->getInt32(token.row));
+                        ctx->builder()->CreateGlobalString(token.filename(), "assertion_source_file"));
+                ArgsV.push_back(ctx->builder()->getInt32(token.row()));
                 ArgsV.push_back(ctx->builder()->CreateGlobalString(callingFunctionName, "assertion_function"));
                 ctx->builder()->CreateCall(assertCall, ArgsV);
             });
@@ -430,7 +455,7 @@ llvm::Value *SystemFunctionCallNode::codegen(std::unique_ptr<Context> &context)
 {
     ASTNode *parent = resolveParent(context);
 
-    if (iequals(m_name, "low"))
+    if (m_call == SystemCall::Low)
     {
 
         const auto paramType = m_args[0]->resolveType(context->programUnit(), parent);
@@ -452,7 +477,7 @@ llvm::Value *SystemFunctionCallNode::codegen(std::unique_ptr<Context> &context)
             return range->generateLowerBounds(expressionToken(), context);
         }
     }
-    else if (iequals(m_name, "high"))
+    else if (m_call == SystemCall::High)
     {
         const auto paramType = m_args[0]->resolveType(context->programUnit(), parent);
         if (const auto arrayType = std::dynamic_pointer_cast<ArrayType>(paramType))
@@ -472,24 +497,24 @@ llvm::Value *SystemFunctionCallNode::codegen(std::unique_ptr<Context> &context)
             return range->generateUpperBounds(expressionToken(), context);
         }
     }
-    else if (iequals(m_name, "length"))
+    else if (m_call == SystemCall::Length)
     {
         return codegen_length(context, parent);
     }
-    else if (iequals(m_name, "setlength"))
+    else if (m_call == SystemCall::SetLength)
     {
         return codegen_setlength(context, parent);
     }
-    else if (iequals(m_name, "write"))
+    else if (m_call == SystemCall::Write)
     {
         return codegen_write(context, parent);
     }
-    else if (iequals(m_name, "writeln"))
+    else if (m_call == SystemCall::Writeln)
     {
 
         return codegen_writeln(context, parent);
     }
-    else if (iequals(m_name, "pchar"))
+    else if (m_call == SystemCall::PChar)
     {
         const auto stringStructPtr = m_args[0]->codegen(context);
         const auto type = m_args[0]->resolveType(context->programUnit(), parent);
@@ -497,18 +522,18 @@ llvm::Value *SystemFunctionCallNode::codegen(std::unique_ptr<Context> &context)
                                                                             stringStructPtr, 2, "string.ptr.offset");
         return context->builder()->CreateLoad(llvm::PointerType::getUnqual(*context->context()), arrayPointerOffset);
     }
-    else if (iequals(m_name, "new"))
+    else if (m_call == SystemCall::New)
     {
         return codegen_new(context, parent);
     }
-    else if (iequals(m_name, "halt"))
+    else if (m_call == SystemCall::Halt)
     {
         const auto argValue = m_args[0]->codegen(context);
         llvm::Function *CalleeF = context->module()->getFunction("exit");
 
         return context->builder()->CreateCall(CalleeF, argValue);
     }
-    else if (iequals(m_name, "exit"))
+    else if (m_call == SystemCall::Exit)
     {
         context->explicitReturn = true;
         context->breakBlock().BlockUsed = true;
@@ -520,22 +545,22 @@ llvm::Value *SystemFunctionCallNode::codegen(std::unique_ptr<Context> &context)
 
         return context->builder()->CreateRet(argValue);
     }
-    else if (iequals(m_name, "assert"))
+    else if (m_call == SystemCall::Assert)
     {
         return codegen_assert(context, parent, m_args[0].get(), m_args[0]->codegen(context),
                               m_args[0]->expressionToken().lexical());
     }
-    else if (iequals(m_name, "ord"))
+    else if (m_call == SystemCall::Ord)
     {
         const auto argValue = m_args[0]->codegen(context);
         return argValue;
     }
-    else if (iequals(m_name, "chr"))
+    else if (m_call == SystemCall::Chr)
     {
         const auto argValue = m_args[0]->codegen(context);
         return argValue;
     }
-    else if (iequals(m_name, "strdispose"))
+    else if (m_call == SystemCall::StrDispose)
     {
         const auto argValue = m_args[0]->codegen(context);
         llvm::Function *CalleeF = context->module()->getFunction("free");
@@ -547,34 +572,34 @@ llvm::Value *SystemFunctionCallNode::codegen(std::unique_ptr<Context> &context)
 }
 
 
-std::shared_ptr<VariableType> SystemFunctionCallNode::resolveType(const std::unique_ptr<UnitNode> &unitNode,
+std::shared_ptr<VariableType> SystemFunctionCallNode::computeType(const std::unique_ptr<UnitNode> &unitNode,
                                                                   ASTNode *parentNode)
 {
-    if (iequals(m_name, "low"))
+    if (m_call == SystemCall::Low)
     {
         return IntegerType::getInteger(64);
     }
-    if (iequals(m_name, "high"))
+    if (m_call == SystemCall::High)
     {
         return IntegerType::getInteger(64);
     }
-    if (iequals(m_name, "length"))
+    if (m_call == SystemCall::Length)
     {
         return IntegerType::getInteger(64);
     }
-    if (iequals(m_name, "setlength"))
+    if (m_call == SystemCall::SetLength)
     {
         return nullptr;
     }
-    if (iequals(m_name, "pchar"))
+    if (m_call == SystemCall::PChar)
     {
         return PointerType::getPointerTo(IntegerType::getCharacter());
     }
-    if (iequals(m_name, "ord"))
+    if (m_call == SystemCall::Ord)
     {
         return IntegerType::getInteger(32);
     }
-    if (iequals(m_name, "chr"))
+    if (m_call == SystemCall::Chr)
     {
         return IntegerType::getCharacter();
     }
@@ -2,12 +2,43 @@
 
 
 #include "FunctionCallNode.h"
+#include "IdentifierTable.h"
 
-bool isKnownSystemCall(const std::string &name);
+/// the functions which are generated by the compiler instead of being declared in the rtl
+enum class SystemCall : uint8_t
+{
+    Unknown,
+    Writeln,
+    Write,
+    Printf,
+    Exit,
+    Low,
+    High,
+    SetLength,
+    Length,
+    PChar,
+    New,
+    Halt,
+    Assert,
+    AssignFile,
+    ReadLn,
+    CloseFile,
+    Reset,
+    Rewrite,
+    Ord,
+    Chr,
+    StrDispose,
+};
+
+/// returns the system function the symbol names, the symbol is the one of the identifier of the call
+SystemCall system_call(SymbolId symbol);
+bool isKnownSystemCall(SymbolId symbol);
 
 class SystemFunctionCallNode final : public FunctionCallNode
 {
 private:
+    SystemCall m_call;
+
     llvm::Value *codegen_setlength(std::unique_ptr<Context> &context, ASTNode *parent) const;
     llvm::Value *codegen_length(std::unique_ptr<Context> &context, ASTNode *parent) const;
     llvm::Value *find_target_fileout(std::unique_ptr<Context> &context, ASTNode *parent) const;
@@ -22,6 +53,7 @@ public:
                                        llvm::Value *expression, const std::string &assertation);
 
     ~SystemFunctionCallNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::SystemFunctionCall; }
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
-    std::shared_ptr<VariableType> resolveType(const std::unique_ptr<UnitNode> &unitNode, ASTNode *parentNode) override;
+    std::shared_ptr<VariableType> computeType(const std::unique_ptr<UnitNode> &unitNode, ASTNode *parentNode) override;
 };
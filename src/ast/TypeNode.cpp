@@ -11,7 +11,7 @@ llvm::Value *TypeNode::codegen(std::unique_ptr<Context> &context)
     assert(false && "TypeNode::codegen should not be called");
     return nullptr;
 }
-std::shared_ptr<VariableType> TypeNode::resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode)
+std::shared_ptr<VariableType> TypeNode::computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode)
 {
     return m_variableType;
 }
@@ -6,12 +6,13 @@ class TypeNode final : public ASTNode
 {
 public:
     TypeNode(const Token &token, const std::shared_ptr<VariableType> &m_variable_type) :
-        ASTNode(token), m_variableType(m_variable_type)
+        ASTNode(NodeKind::Type, token), m_variableType(m_variable_type)
     {
     }
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::Type; }
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
-    std::shared_ptr<VariableType> resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
+    std::shared_ptr<VariableType> computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
 
 private:
     std::shared_ptr<VariableType> m_variableType;
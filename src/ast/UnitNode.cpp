@@ -15,17 +15,22 @@
 UnitNode::UnitNode(const Token &token, const UnitType unitType, const std::string &unitName,
                    const std::vector<std::shared_ptr<FunctionDefinitionNode>> &functionDefinitions,
                    const TypeRegistry &typeDefinitions, const std::shared_ptr<BlockNode> &blockNode) :
-    ASTNode(token), m_unitType(unitType), m_unitName(unitName), m_functionDefinitions(functionDefinitions),
-    m_typeDefinitions(std::move(typeDefinitions)), m_blockNode(blockNode)
+    ASTNode(NodeKind::Unit, token), m_unitType(unitType), m_unitName(unitName),
+    m_functionDefinitions(functionDefinitions), m_typeDefinitions(std::move(typeDefinitions)), m_blockNode(blockNode)
 {
+    for (const auto &function: m_functionDefinitions)
+        m_overloads.add(function);
 }
 UnitNode::UnitNode(const Token &token, const UnitType unitType, const std::string &unitName,
                    const std::vector<std::string> &argumentNames,
                    const std::vector<std::shared_ptr<FunctionDefinitionNode>> &functionDefinitions,
                    const TypeRegistry &typeDefinitions, const std::shared_ptr<BlockNode> &blockNode) :
-    ASTNode(token), m_unitType(unitType), m_unitName(unitName), m_functionDefinitions(functionDefinitions),
-    m_typeDefinitions(std::move(typeDefinitions)), m_blockNode(blockNode), m_argumentNames(argumentNames)
+    ASTNode(NodeKind::Unit, token), m_unitType(unitType), m_unitName(unitName),
+    m_functionDefinitions(functionDefinitions), m_typeDefinitions(std::move(typeDefinitions)), m_blockNode(blockNode),
+    m_argumentNames(argumentNames)
 {
+    for (const auto &function: m_functionDefinitions)
+        m_overloads.add(function);
 }
 
 void UnitNode::print()
@@ -44,7 +49,8 @@ void UnitNode::print()
         def->print();
     }
 
-    m_blockNode->print();
+    if (m_blockNode)
+        m_blockNode->print();
 }
 
 std::vector<std::shared_ptr<FunctionDefinitionNode>> UnitNode::getFunctionDefinitions()
@@ -64,6 +70,12 @@ std::optional<std::shared_ptr<FunctionDefinitionNode>> UnitNode::getFunctionDefi
     }
     return std::nullopt;
 }
+std::optional<std::shared_ptr<FunctionDefinitionNode>> UnitNode::getFunctionDefinition(const OverloadKey &key) const
+{
+    if (auto function = m_overloads.find(key))
+        return function;
+    return std::nullopt;
+}
 std::optional<std::shared_ptr<FunctionDefinitionNode>>
 UnitNode::getFunctionDefinitionByName(const std::string &functionName)
 {
@@ -80,6 +92,35 @@ UnitNode::getFunctionDefinitionByName(const std::string &functionName)
 void UnitNode::addFunctionDefinition(const std::shared_ptr<FunctionDefinitionNode> &functionDefinition)
 {
     m_functionDefinitions.push_back(functionDefinition);
+    m_overloads.add(functionDefinition);
+    clearTypeAnnotations();
+}
+
+std::shared_ptr<VariableType> UnitNode::annotatedType(const ASTNode *node, const ASTNode *parentNode) const
+{
+    std::shared_lock lock(m_typeAnnotationsMutex);
+    if (const auto it = m_typeAnnotations.find({node, parentNode}); it != m_typeAnnotations.end())
+        return it->second;
+    return nullptr;
+}
+
+std::shared_ptr<VariableType> UnitNode::annotateType(const ASTNode *node, const ASTNode *parentNode,
+                                                     std::shared_ptr<VariableType> type)
+{
+    std::unique_lock lock(m_typeAnnotationsMutex);
+    return m_typeAnnotations.try_emplace({node, parentNode}, std::move(type)).first->second;
+}
+
+void UnitNode::clearTypeAnnotations()
+{
+    std::unique_lock lock(m_typeAnnotationsMutex);
+    m_typeAnnotations.clear();
+}
+
+void UnitNode::addArgumentVariable(VariableDefinition definition)
+{
+    m_blockNode->addVariableDefinition(std::move(definition));
+    clearTypeAnnotations();
 }
 
 std::string UnitNode::getUnitName() { return m_unitName; }
@@ -88,7 +129,8 @@ llvm::Value *UnitNode::codegen(std::unique_ptr<Context> &context)
 {
     std::vector<llvm::Type *> params;
 
-    m_blockNode->codegenConstantDefinitions(context);
+    if (m_blockNode)
+        m_blockNode->codegenConstantDefinitions(context);
     {
         // #define stdin  (__acrt_iob_func(0))
         // #define stdout (__acrt_iob_func(1))
@@ -96,22 +138,23 @@ llvm::Value *UnitNode::codegen(std::unique_ptr<Context> &context)
         if (context->TargetTriple->getOS() == llvm::Triple::Win32)
         {
             auto cFile = llvm::PointerType::getUnqual(*context->context());
+            // separately compiled units share the file handles which are initialized by the program
+            const auto linkage = context->options().separateUnits ? llvm::GlobalValue::ExternalLinkage
+                                                                  : llvm::GlobalValue::InternalLinkage;
+            llvm::Constant *initializer =
+                    m_unitType == UnitType::PROGRAM ? llvm::ConstantPointerNull::get(cFile) : nullptr;
             auto ext_stdout =
-                    new llvm::GlobalVariable(*context->module(), cFile, false, llvm::GlobalValue::InternalLinkage,
-                                             llvm::ConstantPointerNull::get(cFile), "stdout");
+                    new llvm::GlobalVariable(*context->module(), cFile, false, linkage, initializer, "stdout");
 
             // ext_stdout->setExternallyInitialized(true);
             context->setNamedValue("stdout", ext_stdout);
             // ext_stdout->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Local);
 
             auto ext_stderr =
-                    new llvm::GlobalVariable(*context->module(), cFile, false, llvm::GlobalValue::InternalLinkage,
-                                             llvm::ConstantPointerNull::get(cFile), "stderr");
+                    new llvm::GlobalVariable(*context->module(), cFile, false, linkage, initializer, "stderr");
             context->setNamedValue("stderr", ext_stderr);
 
-            auto ext_stdin =
-                    new llvm::GlobalVariable(*context->module(), cFile, false, llvm::GlobalValue::InternalLinkage,
-                                             llvm::ConstantPointerNull::get(cFile), "stdin");
+            auto ext_stdin = new llvm::GlobalVariable(*context->module(), cFile, false, linkage, initializer, "stdin");
             // ext_stdin->setExternallyInitialized(true);
             context->setNamedValue("stdin", ext_stdin);
         }
@@ -125,11 +168,11 @@ llvm::Value *UnitNode::codegen(std::unique_ptr<Context> &context)
             ext_stderr->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Local);
             if (m_argumentNames.size() >= 3)
             {
-                m_blockNode->addVariableDefinition(VariableDefinition{.variableType = fileType,
-                                                                      .variableName = m_argumentNames[2],
-                                                                      .scopeId = 0,
-                                                                      .llvmValue = ext_stderr,
-                                                                      .constant = false});
+                addArgumentVariable(VariableDefinition{.variableType = fileType,
+                                                       .variableName = m_argumentNames[2],
+                                                       .scopeId = 0,
+                                                       .llvmValue = ext_stderr,
+                                                       .constant = false});
             }
 
             context->setNamedValue("stderr", ext_stderr);
@@ -139,11 +182,11 @@ llvm::Value *UnitNode::codegen(std::unique_ptr<Context> &context)
             context->setNamedValue("stdout", ext_stdout);
             if (m_argumentNames.size() >= 2)
             {
-                m_blockNode->addVariableDefinition(VariableDefinition{.variableType = fileType,
-                                                                      .variableName = m_argumentNames[1],
-                                                                      .scopeId = 0,
-                                                                      .llvmValue = ext_stdout,
-                                                                      .constant = false});
+                addArgumentVariable(VariableDefinition{.variableType = fileType,
+                                                       .variableName = m_argumentNames[1],
+                                                       .scopeId = 0,
+                                                       .llvmValue = ext_stdout,
+                                                       .constant = false});
             }
             auto ext_stdin = new llvm::GlobalVariable(*context->module(), cFile, false,
                                                       llvm::GlobalValue::ExternalLinkage, nullptr, "stdin");
@@ -151,11 +194,11 @@ llvm::Value *UnitNode::codegen(std::unique_ptr<Context> &context)
             context->setNamedValue("stdin", ext_stdin);
             if (!m_argumentNames.empty())
             {
-                m_blockNode->addVariableDefinition(VariableDefinition{.variableType = fileType,
-                                                                      .variableName = m_argumentNames[1],
-                                                                      .scopeId = 0,
-                                                                      .llvmValue = ext_stdin,
-                                                                      .constant = false});
+                addArgumentVariable(VariableDefinition{.variableType = fileType,
+                                                       .variableName = m_argumentNames[1],
+                                                       .scopeId = 0,
+                                                       .llvmValue = ext_stdin,
+                                                       .constant = false});
             }
         }
 
@@ -163,10 +206,26 @@ llvm::Value *UnitNode::codegen(std::unique_ptr<Context> &context)
     }
 
 
+    if (context->options().separateUnits)
+    {
+        // functions of other units are only declared, their code is part of the object file of their unit
+        for (auto &fdef: m_functionDefinitions)
+        {
+            if (fdef->body() && !fdef->hasAttribute(FunctionAttribute::Inline) &&
+                fdef->expressionToken().filename() != expressionToken().filename())
+            {
+                context->addExternalFunction(fdef->functionSignature());
+            }
+        }
+    }
     for (auto &fdef: m_functionDefinitions)
     {
         fdef->codegen(context);
     }
+    if (m_unitType == UnitType::UNIT)
+    {
+        return nullptr;
+    }
     llvm::FunctionType *FT = llvm::FunctionType::get(llvm::Type::getInt32Ty(*context->context()), params, false);
 
     std::string functionName = m_unitName;
@@ -177,6 +236,7 @@ llvm::Value *UnitNode::codegen(std::unique_ptr<Context> &context)
 
     llvm::Function *F =
             llvm::Function::Create(FT, llvm::Function::ExternalLinkage, functionName, context->module().get());
+    context->addTargetAttributes(F);
     context->setCurrentFunction(F);
     llvm::BasicBlock *BB = llvm::BasicBlock::Create(*context->context(), "entry", context->currentFunction());
     context->builder()->SetInsertPoint(BB);
@@ -200,31 +260,31 @@ llvm::Value *UnitNode::codegen(std::unique_ptr<Context> &context)
             auto fileType = context->programUnit()->getTypeDefinitions().getType("file");
 
 
-            m_blockNode->addVariableDefinition(VariableDefinition{.variableType = fileType,
-                                                                  .variableName = m_argumentNames[1],
-                                                                  .scopeId = 0,
-                                                                  .llvmValue = context->namedValue("stdout"),
-                                                                  .constant = false});
+            addArgumentVariable(VariableDefinition{.variableType = fileType,
+                                                   .variableName = m_argumentNames[1],
+                                                   .scopeId = 0,
+                                                   .llvmValue = context->namedValue("stdout"),
+                                                   .constant = false});
         }
         auto fileType = context->programUnit()->getTypeDefinitions().getType("file");
 
         if (m_argumentNames.size() >= 1)
         {
-            m_blockNode->addVariableDefinition(VariableDefinition{.variableType = fileType,
-                                                                  .variableName = m_argumentNames[0],
-                                                                  .scopeId = 0,
-                                                                  .llvmValue = context->namedValue("stdin"),
-                                                                  .constant = false});
+            addArgumentVariable(VariableDefinition{.variableType = fileType,
+                                                   .variableName = m_argumentNames[0],
+                                                   .scopeId = 0,
+                                                   .llvmValue = context->namedValue("stdin"),
+                                                   .constant = false});
         }
 
 
         if (m_argumentNames.size() >= 2)
         {
-            m_blockNode->addVariableDefinition(VariableDefinition{.variableType = fileType,
-                                                                  .variableName = m_argumentNames[2],
-                                                                  .scopeId = 0,
-                                                                  .llvmValue = context->namedValue("stderr"),
-                                                                  .constant = false});
+            addArgumentVariable(VariableDefinition{.variableType = fileType,
+                                                   .variableName = m_argumentNames[2],
+                                                   .scopeId = 0,
+                                                   .llvmValue = context->namedValue("stderr"),
+                                                   .constant = false});
         }
     }
 
@@ -264,29 +324,35 @@ std::set<std::string> UnitNode::collectLibsToLink()
     }
     return result;
 }
-TypeRegistry UnitNode::getTypeDefinitions() { return m_typeDefinitions; }
+const TypeRegistry &UnitNode::getTypeDefinitions() const { return m_typeDefinitions; }
 void UnitNode::typeCheck(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode)
 {
+    clearTypeAnnotations();
     for (const auto &def: m_functionDefinitions)
     {
         def->typeCheck(unit, parentNode);
     }
 
-    m_blockNode->typeCheck(unit, parentNode);
+    if (m_blockNode)
+        m_blockNode->typeCheck(unit, parentNode);
+}
+void UnitNode::setImportedUnits(const std::vector<std::filesystem::path> &importedUnits)
+{
+    m_importedUnits = importedUnits;
 }
 std::optional<std::pair<const ASTNode *, std::shared_ptr<ASTNode>>> UnitNode::getNodeByToken(const Token &token) const
 {
     if (m_blockNode)
     {
         if (auto result = m_blockNode->getNodeByToken(token))
-            return std::pair{dynamic_cast<const ASTNode *>(this), result.value()};
+            return std::pair{static_cast<const ASTNode *>(this), result.value()};
     }
     for (const auto &function: m_functionDefinitions)
     {
         if (function->body())
         {
             if (auto result = function->body()->getNodeByToken(token))
-                return std::pair{dynamic_cast<const ASTNode *>(function.get()), result.value()};
+                return std::pair{static_cast<const ASTNode *>(function.get()), result.value()};
         }
     }
 
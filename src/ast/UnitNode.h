@@ -1,10 +1,14 @@
 #pragma once
 
+#include <filesystem>
 #include <set>
+#include <shared_mutex>
 #include <unordered_map>
 #include "ASTNode.h"
 #include "ast/BlockNode.h"
 #include "ast/FunctionDefinitionNode.h"
+#include "ast/NodeArena.h"
+#include "ast/OverloadIndex.h"
 #include "types/TypeRegistry.h"
 
 enum class UnitType
@@ -16,12 +20,40 @@ enum class UnitType
 class UnitNode : public ASTNode
 {
 private:
+    /// the arenas of the nodes of the unit and of the imported units whose nodes it shares, they are declared first so
+    /// that they are released after all nodes of the unit
+    std::vector<std::shared_ptr<NodeArena>> m_arenas;
     UnitType m_unitType;
     std::string m_unitName;
     std::vector<std::shared_ptr<FunctionDefinitionNode>> m_functionDefinitions;
+    /// the first function of m_functionDefinitions for every overload key
+    OverloadIndex m_overloads;
     TypeRegistry m_typeDefinitions;
     std::shared_ptr<BlockNode> m_blockNode;
     std::vector<std::string> m_argumentNames;
+    std::vector<std::filesystem::path> m_importedUnits;
+
+    struct AnnotationKey
+    {
+        const ASTNode *node;
+        const ASTNode *parent;
+        bool operator==(const AnnotationKey &) const = default;
+    };
+    struct AnnotationKeyHash
+    {
+        size_t operator()(const AnnotationKey &key) const
+        {
+            return std::hash<const ASTNode *>{}(key.node) * 31 + std::hash<const ASTNode *>{}(key.parent);
+        }
+    };
+    /// the resolved type of every expression in the scope of its parent node. The types are kept in the unit which is
+    /// compiled and not in the nodes, the nodes of imported units are shared between the jobs of the compile server.
+    std::unordered_map<AnnotationKey, std::shared_ptr<VariableType>, AnnotationKeyHash> m_typeAnnotations;
+    mutable std::shared_mutex m_typeAnnotationsMutex;
+
+    /// adds a variable for a program argument, the annotated types are dropped because the name may resolve differently
+    void addArgumentVariable(VariableDefinition definition);
+    void clearTypeAnnotations();
 
 public:
     UnitNode(const Token &token, UnitType unitType, const std::string &unitName,
@@ -32,18 +64,33 @@ public:
              const std::vector<std::shared_ptr<FunctionDefinitionNode>> &functionDefinitions,
              const TypeRegistry &typeDefinitions, const std::shared_ptr<BlockNode> &blockNode);
     ~UnitNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::Unit; }
 
     void print() override;
 
     std::vector<std::shared_ptr<FunctionDefinitionNode>> getFunctionDefinitions();
     std::optional<std::shared_ptr<FunctionDefinitionNode>> getFunctionDefinition(const std::string &functionName);
+    /// returns the function which matches the name and the parameter types of a call
+    std::optional<std::shared_ptr<FunctionDefinitionNode>> getFunctionDefinition(const OverloadKey &key) const;
     std::optional<std::shared_ptr<FunctionDefinitionNode>> getFunctionDefinitionByName(const std::string &functionName);
     void addFunctionDefinition(const std::shared_ptr<FunctionDefinitionNode> &functionDefinition);
     std::string getUnitName();
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
     std::optional<VariableDefinition> getVariableDefinition(const std::string &name) const;
     std::set<std::string> collectLibsToLink();
-    TypeRegistry getTypeDefinitions();
+    [[nodiscard]] const TypeRegistry &getTypeDefinitions() const;
+    [[nodiscard]] UnitType unitType() const { return m_unitType; }
+    /// paths of all units which are imported directly or indirectly, every unit is listed after its own imports
+    [[nodiscard]] const std::vector<std::filesystem::path> &importedUnits() const { return m_importedUnits; }
+    void setImportedUnits(const std::vector<std::filesystem::path> &importedUnits);
+    [[nodiscard]] const std::vector<std::shared_ptr<NodeArena>> &arenas() const { return m_arenas; }
+    void setArenas(const std::vector<std::shared_ptr<NodeArena>> &arenas) { m_arenas = arenas; }
+
+    /// returns the type which was annotated for the node in the scope of the parent or nullptr
+    [[nodiscard]] std::shared_ptr<VariableType> annotatedType(const ASTNode *node, const ASTNode *parentNode) const;
+    /// stores the resolved type of the node, if another job annotated the node first its type is returned
+    std::shared_ptr<VariableType> annotateType(const ASTNode *node, const ASTNode *parentNode,
+                                               std::shared_ptr<VariableType> type);
 
     void typeCheck(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
     std::optional<std::pair<const ASTNode *, std::shared_ptr<ASTNode>>> getNodeByToken(const Token &token) const;
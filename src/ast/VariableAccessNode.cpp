@@ -8,7 +8,7 @@
 
 
 VariableAccessNode::VariableAccessNode(const Token &token, bool dereference) :
-    ASTNode(token), m_variableName(token.lexical()), m_dereference(dereference)
+    ASTNode(NodeKind::VariableAccess, token), m_variableName(token.lexical()), m_dereference(dereference)
 {
 }
 
@@ -71,10 +71,10 @@ llvm::Value *VariableAccessNode::codegen(std::unique_ptr<Context> &context)
     return context->builder()->CreateLoad(A->getAllocatedType(), A, m_variableName.c_str());
 }
 
-std::shared_ptr<VariableType> VariableAccessNode::resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parent)
+std::shared_ptr<VariableType> VariableAccessNode::computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parent)
 {
     std::shared_ptr<VariableType> type;
-    if (auto *functionDefinition = dynamic_cast<FunctionDefinitionNode *>(parent))
+    if (auto *functionDefinition = dyn_cast<FunctionDefinitionNode>(parent))
     {
         if (auto param = functionDefinition->getParam(m_variableName))
         {
@@ -85,7 +85,7 @@ std::shared_ptr<VariableType> VariableAccessNode::resolveType(const std::unique_
             type = var.value().variableType;
         }
     }
-    else if (auto *functionCall = dynamic_cast<FunctionCallNode *>(parent))
+    else if (auto *functionCall = dyn_cast<FunctionCallNode>(parent))
     {
         if (auto unitFunctionDefinition = unit->getFunctionDefinition(functionCall->name()))
         {
@@ -11,9 +11,10 @@ private:
 public:
     explicit VariableAccessNode(const Token &token, bool dereference);
     ~VariableAccessNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::VariableAccess; }
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
 
-    std::shared_ptr<VariableType> resolveType(const std::unique_ptr<UnitNode> &unit, ASTNode *parent) override;
+    std::shared_ptr<VariableType> computeType(const std::unique_ptr<UnitNode> &unit, ASTNode *parent) override;
     std::string variableName() const { return m_variableName; }
 };
@@ -10,8 +10,8 @@
 
 VariableAssignmentNode::VariableAssignmentNode(const Token &variableName, const std::shared_ptr<ASTNode> &expression,
                                                bool dereference) :
-    ASTNode(variableName), m_variable(variableName), m_variableName(std::string(m_variable.lexical())),
-    m_expression(expression), m_dereference(dereference)
+    ASTNode(NodeKind::VariableAssignment, variableName), m_variable(variableName),
+    m_variableName(std::string(m_variable.lexical())), m_expression(expression), m_dereference(dereference)
 {
 }
 
@@ -150,7 +150,7 @@ void VariableAssignmentNode::typeCheck(const std::unique_ptr<UnitNode> &unit, AS
 {
     if (parentNode != unit.get())
     {
-        if (const auto functionDef = dynamic_cast<FunctionDefinitionNode *>(parentNode))
+        if (const auto functionDef = dyn_cast<FunctionDefinitionNode>(parentNode))
         {
             if (const auto varType = functionDef->body()->getVariableDefinition(m_variableName))
             {
@@ -13,6 +13,7 @@ private:
 public:
     VariableAssignmentNode(const Token &variableName, const std::shared_ptr<ASTNode> &expression, bool dereference);
     ~VariableAssignmentNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::VariableAssignment; }
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
     void typeCheck(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
@@ -6,7 +6,7 @@
 
 WhileNode::WhileNode(const Token &token, std::shared_ptr<ASTNode> loopCondition,
                      std::vector<std::shared_ptr<ASTNode>> nodes) :
-    ASTNode(token), m_loopCondition(std::move(loopCondition)), m_nodes(std::move(nodes))
+    ASTNode(NodeKind::While, token), m_loopCondition(std::move(loopCondition)), m_nodes(std::move(nodes))
 {
 }
 
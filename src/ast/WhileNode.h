@@ -14,6 +14,7 @@ private:
 public:
     WhileNode(const Token &token, std::shared_ptr<ASTNode> loopCondition, std::vector<std::shared_ptr<ASTNode>> nodes);
     ~WhileNode() override = default;
+    static bool classof(const ASTNode *node) { return node->kind() == NodeKind::While; }
     void print() override;
     llvm::Value *codegen(std::unique_ptr<Context> &context) override;
     void typeCheck(const std::unique_ptr<UnitNode> &unit, ASTNode *parentNode) override;
@@ -6,34 +6,19 @@
 
 #include <llvm/IR/IRBuilder.h>
 
+#include "TypeContext.h"
 #include "compiler/Context.h"
 #include "exceptions/CompilerException.h"
 
 std::shared_ptr<ArrayType> ArrayType::getFixedArray(size_t low, size_t heigh,
                                                     const std::shared_ptr<VariableType> &baseType)
 {
-    auto type = std::make_shared<ArrayType>();
-    type->typeName = "array_" + baseType->typeName + "_" + std::to_string(low) + "_" + std::to_string(heigh);
-    type->baseType = VariableBaseType::Array;
-    type->low = low;
-    type->high = heigh;
-    type->arrayBase = baseType;
-    type->isDynArray = false;
-    type->llvmType = nullptr;
-    return type;
+    return TypeContext::instance().fixedArray(low, heigh, baseType);
 }
 
 std::shared_ptr<ArrayType> ArrayType::getDynArray(const std::shared_ptr<VariableType> &baseType)
 {
-    auto type = std::make_shared<ArrayType>();
-    type->baseType = VariableBaseType::Array;
-    type->typeName = "dynarray_" + baseType->typeName;
-    type->low = 0;
-    type->high = 0;
-    type->arrayBase = baseType;
-    type->isDynArray = true;
-    type->llvmType = nullptr;
-    return type;
+    return TypeContext::instance().dynArray(baseType);
 }
 
 
@@ -45,32 +30,30 @@ llvm::Type *IntegerType::generateLlvmType(std::unique_ptr<Context> &context)
 
 llvm::Type *ArrayType::generateLlvmType(std::unique_ptr<Context> &context)
 {
-    if (llvmType == nullptr)
+    // the llvm type belongs to the llvm context of the compilation, so it is cached by the context instead of being
+    // stored in the type which is shared between compilations
+    if (const auto cachedType = context->cachedLlvmType(this))
+        return cachedType;
+    if (isDynArray)
     {
+        if (const auto cachedType = llvm::StructType::getTypeByName(*context->context(), typeName))
+            return context->cacheLlvmType(this, cachedType);
         auto arrayBaseType = arrayBase->generateLlvmType(context);
-        if (isDynArray)
-        {
+        std::vector<llvm::Type *> types;
+        types.emplace_back(VariableType::getInteger(64)->generateLlvmType(context));
 
-            std::vector<llvm::Type *> types;
-            types.emplace_back(VariableType::getInteger(64)->generateLlvmType(context));
+        types.emplace_back(llvm::PointerType::getUnqual(arrayBaseType));
 
-            types.emplace_back(llvm::PointerType::getUnqual(arrayBaseType));
 
+        llvm::ArrayRef<llvm::Type *> Elements(types);
 
-            llvm::ArrayRef<llvm::Type *> Elements(types);
 
+        return context->cacheLlvmType(this, llvm::StructType::create(*context->context(), Elements, typeName));
+    }
 
-            llvmType = llvm::StructType::create(*context->context(), Elements, arrayBase->typeName);
-        }
-        else
-        {
-
-            const auto arraySize = high - low + 1;
+    const auto arraySize = high - low + 1;
 
-            return llvm::ArrayType::get(arrayBaseType, arraySize);
-        }
-    }
-    return llvmType;
+    return context->cacheLlvmType(this, llvm::ArrayType::get(arrayBase->generateLlvmType(context), arraySize));
 }
 
 llvm::Value *ArrayType::generateFieldAccess(Token &token, llvm::Value *indexValue, std::unique_ptr<Context> &context)
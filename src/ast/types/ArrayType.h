@@ -6,9 +6,6 @@
 
 class ArrayType final : public VariableType, public FieldAccessableType, public RangeType
 {
-private:
-    llvm::Type *llvmType = nullptr;
-
 public:
     size_t low;
     size_t high;
@@ -24,6 +24,7 @@ public:
 
     [[nodiscard]] static std::shared_ptr<EnumType> getEnum(const std::string &name = "");
     [[nodiscard]] bool hasEnumKey(const std::string &name) const;
+    [[nodiscard]] const std::map<std::string, int64_t> &values() const { return enumNamesWithValues; }
 
     llvm::Type *generateLlvmType(std::unique_ptr<Context> &context) override;
 
@@ -5,6 +5,7 @@
 #include <llvm/IR/Module.h>
 #include <vector>
 
+#include "TypeContext.h"
 #include "compiler/Context.h"
 
 FileType::FileType(const std::string &typeName, std::optional<std::shared_ptr<VariableType>> childType) :
@@ -13,7 +14,8 @@ FileType::FileType(const std::string &typeName, std::optional<std::shared_ptr<Va
 }
 llvm::Type *FileType::generateLlvmType(std::unique_ptr<Context> &context)
 {
-
+    if (const auto cachedType = context->cachedLlvmType(this))
+        return cachedType;
     auto cache = llvm::StructType::getTypeByName(*context->context(), typeName);
     if (cache == nullptr)
     {
@@ -25,11 +27,11 @@ llvm::Type *FileType::generateLlvmType(std::unique_ptr<Context> &context)
         const llvm::ArrayRef<llvm::Type *> elements(types);
 
 
-        return llvm::StructType::create(*context->context(), elements, typeName);
+        return context->cacheLlvmType(this, llvm::StructType::create(*context->context(), elements, typeName));
     }
-    return cache;
+    return context->cacheLlvmType(this, cache);
 }
 std::shared_ptr<VariableType> FileType::getFileType(std::optional<std::shared_ptr<VariableType>> childType)
 {
-    return std::make_shared<FileType>("file", childType);
+    return TypeContext::instance().file(childType.value_or(nullptr));
 }
@@ -12,6 +12,7 @@ public:
     explicit FileType(const std::string &typeName,
                       std::optional<std::shared_ptr<VariableType>> childType = std::nullopt);
     llvm::Type *generateLlvmType(std::unique_ptr<Context> &context) override;
+    [[nodiscard]] const std::optional<std::shared_ptr<VariableType>> &childType() const { return m_childType; }
 
     static std::shared_ptr<VariableType>
     getFileType(std::optional<std::shared_ptr<VariableType>> childType = std::nullopt);
@@ -42,6 +42,8 @@ int RecordType::getFieldIndexByName(const std::string &name) const
 
 llvm::Type *RecordType::generateLlvmType(std::unique_ptr<Context> &context)
 {
+    if (const auto llvmType = context->cachedLlvmType(this))
+        return llvmType;
     auto cached_type = llvm::StructType::getTypeByName(*context->context(), typeName);
     if (cached_type == nullptr)
     {
@@ -54,9 +56,9 @@ llvm::Type *RecordType::generateLlvmType(std::unique_ptr<Context> &context)
         llvm::ArrayRef<llvm::Type *> Elements(types);
 
 
-        return llvm::StructType::create(*context->context(), Elements, typeName);
+        return context->cacheLlvmType(this, llvm::StructType::create(*context->context(), Elements, typeName));
     }
-    return cached_type;
+    return context->cacheLlvmType(this, cached_type);
 }
 
 size_t RecordType::size() const { return m_fields.size(); }
@@ -8,7 +8,8 @@
 
 llvm::Type *StringType::generateLlvmType(std::unique_ptr<Context> &context)
 {
-
+    if (const auto cachedType = context->cachedLlvmType(this))
+        return cachedType;
     const auto llvmType = llvm::StructType::getTypeByName(*context->context(), "string");
 
 
@@ -25,9 +26,9 @@ llvm::Type *StringType::generateLlvmType(std::unique_ptr<Context> &context)
         llvm::ArrayRef<llvm::Type *> Elements(types);
 
 
-        return llvm::StructType::create(*context->context(), Elements, "string");
+        return context->cacheLlvmType(this, llvm::StructType::create(*context->context(), Elements, "string"));
     }
-    return llvmType;
+    return context->cacheLlvmType(this, llvmType);
 }
 
 llvm::Value *StringType::generateFieldAccess(Token &token, llvm::Value *indexValue, std::unique_ptr<Context> &context)
@@ -57,9 +58,14 @@ llvm::Value *StringType::generateFieldAccess(Token &token, llvm::Value *indexVal
 
 std::shared_ptr<StringType> StringType::getString()
 {
-    static auto stringType = std::make_shared<StringType>();
-    stringType->baseType = VariableBaseType::String;
-    stringType->typeName = "string";
+    // the type is shared by all compilation jobs, so it is only initialized once
+    static const auto stringType = []
+    {
+        auto type = std::make_shared<StringType>();
+        type->baseType = VariableBaseType::String;
+        type->typeName = "string";
+        return type;
+    }();
     return stringType;
 }
 llvm::Value *StringType::generateLengthValue(const Token &token, std::unique_ptr<Context> &context)
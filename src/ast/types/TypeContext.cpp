@@ -0,0 +1,125 @@
+#include "TypeContext.h"
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+
+#include "ArrayType.h"
+#include "FileType.h"
+
+TypeContext &TypeContext::instance()
+{
+    static TypeContext typeContext;
+    return typeContext;
+}
+
+size_t TypeContext::DerivedKeyHash::operator()(const DerivedKey &key) const
+{
+    size_t hash = std::hash<const VariableType *>{}(key.base);
+    hash = hash * 31 + static_cast<size_t>(key.kind);
+    hash = hash * 31 + key.low;
+    return hash * 31 + key.high;
+}
+
+std::shared_ptr<IntegerType> TypeContext::integer(const size_t length)
+{
+    {
+        std::shared_lock lock(m_mutex);
+        if (const auto it = m_integers.find(length); it != m_integers.end())
+            return it->second;
+    }
+    std::unique_lock lock(m_mutex);
+    auto &integer = m_integers[length];
+    if (!integer)
+    {
+        integer = std::make_shared<IntegerType>();
+        integer->baseType = VariableBaseType::Integer;
+        integer->length = length;
+        integer->typeName = "integer" + std::to_string(length);
+    }
+    return integer;
+}
+
+template<typename T, typename Create>
+std::shared_ptr<T> TypeContext::derived(const DerivedKey &key, Create create)
+{
+    {
+        std::shared_lock lock(m_mutex);
+        if (const auto it = m_derived.find(key); it != m_derived.end())
+        {
+            if (auto type = it->second.lock())
+                return std::static_pointer_cast<T>(type);
+        }
+    }
+    std::unique_lock lock(m_mutex);
+    // another thread might have created the type in the meantime, an expired entry is replaced. The base of an expired
+    // type can not be alive anymore, so the address in the key might belong to a new type.
+    auto &entry = m_derived[key];
+    if (auto type = entry.lock())
+        return std::static_pointer_cast<T>(type);
+    std::shared_ptr<T> type = create();
+    entry = type;
+    if (m_derived.size() >= 2 * m_sweepSize)
+    {
+        std::erase_if(m_derived, [](const auto &derived) { return derived.second.expired(); });
+        m_sweepSize = std::max(m_sweepSize, m_derived.size());
+    }
+    return type;
+}
+
+std::shared_ptr<PointerType> TypeContext::pointerTo(const std::shared_ptr<VariableType> &baseType)
+{
+    return derived<PointerType>(DerivedKey{.kind = DerivedKind::Pointer, .base = baseType.get(), .low = 0, .high = 0},
+                                [&baseType]
+                                {
+                                    auto type = std::make_shared<PointerType>();
+                                    type->pointerBase = baseType;
+                                    type->baseType = VariableBaseType::Pointer;
+                                    type->typeName = baseType ? baseType->typeName + "_ptr" : "pointer";
+                                    return type;
+                                });
+}
+
+std::shared_ptr<ArrayType> TypeContext::fixedArray(const size_t low, const size_t high,
+                                                   const std::shared_ptr<VariableType> &baseType)
+{
+    return derived<ArrayType>(
+            DerivedKey{.kind = DerivedKind::FixedArray, .base = baseType.get(), .low = low, .high = high},
+            [&]
+            {
+                auto type = std::make_shared<ArrayType>();
+                type->typeName = "array_" + baseType->typeName + "_" + std::to_string(low) + "_" + std::to_string(high);
+                type->baseType = VariableBaseType::Array;
+                type->low = low;
+                type->high = high;
+                type->arrayBase = baseType;
+                type->isDynArray = false;
+                return type;
+            });
+}
+
+std::shared_ptr<ArrayType> TypeContext::dynArray(const std::shared_ptr<VariableType> &baseType)
+{
+    return derived<ArrayType>(DerivedKey{.kind = DerivedKind::DynArray, .base = baseType.get(), .low = 0, .high = 0},
+                              [&baseType]
+                              {
+                                  auto type = std::make_shared<ArrayType>();
+                                  type->baseType = VariableBaseType::Array;
+                                  type->typeName = "dynarray_" + baseType->typeName;
+                                  type->low = 0;
+                                  type->high = 0;
+                                  type->arrayBase = baseType;
+                                  type->isDynArray = true;
+                                  return type;
+                              });
+}
+
+std::shared_ptr<FileType> TypeContext::file(const std::shared_ptr<VariableType> &childType)
+{
+    return derived<FileType>(DerivedKey{.kind = DerivedKind::File, .base = childType.get(), .low = 0, .high = 0},
+                             [&childType]
+                             {
+                                 return std::make_shared<FileType>(
+                                         "file", childType ? std::optional(childType) : std::nullopt);
+                             });
+}
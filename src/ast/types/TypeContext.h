@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "VariableType.h"
+
+class ArrayType;
+class FileType;
+
+/// Hash-conses the structural types, so every integer width, pointer, array and file of a type exists only once and two
+/// of these types are the same if they are the same object. The types of the cached units are shared between the
+/// compilations, so the table is shared as well. The canonical integers are kept alive, the types which are derived
+/// from another type are only referenced weakly and disappear with the last program which uses them.
+class TypeContext
+{
+public:
+    static TypeContext &instance();
+
+    std::shared_ptr<IntegerType> integer(size_t length);
+    /// a pointer to the base type, an untyped pointer if the base type is nullptr
+    std::shared_ptr<PointerType> pointerTo(const std::shared_ptr<VariableType> &baseType);
+    std::shared_ptr<ArrayType> fixedArray(size_t low, size_t high, const std::shared_ptr<VariableType> &baseType);
+    std::shared_ptr<ArrayType> dynArray(const std::shared_ptr<VariableType> &baseType);
+    std::shared_ptr<FileType> file(const std::shared_ptr<VariableType> &childType);
+
+private:
+    enum class DerivedKind : uint8_t
+    {
+        Pointer,
+        FixedArray,
+        DynArray,
+        File
+    };
+    struct DerivedKey
+    {
+        DerivedKind kind;
+        const VariableType *base;
+        size_t low;
+        size_t high;
+
+        bool operator==(const DerivedKey &) const = default;
+    };
+    struct DerivedKeyHash
+    {
+        size_t operator()(const DerivedKey &key) const;
+    };
+
+    TypeContext() = default;
+
+    /// returns the type of the key, create is only called if there is no living type for it
+    template<typename T, typename Create>
+    std::shared_ptr<T> derived(const DerivedKey &key, Create create);
+
+    mutable std::shared_mutex m_mutex;
+    std::unordered_map<size_t, std::shared_ptr<IntegerType>> m_integers;
+    std::unordered_map<DerivedKey, std::weak_ptr<VariableType>, DerivedKeyHash> m_derived;
+    /// expired entries are removed when the table has grown to twice this size
+    size_t m_sweepSize = 64;
+};
@@ -3,10 +3,42 @@
 //
 
 #include "TypeRegistry.h"
+
+#include <ranges>
+
+#include "EnumType.h"
+#include "compare.h"
+
 TypeRegistry::TypeRegistry() {}
 TypeRegistry::~TypeRegistry() {}
 void TypeRegistry::registerType(const std::string &name, const std::shared_ptr<VariableType> &type)
 {
-    m_types[name] = type;
+    auto &registered = m_types[to_lower(name)];
+    // the values of a replaced enum are not known anymore
+    if (const auto replacedEnum = std::dynamic_pointer_cast<EnumType>(registered))
+    {
+        for (const auto &valueName: replacedEnum->values() | std::views::keys)
+        {
+            if (const auto it = m_enumValues.find(valueName); it != m_enumValues.end() && it->second == replacedEnum)
+                m_enumValues.erase(it);
+        }
+    }
+    registered = type;
+    if (const auto enumType = std::dynamic_pointer_cast<EnumType>(type))
+    {
+        for (const auto &valueName: enumType->values() | std::views::keys)
+            m_enumValues[valueName] = enumType;
+    }
+}
+std::shared_ptr<VariableType> TypeRegistry::getType(const std::string &name) const { return m_types.at(to_lower(name)); }
+bool TypeRegistry::hasType(const std::string &name) const { return m_types.contains(to_lower(name)); }
+std::shared_ptr<VariableType> TypeRegistry::findType(const std::string &name) const
+{
+    const auto it = m_types.find(to_lower(name));
+    return it != m_types.end() ? it->second : nullptr;
+}
+std::shared_ptr<EnumType> TypeRegistry::findEnumByValue(const std::string &valueName) const
+{
+    const auto it = m_enumValues.find(valueName);
+    return it != m_enumValues.end() ? it->second : nullptr;
 }
-std::shared_ptr<VariableType> TypeRegistry::getType(const std::string &name) const { return m_types.at(name); }
@@ -10,12 +10,18 @@
 
 #include "VariableType.h"
 
+class EnumType;
+
+/// The named types of a unit. The names of the types are case insensitive, they are stored in lower case, so every
+/// lookup is a hash lookup. The values of the registered enums are indexed as well.
 class TypeRegistry
 {
     using value_type = std::pair<const std::string, const std::shared_ptr<VariableType>>;
 
 private:
     std::unordered_map<std::string, std::shared_ptr<VariableType>> m_types;
+    /// the enum which declares a value, the values are case sensitive
+    std::unordered_map<std::string, std::shared_ptr<EnumType>> m_enumValues;
 
 public:
     using Iterator = std::unordered_map<std::string, std::shared_ptr<VariableType>>::iterator;
@@ -26,7 +32,11 @@ public:
     ~TypeRegistry();
     void registerType(const std::string &name, const std::shared_ptr<VariableType> &type);
     std::shared_ptr<VariableType> getType(const std::string &name) const;
-    bool hasType(const std::string &name) const { return m_types.contains(name); }
+    bool hasType(const std::string &name) const;
+    /// returns the type with the name or nullptr if there is none
+    [[nodiscard]] std::shared_ptr<VariableType> findType(const std::string &name) const;
+    /// returns the registered enum which has a value with the name or nullptr if there is none
+    [[nodiscard]] std::shared_ptr<EnumType> findEnumByValue(const std::string &valueName) const;
 
 
     Iterator begin() noexcept { return m_types.begin(); }
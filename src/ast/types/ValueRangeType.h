@@ -14,6 +14,8 @@ public:
 
     llvm::Type *generateLlvmType(std::unique_ptr<Context> &context) override;
     [[nodiscard]] size_t length() const;
+    [[nodiscard]] int64_t startValue() const { return m_startValue; }
+    [[nodiscard]] int64_t endValue() const { return m_endValue; }
     [[nodiscard]] llvm::Value *generateLowerBounds(const Token &token, std::unique_ptr<Context> &context) override;
     [[nodiscard]] llvm::Value *generateUpperBounds(const Token &token, std::unique_ptr<Context> &context) override;
     llvm::Value *generateFieldAccess(Token &token, llvm::Value *indexValue, std::unique_ptr<Context> &context) override;
@@ -2,6 +2,7 @@
 #include <cassert>
 #include <llvm/IR/IRBuilder.h>
 
+#include "TypeContext.h"
 #include "compiler/Context.h"
 #include "exceptions/CompilerException.h"
 
@@ -65,47 +66,35 @@ llvm::Type *VariableType::generateLlvmType(std::unique_ptr<Context> &context)
 
 std::shared_ptr<IntegerType> VariableType::getInteger(const size_t length)
 {
-    auto integer = std::make_shared<IntegerType>();
-    integer->baseType = VariableBaseType::Integer;
-    integer->length = length;
-    integer->typeName = "integer" + std::to_string(length);
-    return integer;
+    return TypeContext::instance().integer(length);
 }
+
 std::shared_ptr<VariableType> VariableType::getCharacter()
 {
-    auto charType = std::make_shared<VariableType>();
-    charType->baseType = VariableBaseType::Character;
-    charType->typeName = "char";
+    // the plain types are shared by all compilation jobs, so each of them is only created once
+    static const auto charType = std::make_shared<VariableType>(VariableBaseType::Character, "char");
     return charType;
 }
 std::shared_ptr<VariableType> VariableType::getSingle()
 {
-    auto floatType = std::make_shared<VariableType>();
-    floatType->baseType = VariableBaseType::Float;
-    floatType->typeName = "single";
+    static const auto floatType = std::make_shared<VariableType>(VariableBaseType::Float, "single");
     return floatType;
 }
 std::shared_ptr<VariableType> VariableType::getDouble()
 {
-    auto doubleType = std::make_shared<VariableType>();
-    doubleType->baseType = VariableBaseType::Double;
-    doubleType->typeName = "double";
+    static const auto doubleType = std::make_shared<VariableType>(VariableBaseType::Double, "double");
     return doubleType;
 }
 
 std::shared_ptr<VariableType> VariableType::getBoolean()
 {
-    auto boolean = std::make_shared<VariableType>();
-    boolean->baseType = VariableBaseType::Boolean;
-    boolean->typeName = "boolean";
+    static const auto boolean = std::make_shared<VariableType>(VariableBaseType::Boolean, "boolean");
     return boolean;
 }
 
 std::shared_ptr<VariableType> VariableType::getPointer()
 {
-    auto pointer = std::make_shared<VariableType>();
-    pointer->baseType = VariableBaseType::Pointer;
-    pointer->typeName = "pointer";
+    static const auto pointer = std::make_shared<VariableType>(VariableBaseType::Pointer, "pointer");
     return pointer;
 }
 bool VariableType::operator==(const VariableType &other) const { return this->baseType == other.baseType; }
@@ -117,21 +106,9 @@ llvm::Value *FieldAccessableType::getLowValue(std::unique_ptr<Context> &context)
 
 std::shared_ptr<PointerType> PointerType::getPointerTo(const std::shared_ptr<VariableType> &baseType)
 {
-    auto ptrType = std::make_shared<PointerType>();
-
-    ptrType->pointerBase = baseType;
-    ptrType->baseType = VariableBaseType::Pointer;
-    ptrType->typeName = baseType->typeName + "_ptr";
-    return ptrType;
-}
-std::shared_ptr<PointerType> PointerType::getUnqual()
-{
-    auto ptrType = std::make_shared<PointerType>();
-    ptrType->pointerBase = nullptr;
-    ptrType->baseType = VariableBaseType::Pointer;
-    ptrType->typeName = "pointer";
-    return ptrType;
+    return TypeContext::instance().pointerTo(baseType);
 }
+std::shared_ptr<PointerType> PointerType::getUnqual() { return TypeContext::instance().pointerTo(nullptr); }
 llvm::Type *PointerType::generateLlvmType(std::unique_ptr<Context> &context)
 {
     if (pointerBase)
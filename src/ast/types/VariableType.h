@@ -33,7 +33,7 @@ class Context;
 class IntegerType;
 
 
-class VariableType
+class VariableType : public std::enable_shared_from_this<VariableType>
 {
 public:
     explicit VariableType(VariableBaseType baseType = VariableBaseType::Unknown, const std::string &typeName = "");
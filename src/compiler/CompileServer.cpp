@@ -0,0 +1,268 @@
+#include "compiler/CompileServer.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <mutex>
+#include <streambuf>
+#include <vector>
+
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include "config.h"
+#include "os/socket.h"
+
+// Every message is a json object prefixed by its length as a 32 bit little endian integer. The client sends
+// {"version", "cwd", "argv"} or {"shutdown"}, the server answers with any number of {"stream", "data"} messages
+// followed by {"exit"}. A server of another compiler version answers with {"rejected"} instead.
+
+static constexpr uint32_t maxMessageSize = 64 * 1024 * 1024;
+/// the time a client has to send its request after it connected
+static constexpr std::chrono::seconds requestTimeout(30);
+
+static std::string compiler_version()
+{
+    return std::to_string(WIRTHX_VERSION_MAJOR) + "." + std::to_string(WIRTHX_VERSION_MINOR) + "." +
+           std::to_string(WIRTHX_VERSION_PATCH);
+}
+
+static bool send_message(LocalSocket &socket, const llvm::json::Value &message)
+{
+    std::string data;
+    llvm::raw_string_ostream stream(data);
+    stream << message;
+    stream.flush();
+    std::array<char, sizeof(uint32_t)> header{};
+    llvm::support::endian::write32le(header.data(), static_cast<uint32_t>(data.size()));
+    return socket.write(std::string_view(header.data(), header.size())) && socket.write(data);
+}
+
+static std::optional<llvm::json::Object> receive_message(LocalSocket &socket)
+{
+    std::array<char, sizeof(uint32_t)> header{};
+    if (!socket.read(header.data(), header.size()))
+        return std::nullopt;
+    const auto size = llvm::support::endian::read32le(header.data());
+    if (size > maxMessageSize)
+        return std::nullopt;
+    std::string data(size, '\0');
+    if (!socket.read(data.data(), data.size()))
+        return std::nullopt;
+    auto message = llvm::json::parse(data);
+    if (!message)
+    {
+        llvm::consumeError(message.takeError());
+        return std::nullopt;
+    }
+    if (auto *object = message->getAsObject())
+        return std::move(*object);
+    return std::nullopt;
+}
+
+/// sends everything which is written into the stream as "stream" messages to the client
+class SocketStreamBuffer : public std::streambuf
+{
+private:
+    LocalSocket &m_socket;
+    std::string m_name;
+    std::array<char, 4096> m_buffer{};
+    bool m_connected = true;
+
+    bool sendBuffer()
+    {
+        if (pbase() != pptr() && m_connected)
+        {
+            const std::string data(pbase(), pptr());
+            m_connected = send_message(m_socket, llvm::json::Object{{"stream", m_name}, {"data", data}});
+        }
+        setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+        return m_connected;
+    }
+
+public:
+    SocketStreamBuffer(LocalSocket &socket, std::string name) : m_socket(socket), m_name(std::move(name))
+    {
+        setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+    }
+
+protected:
+    int_type overflow(const int_type ch) override
+    {
+        if (!sendBuffer())
+            return traits_type::eof();
+        if (!traits_type::eq_int_type(ch, traits_type::eof()))
+            sputc(traits_type::to_char_type(ch));
+        return traits_type::not_eof(ch);
+    }
+
+    int sync() override { return sendBuffer() ? 0 : -1; }
+};
+
+static int handle_compile_request(LocalSocket &connection, const llvm::json::Object &request,
+                                  const CompileRequestHandler &handler)
+{
+    std::vector<std::string> arguments;
+    if (const auto *argv = request.getArray("argv"))
+    {
+        for (const auto &argument: *argv)
+        {
+            if (const auto value = argument.getAsString())
+                arguments.emplace_back(value->str());
+        }
+    }
+    SocketStreamBuffer outputBuffer(connection, "out");
+    SocketStreamBuffer errorBuffer(connection, "err");
+    std::ostream outputStream(&outputBuffer);
+    std::ostream errorStream(&errorBuffer);
+
+    const auto workingDirectory = request.getString("cwd");
+    if (arguments.empty() || !workingDirectory)
+    {
+        errorStream << "invalid compile request\n";
+        errorStream.flush();
+        return 1;
+    }
+    // the working directory is only passed to the handler, the process wide one is shared by all requests
+    const std::filesystem::path directory = workingDirectory->str();
+    if (!directory.is_absolute() || !std::filesystem::is_directory(directory))
+    {
+        errorStream << "the working directory " << directory.string() << " is not accessible\n";
+        errorStream.flush();
+        return 1;
+    }
+
+    int exitCode;
+    try
+    {
+        exitCode = handler(std::move(arguments), directory, outputStream, errorStream);
+    }
+    catch (const std::exception &e)
+    {
+        errorStream << e.what() << "\n";
+        exitCode = 1;
+    }
+    outputStream.flush();
+    errorStream.flush();
+    return exitCode;
+}
+
+/// the shutdown is received on the thread of its connection, the accept loop answers it once all requests are done
+struct ShutdownRequest
+{
+    std::atomic<bool> requested = false;
+    std::mutex mutex;
+    std::vector<LocalSocket> connections;
+};
+
+static void handle_connection(LocalSocket connection, const std::filesystem::path &socketPath,
+                              const CompileRequestHandler &handler, ShutdownRequest &shutdown)
+{
+    // a client which does not send its request keeps neither the other requests nor a shutdown waiting forever
+    connection.setReceiveTimeout(requestTimeout);
+    auto request = receive_message(connection);
+    if (!request)
+        return;
+    if (request->getBoolean("shutdown").value_or(false))
+    {
+        {
+            std::lock_guard lock(shutdown.mutex);
+            shutdown.connections.push_back(std::move(connection));
+        }
+        shutdown.requested = true;
+        // wakes the accept loop up, which waits for the next connection
+        LocalSocket::connect(socketPath);
+        return;
+    }
+    if (const auto version = request->getString("version"); !version || version->str() != compiler_version())
+    {
+        send_message(connection, llvm::json::Object{{"rejected", "the server runs version " + compiler_version()}});
+        return;
+    }
+    const auto exitCode = handle_compile_request(connection, *request, handler);
+    send_message(connection, llvm::json::Object{{"exit", exitCode}});
+}
+
+int run_compile_server(const std::filesystem::path &socketPath, const CompileRequestHandler &handler,
+                       std::ostream &logStream)
+{
+    std::string error;
+    auto server = LocalServerSocket::listen(socketPath, error);
+    if (!server)
+    {
+        logStream << "the compile server can not listen on " << socketPath.string() << ": " << error << "\n";
+        return 1;
+    }
+    logStream << "compile server listening on " << socketPath.string() << std::endl;
+
+    ShutdownRequest shutdown;
+    // the requests which are still compiled, a shutdown waits for them before the socket is removed
+    std::list<std::future<void>> requests;
+    while (auto connection = server->accept())
+    {
+        if (shutdown.requested)
+            break;
+        requests.remove_if([](const std::future<void> &request)
+                           { return request.wait_for(std::chrono::seconds(0)) == std::future_status::ready; });
+        requests.push_back(std::async(std::launch::async,
+                                      [connection = std::move(*connection), &socketPath, &handler, &shutdown]() mutable
+                                      { handle_connection(std::move(connection), socketPath, handler, shutdown); }));
+    }
+    // the futures of std::async wait for their requests when they are destroyed
+    requests.clear();
+    for (auto &connection: shutdown.connections)
+        send_message(connection, llvm::json::Object{{"exit", 0}});
+    return 0;
+}
+
+std::optional<int> forward_to_compile_server(const std::filesystem::path &socketPath,
+                                             const std::vector<std::string> &arguments, std::ostream &outputStream,
+                                             std::ostream &errorStream)
+{
+    auto connection = LocalSocket::connect(socketPath);
+    if (!connection)
+        return std::nullopt;
+
+    llvm::json::Array argv;
+    for (const auto &argument: arguments)
+        argv.emplace_back(argument);
+    llvm::json::Object request{{"version", compiler_version()},
+                               {"cwd", std::filesystem::current_path().string()},
+                               {"argv", std::move(argv)}};
+    if (!send_message(*connection, std::move(request)))
+        return std::nullopt;
+
+    bool answered = false;
+    while (auto message = receive_message(*connection))
+    {
+        if (message->get("rejected"))
+            return std::nullopt;
+        if (const auto exitCode = message->getInteger("exit"))
+            return static_cast<int>(*exitCode);
+        answered = true;
+        const auto stream = message->getString("stream");
+        const auto data = message->getString("data");
+        if (!stream || !data)
+            continue;
+        auto &targetStream = *stream == "err" ? errorStream : outputStream;
+        targetStream << data->str();
+        targetStream.flush();
+    }
+    // a server which went away before it started the compilation is treated as if none was running
+    if (!answered)
+        return std::nullopt;
+    errorStream << "the connection to the compile server was lost\n";
+    return 1;
+}
+
+bool stop_compile_server(const std::filesystem::path &socketPath)
+{
+    auto connection = LocalSocket::connect(socketPath);
+    if (!connection || !send_message(*connection, llvm::json::Object{{"shutdown", true}}))
+        return false;
+    return receive_message(*connection).has_value();
+}
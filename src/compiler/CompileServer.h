@@ -0,0 +1,30 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// compiles for the command line arguments (including the program name) and returns the exit code of the compiler,
+/// the relative paths of the arguments are resolved against the working directory
+using CompileRequestHandler =
+        std::function<int(std::vector<std::string> arguments, const std::filesystem::path &workingDirectory,
+                          std::ostream &outputStream, std::ostream &errorStream)>;
+
+/// Runs the compile server on the unix domain socket until a client stops it. Every connection is handled on its own
+/// thread, the handler gets the working directory of the client instead of the server changing its own one. The unit
+/// cache and the target machines of the compiler stay warm between the requests. The output of every request is
+/// streamed back to its client while it is compiled. A client which does not send its request within 30 seconds is
+/// dropped, a shutdown waits for the running requests.
+int run_compile_server(const std::filesystem::path &socketPath, const CompileRequestHandler &handler,
+                       std::ostream &logStream);
+
+/// forwards the compilation to a running compile server, returns nullopt if no server is available
+std::optional<int> forward_to_compile_server(const std::filesystem::path &socketPath,
+                                             const std::vector<std::string> &arguments, std::ostream &outputStream,
+                                             std::ostream &errorStream);
+
+/// asks a running compile server to shut down, returns false if no server is running
+bool stop_compile_server(const std::filesystem::path &socketPath);
@@ -1,33 +1,41 @@
 #include "compiler/Compiler.h"
 
-#include <MacroParser.h>
+#include <TokenStream.h>
 #include <filesystem>
 #include <fstream>
+#include <map>
 #include <sstream>
-#include "Lexer.h"
 #include "Parser.h"
 #include "ast/FunctionDefinitionNode.h"
 #include "ast/UnitNode.h"
 
 #include "compiler/Context.h"
+#include "compiler/TimeReport.h"
 #include "compiler/intrinsics.h"
 #include "linker/pascal_linker.h"
+#include "llvm/CodeGen/ParallelCG.h"
 #include "llvm/IR/PassManager.h"
 
 #include "llvm/IR/LegacyPassManager.h"
 
 #include "llvm/IR/Verifier.h"
 #include "llvm/LTO/LTO.h"
+#include "llvm/MC/MCSubtargetInfo.h"
 #include "llvm/MC/TargetRegistry.h"
 #include "llvm/Passes/StandardInstrumentations.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
 #include "llvm/TargetParser/Host.h"
-#include "llvm/Transforms/IPO/AlwaysInliner.h"
-#include "llvm/Transforms/InstCombine/InstCombine.h"
+#include "llvm/TargetParser/SubtargetFeature.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/xxhash.h"
+#include "config.h"
 #include "os/command.h"
 
 static auto TargetTriple = llvm::sys::getDefaultTargetTriple();
@@ -47,73 +55,112 @@ void init_compiler()
     InitializeNativeTargetAsmParser();
     InitializeNativeTargetAsmPrinter();
 }
-void compile_file(const CompilerOptions &options, const std::filesystem::path &inputPath, std::ostream &errorStream,
-                  std::ostream &outputStream)
-{
-    std::ifstream file;
-    std::istringstream is;
 
-    file.open(inputPath, std::ios::in);
-    if (!file.is_open())
+llvm::CodeGenOptLevel codegen_optimization_level(OptimizationLevel level)
+{
+    switch (level)
     {
-        return;
+        case OptimizationLevel::O0:
+            return llvm::CodeGenOptLevel::None;
+        case OptimizationLevel::O1:
+            return llvm::CodeGenOptLevel::Less;
+        case OptimizationLevel::O2:
+        case OptimizationLevel::Os:
+            return llvm::CodeGenOptLevel::Default;
+        case OptimizationLevel::O3:
+            return llvm::CodeGenOptLevel::Aggressive;
     }
-    file.seekg(0, std::ios::end);
-    std::streamsize size = file.tellg();
-    std::string buffer(size, ' ');
-    file.seekg(0);
-    file.read(&buffer[0], size);
-
-
-    using namespace llvm;
-    using namespace llvm::sys;
-
-
-    std::string Error;
-    auto Target = llvm::TargetRegistry::lookupTarget(TargetTriple, Error);
+    return llvm::CodeGenOptLevel::Default;
+}
 
-    // Print an error and exit if we couldn't find the requested target.
-    // This generally occurs if we've forgotten to initialise the
-    // TargetRegistry or we have a bogus target triple.
-    if (!Target)
+CompilerOptions resolve_target_options(const CompilerOptions &options)
+{
+    auto result = options;
+    if (result.targetCPU != "native")
+        return result;
+
+    result.targetCPU = llvm::sys::getHostCPUName().str();
+    llvm::SubtargetFeatures features;
+    llvm::StringMap<bool> hostFeatures;
+    if (llvm::sys::getHostCPUFeatures(hostFeatures))
     {
-        errs() << Error;
-        return;
+        for (const auto &feature: hostFeatures)
+        {
+            features.AddFeature(feature.first(), feature.second);
+        }
     }
+    for (const auto &feature: llvm::SubtargetFeatures(options.targetFeatures).getFeatures())
+    {
+        features.AddFeature(feature);
+    }
+    result.targetFeatures = features.getString();
+    return result;
+}
 
-    auto CPU = "generic";
-    auto Features = "";
+bool check_target_cpu(const llvm::Target &target, const std::string &triple, const CompilerOptions &options,
+                      std::ostream &errorStream)
+{
+    if (options.targetCPU.empty() || options.targetCPU == "generic")
+        return true;
+    // the subtarget is created without a cpu, so LLVM does not warn about the unknown one itself
+    const std::unique_ptr<llvm::MCSubtargetInfo> subtarget(target.createMCSubtargetInfo(triple, "", ""));
+    if (subtarget && subtarget->isCPUStringValid(options.targetCPU))
+        return true;
+    errorStream << "the cpu " << options.targetCPU << " is not known for the target " << triple << "\n";
+    return false;
+}
+
+/// the predefined macros of the target followed by the definitions of the command line
+static MacroDefinitions macro_definitions(const CompilerOptions &options)
+{
+    using namespace llvm;
 
-    TargetOptions opt;
-    auto TheTargetMachine = Target->createTargetMachine(TargetTriple, CPU, Features, opt, Reloc::PIC_);
     Triple target(TargetTriple);
-    Lexer lexer;
-    MacroMap defines;
+    MacroDefinitions defines;
     switch (target.getOS())
     {
         case Triple::Darwin:
         case Triple::Linux:
         case Triple::OpenBSD:
         case Triple::FreeBSD:
-            defines["UNIX"] = true;
+            defines.define("UNIX");
             break;
         case Triple::Win32:
-            defines["WINDOWS"] = true;
+            defines.define("WINDOWS");
             break;
         default:
             break;
     }
-    defines.insert(std::make_pair(target.getArchName(), true));
+    defines.define(target.getArchName().str());
+    // the definitions of the command line come last, so they can override the predefined macros
+    for (const auto &[name, value]: options.macroDefinitions)
+        defines.define(name, value);
+    return defines;
+}
+
+std::unique_ptr<Context> create_program_module(const CompilerOptions &options, const std::filesystem::path &inputPath,
+                                               const llvm::DataLayout &dataLayout, std::ostream &errorStream)
+{
+    const auto sourceFile = SourceManager::instance().loadFile(inputPath);
+    if (!sourceFile)
+    {
+        return nullptr;
+    }
 
+    using namespace llvm;
 
-    auto tokens = lexer.tokenize(inputPath.string(), buffer);
-    MacroParser macroParser(defines);
-    Parser parser(options.rtlDirectories, inputPath, macroParser.macroDefinitions(), macroParser.parseFile(tokens));
+    Triple target(TargetTriple);
+    Parser parser(options.rtlDirectories, inputPath, macro_definitions(options), *sourceFile);
+    // the source is released together with the program, so a compile server does not keep every version of it
+    parser.adoptFile(*sourceFile);
+    // separately compiled units only need the declarations of their imports, the code is part of the unit objects
+    if (options.separateUnits)
+        parser.setUnitInterfaceDirectory(options.outputDirectory / "unitcache");
     auto unit = parser.parseFile();
     if (parser.hasError())
     {
         parser.printErrors(errorStream, options.colorOutput);
-        return;
+        return nullptr;
     }
     if (parser.hasMessages())
     {
@@ -124,7 +171,7 @@ void compile_file(const CompilerOptions &options, const std::filesystem::path &i
     auto int64Type = VariableType::getInteger(64);
     auto int8Type = VariableType::getInteger(8);
     auto pCharType = ::PointerType::getPointerTo(VariableType::getInteger(8));
-    context->module()->setDataLayout(TheTargetMachine->createDataLayout());
+    context->module()->setDataLayout(dataLayout);
 
     createSystemCall(context, "exit", {FunctionArgument{.type = intType, .argumentName = "X", .isReference = false}});
     createSystemCall(context, "fflush",
@@ -179,54 +226,259 @@ void compile_file(const CompilerOptions &options, const std::filesystem::path &i
 
     try
     {
-        context->programUnit()->typeCheck(context->programUnit(), nullptr);
+        {
+            TimeReport::Phase phase("typecheck", inputPath.string());
+            context->programUnit()->typeCheck(context->programUnit(), nullptr);
+        }
+        TimeReport::Phase phase("codegen", inputPath.string());
         context->programUnit()->codegen(context);
+        TimeReport::countInstructions(*context->module());
     }
     catch (CompilerException &e)
     {
         errorStream << e.what();
-        return;
+        return nullptr;
+    }
+    return context;
+}
+
+static bool emit_object_file(llvm::TargetMachine *targetMachine, llvm::Module &module, llvm::raw_pwrite_stream &stream)
+{
+    llvm::legacy::PassManager pass;
+    if (targetMachine->addPassesToEmitFile(pass, stream, nullptr, llvm::CodeGenFileType::ObjectFile))
+    {
+        llvm::errs() << "TheTargetMachine can't emit a file of this type";
+        return false;
+    }
+
+    pass.run(module);
+    return true;
+}
+
+/// every compilation writes its messages into its own output stream, a batch job or a request of the compile server
+/// never writes into the output of another one
+static void print_written_file(const CompilerOptions &options, std::ostream &outputStream, const std::string &fileName)
+{
+    if (options.listWrittenFiles)
+        outputStream << "Wrote " << fileName << "\n";
+}
+
+/// the key covers everything which influences the object file of a unit: the source of the unit, of its included files
+/// and of all units it imports, the macro definitions, the target and the code generation options
+static std::string unit_cache_key(const CompilerOptions &options, const std::filesystem::path &unitPath)
+{
+    const auto definitions = macro_definitions(options);
+    std::string content;
+    // the hashes of the parsed sources cover the files included with {$I} as well, a unit which was not imported in
+    // this process is hashed by its own source
+    const auto sources = Parser::unitSources(unitPath, definitions);
+    for (const auto &[path, hash]: sources)
+    {
+        content += path.filename().string();
+        content.push_back('\0');
+        content += llvm::utohexstr(hash, true);
+        content.push_back('\0');
+    }
+    if (sources.empty())
+    {
+        content += unitPath.filename().string();
+        content.push_back('\0');
+        if (auto buffer = llvm::MemoryBuffer::getFile(unitPath.string()))
+            content += (*buffer)->getBuffer();
+        content.push_back('\0');
+    }
+
+    content += std::to_string(WIRTHX_VERSION_MAJOR) + "." + std::to_string(WIRTHX_VERSION_MINOR) + "." +
+               std::to_string(WIRTHX_VERSION_PATCH);
+    content += TargetTriple + ";" + options.targetCPU + ";" + options.targetFeatures + ";";
+    content += llvm::utohexstr(definitions.hash(), true) + ";";
+    content += std::to_string(static_cast<int>(options.buildMode)) + ";" +
+               std::to_string(static_cast<int>(effectiveOptimizationLevel(options)));
+
+    return llvm::utohexstr(llvm::xxh3_64bits(llvm::arrayRefFromStringRef(content)), true);
+}
+
+/// compiles the unit into its own object file in the unit cache of the output directory, unchanged units reuse the
+/// object file of an earlier build
+static std::optional<std::filesystem::path> compile_unit(const CompilerOptions &options,
+                                                         const std::filesystem::path &unitPath,
+                                                         llvm::TargetMachine *targetMachine,
+                                                         OptimizationLevel optimizationLevel, std::ostream &errorStream,
+                                                         std::ostream &outputStream)
+{
+    TimeReport::Phase phase("compile unit", unitPath.string());
+    const auto cacheDirectory = options.outputDirectory / "unitcache";
+    std::error_code ec;
+    std::filesystem::create_directories(cacheDirectory, ec);
+    const auto objectFile = cacheDirectory / (unitPath.stem().string() + "-" + unit_cache_key(options, unitPath) + ".o");
+    if (std::filesystem::exists(objectFile))
+    {
+        return objectFile;
+    }
+
+    auto context = create_program_module(options, unitPath, targetMachine->createDataLayout(), errorStream);
+    if (!context)
+    {
+        return std::nullopt;
+    }
+    context->optimize(targetMachine, optimizationLevel);
+
+    // the object is written into a temporary file first, so that an interrupted build never leaves a broken object
+    // in the cache
+    auto temporaryFile = llvm::sys::fs::TempFile::create((cacheDirectory / "%%%%%%%%.o.tmp").string());
+    if (!temporaryFile)
+    {
+        errorStream << llvm::toString(temporaryFile.takeError()) << "\n";
+        return std::nullopt;
+    }
+    bool written;
+    {
+        llvm::raw_fd_ostream stream(temporaryFile->FD, false);
+        TimeReport::Phase emitPhase("emit object", objectFile.string());
+        written = emit_object_file(targetMachine, *context->module(), stream);
+    }
+    if (auto error = written ? temporaryFile->keep(objectFile.string()) : temporaryFile->discard())
+    {
+        errorStream << llvm::toString(std::move(error)) << "\n";
+        return std::nullopt;
+    }
+    if (!written)
+    {
+        return std::nullopt;
+    }
+    print_written_file(options, outputStream, objectFile.string());
+    return objectFile;
+}
+
+/// target machines are expensive to create, so a long running compile server reuses them for all of its compilations
+static llvm::TargetMachine *cached_target_machine(const llvm::Target &target, const CompilerOptions &targetOptions)
+{
+    static thread_local std::map<std::pair<std::string, std::string>, std::unique_ptr<llvm::TargetMachine>>
+            targetMachines;
+    auto &targetMachine = targetMachines[{targetOptions.targetCPU, targetOptions.targetFeatures}];
+    if (!targetMachine)
+    {
+        targetMachine.reset(target.createTargetMachine(TargetTriple, targetOptions.targetCPU,
+                                                       targetOptions.targetFeatures, llvm::TargetOptions(),
+                                                       llvm::Reloc::PIC_));
+    }
+    // the previous compilation might have changed the optimization level of the code generator
+    targetMachine->setOptLevel(llvm::CodeGenOptLevel::Default);
+    return targetMachine.get();
+}
+
+static bool compile_program(const CompilerOptions &options, const std::filesystem::path &inputPath,
+                            std::ostream &errorStream, std::ostream &outputStream)
+{
+    using namespace llvm;
+    using namespace llvm::sys;
+
+
+    std::string Error;
+    auto Target = llvm::TargetRegistry::lookupTarget(TargetTriple, Error);
+
+    // Print an error and exit if we couldn't find the requested target.
+    // This generally occurs if we've forgotten to initialise the
+    // TargetRegistry or we have a bogus target triple.
+    if (!Target)
+    {
+        errs() << Error;
+        return false;
+    }
+
+    const auto targetOptions = resolve_target_options(options);
+    if (!check_target_cpu(*Target, TargetTriple, targetOptions, errorStream))
+    {
+        return false;
     }
 
+    TargetOptions opt;
+    auto TheTargetMachine = cached_target_machine(*Target, targetOptions);
+    Triple target(TargetTriple);
+
+    auto context = create_program_module(targetOptions, inputPath, TheTargetMachine->createDataLayout(), errorStream);
+    if (!context)
+    {
+        return false;
+    }
 
     auto basePath = context->options().outputDirectory;
 
 
-    auto objectFileName = basePath / (context->programUnit()->getUnitName() + ".o");
+    const auto unitName = context->programUnit()->getUnitName();
+    const unsigned codegenThreads = context->options().codegenThreads == 0
+                                            ? llvm::hardware_concurrency().compute_thread_count()
+                                            : context->options().codegenThreads;
     std::vector<std::string> objectFiles;
-    objectFiles.emplace_back(objectFileName.string());
+    std::vector<std::unique_ptr<raw_fd_ostream>> objectStreams;
     std::error_code EC;
-    raw_fd_ostream dest(objectFileName.string(), EC, sys::fs::OF_None);
+    for (unsigned i = 0; i < codegenThreads; ++i)
+    {
+        auto objectFileName = codegenThreads == 1 ? basePath / (unitName + ".o")
+                                                  : basePath / (unitName + "." + std::to_string(i) + ".o");
+        objectStreams.push_back(std::make_unique<raw_fd_ostream>(objectFileName.string(), EC, sys::fs::OF_None));
+        if (EC)
+        {
+            errs() << "Could not open file: " << EC.message();
+            return false;
+        }
+        objectFiles.emplace_back(objectFileName.string());
+    }
 
-    if (EC)
+    const auto optimizationLevel = effectiveOptimizationLevel(context->options());
+    context->optimize(TheTargetMachine, optimizationLevel);
+    if (context->options().emitLLVMIR)
     {
-        errs() << "Could not open file: " << EC.message();
-        return;
+        auto irFileName = basePath / (unitName + ".ll");
+        raw_fd_ostream irFile(irFileName.string(), EC, sys::fs::OF_Text);
+        if (EC)
+        {
+            errs() << "Could not open file: " << EC.message();
+            return false;
+        }
+        context->module()->print(irFile, nullptr);
     }
 
-    legacy::PassManager pass;
-    if (context->options().buildMode == BuildMode::Release)
+    TheTargetMachine->setOptLevel(codegen_optimization_level(optimizationLevel));
+    if (objectStreams.size() == 1)
     {
-        pass.add(llvm::createAlwaysInlinerLegacyPass());
-        pass.add(llvm::createInstructionCombiningPass());
-        TheTargetMachine->setOptLevel(CodeGenOptLevel::Aggressive);
+        TimeReport::Phase phase("emit object", objectFiles.front());
+        if (!emit_object_file(TheTargetMachine, *context->module(), *objectStreams.front()))
+        {
+            return false;
+        }
     }
     else
     {
-        TheTargetMachine->setOptLevel(CodeGenOptLevel::None);
+        TimeReport::Phase phase("emit object", std::to_string(codegenThreads) + " partitions");
+        // every partition of the module is generated on its own thread with its own target machine
+        std::vector<raw_pwrite_stream *> outputs;
+        for (const auto &stream: objectStreams)
+            outputs.push_back(stream.get());
+        splitCodeGen(*context->module(), outputs, {},
+                     [&]
+                     {
+                         return std::unique_ptr<TargetMachine>(Target->createTargetMachine(
+                                 TargetTriple, targetOptions.targetCPU, targetOptions.targetFeatures, opt,
+                                 Reloc::PIC_, std::nullopt, codegen_optimization_level(optimizationLevel)));
+                     });
     }
+    objectStreams.clear();
 
-
-    if (TheTargetMachine->addPassesToEmitFile(pass, dest, nullptr, CodeGenFileType::ObjectFile))
+    if (context->options().separateUnits)
     {
-        errs() << "TheTargetMachine can't emit a file of this type";
-        return;
+        for (const auto &unitPath: context->programUnit()->importedUnits())
+        {
+            auto unitObjectFile = compile_unit(targetOptions, unitPath, TheTargetMachine, optimizationLevel,
+                                               errorStream, outputStream);
+            if (!unitObjectFile)
+            {
+                return false;
+            }
+            objectFiles.emplace_back(unitObjectFile->string());
+        }
     }
 
-    pass.run(*context->module());
-    dest.flush();
-    dest.close();
-
 
     llvm::verifyModule(*context->module(), &llvm::errs());
     if (context->options().printLLVMIR)
@@ -234,7 +486,10 @@ void compile_file(const CompilerOptions &options, const std::filesystem::path &i
         context->module()->print(llvm::errs(), nullptr, false, false);
     }
 
-    outs() << "Wrote " << objectFileName.string() << "\n";
+    for (const auto &objectFile: objectFiles)
+    {
+        print_written_file(options, outputStream, objectFile);
+    }
 
     std::vector<std::string> flags;
     for (const auto &lib: context->programUnit()->collectLibsToLink())
@@ -257,17 +512,104 @@ void compile_file(const CompilerOptions &options, const std::filesystem::path &i
         flags.erase(std::ranges::find(flags, "-lc"));
     }
 
-    if (!pascal_link_modules(errorStream, basePath, executableName, flags, objectFiles))
     {
-        return;
+        TimeReport::Phase phase("link", executableName);
+        if (!pascal_link_modules(errorStream, basePath, executableName, flags, objectFiles,
+                                 context->options().linker))
+        {
+            return false;
+        }
     }
 
     if (context->options().runProgram)
     {
-
-        if (!execute_command(outputStream, errorStream, (basePath / executableName).string()))
+        TimeReport::Phase phase("run", executableName);
+        if (!execute_command_list(outputStream, errorStream, (basePath / executableName).string(), {},
+                                  context->options().workingDirectory))
         {
             errorStream << "program could not be executed!\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+void write_time_report(const TimeReport &report, const CompilerOptions &options, const std::filesystem::path &inputPath,
+                       std::ostream &errorStream, std::ostream &outputStream)
+{
+    if (options.timeReport != TimeReportFormat::Json)
+    {
+        report.print(errorStream, options.timeReport);
+        return;
+    }
+
+    const auto reportFile = options.outputDirectory / (inputPath.stem().string() + ".time-report.json");
+    std::ofstream stream(reportFile);
+    if (!stream)
+    {
+        errorStream << "could not write the time report " << reportFile.string() << "\n";
+        return;
+    }
+    report.print(stream, options.timeReport);
+    print_written_file(options, outputStream, reportFile.string());
+}
+
+bool compile_file(const CompilerOptions &options, const std::filesystem::path &inputPath, std::ostream &errorStream,
+                  std::ostream &outputStream)
+{
+    if (options.timeReport == TimeReportFormat::None)
+    {
+        return compile_program(options, inputPath, errorStream, outputStream);
+    }
+
+    TimeReport report;
+    bool compiled;
+    {
+        TimeReport::Phase phase("compile", inputPath.string());
+        compiled = compile_program(options, inputPath, errorStream, outputStream);
+    }
+    write_time_report(report, options, inputPath, errorStream, outputStream);
+    return compiled;
+}
+
+bool compile_files(const CompilerOptions &options, const std::vector<std::filesystem::path> &inputPaths,
+                   std::ostream &errorStream, std::ostream &outputStream)
+{
+    if (inputPaths.size() == 1)
+    {
+        return compile_file(options, inputPaths.front(), errorStream, outputStream);
+    }
+
+    struct JobOutput
+    {
+        std::stringstream errors;
+        std::stringstream output;
+        bool compiled = false;
+    };
+    std::vector<JobOutput> jobOutputs(inputPaths.size());
+    {
+        // a strategy with 0 threads uses all cores of the host
+        llvm::ThreadPool pool(llvm::hardware_concurrency(options.jobs));
+        for (size_t i = 0; i < inputPaths.size(); ++i)
+        {
+            pool.async(
+                    [&, i]
+                    {
+                        auto &jobOutput = jobOutputs[i];
+                        jobOutput.compiled =
+                                compile_file(options, inputPaths[i], jobOutput.errors, jobOutput.output);
+                    });
         }
+        pool.wait();
+    }
+
+    // the output of the jobs is not interleaved, it is written in the order of the input files
+    bool compiled = true;
+    for (auto &jobOutput: jobOutputs)
+    {
+        errorStream << jobOutput.errors.str();
+        outputStream << jobOutput.output.str();
+        compiled &= jobOutput.compiled;
     }
+    return compiled;
 }
@@ -1,10 +1,52 @@
-
 #pragma once
 #include <filesystem>
+#include <memory>
 #include <sstream>
+#include <vector>
 #include "compiler/CompilerOptions.h"
+#include "llvm/Support/CodeGen.h"
+
+namespace llvm
+{
+    class DataLayout;
+    class Target;
+}
+class Context;
+class TimeReport;
 
 void init_compiler();
 
-void compile_file(const CompilerOptions &options, const std::filesystem::path &inputPath, std::ostream &errorStream,
+/// maps the optimization level to the optimization level of the code generator
+llvm::CodeGenOptLevel codegen_optimization_level(OptimizationLevel level);
+
+/// replaces --cpu=native with the name and the feature set of the host cpu, explicitly requested features are
+/// applied on top of the detected ones
+CompilerOptions resolve_target_options(const CompilerOptions &options);
+
+/// returns false and writes an error to the error stream if the cpu of the resolved options is unknown to the target
+bool check_target_cpu(const llvm::Target &target, const std::string &triple, const CompilerOptions &options,
+                      std::ostream &errorStream);
+
+/// lexes, parses and type checks the program and generates its LLVM module. Errors are written to the error stream
+/// and result in a nullptr.
+std::unique_ptr<Context> create_program_module(const CompilerOptions &options, const std::filesystem::path &inputPath,
+                                               const llvm::DataLayout &dataLayout, std::ostream &errorStream);
+
+/// prints the time report to the error stream, a json report is written into the output directory instead and its
+/// file name is reported to the output stream
+void write_time_report(const TimeReport &report, const CompilerOptions &options, const std::filesystem::path &inputPath,
+                       std::ostream &errorStream, std::ostream &outputStream);
+
+/// compiles and links the program, the result is false if the compilation, the linking or the run failed
+bool compile_file(const CompilerOptions &options, const std::filesystem::path &inputPath, std::ostream &errorStream,
                   std::ostream &outputStream);
+
+/// compiles every input file as an independent job, options.jobs of them run in parallel. The output of every job
+/// is buffered and written in the order of the input files, the result is false if any of the jobs failed.
+bool compile_files(const CompilerOptions &options, const std::vector<std::filesystem::path> &inputPaths,
+                   std::ostream &errorStream, std::ostream &outputStream);
+
+/// compiles the program in memory with the ORC JIT and runs it inside of the compiler process. The output of the
+/// program is written to the output and error stream, the result is the exit code of the program.
+int jit_file(const CompilerOptions &options, const std::filesystem::path &inputPath, std::ostream &errorStream,
+             std::ostream &outputStream);
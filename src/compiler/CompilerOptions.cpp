@@ -1,6 +1,10 @@
 #include "CompilerOptions.h"
+#include <algorithm>
+#include <cstdlib>
 #include <filesystem>
 
+#include "os/socket.h"
+
 std::string shiftarg(std::vector<std::string> &args)
 {
     auto result = args.front();
@@ -10,11 +14,18 @@ std::string shiftarg(std::vector<std::string> &args)
 
 
 CompilerOptions parseCompilerOptions(std::vector<std::string> &argList)
+{
+    return parseCompilerOptions(argList, std::filesystem::current_path());
+}
+
+CompilerOptions parseCompilerOptions(std::vector<std::string> &argList, const std::filesystem::path &workingDirectory)
 {
     using namespace std::literals;
     CompilerOptions options;
-    options.outputDirectory = std::filesystem::current_path().string();
+    options.workingDirectory = workingDirectory;
+    options.outputDirectory = workingDirectory;
     options.compilerPath = shiftarg(argList);
+    options.serverSocket = default_local_socket_path("wirthx");
 
     while (!argList.empty())
     {
@@ -33,16 +44,20 @@ CompilerOptions parseCompilerOptions(std::vector<std::string> &argList)
         }
         else if (arg == "--output"sv)
         {
-            options.outputDirectory = shiftarg(argList);
+            options.outputDirectory = workingDirectory / shiftarg(argList);
         }
         else if (arg == "--rtl"sv)
         {
-            options.rtlDirectories.emplace(options.rtlDirectories.begin(), shiftarg(argList));
+            options.rtlDirectories.emplace(options.rtlDirectories.begin(), workingDirectory / shiftarg(argList));
         }
         else if (arg == "-c")
         {
             options.option = CompileOption::COMPILE;
         }
+        else if (arg == "--jit"sv)
+        {
+            options.option = CompileOption::JIT;
+        }
         else if (arg == "--release")
         {
             options.buildMode = BuildMode::Release;
@@ -55,6 +70,91 @@ CompilerOptions parseCompilerOptions(std::vector<std::string> &argList)
         {
             options.lsp = true;
         }
+        else if (arg == "--server"sv)
+        {
+            options.serverMode = CompileServerMode::Serve;
+        }
+        else if (arg == "--no-server"sv)
+        {
+            options.serverMode = CompileServerMode::Disabled;
+        }
+        else if (arg == "--stop-server"sv)
+        {
+            options.serverMode = CompileServerMode::Stop;
+        }
+        else if (arg.starts_with("--server-socket="))
+        {
+            options.serverSocket = workingDirectory / arg.substr(16);
+        }
+        else if (arg == "--emit-llvm"sv)
+        {
+            options.emitLLVMIR = true;
+        }
+        else if (arg == "--separate-units"sv)
+        {
+            options.separateUnits = true;
+        }
+        else if (arg == "--time-report"sv or arg == "--time-report=text"sv)
+        {
+            options.timeReport = TimeReportFormat::Text;
+        }
+        else if (arg == "--time-report=json"sv)
+        {
+            options.timeReport = TimeReportFormat::Json;
+        }
+        else if (arg.starts_with("--cpu="))
+        {
+            options.targetCPU = arg.substr(6);
+        }
+        else if (arg.starts_with("--codegen-threads="))
+        {
+            options.codegenThreads = static_cast<unsigned>(std::max(0, std::atoi(arg.substr(18).c_str())));
+        }
+        else if (arg == "-j"sv && !argList.empty())
+        {
+            options.jobs = static_cast<unsigned>(std::max(0, std::atoi(shiftarg(argList).c_str())));
+        }
+        else if (arg.starts_with("-j"))
+        {
+            options.jobs = static_cast<unsigned>(std::max(0, std::atoi(arg.substr(2).c_str())));
+        }
+        else if (arg.starts_with("-D"))
+        {
+            auto definition = arg.size() == 2 && !argList.empty() ? shiftarg(argList) : arg.substr(2);
+            const auto separator = definition.find('=');
+            if (separator == std::string::npos)
+                options.macroDefinitions.emplace_back(definition, "1");
+            else
+                options.macroDefinitions.emplace_back(definition.substr(0, separator), definition.substr(separator + 1));
+        }
+        else if (arg.starts_with("--linker="))
+        {
+            options.linker = arg.substr(9);
+        }
+        else if (arg.starts_with("--features="))
+        {
+            options.targetFeatures = arg.substr(11);
+        }
+        else if (arg == "-O0"sv)
+        {
+            options.optimizationLevel = OptimizationLevel::O0;
+        }
+        else if (arg == "-O1"sv)
+        {
+            options.optimizationLevel = OptimizationLevel::O1;
+        }
+        else if (arg == "-O2"sv)
+        {
+            options.optimizationLevel = OptimizationLevel::O2;
+        }
+        else if (arg == "-O3"sv)
+        {
+            options.optimizationLevel = OptimizationLevel::O3;
+        }
+        else if (arg == "-Os"sv)
+        {
+            options.optimizationLevel = OptimizationLevel::Os;
+        }
         else
         {
             argList.push_back(arg);
@@ -71,8 +171,15 @@ CompilerOptions parseCompilerOptions(std::vector<std::string> &argList)
     }
     else if (options.rtlDirectories.empty())
     {
-        options.rtlDirectories.push_back(std::filesystem::current_path() / "rtl");
+        options.rtlDirectories.push_back(workingDirectory / "rtl");
     }
 
     return options;
 }
+
+OptimizationLevel effectiveOptimizationLevel(const CompilerOptions &options)
+{
+    if (options.optimizationLevel.has_value())
+        return options.optimizationLevel.value();
+    return options.buildMode == BuildMode::Release ? OptimizationLevel::O2 : OptimizationLevel::O0;
+}
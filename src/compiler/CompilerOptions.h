@@ -1,7 +1,9 @@
 #pragma once
 
 #include <filesystem>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 enum class CompileOption
@@ -14,22 +16,82 @@ enum class BuildMode
     Debug,
     Release
 };
+enum class OptimizationLevel
+{
+    O0,
+    O1,
+    O2,
+    O3,
+    Os
+};
+
+enum class TimeReportFormat
+{
+    None,
+    Text,
+    Json
+};
+
+enum class CompileServerMode
+{
+    /// forwards the compilation to a running compile server, compiles in process if none is running
+    Auto,
+    /// always compiles in process
+    Disabled,
+    /// runs the compile server
+    Serve,
+    /// shuts a running compile server down
+    Stop
+};
 
 struct CompilerOptions
 {
     CompileOption option = CompileOption::COMPILE;
     BuildMode buildMode = BuildMode::Debug;
+    std::optional<OptimizationLevel> optimizationLevel;
+    /// cpu name passed to the target machine, "native" selects the cpu of the host
+    std::string targetCPU = "generic";
+    /// comma separated list of target features, e.g. "+avx2,-avx512f"
+    std::string targetFeatures;
+
+    /// number of threads which generate the object files in parallel, 0 uses all cores of the host
+    unsigned codegenThreads = 1;
+    /// number of input files which are compiled in parallel, 0 uses all cores of the host
+    unsigned jobs = 1;
+    /// "lld" links in process if available, every other value names the compiler driver used for linking
+    std::string linker = "lld";
 
+    /// directory against which the relative paths of the command line are resolved
+    std::filesystem::path workingDirectory;
     std::filesystem::path outputDirectory;
     std::vector<std::filesystem::path> rtlDirectories;
+    /// macros of the conditional compilation given with -DNAME or -DNAME=value, a macro without a value is 1
+    std::vector<std::pair<std::string, std::string>> macroDefinitions;
     std::string compilerPath;
     bool runProgram = false;
+    /// writes a "Wrote <file>" line into the output stream for every file the compiler writes
+    bool listWrittenFiles = false;
     bool printLLVMIR = false;
+    bool emitLLVMIR = false;
+    /// compiles every imported unit into its own cached object file
+    bool separateUnits = false;
+    /// reports the duration and memory usage of the compiler phases after the compilation
+    TimeReportFormat timeReport = TimeReportFormat::None;
     bool printAST = false;
     bool lsp = false;
+    CompileServerMode serverMode = CompileServerMode::Auto;
+    /// unix domain socket on which the compile server listens
+    std::filesystem::path serverSocket;
     bool colorOutput = true;
 };
 
 std::string shiftarg(std::vector<std::string> &args);
 
 CompilerOptions parseCompilerOptions(std::vector<std::string> &argList);
+
+/// parses the options as given in the working directory, every relative path of the options is resolved against it
+CompilerOptions parseCompilerOptions(std::vector<std::string> &argList, const std::filesystem::path &workingDirectory);
+
+/// returns the explicitly requested optimization level or the default of the build mode (-O0 for debug, -O2 for
+/// release builds)
+OptimizationLevel effectiveOptimizationLevel(const CompilerOptions &options);
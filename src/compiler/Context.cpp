@@ -6,22 +6,14 @@
 #include <llvm/IR/Verifier.h>
 #include <llvm/Passes/PassBuilder.h>
 #include <llvm/Passes/StandardInstrumentations.h>
-#include <llvm/Transforms/IPO/AlwaysInliner.h>
-#include <llvm/Transforms/IPO/GlobalDCE.h>
-#include <llvm/Transforms/IPO/PartialInlining.h>
-#include <llvm/Transforms/InstCombine/InstCombine.h>
-#include <llvm/Transforms/Scalar/DCE.h>
-#include <llvm/Transforms/Scalar/GVN.h>
-#include <llvm/Transforms/Scalar/MemCpyOptimizer.h>
-#include <llvm/Transforms/Scalar/Reassociate.h>
-#include <llvm/Transforms/Scalar/SCCP.h>
-#include <llvm/Transforms/Scalar/SimplifyCFG.h>
-#include <llvm/Transforms/Utils/LoopSimplify.h>
+#include <llvm/Target/TargetMachine.h>
 
+#include <unordered_set>
 #include <utility>
 
 #include "ast/UnitNode.h"
 #include "compare.h"
+#include "compiler/TimeReport.h"
 
 
 void LogError(const char *Str) { fprintf(stderr, "Error: %s\n", Str); }
@@ -47,12 +39,15 @@ struct ContextImpl
     std::unordered_map<std::string, llvm::Value *> NamedValues;
     llvm::Function *TopLevelFunction{};
     std::unordered_map<std::string, llvm::Function *> FunctionDefinitions;
+    std::unordered_set<std::string> ExternalFunctions;
+    /// the owner detects a type which was freed and whose address belongs to another type now
+    std::unordered_map<const VariableType *, std::pair<std::weak_ptr<const VariableType>, llvm::Type *>> LlvmTypes;
     BreakBasicBlock BreakBlock;
 
-    std::unique_ptr<llvm::FunctionPassManager> TheFPM;
+    std::unique_ptr<llvm::LoopAnalysisManager> TheLAM;
     std::unique_ptr<llvm::FunctionAnalysisManager> TheFAM;
+    std::unique_ptr<llvm::CGSCCAnalysisManager> TheCGAM;
     std::unique_ptr<llvm::ModuleAnalysisManager> TheMAM;
-    std::unique_ptr<llvm::ModulePassManager> TheMPM;
     std::unique_ptr<llvm::PassInstrumentationCallbacks> ThePIC;
     std::unique_ptr<llvm::StandardInstrumentations> TheSI;
 };
@@ -69,61 +64,42 @@ Context::Context(std::unique_ptr<UnitNode> &unit, CompilerOptions options, const
 
     // Create a new builder for the module.
     m_impl->Builder = std::make_unique<llvm::IRBuilder<>>(*m_impl->TheContext);
-    // Create new pass and analysis managers.
-    m_impl->TheFPM = std::make_unique<llvm::FunctionPassManager>();
-    m_impl->TheMPM = std::make_unique<llvm::ModulePassManager>();
+    // Create new analysis managers, the optimization pipeline itself is built in optimize().
+    m_impl->TheLAM = std::make_unique<llvm::LoopAnalysisManager>();
     m_impl->TheFAM = std::make_unique<llvm::FunctionAnalysisManager>();
+    m_impl->TheCGAM = std::make_unique<llvm::CGSCCAnalysisManager>();
     m_impl->TheMAM = std::make_unique<llvm::ModuleAnalysisManager>();
 
     m_impl->ThePIC = std::make_unique<llvm::PassInstrumentationCallbacks>();
     m_impl->TheSI = std::make_unique<llvm::StandardInstrumentations>(*m_impl->TheContext,
-                                                                     /*DebugLogging*/ true);
+                                                                     /*DebugLogging*/ false);
 
     m_impl->TheSI->registerCallbacks(*m_impl->ThePIC, m_impl->TheMAM.get());
-    this->TargetTriple = std::make_unique<llvm::Triple>(TargetTriple);
-
-    // Add transform passes.
-    // Do simple "peephole" optimizations and bit-twiddling optzns.
-    if (compilerOptions.buildMode == BuildMode::Release)
+    if (compilerOptions.timeReport != TimeReportFormat::None)
     {
-        m_impl->TheFPM->addPass(llvm::InstCombinePass());
-        // Reassociate expressions.
-        m_impl->TheFPM->addPass(llvm::ReassociatePass());
-        // Eliminate Common SubExpressions.
-        m_impl->TheFPM->addPass(llvm::GVNPass());
-        // Simplify the control flow graph (deleting unreachable blocks, etc).
-        m_impl->TheFPM->addPass(llvm::SimplifyCFGPass());
-
-        m_impl->TheFPM->addPass(llvm::SCCPPass());
-
-        m_impl->TheFPM->addPass(llvm::LoopSimplifyPass());
-
-        m_impl->TheFPM->addPass(llvm::MemCpyOptPass());
-
-        m_impl->TheFPM->addPass(llvm::DCEPass());
-        m_impl->TheMPM->addPass(llvm::AlwaysInlinerPass());
-
-
-        m_impl->TheMPM->addPass(llvm::PartialInlinerPass());
-        m_impl->TheMPM->addPass(llvm::ModuleInlinerPass());
-        m_impl->TheMPM->addPass(llvm::GlobalDCEPass());
-
-        // how do i remove unused functions?
-
-
-        m_impl->TheMPM->addPass(llvm::createModuleToFunctionPassAdaptor(
-                llvm::DCEPass())); // Remove dead functions and global variables.
+        // pass managers and adaptors only run other passes, so they are not timed on their own
+        const auto isTimedPass = [](const llvm::StringRef passName)
+        { return !llvm::isSpecialPass(passName, {"PassManager", "PassAdaptor"}); };
+        m_impl->ThePIC->registerBeforeNonSkippedPassCallback(
+                [isTimedPass](const llvm::StringRef passName, llvm::Any)
+                {
+                    if (const auto report = TimeReport::current(); report && isTimedPass(passName))
+                        report->startPass();
+                });
+        m_impl->ThePIC->registerAfterPassCallback(
+                [isTimedPass](const llvm::StringRef passName, llvm::Any, const llvm::PreservedAnalyses &)
+                {
+                    if (const auto report = TimeReport::current(); report && isTimedPass(passName))
+                        report->stopPass(passName);
+                });
+        m_impl->ThePIC->registerAfterPassInvalidatedCallback(
+                [isTimedPass](const llvm::StringRef passName, const llvm::PreservedAnalyses &)
+                {
+                    if (const auto report = TimeReport::current(); report && isTimedPass(passName))
+                        report->stopPass(passName);
+                });
     }
-
-    // Register analysis passes used in these transform passes.
-    llvm::PassBuilder PB;
-    const auto TheLAM = std::make_unique<llvm::LoopAnalysisManager>();
-    const auto TheCGAM = std::make_unique<llvm::CGSCCAnalysisManager>();
-
-    PB.registerModuleAnalyses(*m_impl->TheMAM);
-    PB.registerFunctionAnalyses(*m_impl->TheFAM);
-    PB.crossRegisterProxies(*TheLAM, *m_impl->TheFAM, *TheCGAM, *m_impl->TheMAM);
-
+    this->TargetTriple = std::make_unique<llvm::Triple>(TargetTriple);
 
     ProgramUnit = std::move(unit);
 }
@@ -139,24 +115,61 @@ std::unique_ptr<llvm::IRBuilder<>> &Context::builder() const { return m_impl->Bu
 void Context::verifyModule(llvm::Function *function) const
 {
     llvm::verifyFunction(*function, &llvm::errs());
-    if (!llvm::verifyModule(*m_impl->TheModule, &llvm::errs()))
-    {
-        if (compilerOptions.buildMode == BuildMode::Release)
-        {
-            m_impl->TheMPM->run(*m_impl->TheModule, *m_impl->TheMAM);
-            m_impl->TheFPM->run(*function, *m_impl->TheFAM);
-        }
-    }
+    llvm::verifyModule(*m_impl->TheModule, &llvm::errs());
 }
 void Context::verifyFunction(llvm::Function *functionDefinition) const
 {
-    if (llvm::verifyFunction(*functionDefinition, &llvm::errs()))
+    llvm::verifyFunction(*functionDefinition, &llvm::errs());
+}
+void Context::optimize(llvm::TargetMachine *targetMachine, const OptimizationLevel level) const
+{
+    TimeReport::Phase phase("optimize", m_impl->TheModule->getName().str());
+    llvm::OptimizationLevel llvmLevel = llvm::OptimizationLevel::O0;
+    switch (level)
     {
-        if (compilerOptions.buildMode == BuildMode::Release)
-        {
-            m_impl->TheFPM->run(*functionDefinition, *m_impl->TheFAM);
-        }
+        case OptimizationLevel::O0:
+            llvmLevel = llvm::OptimizationLevel::O0;
+            break;
+        case OptimizationLevel::O1:
+            llvmLevel = llvm::OptimizationLevel::O1;
+            break;
+        case OptimizationLevel::O2:
+            llvmLevel = llvm::OptimizationLevel::O2;
+            break;
+        case OptimizationLevel::O3:
+            llvmLevel = llvm::OptimizationLevel::O3;
+            break;
+        case OptimizationLevel::Os:
+            llvmLevel = llvm::OptimizationLevel::Os;
+            break;
     }
+
+    // the vectorizers are opt-in for the pass builder, enable them like clang does for -O2 and above
+    llvm::PipelineTuningOptions tuningOptions;
+    tuningOptions.LoopUnrolling = llvmLevel.getSpeedupLevel() > 1;
+    tuningOptions.LoopInterleaving = llvmLevel.getSpeedupLevel() > 1;
+    tuningOptions.LoopVectorization = llvmLevel.getSpeedupLevel() > 1;
+    tuningOptions.SLPVectorization = llvmLevel.getSpeedupLevel() > 1;
+
+    llvm::PassBuilder PB(targetMachine, tuningOptions, std::nullopt, m_impl->ThePIC.get());
+    PB.registerModuleAnalyses(*m_impl->TheMAM);
+    PB.registerCGSCCAnalyses(*m_impl->TheCGAM);
+    PB.registerFunctionAnalyses(*m_impl->TheFAM);
+    PB.registerLoopAnalyses(*m_impl->TheLAM);
+    PB.crossRegisterProxies(*m_impl->TheLAM, *m_impl->TheFAM, *m_impl->TheCGAM, *m_impl->TheMAM);
+
+    llvm::ModulePassManager MPM = (llvmLevel == llvm::OptimizationLevel::O0)
+                                          ? PB.buildO0DefaultPipeline(llvmLevel)
+                                          : PB.buildPerModuleDefaultPipeline(llvmLevel);
+    MPM.run(*m_impl->TheModule, *m_impl->TheMAM);
+    TimeReport::countInstructions(*m_impl->TheModule);
+}
+void Context::addTargetAttributes(llvm::Function *function) const
+{
+    if (!compilerOptions.targetCPU.empty())
+        function->addFnAttr("target-cpu", compilerOptions.targetCPU);
+    if (!compilerOptions.targetFeatures.empty())
+        function->addFnAttr("target-features", compilerOptions.targetFeatures);
 }
 void Context::setNamedAllocation(const std::string &name, llvm::AllocaInst *allocation) const
 {
@@ -176,6 +189,26 @@ llvm::Function *Context::functionDefinition(const std::string &string) const
 {
     return m_impl->FunctionDefinitions[string];
 }
+void Context::addExternalFunction(const std::string &function_signature) const
+{
+    m_impl->ExternalFunctions.insert(function_signature);
+}
+bool Context::isExternalFunction(const std::string &function_signature) const
+{
+    return m_impl->ExternalFunctions.contains(function_signature);
+}
+llvm::Type *Context::cachedLlvmType(const VariableType *type) const
+{
+    const auto it = m_impl->LlvmTypes.find(type);
+    if (it == m_impl->LlvmTypes.end() || it->second.first.expired())
+        return nullptr;
+    return it->second.second;
+}
+llvm::Type *Context::cacheLlvmType(const VariableType *type, llvm::Type *llvmType) const
+{
+    m_impl->LlvmTypes[type] = {type->weak_from_this(), llvmType};
+    return llvmType;
+}
 std::optional<llvm::Value *> Context::findValue(const std::string &name) const
 {
     llvm::Value *V = namedAllocation(name);
@@ -20,11 +20,13 @@ namespace llvm
     class AllocaInst;
     class Value;
     class Function;
+    class Type;
 
     class BasicBlock;
     class ConstantFolder;
     class IRBuilderDefaultInserter;
     class Triple;
+    class TargetMachine;
     // template<typename FolderTy = ConstantFolder, typename InserterTy = IRBuilderDefaultInserter>
     template<class FolderTy, class InserterTy>
     class IRBuilder;
@@ -36,6 +38,7 @@ namespace llvm
 // #include "llvm/IR/PassManager.h"
 
 class UnitNode;
+class VariableType;
 
 struct BreakBasicBlock
 {
@@ -72,11 +75,23 @@ public:
     std::unique_ptr<llvm::IRBuilder<llvm::ConstantFolder, llvm::IRBuilderDefaultInserter>> &builder() const;
     void verifyModule(llvm::Function *function) const;
     void verifyFunction(llvm::Function *function) const;
+    /// runs the default LLVM optimization pipeline of the given level once over the whole module
+    void optimize(llvm::TargetMachine *targetMachine, OptimizationLevel level) const;
+    /// adds the target-cpu and target-features attributes of the compiler options to the function
+    void addTargetAttributes(llvm::Function *function) const;
     void setNamedAllocation(const std::string &name, llvm::AllocaInst *allocation) const;
     void removeName(const std::string &name) const;
     void setNamedValue(const std::string &name, llvm::Value *value) const;
     void addFunctionDefinition(const std::string &function_signature, llvm::Function *function) const;
     llvm::Function *functionDefinition(const std::string &string) const;
+    /// marks the function as defined in another object file, only its declaration is generated
+    void addExternalFunction(const std::string &function_signature) const;
+    bool isExternalFunction(const std::string &function_signature) const;
+
+    /// the llvm type which was generated for a type in this compilation or nullptr. The structural types are
+    /// canonical, so the type itself is the key instead of its name.
+    llvm::Type *cachedLlvmType(const VariableType *type) const;
+    llvm::Type *cacheLlvmType(const VariableType *type, llvm::Type *llvmType) const;
 
     std::optional<llvm::Value *> findValue(const std::string &name) const;
     llvm::GlobalVariable *getOrCreateGlobalString(const std::string &value, const std::string &name = "") const;
@@ -0,0 +1,180 @@
+#include "compiler/TimeReport.h"
+
+#include <algorithm>
+#include <iomanip>
+
+#include <llvm/IR/Module.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/raw_os_ostream.h>
+
+#include "os/memory.h"
+
+static thread_local TimeReport *currentReport = nullptr;
+
+static double elapsed_seconds(const TimeReport::Clock::time_point start)
+{
+    return std::chrono::duration<double>(TimeReport::Clock::now() - start).count();
+}
+
+TimeReport::Phase::Phase(std::string_view name, std::string detail) : m_report(currentReport)
+{
+    if (!m_report)
+        return;
+    m_index = m_report->m_phases.size();
+    m_report->m_phases.push_back(PhaseRecord{.name = std::string(name),
+                                             .detail = std::move(detail),
+                                             .depth = m_report->m_runningPhases.size(),
+                                             .start = Clock::now()});
+    m_report->m_runningPhases.push_back(m_index);
+}
+
+TimeReport::Phase::~Phase()
+{
+    if (!m_report)
+        return;
+    auto &phase = m_report->m_phases[m_index];
+    phase.seconds = elapsed_seconds(phase.start);
+    phase.processPeakMemory = peak_memory_usage();
+    m_report->m_runningPhases.pop_back();
+}
+
+TimeReport::TimeReport() : m_previous(currentReport) { currentReport = this; }
+
+TimeReport::~TimeReport() { currentReport = m_previous; }
+
+TimeReport *TimeReport::current() { return currentReport; }
+
+void TimeReport::count(const std::string_view counter, const uint64_t value)
+{
+    if (!currentReport || currentReport->m_runningPhases.empty())
+        return;
+    auto &counters = currentReport->m_phases[currentReport->m_runningPhases.back()].counters;
+    if (const auto it = counters.find(counter); it != counters.end())
+        it->second += value;
+    else
+        counters.emplace(counter, value);
+}
+
+void TimeReport::countInstructions(const llvm::Module &module)
+{
+    if (!currentReport)
+        return;
+    uint64_t instructions = 0;
+    for (const auto &function: module)
+        instructions += function.getInstructionCount();
+    count("ir instructions", instructions);
+}
+
+void TimeReport::record(const std::string_view name, std::string detail, const double seconds,
+                        const std::string_view counter, const uint64_t value)
+{
+    if (!currentReport)
+        return;
+    auto &phases = currentReport->m_phases;
+    phases.push_back(PhaseRecord{.name = std::string(name),
+                                 .detail = std::move(detail),
+                                 .depth = currentReport->m_runningPhases.size(),
+                                 .start = Clock::now(),
+                                 .seconds = seconds,
+                                 .processPeakMemory = peak_memory_usage()});
+    phases.back().counters.emplace(counter, value);
+}
+
+void TimeReport::startPass() { m_runningPasses.push_back(Clock::now()); }
+
+void TimeReport::stopPass(const std::string_view passName)
+{
+    if (m_runningPasses.empty())
+        return;
+    const auto seconds = elapsed_seconds(m_runningPasses.back());
+    m_runningPasses.pop_back();
+    auto it = m_passes.find(passName);
+    if (it == m_passes.end())
+        it = m_passes.emplace(passName, PassRecord{}).first;
+    it->second.seconds += seconds;
+    ++it->second.runs;
+}
+
+void TimeReport::print(std::ostream &stream, const TimeReportFormat format) const
+{
+    if (format == TimeReportFormat::Json)
+        printJson(stream);
+    else
+        printText(stream);
+}
+
+void TimeReport::printText(std::ostream &stream) const
+{
+    constexpr double mebibyte = 1024.0 * 1024.0;
+    const auto flags = stream.flags();
+    const auto precision = stream.precision();
+    stream << "===-------------------------------------------------------------------------===\n";
+    stream << "                          wirthx compile time report\n";
+    stream << "===-------------------------------------------------------------------------===\n";
+    stream << "   Wall (s)  Process peak RSS after (MiB)  Phase\n";
+    for (const auto &phase: m_phases)
+    {
+        stream << std::fixed << std::setprecision(6) << std::setw(11) << phase.seconds << "  "
+               << std::setprecision(1) << std::setw(28) << phase.processPeakMemory / mebibyte << "  "
+               << std::string(phase.depth * 2, ' ') << phase.name;
+        if (!phase.detail.empty())
+            stream << " " << phase.detail;
+        for (const auto &[counter, value]: phase.counters)
+            stream << "  " << counter << "=" << value;
+        stream << "\n";
+    }
+
+    std::vector<std::pair<std::string, PassRecord>> passes(m_passes.begin(), m_passes.end());
+    std::ranges::sort(passes, [](const auto &lhs, const auto &rhs) { return lhs.second.seconds > rhs.second.seconds; });
+    if (!passes.empty())
+        stream << "\n   Wall (s)        Runs  Optimization pass\n";
+    for (const auto &[passName, pass]: passes)
+    {
+        stream << std::setprecision(6) << std::setw(11) << pass.seconds << "  " << std::setw(10) << pass.runs << "  "
+               << passName << "\n";
+    }
+    stream.flags(flags);
+    stream.precision(precision);
+}
+
+void TimeReport::printJson(std::ostream &stream) const
+{
+    llvm::raw_os_ostream output(stream);
+    llvm::json::OStream json(output, 2);
+    json.objectBegin();
+    json.attributeBegin("phases");
+    json.arrayBegin();
+    for (const auto &phase: m_phases)
+    {
+        json.objectBegin();
+        json.attribute("name", phase.name);
+        json.attribute("detail", phase.detail);
+        json.attribute("depth", static_cast<int64_t>(phase.depth));
+        json.attribute("seconds", phase.seconds);
+        json.attribute("processPeakMemory", static_cast<int64_t>(phase.processPeakMemory));
+        json.attributeObject("counters",
+                             [&]
+                             {
+                                 for (const auto &[counter, value]: phase.counters)
+                                     json.attribute(counter, static_cast<int64_t>(value));
+                             });
+        json.objectEnd();
+    }
+    json.arrayEnd();
+    json.attributeEnd();
+
+    json.attributeBegin("passes");
+    json.arrayBegin();
+    for (const auto &[passName, pass]: m_passes)
+    {
+        json.objectBegin();
+        json.attribute("name", passName);
+        json.attribute("seconds", pass.seconds);
+        json.attribute("runs", static_cast<int64_t>(pass.runs));
+        json.objectEnd();
+    }
+    json.arrayEnd();
+    json.attributeEnd();
+    json.objectEnd();
+    output << "\n";
+}
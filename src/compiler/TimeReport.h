@@ -0,0 +1,89 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "compiler/CompilerOptions.h"
+
+namespace llvm
+{
+    class Module;
+}
+
+/// Collects the duration, the counters and the peak memory usage of the compiler phases. A report is active for the
+/// thread which created it until it is destroyed, the phases of other threads are not recorded. The peak memory is the
+/// high-water mark of the whole process when the phase ended, not the memory the phase itself used: it includes every
+/// earlier phase and the work of other threads.
+class TimeReport
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// measures a compiler phase from its construction to its destruction, it does nothing without an active report
+    class Phase
+    {
+    private:
+        TimeReport *m_report;
+        size_t m_index = 0;
+
+    public:
+        explicit Phase(std::string_view name, std::string detail = "");
+        ~Phase();
+        Phase(const Phase &) = delete;
+        Phase &operator=(const Phase &) = delete;
+    };
+
+    TimeReport();
+    ~TimeReport();
+    TimeReport(const TimeReport &) = delete;
+    TimeReport &operator=(const TimeReport &) = delete;
+
+    /// the active report of the current thread or nullptr
+    static TimeReport *current();
+    /// adds the value to a counter (e.g. tokens or IR instructions) of the innermost running phase
+    static void count(std::string_view counter, uint64_t value);
+    /// adds the number of IR instructions of the module to the innermost running phase
+    static void countInstructions(const llvm::Module &module);
+    /// adds a finished phase below the innermost running phase, for work which is interleaved with another phase and
+    /// measured in pieces, e.g. the lexing of the token stream the parser pulls from
+    static void record(std::string_view name, std::string detail, double seconds, std::string_view counter,
+                       uint64_t value);
+
+    /// LLVM passes are reported by name, the time of every run of a pass is summed up
+    void startPass();
+    void stopPass(std::string_view passName);
+
+    void print(std::ostream &stream, TimeReportFormat format) const;
+
+private:
+    struct PhaseRecord
+    {
+        std::string name;
+        std::string detail;
+        size_t depth;
+        Clock::time_point start;
+        double seconds = 0;
+        /// the peak resident set size of the process at the end of the phase
+        size_t processPeakMemory = 0;
+        std::map<std::string, uint64_t, std::less<>> counters;
+    };
+    struct PassRecord
+    {
+        double seconds = 0;
+        uint64_t runs = 0;
+    };
+
+    std::vector<PhaseRecord> m_phases;
+    std::vector<size_t> m_runningPhases;
+    std::vector<Clock::time_point> m_runningPasses;
+    std::map<std::string, PassRecord, std::less<>> m_passes;
+    TimeReport *m_previous;
+
+    void printText(std::ostream &stream) const;
+    void printJson(std::ostream &stream) const;
+};
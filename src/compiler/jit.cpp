@@ -0,0 +1,285 @@
+#include <csetjmp>
+#include <cstdarg>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+
+#include "ast/UnitNode.h"
+#include "compiler/Compiler.h"
+#include "compiler/Context.h"
+#include "compiler/TimeReport.h"
+
+#include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/MC/TargetRegistry.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/TargetParser/Host.h"
+#include "llvm/TargetParser/SubtargetFeature.h"
+
+namespace
+{
+    /// state of the program which is executed by the JIT on the current thread
+    struct JitRuntime
+    {
+        FILE *output = nullptr;
+        FILE *error = nullptr;
+        int exitCode = 0;
+        std::jmp_buf *exitTarget = nullptr;
+    };
+
+    thread_local JitRuntime *currentRuntime = nullptr;
+
+    // The following functions replace the c library functions which would write into the output of the compiler
+    // or terminate the compiler process.
+
+    int jit_printf(const char *format, ...)
+    {
+        va_list args;
+        va_start(args, format);
+        const int result = vfprintf(currentRuntime->output, format, args);
+        va_end(args);
+        return result;
+    }
+
+    int jit_puts(const char *value) { return fprintf(currentRuntime->output, "%s\n", value); }
+
+    int jit_putchar(int value) { return fputc(value, currentRuntime->output); }
+
+    FILE *jit_acrt_iob_func(unsigned index)
+    {
+        switch (index)
+        {
+            case 1:
+                return currentRuntime->output;
+            case 2:
+                return currentRuntime->error;
+            default:
+                return stdin;
+        }
+    }
+
+    [[noreturn]] void jit_exit(int exitCode)
+    {
+        currentRuntime->exitCode = exitCode;
+        std::longjmp(*currentRuntime->exitTarget, 1);
+    }
+
+    [[noreturn]] void jit_assert_fail(const char *assertion, const char *filename, unsigned line, const char *function)
+    {
+        fprintf(currentRuntime->error, "%s:%u: %s: Assertion `%s' failed.\n", filename, line, function, assertion);
+        jit_exit(134);
+    }
+
+    /// calls the main function of the program, exit() of the program jumps back into this function
+    int run_main(int (*mainFunction)())
+    {
+        std::jmp_buf exitTarget;
+        currentRuntime->exitTarget = &exitTarget;
+        if (setjmp(exitTarget) == 0)
+        {
+            currentRuntime->exitCode = mainFunction();
+        }
+        return currentRuntime->exitCode;
+    }
+
+    /// closes a buffer which captures an output stream of the program, the standard streams of the process stay open
+    struct CapturedFileCloser
+    {
+        void operator()(FILE *file) const
+        {
+            if (file != stdout && file != stderr)
+                fclose(file);
+        }
+    };
+    using CapturedFile = std::unique_ptr<FILE, CapturedFileCloser>;
+
+    void copy_captured_output(FILE *file, std::ostream &stream)
+    {
+        fflush(file);
+        if (file == stdout || file == stderr)
+            return;
+
+        rewind(file);
+        char buffer[4096];
+        size_t bytesRead;
+        while ((bytesRead = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        {
+            stream.write(buffer, static_cast<std::streamsize>(bytesRead));
+        }
+    }
+
+    std::string shared_library_name(const llvm::Triple &triple, const std::string &libName)
+    {
+        if (triple.isOSWindows())
+            return libName + ".dll";
+        if (triple.isOSDarwin())
+            return "lib" + libName + ".dylib";
+        return "lib" + libName + ".so";
+    }
+
+    bool report_error(llvm::Error error, std::ostream &errorStream)
+    {
+        if (!error)
+            return false;
+        errorStream << llvm::toString(std::move(error)) << "\n";
+        return true;
+    }
+} // namespace
+
+static int jit_program(const CompilerOptions &options, const std::filesystem::path &inputPath,
+                       std::ostream &errorStream, std::ostream &outputStream)
+{
+    using namespace llvm;
+
+    auto jitOptions = options;
+    // code generated by the JIT never leaves the host, so it is tuned for the host cpu by default
+    if (jitOptions.targetCPU == "generic")
+        jitOptions.targetCPU = "native";
+    // the module of the JIT has to contain the code of all units
+    jitOptions.separateUnits = false;
+    const auto targetOptions = resolve_target_options(jitOptions);
+    const auto optimizationLevel = effectiveOptimizationLevel(targetOptions);
+
+    const Triple processTriple(sys::getProcessTriple());
+    std::string targetError;
+    const auto *target = TargetRegistry::lookupTarget(processTriple.str(), targetError);
+    if (!target)
+    {
+        errorStream << targetError << "\n";
+        return 1;
+    }
+    if (!check_target_cpu(*target, processTriple.str(), targetOptions, errorStream))
+        return 1;
+    orc::JITTargetMachineBuilder targetMachineBuilder(processTriple);
+    targetMachineBuilder.setCPU(targetOptions.targetCPU);
+    targetMachineBuilder.addFeatures(SubtargetFeatures(targetOptions.targetFeatures).getFeatures());
+    targetMachineBuilder.setCodeGenOptLevel(codegen_optimization_level(optimizationLevel));
+
+    auto targetMachine = targetMachineBuilder.createTargetMachine();
+    if (!targetMachine)
+    {
+        report_error(targetMachine.takeError(), errorStream);
+        return 1;
+    }
+
+    auto context = create_program_module(targetOptions, inputPath, (*targetMachine)->createDataLayout(), errorStream);
+    if (!context)
+    {
+        return 1;
+    }
+    context->optimize(targetMachine->get(), optimizationLevel);
+    if (context->options().printLLVMIR)
+    {
+        context->module()->print(llvm::errs(), nullptr, false, false);
+    }
+
+    const auto libs = context->programUnit()->collectLibsToLink();
+    orc::ThreadSafeModule module(std::move(context->module()), std::move(context->context()));
+    // the analysis managers of the context still refer to the module, so they have to go before the JIT takes over
+    context.reset();
+
+    auto jit = orc::LLJITBuilder().setJITTargetMachineBuilder(std::move(targetMachineBuilder)).create();
+    if (!jit)
+    {
+        report_error(jit.takeError(), errorStream);
+        return 1;
+    }
+
+    auto &mainLibrary = (*jit)->getMainJITDylib();
+    const char globalPrefix = (*jit)->getDataLayout().getGlobalPrefix();
+    auto processSymbols = orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(globalPrefix);
+    if (!processSymbols)
+    {
+        report_error(processSymbols.takeError(), errorStream);
+        return 1;
+    }
+    mainLibrary.addGenerator(std::move(*processSymbols));
+    for (const auto &lib: libs)
+    {
+        // the c library is already part of the compiler process
+        if (lib == "c")
+            continue;
+        auto libraryName = shared_library_name(processTriple, lib);
+        if (auto librarySymbols = orc::DynamicLibrarySearchGenerator::Load(libraryName.c_str(), globalPrefix))
+        {
+            mainLibrary.addGenerator(std::move(*librarySymbols));
+        }
+        else
+        {
+            // the symbols might still be found in the process, missing ones are reported by the lookup
+            consumeError(librarySymbols.takeError());
+        }
+    }
+
+    const CapturedFile output(&outputStream == &std::cout ? stdout : std::tmpfile());
+    const CapturedFile error(&errorStream == &std::cerr ? stderr : std::tmpfile());
+    if (!output || !error)
+    {
+        errorStream << "could not create the output buffers of the program\n";
+        return 1;
+    }
+    JitRuntime runtime;
+    runtime.output = output.get();
+    runtime.error = error.get();
+
+    const auto hostSymbol = [](auto *address)
+    { return orc::ExecutorSymbolDef(orc::ExecutorAddr::fromPtr(address), JITSymbolFlags::Exported); };
+    orc::SymbolMap hostSymbols;
+    hostSymbols[(*jit)->mangleAndIntern("stdout")] = hostSymbol(&runtime.output);
+    hostSymbols[(*jit)->mangleAndIntern("stderr")] = hostSymbol(&runtime.error);
+    hostSymbols[(*jit)->mangleAndIntern("printf")] = hostSymbol(&jit_printf);
+    hostSymbols[(*jit)->mangleAndIntern("puts")] = hostSymbol(&jit_puts);
+    hostSymbols[(*jit)->mangleAndIntern("putchar")] = hostSymbol(&jit_putchar);
+    hostSymbols[(*jit)->mangleAndIntern("exit")] = hostSymbol(&jit_exit);
+    hostSymbols[(*jit)->mangleAndIntern("__assert_fail")] = hostSymbol(&jit_assert_fail);
+    hostSymbols[(*jit)->mangleAndIntern("_assert")] = hostSymbol(&jit_assert_fail);
+    hostSymbols[(*jit)->mangleAndIntern("__acrt_iob_func")] = hostSymbol(&jit_acrt_iob_func);
+
+    int exitCode = 1;
+    if (!report_error(mainLibrary.define(orc::absoluteSymbols(std::move(hostSymbols))), errorStream) &&
+        !report_error((*jit)->addIRModule(std::move(module)), errorStream))
+    {
+        // the lookup materializes the module, so it contains the machine code generation of the JIT
+        auto mainSymbol = [&]
+        {
+            TimeReport::Phase phase("jit compile", inputPath.string());
+            return (*jit)->lookup("main");
+        }();
+        if (mainSymbol)
+        {
+            TimeReport::Phase phase("run", inputPath.string());
+            currentRuntime = &runtime;
+            exitCode = run_main(mainSymbol->toPtr<int (*)()>());
+            currentRuntime = nullptr;
+        }
+        else
+        {
+            report_error(mainSymbol.takeError(), errorStream);
+        }
+    }
+
+    copy_captured_output(runtime.output, outputStream);
+    copy_captured_output(runtime.error, errorStream);
+    return exitCode;
+}
+
+int jit_file(const CompilerOptions &options, const std::filesystem::path &inputPath, std::ostream &errorStream,
+             std::ostream &outputStream)
+{
+    if (options.timeReport == TimeReportFormat::None)
+        return jit_program(options, inputPath, errorStream, outputStream);
+
+    TimeReport report;
+    int exitCode;
+    {
+        TimeReport::Phase phase("jit", inputPath.string());
+        exitCode = jit_program(options, inputPath, errorStream, outputStream);
+    }
+    write_time_report(report, options, inputPath, errorStream, outputStream);
+    return exitCode;
+}
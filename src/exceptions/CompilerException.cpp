@@ -1,6 +1,7 @@
 #include "CompilerException.h"
 
 #include <cassert>
+#include <iomanip>
 
 std::string outputTypeString(OutputType outputType)
 {
@@ -32,18 +33,19 @@ Color::Modifier outputTypeToColor(OutputType outputType)
 }
 void ParserError::msg(std::ostream &ostream, bool printColor) const
 {
+    const auto [row, col] = token.position();
     if (printColor)
-        ostream << token.sourceLocation.filename << ":" << token.row << ":" << token.col << ": "
+        ostream << token.filename() << ":" << row << ":" << col << ": "
                 << outputTypeToColor(outputType) << outputTypeString(outputType) << Color::Modifier(Color::FG_DEFAULT)
                 << ": " << message << "\n";
     else
-        ostream << token.sourceLocation.filename << ":" << token.row << ":" << token.col << ": "
+        ostream << token.filename() << ":" << row << ":" << col << ": "
                 << outputTypeString(outputType) << ": " << message << "\n";
 
-    ostream << token.sourceLocation.sourceline() << "\n";
-    size_t startOffset = token.sourceLocation.byte_offset - token.sourceLocation.lineStart() + 1;
-    size_t endOffset = (token.sourceLocation.source->find('\n', token.sourceLocation.byte_offset) - 1) -
-                       (token.sourceLocation.byte_offset - 1);
+    const auto sourceline = token.sourceline();
+    ostream << sourceline << "\n";
+    size_t startOffset = col;
+    size_t endOffset = sourceline.size() - startOffset + 1;
 
     ostream << std::setw(startOffset) << std::setfill(' ') << '^' << std::setw(endOffset) << std::setfill('-') << "\n";
 }
@@ -5,5 +5,8 @@
 #include <string>
 #include <vector>
 
+/// links the object files into an executable. The linker "lld" links in process when the compiler is built with lld
+/// support, every other value names the compiler driver which is used for linking.
 bool pascal_link_modules(std::ostream &errStream, const std::filesystem::path &baseDir, const std::string &program_name,
-                         const std::vector<std::string> &flags, const std::vector<std::string> &object_files);
+                         const std::vector<std::string> &flags, const std::vector<std::string> &object_files,
+                         const std::string &linker);
@@ -2,9 +2,161 @@
 #include "llvm/Support/CommandLine.h"
 #include "os/command.h"
 
+#ifdef WIRTHX_HAS_LLD
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include "lld/Common/Driver.h"
+#include "llvm/Support/raw_os_ostream.h"
+#include "llvm/TargetParser/Host.h"
+#include "llvm/TargetParser/Triple.h"
+
+LLD_HAS_DRIVER(elf)
+
+/// paths of the c runtime which the c compiler driver would pass to the linker
+struct CRuntimeEnvironment
+{
+    std::string emulation;
+    std::string dynamicLinker;
+    std::filesystem::path crtDirectory;
+    std::filesystem::path gccDirectory;
+    std::vector<std::filesystem::path> libraryDirectories;
+};
+
+static std::optional<CRuntimeEnvironment> probeCRuntimeEnvironment()
+{
+    const llvm::Triple triple(llvm::sys::getProcessTriple());
+    if (!triple.isOSLinux() || !triple.isGNUEnvironment())
+        return std::nullopt;
+
+    CRuntimeEnvironment environment;
+    switch (triple.getArch())
+    {
+        case llvm::Triple::x86_64:
+            environment.emulation = "elf_x86_64";
+            environment.dynamicLinker = "/lib64/ld-linux-x86-64.so.2";
+            break;
+        case llvm::Triple::aarch64:
+            environment.emulation = "aarch64linux";
+            environment.dynamicLinker = "/lib/ld-linux-aarch64.so.1";
+            break;
+        default:
+            return std::nullopt;
+    }
+    if (!std::filesystem::exists(environment.dynamicLinker))
+        return std::nullopt;
+
+    const std::string multiarch = triple.getArchName().str() + "-linux-gnu";
+    for (const auto &directory: {std::filesystem::path("/usr/lib") / multiarch, std::filesystem::path("/usr/lib64"),
+                                 std::filesystem::path("/lib") / multiarch, std::filesystem::path("/lib64"),
+                                 std::filesystem::path("/usr/lib"), std::filesystem::path("/lib")})
+    {
+        if (!std::filesystem::is_directory(directory))
+            continue;
+        environment.libraryDirectories.push_back(directory);
+        if (environment.crtDirectory.empty() && std::filesystem::exists(directory / "Scrt1.o"))
+            environment.crtDirectory = directory;
+    }
+
+    // use the newest gcc installation for the architecture, it provides crtbeginS.o and libgcc
+    for (const auto &gccRoot: {std::filesystem::path("/usr/lib/gcc"), std::filesystem::path("/usr/lib64/gcc")})
+    {
+        std::error_code ec;
+        for (const auto &targetEntry: std::filesystem::directory_iterator(gccRoot, ec))
+        {
+            if (!targetEntry.path().filename().string().starts_with(triple.getArchName().str()))
+                continue;
+            for (const auto &versionEntry: std::filesystem::directory_iterator(targetEntry.path(), ec))
+            {
+                if (!std::filesystem::exists(versionEntry.path() / "crtbeginS.o"))
+                    continue;
+                const auto version = std::stoi("0" + versionEntry.path().filename().string());
+                if (environment.gccDirectory.empty() ||
+                    version > std::stoi("0" + environment.gccDirectory.filename().string()))
+                    environment.gccDirectory = versionEntry.path();
+            }
+        }
+    }
+
+    if (environment.crtDirectory.empty() || environment.gccDirectory.empty())
+        return std::nullopt;
+    return environment;
+}
+
+static const std::optional<CRuntimeEnvironment> &cRuntimeEnvironment()
+{
+    static const auto environment = probeCRuntimeEnvironment();
+    return environment;
+}
+
+/// lld can not be used again inside of the process after it crashed
+static std::atomic<bool> lldCrashed = false;
+/// lld keeps its state in globals, so parallel compilation jobs have to link one after another
+static std::mutex lldMutex;
+
+/// returns nullopt if lld can not be used anymore, the program is linked by the compiler driver instead
+static std::optional<bool> link_with_lld(std::ostream &errStream, const CRuntimeEnvironment &environment,
+                          const std::filesystem::path &outputFile, const std::vector<std::string> &flags,
+                          const std::vector<std::string> &object_files)
+{
+    std::vector<std::string> args = {"ld.lld",
+                                     "-pie",
+                                     "--eh-frame-hdr",
+                                     "-m",
+                                     environment.emulation,
+                                     "-dynamic-linker",
+                                     environment.dynamicLinker,
+                                     "-o",
+                                     outputFile.string(),
+                                     (environment.crtDirectory / "Scrt1.o").string(),
+                                     (environment.crtDirectory / "crti.o").string(),
+                                     (environment.gccDirectory / "crtbeginS.o").string(),
+                                     "-L" + environment.gccDirectory.string()};
+    for (const auto &directory: environment.libraryDirectories)
+        args.emplace_back("-L" + directory.string());
+    for (const auto &obj: object_files)
+        args.emplace_back(obj);
+    for (const auto &flag: flags)
+        args.emplace_back(flag);
+    // same library sequence as the one of the gcc driver
+    args.insert(args.end(), {"-lgcc", "--as-needed", "-lgcc_s", "--no-as-needed", "-lc", "-lgcc", "--as-needed",
+                             "-lgcc_s", "--no-as-needed", (environment.gccDirectory / "crtendS.o").string(),
+                             (environment.crtDirectory / "crtn.o").string()});
+
+    std::vector<const char *> argv;
+    argv.reserve(args.size());
+    for (const auto &arg: args)
+        argv.push_back(arg.c_str());
+
+    llvm::raw_os_ostream errorOutput(errStream);
+    std::scoped_lock lock(lldMutex);
+    if (lldCrashed)
+        return std::nullopt;
+    const auto result = lld::lldMain(argv, errorOutput, errorOutput, {{lld::Gnu, &lld::elf::link}});
+    lldCrashed = !result.canRunAgain;
+    return result.retCode == 0;
+}
+#endif
+
 bool pascal_link_modules(std::ostream &errStream, const std::filesystem::path &baseDir, const std::string &program_name,
-                         const std::vector<std::string> &flags, const std::vector<std::string> &object_files)
+                         const std::vector<std::string> &flags, const std::vector<std::string> &object_files,
+                         const std::string &linker)
 {
+#ifdef WIRTHX_HAS_LLD
+    // flags other than libraries (e.g. -fsanitize) need the runtime setup of the compiler driver
+    const bool onlyLibraries =
+            std::ranges::all_of(flags, [](const std::string &flag) { return flag.starts_with("-l"); });
+    if (linker == "lld" && onlyLibraries && !lldCrashed)
+    {
+        if (const auto &environment = cRuntimeEnvironment())
+        {
+            if (const auto linked = link_with_lld(errStream, *environment, baseDir / program_name, flags, object_files))
+                return *linked;
+        }
+    }
+#endif
+
     std::vector<std::string> args;
     // args.emplace_back("-nostdlib");
     args.emplace_back("-o");
@@ -17,5 +169,5 @@ bool pascal_link_modules(std::ostream &errStream, const std::filesystem::path &b
 
     args.emplace_back("-fuse-ld=gold");
 
-    return execute_command_list(errStream, errStream, "cc", args);
+    return execute_command_list(errStream, errStream, linker == "lld" ? "cc" : linker, args);
 }
@@ -3,7 +3,8 @@
 #include "os/command.h"
 
 bool pascal_link_modules(std::ostream &errStream, const std::filesystem::path &baseDir, const std::string &program_name,
-                         const std::vector<std::string> &flags, const std::vector<std::string> &object_files)
+                         const std::vector<std::string> &flags, const std::vector<std::string> &object_files,
+                         const std::string &linker)
 {
     std::vector<std::string> args;
     // args.emplace_back("-nostdlib");
@@ -19,5 +20,5 @@ bool pascal_link_modules(std::ostream &errStream, const std::filesystem::path &b
     for (auto &flag: flags)
         args.emplace_back(flag);
 
-    return execute_command_list(errStream, errStream, "clang", args);
+    return execute_command_list(errStream, errStream, linker == "lld" ? "clang" : linker, args);
 }
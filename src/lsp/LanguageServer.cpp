@@ -4,21 +4,82 @@
 
 #include "LanguageServer.h"
 
+#include <algorithm>
 #include <future>
 #include <llvm/Support/CommandLine.h>
 #include <llvm/Support/Endian.h>
 
 #include <iostream>
 #include <llvm/Support/JSON.h>
+#include <llvm/Support/Path.h>
 #include <utility>
 #include "Lexer.h"
-#include "MacroParser.h"
 #include "Parser.h"
 #include "ast/VariableAccessNode.h"
 #include "ast/VariableAssignmentNode.h"
 
 
 LanguageServer::LanguageServer(CompilerOptions options) : m_options(std::move(options)) {}
+
+LspDocumentVersion::LspDocumentVersion(const FileId file, std::vector<Token> tokens) :
+    file(file), tokens(std::move(tokens))
+{
+}
+
+LspDocumentVersion::~LspDocumentVersion() { SourceManager::instance().releaseFile(file); }
+
+/// returns the byte column of a character of the line, utf-16 clients count the code units of the characters
+static size_t byte_column(const std::string_view line, const size_t character, const PositionEncoding encoding)
+{
+    if (encoding == PositionEncoding::Utf8)
+        return character;
+    size_t units = 0;
+    size_t column = 0;
+    while (column < line.size() && units < character)
+    {
+        const auto lead = static_cast<unsigned char>(line[column]);
+        const size_t length = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+        // characters outside of the basic multilingual plane are a surrogate pair in utf-16
+        units += length == 4 ? 2 : 1;
+        column = std::min(column + length, line.size());
+    }
+    return column;
+}
+
+/// the inverse of byte_column, columns past the end of the line count one unit per byte
+static size_t lsp_character(const std::string_view line, const size_t column, const PositionEncoding encoding)
+{
+    if (encoding == PositionEncoding::Utf8)
+        return column;
+    size_t units = column > line.size() ? column - line.size() : 0;
+    for (const auto c: line.substr(0, column))
+    {
+        const auto byte = static_cast<unsigned char>(c);
+        if ((byte & 0xC0) != 0x80)
+            units += byte >= 0xF0 ? 2 : 1;
+    }
+    return units;
+}
+
+/// returns the byte offset of a position of the client in the file
+static size_t document_offset(const FileId file, const llvm::json::Object *position, const PositionEncoding encoding)
+{
+    const auto &sourceManager = SourceManager::instance();
+    const auto row = static_cast<size_t>(position->getInteger("line").value_or(0)) + 1;
+    const auto character = static_cast<size_t>(position->getInteger("character").value_or(0));
+    const auto lineStart = sourceManager.byteOffset(file, row, 1);
+    return sourceManager.byteOffset(file, row,
+                                    byte_column(sourceManager.sourceline(file, lineStart), character, encoding) + 1);
+}
+
+/// the language server keeps the precompiled interfaces of the imported units in the cache directory of the user
+static std::filesystem::path unitInterfaceDirectory()
+{
+    llvm::SmallString<128> cacheDirectory;
+    if (!llvm::sys::path::cache_directory(cacheDirectory))
+        return {};
+    return std::filesystem::path(cacheDirectory.str().str()) / "wirthx" / "interfaces";
+}
 void sendNotification(const std::string &method)
 {
     std::string resultString;
@@ -42,6 +103,18 @@ llvm::json::Object buildPosition(const size_t line, const size_t character)
     return response;
 }
 
+/// the position of the token is resolved once for both ends of the range
+llvm::json::Object buildRange(const Token &token, const PositionEncoding encoding)
+{
+    const auto [row, col] = token.position();
+    const auto line = token.sourceline();
+    const auto start = col > 0 ? col - 1 : 0;
+    llvm::json::Object range;
+    range["start"] = buildPosition(row, lsp_character(line, start, encoding) + 1);
+    range["end"] = buildPosition(row, lsp_character(line, start + token.length, encoding) + 1);
+    return range;
+}
+
 llvm::json::Object buildColor(TokenType token)
 {
     llvm::json::Object response;
@@ -90,7 +163,7 @@ constexpr int mapOutputTypeToSeverity(const OutputType output)
     }
     return 0;
 }
-void sentDiagnostics(std::map<std::string, std::vector<ParserError>> errorsMap)
+void sentDiagnostics(std::map<std::string, std::vector<ParserError>> errorsMap, const PositionEncoding encoding)
 {
     if (errorsMap.empty())
         return;
@@ -104,20 +177,14 @@ void sentDiagnostics(std::map<std::string, std::vector<ParserError>> errorsMap)
         for (const auto &[outputType, token, message]: messsages)
         {
             llvm::json::Object logMessage;
-            llvm::json::Object range;
-            range["start"] = buildPosition(token.row, token.col);
-            range["end"] = buildPosition(token.row, token.col + token.sourceLocation.num_bytes);
-            logMessage["range"] = std::move(range);
+            logMessage["range"] = buildRange(token, encoding);
             logMessage["severity"] = mapOutputTypeToSeverity(outputType);
             logMessage["message"] = message;
             llvm::json::Array relatedInformations;
             llvm::json::Object source;
             llvm::json::Object location;
-            location["uri"] = token.sourceLocation.filename;
-            llvm::json::Object range2;
-            range2["start"] = buildPosition(token.row, token.col);
-            range2["end"] = buildPosition(token.row, token.col + token.sourceLocation.num_bytes);
-            location["range"] = std::move(range2);
+            location["uri"] = token.filename();
+            location["range"] = buildRange(token, encoding);
             source["location"] = std::move(location);
             source["message"] = message;
             source["source"] = "wirthx";
@@ -148,16 +215,14 @@ void sentDiagnostics(std::map<std::string, std::vector<ParserError>> errorsMap)
     }
 }
 
-void parseAndSendDiagnostics(std::vector<std::filesystem::path> rtlDirectories, llvm::StringRef uri,
-                             llvm::StringRef text)
+void parseAndSendDiagnostics(std::vector<std::filesystem::path> rtlDirectories, const FileId file,
+                             std::shared_ptr<const std::vector<Token>> tokens, const PositionEncoding encoding)
 {
     std::map<std::string, std::vector<ParserError>> errorsMap;
-    Lexer lexer;
-    auto tokens = lexer.tokenize(uri.str(), text.str());
-    std::filesystem::path filePath = uri.str();
-    std::unordered_map<std::string, bool> definitions;
-    MacroParser macro_parser(definitions);
-    Parser parser(rtlDirectories, filePath, definitions, macro_parser.parseFile(tokens));
+    std::filesystem::path filePath = SourceManager::instance().filename(file);
+    MacroDefinitions definitions;
+    Parser parser(rtlDirectories, filePath, definitions, file, std::move(tokens));
+    parser.setUnitInterfaceDirectory(unitInterfaceDirectory());
     auto ast = parser.parseFile();
     if (!parser.hasMessages())
     {
@@ -167,15 +232,15 @@ void parseAndSendDiagnostics(std::vector<std::filesystem::path> rtlDirectories,
     {
         for (auto &error: parser.getErrors())
         {
-            errorsMap[error.token.sourceLocation.filename].push_back(error);
+            errorsMap[error.token.filename()].push_back(error);
         }
     }
-    sentDiagnostics(errorsMap);
+    sentDiagnostics(errorsMap, encoding);
 }
-llvm::json::Object buildLocationFromToken(const Token &expressionToken)
+llvm::json::Object buildLocationFromToken(const Token &expressionToken, const PositionEncoding encoding)
 {
     llvm::json::Object location;
-    auto filePath = expressionToken.sourceLocation.filename;
+    auto filePath = expressionToken.filename();
     if (filePath.starts_with("file://"))
     {
         location["uri"] = filePath;
@@ -184,10 +249,7 @@ llvm::json::Object buildLocationFromToken(const Token &expressionToken)
     {
         location["uri"] = "file://" + filePath;
     }
-    llvm::json::Object range;
-    range["start"] = buildPosition(expressionToken.row, expressionToken.col);
-    range["end"] = buildPosition(expressionToken.row, expressionToken.col + expressionToken.sourceLocation.num_bytes);
-    location["range"] = std::move(range);
+    location["range"] = buildRange(expressionToken, encoding);
     return location;
 }
 llvm::json::Object buildError(const char *message, const int errorCode)
@@ -198,10 +260,39 @@ llvm::json::Object buildError(const char *message, const int errorCode)
     error["data"] = "An internal error occurred while processing the request.";
     return error;
 }
+void LanguageServer::applyChange(LspDocument &document, const llvm::json::Object &change,
+                                 const PositionEncoding encoding)
+{
+    auto &sourceManager = SourceManager::instance();
+    const auto text = change.getString("text").value_or("");
+    Lexer lexer;
+    const auto range = change.getObject("range");
+    if (!range || !document.version)
+    {
+        const auto file = sourceManager.addFile(document.uri, text);
+        document.version = std::make_shared<LspDocumentVersion>(file, lexer.tokenize(file));
+        return;
+    }
+
+    const auto previousFile = document.version->file;
+    const auto begin = document_offset(previousFile, range->getObject("start"), encoding);
+    const auto end = std::max(begin, document_offset(previousFile, range->getObject("end"), encoding));
+    const auto previous = sourceManager.content(previousFile);
+    std::string content;
+    content.reserve(previous.size() - (end - begin) + text.size());
+    content.append(previous.substr(0, begin)).append(text.data(), text.size()).append(previous.substr(end));
+    const auto file = sourceManager.addFile(document.uri, std::move(content));
+    // a parser which still streams the tokens of the previous version keeps them, otherwise the previous version is
+    // released together with its file as soon as it is replaced
+    auto tokens = document.version.use_count() > 1 ? document.version->tokens : std::move(document.version->tokens);
+    lexer.relex(tokens, file, TextEdit{.begin = begin, .oldEnd = end, .newEnd = begin + text.size()});
+    document.version = std::make_shared<LspDocumentVersion>(file, std::move(tokens));
+}
+
 bool tokenInRange(const Token &token, size_t line, size_t character)
 {
-    return token.row == line + 1 && character + 1 >= token.col &&
-           character + 1 <= token.col + token.sourceLocation.num_bytes;
+    const auto [row, col] = token.position();
+    return row == line + 1 && character + 1 >= col && character + 1 <= col + token.length;
 }
 void LanguageServer::handleRequest()
 {
@@ -265,6 +356,23 @@ void LanguageServer::handleRequest()
                 if (method.value() == "initialize")
                 {
                     llvm::json::Object capabilities;
+                    // the columns are byte offsets in the source manager, utf-16 positions are converted
+                    m_positionEncoding = PositionEncoding::Utf16;
+                    if (const auto *params = requestObject->getObject("params"))
+                    {
+                        const auto *clientCapabilities = params->getObject("capabilities");
+                        const auto *general = clientCapabilities ? clientCapabilities->getObject("general") : nullptr;
+                        if (const auto *encodings = general ? general->getArray("positionEncodings") : nullptr)
+                        {
+                            for (const auto &encoding: *encodings)
+                            {
+                                if (const auto name = encoding.getAsString(); name && *name == "utf-8")
+                                    m_positionEncoding = PositionEncoding::Utf8;
+                            }
+                        }
+                    }
+                    capabilities["positionEncoding"] =
+                            m_positionEncoding == PositionEncoding::Utf8 ? "utf-8" : "utf-16";
                     capabilities["documentHighlightProvider"] = false;
                     capabilities["documentSymbolProvider"] = true;
                     capabilities["colorProvider"] = false;
@@ -274,7 +382,8 @@ void LanguageServer::handleRequest()
                     capabilities["diagnosticProvider"] = std::move(diagnosticProvider);
                     llvm::json::Object textDocumentSync;
                     textDocumentSync["openClose"] = true;
-                    textDocumentSync["change"] = 1;
+                    // incremental changes, only the changed range of a document is lexed again
+                    textDocumentSync["change"] = 2;
                     capabilities["textDocumentSync"] = std::move(textDocumentSync);
                     capabilities["declarationProvider"] = true;
                     capabilities["definitionProvider"] = true;
@@ -307,12 +416,16 @@ void LanguageServer::handleRequest()
                     auto uri = params->getObject("textDocument")->getString("uri");
 
                     auto text = params->getObject("textDocument")->getString("text");
-                    m_openDocuments[uri.value().str()] =
-                            LspDocument{.uri = uri.value().str(), .text = text.value().str()};
+                    const auto file = SourceManager::instance().addFile(uri.value().str(), text.value());
+                    Lexer lexer;
+                    auto &document = m_openDocuments[uri.value().str()];
+                    document = LspDocument{.uri = uri.value().str(),
+                                           .version = std::make_shared<LspDocumentVersion>(file, lexer.tokenize(file))};
                     response["result"] = std::move(result);
-                    std::ignore = std::async(std::launch::async, [rtlDirectories = this->m_options.rtlDirectories,
-                                                                  uri = uri.value(), text = text.value()]()
-                                             { parseAndSendDiagnostics(rtlDirectories, uri, text); });
+                    std::ignore = std::async(std::launch::async,
+                                             [rtlDirectories = this->m_options.rtlDirectories, file,
+                                              tokens = document.tokens(), encoding = m_positionEncoding]()
+                                             { parseAndSendDiagnostics(rtlDirectories, file, tokens, encoding); });
                 }
                 else if (method.value() == "textDocument/didClose")
                 {
@@ -325,13 +438,16 @@ void LanguageServer::handleRequest()
                     auto params = requestObject->getObject("params");
                     auto uri = params->getObject("textDocument")->getString("uri");
 
-                    auto text = params->getArray("contentChanges")->front().getAsObject()->getString("text");
-                    m_openDocuments[uri.value().str()] =
-                            LspDocument{.uri = uri.value().str(), .text = text.value().str()};
+                    auto &document = m_openDocuments[uri.value().str()];
+                    document.uri = uri.value().str();
+                    for (const auto &change: *params->getArray("contentChanges"))
+                        applyChange(document, *change.getAsObject(), m_positionEncoding);
                     response["result"] = std::move(result);
-                    std::ignore = std::async(std::launch::async, [rtlDirectories = this->m_options.rtlDirectories,
-                                                                  uri = uri.value(), text = text.value()]()
-                                             { parseAndSendDiagnostics(rtlDirectories, uri, text); });
+                    std::ignore = std::async(std::launch::async,
+                                             [rtlDirectories = this->m_options.rtlDirectories,
+                                              file = document.version->file, tokens = document.tokens(),
+                                              encoding = m_positionEncoding]()
+                                             { parseAndSendDiagnostics(rtlDirectories, file, tokens, encoding); });
                 }
                 // else if (method.value() == "textDocument/documentHighlight")
                 // {
@@ -341,7 +457,7 @@ void LanguageServer::handleRequest()
                 //     auto uri = params->getObject("textDocument")->getString("uri");
                 //     auto &document = m_openDocuments.at(uri.value().str());
                 //     Lexer lexer;
-                //     auto tokens = lexer.tokenize(uri.value().str(), document.text);
+                //     auto tokens = lexer.tokenize(document.file);
                 //     llvm::json::Array array;
                 //
                 //
@@ -361,17 +477,14 @@ void LanguageServer::handleRequest()
                 {
                     auto uri = requestObject->getObject("params")->getObject("textDocument")->getString("uri").value();
                     std::map<std::string, std::vector<ParserError>> errorsMap;
-                    Lexer lexer;
-                    std::stringstream text;
                     if (m_openDocuments.contains(uri.str()))
                     {
-                        text << m_openDocuments.at(uri.str()).text;
-                        auto tokens = lexer.tokenize(uri.str(), text.str());
                         std::filesystem::path filePath = uri.str();
-                        std::unordered_map<std::string, bool> definitions;
-                        MacroParser macro_parser(definitions);
+                        MacroDefinitions definitions;
+                        const auto &document = m_openDocuments.at(uri.str());
                         Parser parser(this->m_options.rtlDirectories, filePath, definitions,
-                                      macro_parser.parseFile(tokens));
+                                      document.version->file, document.tokens());
+                        parser.setUnitInterfaceDirectory(unitInterfaceDirectory());
                         auto ast = parser.parseFile();
                         if (!parser.hasMessages())
                         {
@@ -381,7 +494,7 @@ void LanguageServer::handleRequest()
                         {
                             for (auto &error: parser.getErrors())
                             {
-                                errorsMap[error.token.sourceLocation.filename].push_back(error);
+                                errorsMap[error.token.filename()].push_back(error);
                             }
                         }
                         llvm::json::Array diagnosticValues;
@@ -393,20 +506,14 @@ void LanguageServer::handleRequest()
                             for (const auto &[outputType, token, message]: messsages)
                             {
                                 llvm::json::Object logMessage;
-                                llvm::json::Object range;
-                                range["start"] = buildPosition(token.row, token.col);
-                                range["end"] = buildPosition(token.row, token.col + token.sourceLocation.num_bytes);
-                                logMessage["range"] = std::move(range);
+                                logMessage["range"] = buildRange(token, m_positionEncoding);
                                 logMessage["severity"] = mapOutputTypeToSeverity(outputType);
                                 logMessage["message"] = message;
                                 llvm::json::Array relatedInformations;
                                 llvm::json::Object source;
                                 llvm::json::Object location;
-                                location["uri"] = token.sourceLocation.filename;
-                                llvm::json::Object range2;
-                                range2["start"] = buildPosition(token.row, token.col);
-                                range2["end"] = buildPosition(token.row, token.col + token.sourceLocation.num_bytes);
-                                location["range"] = std::move(range2);
+                                location["uri"] = token.filename();
+                                location["range"] = buildRange(token, m_positionEncoding);
                                 source["location"] = std::move(location);
                                 source["message"] = message;
                                 source["source"] = "wirthx";
@@ -450,26 +557,34 @@ void LanguageServer::handleRequest()
                     auto uri = params->getObject("textDocument")->getString("uri");
                     auto position = params->getObject("position");
                     size_t line = position->getInteger("line").value();
-                    size_t character = position->getInteger("character").value();
                     auto &document = m_openDocuments.at(uri.value().str());
+                    const auto file = document.version->file;
+                    // the character is converted into a byte column of the line
+                    const auto lineStart = SourceManager::instance().byteOffset(file, line + 1, 1);
+                    size_t character = byte_column(SourceManager::instance().sourceline(file, lineStart),
+                                                   position->getInteger("character").value(), m_positionEncoding);
                     std::filesystem::path filePath = uri.value().str();
 
-                    Lexer lexer;
-                    auto tokens = lexer.tokenize(filePath.string(), document.text);
-                    std::unordered_map<std::string, bool> definitions;
+                    const auto &tokens = document.version->tokens;
+                    MacroDefinitions definitions;
 
-                    MacroParser macro_parser(definitions);
-                    Parser parser(this->m_options.rtlDirectories, filePath, definitions,
-                                  macro_parser.parseFile(tokens));
+                    Parser parser(this->m_options.rtlDirectories, filePath, definitions, file, document.tokens());
+                    parser.setUnitInterfaceDirectory(unitInterfaceDirectory());
                     auto ast = parser.parseFile();
                     bool found = false;
-                    for (auto &token: tokens)
+                    // the tokens are ordered by their offset, only the tokens around the cursor can be in its range
+                    const auto cursor =
+                            SourceManager::instance().byteOffset(file, line + 1, character + 2);
+                    const auto first = std::ranges::partition_point(
+                            tokens, [cursor](const Token &token) { return token.byteOffset + token.length < cursor; });
+                    for (auto it = first; it != tokens.end() && it->byteOffset <= cursor; ++it)
                     {
+                        const auto &token = *it;
                         if (tokenInRange(token, line, character + 1))
                         {
 
 
-                            if (token.tokenType == TokenType::NAMEDTOKEN)
+                            if (token.tokenType() == TokenType::NAMEDTOKEN)
                             {
                                 auto resultPair = ast->getNodeByToken(token);
                                 if (resultPair.has_value())
@@ -477,7 +592,7 @@ void LanguageServer::handleRequest()
                                     std::cerr << " node found for token: " << token.lexical() << "\n";
 
                                     auto [parent, node] = resultPair.value();
-                                    if (const auto function = dynamic_cast<const FunctionDefinitionNode *>(parent))
+                                    if (const auto function = dyn_cast<FunctionDefinitionNode>(parent))
                                     {
                                         if (auto varDefinition =
                                                     function->body()->getVariableDefinition(token.lexical()))
@@ -485,7 +600,8 @@ void LanguageServer::handleRequest()
                                             std::cerr << "Found variable definition: " << varDefinition->token.lexical()
                                                       << "\n";
 
-                                            llvm::json::Object location = buildLocationFromToken(varDefinition->token);
+                                            llvm::json::Object location =
+                                                    buildLocationFromToken(varDefinition->token, m_positionEncoding);
                                             response["result"] = std::move(location);
                                             found = true;
                                             break;
@@ -493,20 +609,22 @@ void LanguageServer::handleRequest()
                                         if (auto param = function->getParam(token.lexical()); param.has_value())
                                         {
 
-                                            llvm::json::Object location = buildLocationFromToken(param->token);
+                                            llvm::json::Object location =
+                                                    buildLocationFromToken(param->token, m_positionEncoding);
                                             response["result"] = std::move(location);
                                             found = true;
                                             break;
                                         }
                                     }
-                                    else if (auto unit = dynamic_cast<const UnitNode *>(parent))
+                                    else if (auto unit = dyn_cast<UnitNode>(parent))
                                     {
                                         if (auto varDefinition = unit->getVariableDefinition(token.lexical()))
                                         {
                                             std::cerr << "Found variable definition: " << varDefinition->token.lexical()
                                                       << "\n";
 
-                                            llvm::json::Object location = buildLocationFromToken(varDefinition->token);
+                                            llvm::json::Object location =
+                                                    buildLocationFromToken(varDefinition->token, m_positionEncoding);
                                             response["result"] = std::move(location);
                                             found = true;
                                             break;
@@ -518,7 +636,8 @@ void LanguageServer::handleRequest()
                                 {
 
                                     auto expressionToken = functionDefinition.value()->expressionToken();
-                                    llvm::json::Object location = buildLocationFromToken(expressionToken);
+                                    llvm::json::Object location =
+                                            buildLocationFromToken(expressionToken, m_positionEncoding);
                                     response["result"] = std::move(location);
                                     found = true;
                                     break;
@@ -8,20 +8,52 @@
 #include <llvm/ADT/StringRef.h>
 #include <llvm/Support/JSON.h>
 #include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "SourceManager.h"
+#include "Token.h"
 #include "compiler/CompilerOptions.h"
 #include "exceptions/CompilerException.h"
+/// the unit in which the client counts the characters of a position
+enum class PositionEncoding
+{
+    Utf8,
+    Utf16
+};
+
+/// A version of the text of a document. The text is owned by the source manager, it is released with the last
+/// reference to the version, e.g. the tokens of a parser which still computes the diagnostics of the version.
+struct LspDocumentVersion
+{
+    FileId file;
+    /// a change only lexes the tokens around the changed range again
+    std::vector<Token> tokens;
+
+    LspDocumentVersion(FileId file, std::vector<Token> tokens);
+    ~LspDocumentVersion();
+    LspDocumentVersion(const LspDocumentVersion &) = delete;
+    LspDocumentVersion &operator=(const LspDocumentVersion &) = delete;
+};
+
 struct LspDocument
 {
     std::string uri;
-    std::string text;
+    std::shared_ptr<LspDocumentVersion> version;
+
+    /// the tokens of the current version, they keep the version and its text alive
+    [[nodiscard]] std::shared_ptr<const std::vector<Token>> tokens() const { return {version, &version->tokens}; }
 };
 
 class LanguageServer
 {
     std::map<std::string, LspDocument> m_openDocuments;
     CompilerOptions m_options;
+    PositionEncoding m_positionEncoding = PositionEncoding::Utf16;
+
+    /// applies a change of the content of a document, a change without a range replaces the whole text
+    static void applyChange(LspDocument &document, const llvm::json::Object &change, PositionEncoding encoding);
 
 public:
     explicit LanguageServer(CompilerOptions options);
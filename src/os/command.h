@@ -1,11 +1,13 @@
 #pragma once
 
+#include <filesystem>
 #include <ostream>
 #include <string>
 #include <vector>
 
+/// runs the command with the arguments, an empty working directory keeps the current directory of the process
 bool execute_command_list(std::ostream &outstream, std::ostream &errorStream, const std::string &command,
-                          std::vector<std::string> args);
+                          std::vector<std::string> args, const std::filesystem::path &workingDirectory = {});
 
 template<typename... Args>
 bool execute_command(std::ostream &outstream, std::ostream &errorStream, const std::string &command, Args... args)
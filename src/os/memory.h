@@ -0,0 +1,6 @@
+#pragma once
+
+#include <cstddef>
+
+/// returns the peak resident set size of the compiler process in bytes, 0 if it is not available
+std::size_t peak_memory_usage();
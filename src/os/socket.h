@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/// a connected stream socket of the local machine (unix domain socket)
+class LocalSocket
+{
+private:
+    int m_handle;
+
+public:
+    explicit LocalSocket(int handle);
+    ~LocalSocket();
+    LocalSocket(LocalSocket &&other) noexcept;
+    LocalSocket &operator=(LocalSocket &&other) noexcept;
+    LocalSocket(const LocalSocket &) = delete;
+    LocalSocket &operator=(const LocalSocket &) = delete;
+
+    /// connects to a listening socket, returns nullopt if nobody is listening on the path. A socket whose directory
+    /// could be written by another user or whose server runs as another user is not connected to.
+    static std::optional<LocalSocket> connect(const std::filesystem::path &path);
+
+    /// writes all bytes, returns false if the connection is closed
+    bool write(std::string_view data);
+    /// reads exactly size bytes, returns false if the connection is closed before or the receive timeout expires
+    bool read(char *buffer, std::size_t size);
+    /// a read fails if no data arrives within the timeout, a timeout of zero waits forever
+    void setReceiveTimeout(std::chrono::milliseconds timeout);
+};
+
+/// a socket which accepts the connections of the local machine, the socket file is removed on destruction
+class LocalServerSocket
+{
+private:
+    int m_handle;
+    std::filesystem::path m_path;
+
+    LocalServerSocket(int handle, std::filesystem::path path);
+
+public:
+    ~LocalServerSocket();
+    LocalServerSocket(LocalServerSocket &&other) noexcept;
+    LocalServerSocket(const LocalServerSocket &) = delete;
+    LocalServerSocket &operator=(const LocalServerSocket &) = delete;
+
+    /// starts to listen on the path, a stale socket file of a terminated server is replaced. The directory of the
+    /// socket is created private to the current user, an existing one must not be writable by other users.
+    static std::optional<LocalServerSocket> listen(const std::filesystem::path &path, std::string &error);
+
+    /// waits for the next connection of the current user, returns nullopt if the socket failed
+    std::optional<LocalSocket> accept();
+};
+
+/// path for a socket with the given name in a directory which is private to the current user
+std::filesystem::path default_local_socket_path(const std::string &name);
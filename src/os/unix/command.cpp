@@ -3,7 +3,7 @@
 #include <iostream>
 #include <llvm/Support/FileSystem.h>
 bool execute_command_list(std::ostream &outstream, std::ostream &errorStream, const std::string &command,
-                          std::vector<std::string> args)
+                          std::vector<std::string> args, const std::filesystem::path &workingDirectory)
 {
     int LINE_LEN = 1024;
     char line[LINE_LEN];
@@ -12,7 +12,15 @@ bool execute_command_list(std::ostream &outstream, std::ostream &errorStream, co
     if (pipe(pfd) < 0)
         return -1;
     auto perr = fdopen(pfd[0], "r");
-    std::string cmd = command;
+    std::string cmd;
+    if (!workingDirectory.empty())
+    {
+        std::string directory = workingDirectory.string();
+        for (size_t pos = directory.find('\''); pos != std::string::npos; pos = directory.find('\'', pos + 4))
+            directory.replace(pos, 1, "'\\''");
+        cmd = "cd '" + directory + "' && ";
+    }
+    cmd += command;
 
     for (auto &arg: args)
         cmd += " " + arg;
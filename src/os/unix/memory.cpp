@@ -0,0 +1,16 @@
+#include "os/memory.h"
+
+#include <sys/resource.h>
+
+std::size_t peak_memory_usage()
+{
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    // macOS reports the size in bytes, linux and the BSDs in kilobytes
+    return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+}
@@ -0,0 +1,240 @@
+#include "os/socket.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <utility>
+
+#ifdef MSG_NOSIGNAL
+constexpr int sendFlags = MSG_NOSIGNAL;
+#else
+constexpr int sendFlags = 0;
+#endif
+
+static bool socket_address(const std::filesystem::path &path, sockaddr_un &address)
+{
+    const auto &native = path.native();
+    address = sockaddr_un{};
+    address.sun_family = AF_UNIX;
+    if (native.size() >= sizeof(address.sun_path))
+        return false;
+    std::memcpy(address.sun_path, native.c_str(), native.size() + 1);
+    return true;
+}
+
+/// the directory of a socket has to belong to the current user and must not be writable by others, otherwise another
+/// user could replace the socket by its own. A missing directory is created private to the current user.
+static bool is_private_directory(const std::filesystem::path &socketPath, const bool create, std::string &error)
+{
+    const auto directory = std::filesystem::absolute(socketPath).parent_path();
+    struct stat status{};
+    if (::lstat(directory.c_str(), &status) != 0)
+    {
+        if (errno != ENOENT || !create || ::mkdir(directory.c_str(), 0700) != 0 ||
+            ::lstat(directory.c_str(), &status) != 0)
+        {
+            error = directory.string() + ": " + std::strerror(errno);
+            return false;
+        }
+    }
+    // lstat does not follow a symbolic link, a link to a directory is rejected as well
+    if (!S_ISDIR(status.st_mode))
+        error = directory.string() + " is not a directory";
+    else if (status.st_uid != ::geteuid())
+        error = directory.string() + " belongs to another user";
+    else if ((status.st_mode & (S_IWGRP | S_IWOTH)) != 0)
+        error = directory.string() + " is writable by other users";
+    else
+        return true;
+    return false;
+}
+
+/// returns true if the process on the other side of the connection runs as the current user
+static bool peer_is_current_user(const int handle)
+{
+#ifdef SO_PEERCRED
+    ucred credentials{};
+    socklen_t length = sizeof(credentials);
+    return ::getsockopt(handle, SOL_SOCKET, SO_PEERCRED, &credentials, &length) == 0 &&
+           credentials.uid == ::geteuid();
+#else
+    uid_t uid;
+    gid_t gid;
+    return ::getpeereid(handle, &uid, &gid) == 0 && uid == ::geteuid();
+#endif
+}
+
+static int open_socket()
+{
+    const int handle = ::socket(AF_UNIX, SOCK_STREAM, 0);
+#ifdef SO_NOSIGPIPE
+    // macOS has no MSG_NOSIGNAL, a closed client must not terminate the server
+    if (handle >= 0)
+    {
+        int enabled = 1;
+        setsockopt(handle, SOL_SOCKET, SO_NOSIGPIPE, &enabled, sizeof(enabled));
+    }
+#endif
+    return handle;
+}
+
+LocalSocket::LocalSocket(const int handle) : m_handle(handle) {}
+
+LocalSocket::~LocalSocket()
+{
+    if (m_handle >= 0)
+        ::close(m_handle);
+}
+
+LocalSocket::LocalSocket(LocalSocket &&other) noexcept : m_handle(other.m_handle) { other.m_handle = -1; }
+
+LocalSocket &LocalSocket::operator=(LocalSocket &&other) noexcept
+{
+    std::swap(m_handle, other.m_handle);
+    return *this;
+}
+
+std::optional<LocalSocket> LocalSocket::connect(const std::filesystem::path &path)
+{
+    sockaddr_un address{};
+    if (!socket_address(path, address))
+        return std::nullopt;
+    // a socket which another user could have created is never used, the sources would be sent to that user
+    std::string error;
+    if (!is_private_directory(path, false, error))
+        return std::nullopt;
+    LocalSocket socket(open_socket());
+    if (socket.m_handle < 0 ||
+        ::connect(socket.m_handle, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 ||
+        !peer_is_current_user(socket.m_handle))
+        return std::nullopt;
+    return socket;
+}
+
+bool LocalSocket::write(std::string_view data)
+{
+    while (!data.empty())
+    {
+        const auto written = ::send(m_handle, data.data(), data.size(), sendFlags);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return false;
+        data.remove_prefix(static_cast<std::size_t>(written));
+    }
+    return true;
+}
+
+bool LocalSocket::read(char *buffer, std::size_t size)
+{
+    while (size > 0)
+    {
+        const auto received = ::recv(m_handle, buffer, size, 0);
+        if (received < 0 && errno == EINTR)
+            continue;
+        if (received <= 0)
+            return false;
+        buffer += received;
+        size -= static_cast<std::size_t>(received);
+    }
+    return true;
+}
+
+void LocalSocket::setReceiveTimeout(const std::chrono::milliseconds timeout)
+{
+    timeval value{};
+    value.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+    value.tv_usec = static_cast<suseconds_t>(timeout.count() % 1000 * 1000);
+    ::setsockopt(m_handle, SOL_SOCKET, SO_RCVTIMEO, &value, sizeof(value));
+}
+
+LocalServerSocket::LocalServerSocket(const int handle, std::filesystem::path path) :
+    m_handle(handle), m_path(std::move(path))
+{
+}
+
+LocalServerSocket::~LocalServerSocket()
+{
+    if (m_handle < 0)
+        return;
+    ::close(m_handle);
+    std::error_code ec;
+    std::filesystem::remove(m_path, ec);
+}
+
+LocalServerSocket::LocalServerSocket(LocalServerSocket &&other) noexcept :
+    m_handle(other.m_handle), m_path(std::move(other.m_path))
+{
+    other.m_handle = -1;
+}
+
+std::optional<LocalServerSocket> LocalServerSocket::listen(const std::filesystem::path &path, std::string &error)
+{
+    sockaddr_un address{};
+    if (!socket_address(path, address))
+    {
+        error = "the socket path is too long";
+        return std::nullopt;
+    }
+    if (!is_private_directory(path, true, error))
+        return std::nullopt;
+    if (std::filesystem::exists(path))
+    {
+        if (LocalSocket::connect(path))
+        {
+            error = "a server is already listening";
+            return std::nullopt;
+        }
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+
+    const int handle = open_socket();
+    if (handle < 0)
+    {
+        error = std::strerror(errno);
+        return std::nullopt;
+    }
+    // only the current user may send compile requests
+    const auto previousMask = ::umask(0077);
+    const bool bound = ::bind(handle, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0;
+    ::umask(previousMask);
+    if (!bound || ::listen(handle, SOMAXCONN) != 0)
+    {
+        error = std::strerror(errno);
+        ::close(handle);
+        return std::nullopt;
+    }
+    return LocalServerSocket(handle, path);
+}
+
+std::optional<LocalSocket> LocalServerSocket::accept()
+{
+    while (true)
+    {
+        const int connection = ::accept(m_handle, nullptr, nullptr);
+        if (connection >= 0)
+        {
+            // a connection of another user is dropped
+            if (peer_is_current_user(connection))
+                return LocalSocket(connection);
+            ::close(connection);
+            continue;
+        }
+        if (errno != EINTR && errno != ECONNABORTED)
+            return std::nullopt;
+    }
+}
+
+std::filesystem::path default_local_socket_path(const std::string &name)
+{
+    if (const char *runtimeDirectory = std::getenv("XDG_RUNTIME_DIR"); runtimeDirectory && *runtimeDirectory)
+        return std::filesystem::path(runtimeDirectory) / (name + ".sock");
+    // the temporary directory is shared by all users, the socket is placed in a directory of the current user in it
+    return std::filesystem::temp_directory_path() / (name + "-" + std::to_string(::geteuid())) / (name + ".sock");
+}
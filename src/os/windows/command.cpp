@@ -8,7 +8,7 @@
 
 
 bool execute_command_list(std::ostream &outstream, std::ostream &errorStream, const std::string &command,
-                          std::vector<std::string> args)
+                          std::vector<std::string> args, const std::filesystem::path &workingDirectory)
 {
     STARTUPINFOA si;
     PROCESS_INFORMATION pi;
@@ -42,6 +42,7 @@ bool execute_command_list(std::ostream &outstream, std::ostream &errorStream, co
     {
         commandLine += " " + arg;
     }
+    const std::string currentDirectory = workingDirectory.string();
     //
     // Start the child process.
     if (!CreateProcessA(nullptr, // No module name (use command line)
@@ -51,7 +52,7 @@ bool execute_command_list(std::ostream &outstream, std::ostream &errorStream, co
                         TRUE, // Set handle inheritance to FALSE
                         NORMAL_PRIORITY_CLASS | CREATE_NO_WINDOW | CREATE_NEW_PROCESS_GROUP, // No creation flags
                         nullptr, // Use parent's environment block
-                        nullptr, // Use parent's starting directory
+                        currentDirectory.empty() ? nullptr : currentDirectory.c_str(), // Starting directory
                         &si, // Pointer to STARTUPINFO structure
                         &pi) // Pointer to PROCESS_INFORMATION structure
     )
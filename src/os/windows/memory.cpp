@@ -0,0 +1,13 @@
+#include "os/memory.h"
+
+#include "windows.h"
+
+#include "psapi.h"
+
+std::size_t peak_memory_usage()
+{
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return counters.PeakWorkingSetSize;
+}
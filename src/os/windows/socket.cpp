@@ -0,0 +1,51 @@
+#include "os/socket.h"
+
+#include <utility>
+
+// the compile server is not available on windows, the client falls back to compiling in its own process
+
+LocalSocket::LocalSocket(const int handle) : m_handle(handle) {}
+
+LocalSocket::~LocalSocket() = default;
+
+LocalSocket::LocalSocket(LocalSocket &&other) noexcept : m_handle(other.m_handle) { other.m_handle = -1; }
+
+LocalSocket &LocalSocket::operator=(LocalSocket &&other) noexcept
+{
+    std::swap(m_handle, other.m_handle);
+    return *this;
+}
+
+std::optional<LocalSocket> LocalSocket::connect(const std::filesystem::path &) { return std::nullopt; }
+
+bool LocalSocket::write(std::string_view) { return false; }
+
+bool LocalSocket::read(char *, std::size_t) { return false; }
+
+void LocalSocket::setReceiveTimeout(std::chrono::milliseconds) {}
+
+LocalServerSocket::LocalServerSocket(const int handle, std::filesystem::path path) :
+    m_handle(handle), m_path(std::move(path))
+{
+}
+
+LocalServerSocket::~LocalServerSocket() = default;
+
+LocalServerSocket::LocalServerSocket(LocalServerSocket &&other) noexcept :
+    m_handle(other.m_handle), m_path(std::move(other.m_path))
+{
+    other.m_handle = -1;
+}
+
+std::optional<LocalServerSocket> LocalServerSocket::listen(const std::filesystem::path &, std::string &error)
+{
+    error = "the compile server is not supported on windows";
+    return std::nullopt;
+}
+
+std::optional<LocalSocket> LocalServerSocket::accept() { return std::nullopt; }
+
+std::filesystem::path default_local_socket_path(const std::string &name)
+{
+    return std::filesystem::temp_directory_path() / (name + ".sock");
+}
@@ -0,0 +1,144 @@
+#include "scan.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define WIRTHX_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    constexpr bool is_blank(const char value) { return value == ' ' || value == '\t' || value == '\r' || value == '\n'; }
+
+    const char *find_byte_portable(const char *begin, const char *end, const char value)
+    {
+        const void *result = std::memchr(begin, value, static_cast<size_t>(end - begin));
+        return result ? static_cast<const char *>(result) : end;
+    }
+
+    const char *skip_blanks_portable(const char *begin, const char *end)
+    {
+        return std::find_if_not(begin, end, is_blank);
+    }
+
+    size_t count_byte_portable(const char *begin, const char *end, const char value)
+    {
+        return static_cast<size_t>(std::count(begin, end, value));
+    }
+
+#ifdef WIRTHX_SCAN_X86
+    // the masks of the compare instructions have one bit per byte, the first match is the lowest set bit
+
+    __attribute__((target("sse2"))) const char *find_byte_sse2(const char *begin, const char *end, const char value)
+    {
+        const __m128i needle = _mm_set1_epi8(value);
+        for (; end - begin >= 16; begin += 16)
+        {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+            if (const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)))
+                return begin + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+        return std::find(begin, end, value);
+    }
+
+    __attribute__((target("sse2"))) __m128i blank_mask_sse2(const __m128i chunk)
+    {
+        const __m128i spaces = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+                                            _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t')));
+        const __m128i lineBreaks = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')),
+                                                _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')));
+        return _mm_or_si128(spaces, lineBreaks);
+    }
+
+    __attribute__((target("sse2"))) const char *skip_blanks_sse2(const char *begin, const char *end)
+    {
+        for (; end - begin >= 16; begin += 16)
+        {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+            const unsigned blanks = static_cast<unsigned>(_mm_movemask_epi8(blank_mask_sse2(chunk)));
+            if (blanks != 0xFFFF)
+                return begin + __builtin_ctz(~blanks);
+        }
+        return std::find_if_not(begin, end, is_blank);
+    }
+
+    __attribute__((target("sse2,popcnt"))) size_t count_byte_sse2(const char *begin, const char *end,
+                                                                    const char value)
+    {
+        const __m128i needle = _mm_set1_epi8(value);
+        size_t count = 0;
+        for (; end - begin >= 16; begin += 16)
+        {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+            count += static_cast<size_t>(
+                    __builtin_popcount(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)))));
+        }
+        return count + static_cast<size_t>(std::count(begin, end, value));
+    }
+
+    __attribute__((target("avx2"))) const char *find_byte_avx2(const char *begin, const char *end, const char value)
+    {
+        const __m256i needle = _mm256_set1_epi8(value);
+        for (; end - begin >= 32; begin += 32)
+        {
+            const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+            if (const auto mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle))))
+                return begin + __builtin_ctz(mask);
+        }
+        return find_byte_sse2(begin, end, value);
+    }
+
+    __attribute__((target("avx2"))) const char *skip_blanks_avx2(const char *begin, const char *end)
+    {
+        for (; end - begin >= 32; begin += 32)
+        {
+            const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+            const __m256i spaces = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')),
+                                                   _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t')));
+            const __m256i lineBreaks = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r')),
+                                                       _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n')));
+            const auto blanks = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_or_si256(spaces, lineBreaks)));
+            if (blanks != 0xFFFFFFFFu)
+                return begin + __builtin_ctz(~blanks);
+        }
+        return skip_blanks_sse2(begin, end);
+    }
+
+    __attribute__((target("avx2,popcnt"))) size_t count_byte_avx2(const char *begin, const char *end,
+                                                                    const char value)
+    {
+        const __m256i needle = _mm256_set1_epi8(value);
+        size_t count = 0;
+        for (; end - begin >= 32; begin += 32)
+        {
+            const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+            count += static_cast<size_t>(
+                    __builtin_popcount(static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle)))));
+        }
+        return count + count_byte_sse2(begin, end, value);
+    }
+#endif
+} // namespace
+
+std::vector<ScanFunctions> supported_scan_functions()
+{
+    std::vector<ScanFunctions> functions = {
+            {"portable", find_byte_portable, skip_blanks_portable, count_byte_portable}};
+#ifdef WIRTHX_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2") && __builtin_cpu_supports("popcnt"))
+        functions.push_back({"sse2", find_byte_sse2, skip_blanks_sse2, count_byte_sse2});
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+        functions.push_back({"avx2", find_byte_avx2, skip_blanks_avx2, count_byte_avx2});
+#endif
+    return functions;
+}
+
+const ScanFunctions &scan_functions()
+{
+    // a local static, so the lexer can already be used during the static initialization of other files
+    static const ScanFunctions selected = supported_scan_functions().back();
+    return selected;
+}
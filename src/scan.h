@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+/// Vectorized byte scans over source text. Every implementation handles the same ranges, the best one which is
+/// supported by the cpu (AVX2, SSE2 or the portable one) is selected once when the program starts.
+struct ScanFunctions
+{
+    std::string_view name;
+    /// returns the first position of the byte in [begin, end) or end if there is none
+    const char *(*findByte)(const char *begin, const char *end, char value);
+    /// returns the first position in [begin, end) which is no blank, tab, carriage return or line feed
+    const char *(*skipBlanks)(const char *begin, const char *end);
+    /// counts the occurrences of the byte in [begin, end)
+    size_t (*countByte)(const char *begin, const char *end, char value);
+};
+
+/// all implementations the cpu supports, the portable one is the first and the selected one is the last
+std::vector<ScanFunctions> supported_scan_functions();
+
+const ScanFunctions &scan_functions();
+
+inline const char *find_byte(const char *begin, const char *end, const char value)
+{
+    return scan_functions().findByte(begin, end, value);
+}
+
+inline const char *skip_blanks(const char *begin, const char *end) { return scan_functions().skipBlanks(begin, end); }
+
+inline size_t count_byte(const char *begin, const char *end, const char value)
+{
+    return scan_functions().countByte(begin, end, value);
+}
@@ -1,12 +1,26 @@
+#include "compiler/CompileServer.h"
 #include "compiler/Compiler.h"
 #include <algorithm>
 #include <fstream>
+#include <future>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <map>
 #include <string>
+#include <thread>
 #include <utility>
 
+#include "Parser.h"
+#include "ast/DoubleNode.h"
+#include "ast/MinusNode.h"
+#include "ast/NodeArena.h"
+#include "ast/SystemFunctionCallNode.h"
+#include "ast/types/RecordType.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/TargetParser/Host.h"
+#include "llvm/TargetParser/Triple.h"
 #include "os/command.h"
+#include "os/socket.h"
 
 using namespace std::literals;
 
@@ -241,13 +255,782 @@ TEST_P(WriteToStdErrTest, WriteToStdErrTest)
 }
 
 
+class JITTest : public testing::TestWithParam<std::string>
+{
+public:
+    static void SetUpTestSuite() { init_compiler(); }
+};
+
+TEST_P(JITTest, OutputMatchesCompiledProgram)
+{
+    std::filesystem::path base_path = "testfiles";
+    auto name = GetParam();
+    std::filesystem::path input_path = base_path / (name + ".pas");
+    std::filesystem::path output_path = base_path / (name + ".txt");
+    ASSERT_TRUE(std::filesystem::exists(input_path));
+    ASSERT_TRUE(std::filesystem::exists(output_path));
+    std::stringstream ostream;
+    std::stringstream erstream;
+    CompilerOptions options;
+    options.rtlDirectories.emplace_back("rtl");
+    options.option = CompileOption::JIT;
+    options.buildMode = BuildMode::Debug;
+    options.outputDirectory = std::filesystem::current_path();
+    const int exitCode = jit_file(options, input_path, erstream, ostream);
+
+    std::ifstream file(output_path);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    auto expected = buffer.str();
+    std::string result = ostream.str();
+    result.erase(std::ranges::remove(result, '\r').begin(), result.end());
+
+    ASSERT_EQ(erstream.str(), "");
+    ASSERT_EQ(result, expected);
+    ASSERT_EQ(exitCode, 0);
+}
+
+TEST(LinkerTest, ExternalCompilerDriver)
+{
+    init_compiler();
+    std::filesystem::path input_path = std::filesystem::path("testfiles") / "helloworld.pas";
+    std::filesystem::path output_path = std::filesystem::path("testfiles") / "helloworld.txt";
+    std::stringstream ostream;
+    std::stringstream erstream;
+    CompilerOptions options;
+    options.rtlDirectories.emplace_back("rtl");
+    options.runProgram = true;
+    options.buildMode = BuildMode::Release;
+#ifdef _WIN32
+    options.linker = "clang";
+#else
+    options.linker = "cc";
+#endif
+    options.outputDirectory = std::filesystem::current_path() / "external_linker";
+    std::filesystem::create_directories(options.outputDirectory);
+    compile_file(options, input_path, erstream, ostream);
+
+    std::ifstream file(output_path);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string result = ostream.str();
+    result.erase(std::ranges::remove(result, '\r').begin(), result.end());
+
+    ASSERT_EQ(erstream.str(), "");
+    ASSERT_EQ(result, buffer.str());
+}
+
+TEST(LinkerTest, EmbeddedLld)
+{
+#ifndef WIRTHX_HAS_LLD
+    GTEST_SKIP() << "the compiler is built without lld";
+#else
+    const llvm::Triple triple(llvm::sys::getProcessTriple());
+    if (!triple.isOSLinux() || !triple.isGNUEnvironment() ||
+        (triple.getArch() != llvm::Triple::x86_64 && triple.getArch() != llvm::Triple::aarch64))
+        GTEST_SKIP() << "lld only links in process for linux gnu targets";
+    init_compiler();
+    std::filesystem::path input_path = std::filesystem::path("testfiles") / "helloworld.pas";
+    std::filesystem::path output_path = std::filesystem::path("testfiles") / "helloworld.txt";
+    std::stringstream ostream;
+    std::stringstream erstream;
+    CompilerOptions options;
+    options.rtlDirectories.emplace_back("rtl");
+    options.runProgram = true;
+    // the sanitizer flags of debug builds need the compiler driver, a release build is linked by lld alone
+    options.buildMode = BuildMode::Release;
+    options.linker = "lld";
+    options.outputDirectory = std::filesystem::current_path() / "embedded_lld";
+    std::filesystem::create_directories(options.outputDirectory);
+    compile_file(options, input_path, erstream, ostream);
+
+    std::ifstream file(output_path);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    ASSERT_EQ(erstream.str(), "");
+    ASSERT_EQ(ostream.str(), buffer.str());
+
+    // lld records itself in the .comment section, the fallback to the compiler driver links with gold
+    std::ifstream executable(options.outputDirectory / "helloworld", std::ios::binary);
+    const std::string content((std::istreambuf_iterator<char>(executable)), std::istreambuf_iterator<char>());
+    EXPECT_NE(content.find("Linker: LLD"), std::string::npos) << "the program was not linked in process by lld";
+#endif
+}
+
+TEST(ParallelCodegenTest, SplitModuleProducesSameOutput)
+{
+    init_compiler();
+    std::filesystem::path input_path = std::filesystem::path("testfiles") / "functions.pas";
+    std::filesystem::path output_path = std::filesystem::path("testfiles") / "functions.txt";
+    std::stringstream ostream;
+    std::stringstream erstream;
+    CompilerOptions options;
+    options.rtlDirectories.emplace_back("rtl");
+    options.runProgram = true;
+    options.buildMode = BuildMode::Release;
+    options.optimizationLevel = OptimizationLevel::O3;
+    options.codegenThreads = 4;
+    options.outputDirectory = std::filesystem::current_path() / "parallel_codegen";
+    std::filesystem::create_directories(options.outputDirectory);
+    compile_file(options, input_path, erstream, ostream);
+
+    for (int i = 0; i < 4; ++i)
+        EXPECT_TRUE(std::filesystem::exists(options.outputDirectory / ("functions." + std::to_string(i) + ".o")));
+
+    std::ifstream file(output_path);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string result = ostream.str();
+    result.erase(std::ranges::remove(result, '\r').begin(), result.end());
+
+    ASSERT_EQ(erstream.str(), "");
+    ASSERT_EQ(result, buffer.str());
+}
+
+class SeparateUnitsTest : public testing::TestWithParam<std::string>
+{
+public:
+    static void SetUpTestSuite() { init_compiler(); }
+};
+
+TEST_P(SeparateUnitsTest, UnitsAreCompiledIntoCachedObjects)
+{
+    std::filesystem::path base_path = "testfiles";
+    auto name = GetParam();
+    std::filesystem::path input_path = base_path / (name + ".pas");
+    std::filesystem::path output_path = base_path / (name + ".txt");
+    ASSERT_TRUE(std::filesystem::exists(input_path));
+    ASSERT_TRUE(std::filesystem::exists(output_path));
+    CompilerOptions options;
+    options.rtlDirectories.emplace_back("rtl");
+    options.runProgram = true;
+    options.buildMode = BuildMode::Release;
+    options.separateUnits = true;
+    options.outputDirectory = std::filesystem::current_path() / ("separate_units_" + name);
+    std::filesystem::remove_all(options.outputDirectory);
+    std::filesystem::create_directories(options.outputDirectory);
+
+    std::ifstream file(output_path);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const auto expected = buffer.str();
+
+    std::map<std::filesystem::path, std::filesystem::file_time_type> cachedObjects;
+    for (int build = 0; build < 2; ++build)
+    {
+        std::stringstream ostream;
+        std::stringstream erstream;
+        compile_file(options, input_path, erstream, ostream);
+        std::string result = ostream.str();
+        result.erase(std::ranges::remove(result, '\r').begin(), result.end());
+        ASSERT_EQ(erstream.str(), "");
+        ASSERT_EQ(result, expected);
+
+        for (const auto &entry: std::filesystem::directory_iterator(options.outputDirectory / "unitcache"))
+        {
+            if (build == 0)
+                cachedObjects[entry.path()] = entry.last_write_time();
+            else
+                EXPECT_EQ(cachedObjects[entry.path()], entry.last_write_time()) << entry.path();
+        }
+    }
+    // at least the system unit is compiled separately
+    ASSERT_FALSE(cachedObjects.empty());
+}
+
+class UnitInterfaceTest : public testing::TestWithParam<std::string>
+{
+public:
+    static void SetUpTestSuite() { init_compiler(); }
+};
+
+TEST_P(UnitInterfaceTest, UnitsAreImportedFromPrecompiledInterfaces)
+{
+    std::filesystem::path base_path = "testfiles";
+    auto name = GetParam();
+    std::filesystem::path input_path = base_path / (name + ".pas");
+    std::filesystem::path output_path = base_path / (name + ".txt");
+    ASSERT_TRUE(std::filesystem::exists(input_path));
+    ASSERT_TRUE(std::filesystem::exists(output_path));
+    CompilerOptions options;
+    options.rtlDirectories.emplace_back("rtl");
+    options.runProgram = true;
+    options.buildMode = BuildMode::Release;
+    options.separateUnits = true;
+    options.outputDirectory = std::filesystem::current_path() / ("unit_interface_" + name);
+    std::filesystem::remove_all(options.outputDirectory);
+    std::filesystem::create_directories(options.outputDirectory);
+
+    std::ifstream file(output_path);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+
+    for (int build = 0; build < 2; ++build)
+    {
+        // without the units of the earlier build the second build has to load the written interfaces
+        Parser::clearUnitCache();
+        std::stringstream ostream;
+        std::stringstream erstream;
+        compile_file(options, input_path, erstream, ostream);
+        std::string result = ostream.str();
+        result.erase(std::ranges::remove(result, '\r').begin(), result.end());
+        ASSERT_EQ(erstream.str(), "");
+        ASSERT_EQ(result, buffer.str());
+    }
+
+    bool interfaceWritten = false;
+    for (const auto &entry: std::filesystem::directory_iterator(options.outputDirectory / "unitcache"))
+    {
+        interfaceWritten |= entry.path().extension() == ".wxi";
+    }
+    ASSERT_TRUE(interfaceWritten);
+}
+
+class UnitCacheTest : public testing::Test
+{
+public:
+    static void SetUpTestSuite() { init_compiler(); }
+};
+
+TEST_F(UnitCacheTest, ChangedIncludeFilesRebuildTheUnit)
+{
+    const auto directory = std::filesystem::current_path() / "unit_cache_includes";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const auto includePath = directory / "value.inc";
+    const auto writeInclude = [&](const int value)
+    {
+        std::ofstream include(includePath);
+        include << "        value := " << value << ";\n";
+    };
+    writeInclude(1);
+    {
+        std::ofstream unit(directory / "includeunit.pas");
+        unit << "unit includeunit;\ninterface\n    function value(): integer;\nimplementation\n"
+             << "    function value(): integer;\n    begin\n{$I value.inc}\n    end;\nend.";
+        std::ofstream program(directory / "includeprogram.pas");
+        program << "program includeprogram;\nuses includeunit;\nbegin\n    writeln(value());\nend.";
+    }
+    CompilerOptions options;
+    options.rtlDirectories.emplace_back("rtl");
+    options.runProgram = true;
+    options.separateUnits = true;
+    options.outputDirectory = directory;
+
+    for (const auto value: {1, 2})
+    {
+        if (value == 2)
+        {
+            // the unit source is unchanged, only the included file selects another object of the unit
+            writeInclude(value);
+            std::filesystem::last_write_time(includePath,
+                                             std::filesystem::last_write_time(includePath) + std::chrono::seconds(2));
+        }
+        std::stringstream ostream;
+        std::stringstream erstream;
+        compile_file(options, directory / "includeprogram.pas", erstream, ostream);
+        std::string result = ostream.str();
+        result.erase(std::ranges::remove(result, '\r').begin(), result.end());
+        ASSERT_EQ(erstream.str(), "");
+        ASSERT_EQ(result, std::to_string(value) + "\n");
+    }
+}
+
+class TimeReportTest : public testing::Test
+{
+public:
+    static void SetUpTestSuite() { init_compiler(); }
+};
+
+TEST_F(TimeReportTest, JsonReportContainsAllPhases)
+{
+    std::filesystem::path input_path = "testfiles/helloworld.pas";
+    CompilerOptions options;
+    options.rtlDirectories.emplace_back("rtl");
+    options.buildMode = BuildMode::Release;
+    options.timeReport = TimeReportFormat::Json;
+    options.outputDirectory = std::filesystem::current_path() / "time_report";
+    std::filesystem::remove_all(options.outputDirectory);
+    std::filesystem::create_directories(options.outputDirectory);
+
+    std::stringstream ostream;
+    std::stringstream erstream;
+    compile_file(options, input_path, erstream, ostream);
+    ASSERT_EQ(erstream.str(), "");
+
+    std::ifstream file(options.outputDirectory / "helloworld.time-report.json");
+    ASSERT_TRUE(file.is_open());
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    auto report = llvm::json::parse(buffer.str());
+    ASSERT_TRUE(static_cast<bool>(report)) << llvm::toString(report.takeError());
+
+    std::map<std::string, llvm::json::Object> phases;
+    for (const auto &phase: *report->getAsObject()->getArray("phases"))
+    {
+        phases.emplace(phase.getAsObject()->getString("name")->str(), *phase.getAsObject());
+    }
+    for (const auto &name: {"compile", "lex", "preprocess", "parse", "typecheck", "codegen", "optimize",
+                            "emit object", "link"})
+    {
+        EXPECT_TRUE(phases.contains(name)) << name;
+    }
+    EXPECT_GT(*phases["lex"].getObject("counters")->getInteger("tokens"), 0);
+    EXPECT_GT(*phases["codegen"].getObject("counters")->getInteger("ir instructions"), 0);
+    EXPECT_GT(*phases["compile"].getInteger("processPeakMemory"), 0);
+    EXPECT_FALSE(report->getAsObject()->getArray("passes")->empty());
+}
+
+class BatchCompileTest : public testing::Test
+{
+public:
+    static void SetUpTestSuite() { init_compiler(); }
+};
+
+TEST_F(BatchCompileTest, ParallelJobsKeepTheOrderOfTheInputFiles)
+{
+    const std::vector<std::string> names = {"helloworld", "includetest", "stringconv", "dynarray"};
+    std::vector<std::filesystem::path> inputPaths;
+    std::string expectedOutput;
+    for (const auto &name: names)
+    {
+        inputPaths.emplace_back(std::filesystem::path("testfiles") / (name + ".pas"));
+        std::ifstream file(std::filesystem::path("testfiles") / (name + ".txt"));
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        expectedOutput += buffer.str();
+    }
+    CompilerOptions options;
+    options.rtlDirectories.emplace_back("rtl");
+    options.runProgram = true;
+    options.buildMode = BuildMode::Release;
+    options.jobs = 4;
+    options.outputDirectory = std::filesystem::current_path() / "batch_compile";
+    std::filesystem::remove_all(options.outputDirectory);
+    std::filesystem::create_directories(options.outputDirectory);
+
+    std::stringstream ostream;
+    std::stringstream erstream;
+    ASSERT_TRUE(compile_files(options, inputPaths, erstream, ostream));
+    std::string result = ostream.str();
+    result.erase(std::ranges::remove(result, '\r').begin(), result.end());
+    ASSERT_EQ(erstream.str(), "");
+    ASSERT_EQ(result, expectedOutput);
+}
+
+class MacroDefinitionTest : public testing::Test
+{
+public:
+    static void SetUpTestSuite() { init_compiler(); }
+};
+
+TEST_F(MacroDefinitionTest, CommandLineDefinitionsSelectTheCompiledCode)
+{
+    const auto directory = std::filesystem::current_path() / "macro_definitions";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    {
+        std::ofstream program(directory / "macros.pas");
+        program << "program macros;\nbegin\n{$if LEVEL >= 2}\n    writeln('level 2');\n{$endif}\n"
+                << "{$ifdef Verbose}\n    writeln('verbose');\n{$else}\n    writeln('quiet');\n{$endif}\nend.";
+    }
+    std::vector<std::string> arguments = {"wirthx", "-DLEVEL=2", "-D", "VERBOSE", "--run", "--output",
+                                          directory.string(), (directory / "macros.pas").string()};
+    auto options = parseCompilerOptions(arguments);
+    ASSERT_EQ(options.macroDefinitions.size(), 2);
+    ASSERT_EQ(options.macroDefinitions[0], std::make_pair("LEVEL"s, "2"s));
+    ASSERT_EQ(options.macroDefinitions[1], std::make_pair("VERBOSE"s, "1"s));
+    options.rtlDirectories.emplace_back("rtl");
+
+    std::stringstream ostream;
+    std::stringstream erstream;
+    compile_file(options, arguments[0], erstream, ostream);
+    std::string result = ostream.str();
+    result.erase(std::ranges::remove(result, '\r').begin(), result.end());
+    ASSERT_EQ(erstream.str(), "");
+    ASSERT_EQ(result, "level 2\nverbose\n");
+}
+
+TEST_F(MacroDefinitionTest, UnitsAreCachedForEveryDefinition)
+{
+    const auto directory = std::filesystem::current_path() / "macro_units";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    {
+        std::ofstream unit(directory / "macrounit.pas");
+        unit << "unit macrounit;\ninterface\n    function value(): integer;\nimplementation\n"
+             << "    function value(): integer;\n    begin\n{$ifdef FAST}\n        value := 2;\n{$else}\n"
+             << "        value := 1;\n{$endif}\n    end;\nend.";
+        std::ofstream program(directory / "macroprogram.pas");
+        program << "program macroprogram;\nuses macrounit;\nbegin\n    writeln(value());\nend.";
+    }
+    CompilerOptions options;
+    options.rtlDirectories.emplace_back("rtl");
+    options.runProgram = true;
+    options.separateUnits = true;
+    options.outputDirectory = directory;
+
+    // the parsed unit and its cached object of one definition must not be used for the other one
+    for (const auto fast: {true, false, true})
+    {
+        options.macroDefinitions.clear();
+        if (fast)
+            options.macroDefinitions.emplace_back("FAST", "1");
+        std::stringstream ostream;
+        std::stringstream erstream;
+        compile_file(options, directory / "macroprogram.pas", erstream, ostream);
+        std::string result = ostream.str();
+        result.erase(std::ranges::remove(result, '\r').begin(), result.end());
+        ASSERT_EQ(erstream.str(), "");
+        ASSERT_EQ(result, fast ? "2\n" : "1\n");
+    }
+}
+
+class CompileServerTest : public testing::Test
+{
+public:
+    static void SetUpTestSuite() { init_compiler(); }
+};
+
+TEST_F(CompileServerTest, ServerRecompilesChangedUnits)
+{
+#ifdef _WIN32
+    GTEST_SKIP() << "the compile server is not supported on windows";
+#endif
+    const auto directory = std::filesystem::current_path() / "compile_server";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    // the socket is only used in a directory which other users can not write to
+    std::filesystem::permissions(directory, std::filesystem::perms::owner_all);
+    const auto unitPath = directory / "serverunit.pas";
+    const auto writeUnit = [&](const int value)
+    {
+        std::ofstream unit(unitPath);
+        unit << "unit serverunit;\ninterface\n    function value(): integer;\nimplementation\n"
+             << "    function value(): integer;\n    begin\n        value := " << value << ";\n    end;\nend.";
+    };
+    writeUnit(1);
+    {
+        std::ofstream program(directory / "serverprogram.pas");
+        program << "program serverprogram;\nuses serverunit;\nbegin\n    writeln(value());\nend.";
+    }
+
+    const auto socketPath = directory / "server.sock";
+    const auto rtlDirectory = std::filesystem::absolute("rtl");
+    std::thread server(
+            [&]
+            {
+                run_compile_server(
+                        socketPath,
+                        [&](std::vector<std::string> arguments, const std::filesystem::path &workingDirectory,
+                            std::ostream &outputStream, std::ostream &)
+                        {
+                            auto options = parseCompilerOptions(arguments, workingDirectory);
+                            options.rtlDirectories.push_back(rtlDirectory);
+                            compile_file(options, workingDirectory / arguments[0], outputStream, outputStream);
+                            return 0;
+                        },
+                        std::cerr);
+            });
+
+    // the relative paths of the request are resolved against the working directory of the client
+    const auto compile = [&](const std::string &outputDirectory)
+    {
+        const std::vector<std::string> arguments = {"wirthx", "--run", "--output", outputDirectory,
+                                                    "compile_server/serverprogram.pas"};
+        std::stringstream ostream;
+        std::stringstream erstream;
+        std::optional<int> exitCode;
+        for (int attempt = 0; attempt < 100 && !exitCode; ++attempt)
+        {
+            exitCode = forward_to_compile_server(socketPath, arguments, ostream, erstream);
+            if (!exitCode)
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        EXPECT_EQ(exitCode, 0);
+        EXPECT_EQ(erstream.str(), "");
+        return ostream.str();
+    };
+
+    EXPECT_NE(compile("compile_server").find("1\n"), std::string::npos);
+    // the cached unit of the first request has to be replaced by the changed unit
+    writeUnit(2);
+    std::filesystem::last_write_time(unitPath, std::filesystem::last_write_time(unitPath) + std::chrono::seconds(2));
+    EXPECT_NE(compile("compile_server").find("2\n"), std::string::npos);
+    // a client which does not send its request does not keep the server from accepting the next one
+    auto stalledClient = LocalSocket::connect(socketPath);
+    ASSERT_TRUE(stalledClient);
+    EXPECT_NE(compile("compile_server").find("2\n"), std::string::npos);
+    stalledClient.reset();
+    // concurrent requests are compiled on their own threads and get their own output
+    std::filesystem::create_directories(directory / "first");
+    std::filesystem::create_directories(directory / "second");
+    auto first = std::async(std::launch::async, compile, "compile_server/first");
+    auto second = std::async(std::launch::async, compile, "compile_server/second");
+    EXPECT_NE(first.get().find("2\n"), std::string::npos);
+    EXPECT_NE(second.get().find("2\n"), std::string::npos);
+
+    EXPECT_TRUE(stop_compile_server(socketPath));
+    server.join();
+    EXPECT_FALSE(std::filesystem::exists(socketPath));
+}
+
+TEST(LocalSocketTest, SocketsInSharedDirectoriesAreRejected)
+{
+#ifdef _WIN32
+    GTEST_SKIP() << "the compile server is not supported on windows";
+#endif
+    const auto directory = std::filesystem::current_path() / "shared_socket";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    std::filesystem::permissions(directory, std::filesystem::perms::owner_all | std::filesystem::perms::others_all);
+    const auto socketPath = directory / "server.sock";
+
+    std::string error;
+    EXPECT_FALSE(LocalServerSocket::listen(socketPath, error));
+    EXPECT_NE(error.find("writable by other users"), std::string::npos);
+    EXPECT_FALSE(LocalSocket::connect(socketPath));
+
+    // the directory of the default socket is created private to the user
+    std::filesystem::permissions(directory, std::filesystem::perms::owner_all);
+    const auto privateSocket = directory / "private" / "server.sock";
+    auto server = LocalServerSocket::listen(privateSocket, error);
+    ASSERT_TRUE(server) << error;
+    EXPECT_EQ(std::filesystem::status(privateSocket.parent_path()).permissions(), std::filesystem::perms::owner_all);
+    EXPECT_TRUE(LocalSocket::connect(privateSocket));
+}
+
+TEST(LocalSocketTest, ReadsFailAfterTheReceiveTimeout)
+{
+#ifdef _WIN32
+    GTEST_SKIP() << "the compile server is not supported on windows";
+#endif
+    const auto directory = std::filesystem::current_path() / "socket_timeout";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    std::filesystem::permissions(directory, std::filesystem::perms::owner_all);
+    const auto socketPath = directory / "server.sock";
+
+    std::string error;
+    auto server = LocalServerSocket::listen(socketPath, error);
+    ASSERT_TRUE(server) << error;
+    auto client = LocalSocket::connect(socketPath);
+    ASSERT_TRUE(client);
+    auto connection = server->accept();
+    ASSERT_TRUE(connection);
+    connection->setReceiveTimeout(std::chrono::milliseconds(100));
+    char data = 0;
+    EXPECT_FALSE(connection->read(&data, 1));
+}
+
+class OptimizationTest : public testing::Test
+{
+public:
+    static void SetUpTestSuite() { init_compiler(); }
+
+    static std::string compileToLLVMIR(const std::filesystem::path &inputPath, OptimizationLevel level,
+                                       const std::string &outputName)
+    {
+        std::stringstream ostream;
+        std::stringstream erstream;
+        CompilerOptions options;
+        options.rtlDirectories.emplace_back("rtl");
+        options.buildMode = BuildMode::Release;
+        options.optimizationLevel = level;
+        options.emitLLVMIR = true;
+        options.outputDirectory = std::filesystem::current_path() / outputName;
+        std::filesystem::create_directories(options.outputDirectory);
+        compile_file(options, inputPath, erstream, ostream);
+        EXPECT_EQ(erstream.str(), "");
+
+        std::ifstream file(options.outputDirectory / (inputPath.stem().string() + ".ll"));
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        return buffer.str();
+    }
+};
+
+TEST_F(OptimizationTest, HotLoopVariablesArePromotedToRegisters)
+{
+    const std::filesystem::path input_path = std::filesystem::path("projecteuler") / "problem10.pas";
+    ASSERT_TRUE(std::filesystem::exists(input_path));
+
+    const auto unoptimized = compileToLLVMIR(input_path, OptimizationLevel::O0, "opt_O0");
+    const auto optimized = compileToLLVMIR(input_path, OptimizationLevel::O2, "opt_O2");
+    ASSERT_FALSE(unoptimized.empty());
+    ASSERT_FALSE(optimized.empty());
+
+    // the sieve loop counters live on the stack without optimizations
+    EXPECT_NE(unoptimized.find("%k = alloca"), std::string::npos);
+    EXPECT_NE(unoptimized.find("%prime = alloca"), std::string::npos);
+
+    // SROA / mem2reg must have promoted them into registers
+    EXPECT_EQ(optimized.find("%k = alloca"), std::string::npos);
+    EXPECT_EQ(optimized.find("%prime = alloca"), std::string::npos);
+    EXPECT_LT(optimized.size(), unoptimized.size());
+}
+
+class TargetOptionsTest : public testing::Test
+{
+public:
+    static void SetUpTestSuite() { init_compiler(); }
+};
+
+TEST_F(TargetOptionsTest, FunctionsCarryTheTargetAttributes)
+{
+    if (llvm::Triple(llvm::sys::getDefaultTargetTriple()).getArch() != llvm::Triple::x86_64)
+        GTEST_SKIP() << "the cpu is only known for x86-64 targets";
+    std::stringstream ostream;
+    std::stringstream erstream;
+    CompilerOptions options;
+    options.rtlDirectories.emplace_back("rtl");
+    options.emitLLVMIR = true;
+    options.targetCPU = "x86-64-v3";
+    options.targetFeatures = "+avx2";
+    options.outputDirectory = std::filesystem::current_path() / "target_attributes";
+    std::filesystem::create_directories(options.outputDirectory);
+    EXPECT_TRUE(compile_file(options, "testfiles/helloworld.pas", erstream, ostream));
+    EXPECT_EQ(erstream.str(), "");
+
+    std::ifstream file(options.outputDirectory / "helloworld.ll");
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    EXPECT_NE(buffer.str().find("\"target-cpu\"=\"x86-64-v3\""), std::string::npos);
+    EXPECT_NE(buffer.str().find("\"target-features\"=\"+avx2\""), std::string::npos);
+}
+
+TEST_F(TargetOptionsTest, NativeResolvesToTheHostCpu)
+{
+    CompilerOptions options;
+    options.targetCPU = "native";
+    options.targetFeatures = "-avx512f";
+    const auto resolved = resolve_target_options(options);
+    EXPECT_EQ(resolved.targetCPU, llvm::sys::getHostCPUName().str());
+    // the requested features are applied after the detected ones, so they win
+    EXPECT_TRUE(resolved.targetFeatures.ends_with("-avx512f"));
+
+    options.targetCPU = "generic";
+    EXPECT_EQ(resolve_target_options(options).targetCPU, "generic");
+}
+
+TEST_F(TargetOptionsTest, UnknownCpusAreRejected)
+{
+    std::stringstream ostream;
+    std::stringstream erstream;
+    CompilerOptions options;
+    options.rtlDirectories.emplace_back("rtl");
+    options.targetCPU = "no-such-cpu";
+    options.outputDirectory = std::filesystem::current_path() / "unknown_cpu";
+    std::filesystem::create_directories(options.outputDirectory);
+    EXPECT_FALSE(compile_file(options, "testfiles/helloworld.pas", erstream, ostream));
+    EXPECT_NE(erstream.str().find("the cpu no-such-cpu is not known for the target"), std::string::npos);
+}
+
+TEST(TypeContextTest, StructuralTypesAreCanonical)
+{
+    EXPECT_EQ(VariableType::getInteger(16), VariableType::getInteger(16));
+    EXPECT_NE(VariableType::getInteger(16), VariableType::getInteger(32));
+    EXPECT_EQ(VariableType::getBoolean(), VariableType::getBoolean());
+
+    const auto record = std::make_shared<RecordType>(std::vector<VariableDefinition>{}, "TPoint");
+    EXPECT_EQ(PointerType::getPointerTo(record), PointerType::getPointerTo(record));
+    EXPECT_EQ(ArrayType::getFixedArray(1, 10, record), ArrayType::getFixedArray(1, 10, record));
+    EXPECT_NE(ArrayType::getFixedArray(1, 10, record), ArrayType::getFixedArray(0, 10, record));
+    EXPECT_EQ(ArrayType::getDynArray(record), ArrayType::getDynArray(record));
+    EXPECT_NE(ArrayType::getDynArray(record), ArrayType::getDynArray(VariableType::getInteger()));
+
+    // a record with the same name is another type
+    const auto otherRecord = std::make_shared<RecordType>(std::vector<VariableDefinition>{}, "TPoint");
+    EXPECT_NE(PointerType::getPointerTo(record), PointerType::getPointerTo(otherRecord));
+}
+
+TEST(NodeArenaTest, NodesAreCastByTheirKind)
+{
+    const auto arena = std::make_shared<NodeArena>();
+    const auto number = make_node<NumberNode>(*arena, Token(), 42, 64);
+    const std::shared_ptr<ASTNode> minus = make_node<MinusNode>(*arena, Token(), number);
+    const std::shared_ptr<ASTNode> call =
+            make_node<SystemFunctionCallNode>(*arena, Token(), "writeln", std::vector<std::shared_ptr<ASTNode>>{});
+    EXPECT_GT(arena->bytesAllocated(), sizeof(NumberNode) + sizeof(MinusNode) + sizeof(SystemFunctionCallNode));
+
+    // a minus node is a number node, the kinds of the subclasses are in the range of their base class
+    EXPECT_TRUE(isa<NumberNode>(minus));
+    EXPECT_TRUE(isa<MinusNode>(minus));
+    EXPECT_FALSE(isa<DoubleNode>(minus));
+    EXPECT_EQ(dyn_cast<NumberNode>(minus)->getValue(), -42);
+    EXPECT_FALSE(isa<MinusNode>(number));
+
+    EXPECT_TRUE(isa<FunctionCallNode>(call));
+    EXPECT_TRUE(isa<SystemFunctionCallNode>(call.get()));
+    EXPECT_EQ(dyn_cast<NumberNode>(call), nullptr);
+    EXPECT_EQ(cast<FunctionCallNode>(call)->name(), "writeln");
+    EXPECT_FALSE(isa<FunctionCallNode>(std::shared_ptr<ASTNode>()));
+
+    // the nodes do not own the arena, the unit which owns the nodes keeps it alive
+    EXPECT_EQ(arena.use_count(), 1);
+}
+
+TEST(NodeArenaTest, UnitsKeepTheArenasOfTheirImports)
+{
+    init_compiler();
+    const std::filesystem::path inputPath = "testfiles/helloworld.pas";
+    const auto sourceFile = SourceManager::instance().loadFile(inputPath);
+    ASSERT_TRUE(sourceFile.has_value());
+    Parser parser({"rtl"}, inputPath, MacroDefinitions(), *sourceFile);
+    parser.adoptFile(*sourceFile);
+    const auto unit = parser.parseFile();
+    ASSERT_FALSE(parser.hasError());
+    // the program shares the functions of the system unit, so it owns the arena of the system unit as well
+    EXPECT_GT(unit->arenas().size(), 1);
+    EXPECT_GT(unit->arenas().front()->bytesAllocated(), 0);
+}
+
+TEST(NodeArenaTest, ReleasedUnitsReleaseTheirSources)
+{
+    init_compiler();
+    const auto directory = std::filesystem::current_path() / "released_sources";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const auto unitPath = directory / "releasedunit.pas";
+    const auto programPath = directory / "releasedprogram.pas";
+    const auto writeSources = [&](const int value)
+    {
+        std::ofstream unit(unitPath);
+        unit << "unit releasedunit;\ninterface\n    function value(): integer;\nimplementation\n"
+             << "    function value(): integer;\n    begin\n        value := " << value << ";\n    end;\nend.";
+        std::ofstream program(programPath);
+        program << "program releasedprogram;\nuses releasedunit;\nbegin\n    writeln(value() + " << value << ");\nend.";
+    };
+    const auto parse = [&]
+    {
+        const auto sourceFile = SourceManager::instance().loadFile(programPath);
+        ASSERT_TRUE(sourceFile.has_value());
+        Parser parser({"rtl"}, programPath, MacroDefinitions(), *sourceFile);
+        parser.adoptFile(*sourceFile);
+        const auto unit = parser.parseFile();
+        EXPECT_FALSE(parser.hasError());
+    };
+
+    writeSources(1);
+    parse();
+    const auto fileCount = SourceManager::instance().fileCount();
+    // the program of the last parse and the replaced unit of the cache release their sources
+    writeSources(2);
+    std::filesystem::last_write_time(unitPath, std::filesystem::last_write_time(unitPath) + std::chrono::seconds(2));
+    parse();
+    EXPECT_EQ(SourceManager::instance().fileCount(), fileCount);
+}
+
+
 INSTANTIATE_TEST_SUITE_P(CompilerTestNoError, CompilerTest,
                          testing::Values("helloworld", "functions", "math", "includetest", "whileloop", "conditions",
                                          "forloop", "arraytest", "constantstest", "customint", "logicalcondition",
                                          "basicvec2", "dynarray", "externalfunction", "stringtest", "readfile",
                                          "repeatuntil", "stringcompare", "pointer_test", "rule110", "positive_assert",
                                          "stringconv", "singletest", "doubletest", "exittest", "stringreturn",
-                                         "enumtest", "rangetypetest", "casetest", "forintest"));
+                                         "enumtest", "rangetypetest", "casetest", "forintest",
+                                         "conditionalcompilation", "includefile", "overloads",
+                                         "nestedexpressions"));
 
 INSTANTIATE_TEST_SUITE_P(CompilerTestWithError, CompilerTestError,
                          testing::Values("arrayaccess", "missing_return_type", "wrong_return_type", "parsing_errors"));
@@ -256,4 +1039,15 @@ INSTANTIATE_TEST_SUITE_P(ProjectEuler, ProjectEulerTest,
                          testing::Values("problem1", "problem2", "problem3", "problem4", "problem5", "problem6",
                                          "problem7", "problem8", "problem9", "problem10"));
 
+INSTANTIATE_TEST_SUITE_P(JIT, JITTest,
+                         testing::Values("helloworld", "functions", "math", "whileloop", "conditions", "forloop",
+                                         "arraytest", "dynarray", "externalfunction", "stringtest", "readfile",
+                                         "stringcompare", "pointer_test", "rule110", "exittest", "casetest"));
+
+INSTANTIATE_TEST_SUITE_P(SeparateUnits, SeparateUnitsTest,
+                         testing::Values("helloworld", "includetest", "stringconv", "stringtest"));
+
+INSTANTIATE_TEST_SUITE_P(UnitInterfaces, UnitInterfaceTest,
+                         testing::Values("helloworld", "includetest", "stringconv"));
+
 INSTANTIATE_TEST_SUITE_P(WriteToStdErrTest, WriteToStdErrTest, testing::Values("writetoerror"));
@@ -0,0 +1,59 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "Lexer.h"
+
+/// generates a program with a mix of keywords, identifiers, numbers, strings and comments of roughly the given size
+static std::string generate_source(const size_t size)
+{
+    std::string source = "program benchmark;\n";
+    source.reserve(size + 256);
+    for (size_t i = 0; source.size() < size; ++i)
+    {
+        const auto index = std::to_string(i);
+        source += "{ procedure number " + index + " }\n";
+        source += "procedure Proc" + index + "(value : integer; var result : string);\n";
+        source += "var\n    counter, total_" + index + " : integer;\n";
+        source += "begin\n";
+        source += "    total_" + index + " := value * 42 - 17 div 3;\n";
+        source += "    for counter := 1 to value do\n";
+        source += "        if (counter mod 2 = 0) and not (counter > 100) then\n";
+        source += "            total_" + index + " := total_" + index + " + counter // even numbers\n";
+        source += "        else\n";
+        source += "            result := 'odd number ' + #13#10 + 'it''s fine';\n";
+        source += "    writeln(total_" + index + ", 3.1415);\n";
+        source += "end;\n\n";
+    }
+    source += "begin\nend.\n";
+    return source;
+}
+
+int main(int argc, char **argv)
+{
+    using Clock = std::chrono::steady_clock;
+    const size_t megabytes = argc > 1 ? std::max(1, std::atoi(argv[1])) : 16;
+    const int iterations = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+
+    const auto source = generate_source(megabytes * 1024 * 1024);
+    double bestSeconds = 0;
+    size_t tokenCount = 0;
+    for (int i = 0; i < iterations; ++i)
+    {
+        Lexer lexer;
+        const auto start = Clock::now();
+        const auto tokens = lexer.tokenize("benchmark.pas", source);
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        tokenCount = tokens.size();
+        if (i == 0 || seconds < bestSeconds)
+            bestSeconds = seconds;
+    }
+
+    const double sourceMegabytes = static_cast<double>(source.size()) / (1024.0 * 1024.0);
+    std::cout << std::fixed << std::setprecision(2) << "lexed " << sourceMegabytes << " MiB into " << tokenCount
+              << " tokens in " << bestSeconds * 1000.0 << " ms: " << sourceMegabytes / bestSeconds << " MiB/s, "
+              << static_cast<double>(tokenCount) / bestSeconds / 1e6 << " Mtokens/s\n";
+    return 0;
+}
@@ -1,7 +1,13 @@
 #include "Lexer.h"
+#include <filesystem>
+#include <fstream>
+#include <random>
 #include <gtest/gtest.h>
 #include <magic_enum/magic_enum.hpp>
 #include <string>
+#include "SymbolTable.h"
+#include "TokenStream.h"
+#include "scan.h"
 using namespace std::literals;
 
 
@@ -17,9 +23,9 @@ TEST(LexerTest, LexHelloWorld)
     end.)");
 
     EXPECT_EQ(result.size(), 12);
-    ASSERT_EQ(result[0].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[0].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[0].lexical(), "program"sv);
-    ASSERT_EQ(result[1].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[1].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[1].lexical(), "Test"sv);
 }
 
@@ -30,29 +36,29 @@ TEST(LexerTest, LexNumbers)
     auto result = lexer.tokenize("filename.pas", R"(x := (1 + 2) * 5;)");
 
     EXPECT_EQ(result.size(), 12);
-    ASSERT_EQ(result[0].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[0].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[0].lexical(), "x"sv);
-    ASSERT_EQ(result[1].tokenType, TokenType::COLON);
+    ASSERT_EQ(result[1].tokenType(), TokenType::COLON);
     ASSERT_EQ(result[1].lexical(), ":"sv);
-    ASSERT_EQ(result[2].tokenType, TokenType::EQUAL);
+    ASSERT_EQ(result[2].tokenType(), TokenType::EQUAL);
     ASSERT_EQ(result[2].lexical(), "="sv);
-    ASSERT_EQ(result[3].tokenType, TokenType::LEFT_CURLY);
+    ASSERT_EQ(result[3].tokenType(), TokenType::LEFT_CURLY);
     ASSERT_EQ(result[3].lexical(), "("sv);
-    ASSERT_EQ(result[4].tokenType, TokenType::NUMBER);
+    ASSERT_EQ(result[4].tokenType(), TokenType::NUMBER);
     ASSERT_EQ(result[4].lexical(), "1"sv);
-    ASSERT_EQ(result[5].tokenType, TokenType::PLUS);
+    ASSERT_EQ(result[5].tokenType(), TokenType::PLUS);
     ASSERT_EQ(result[5].lexical(), "+"sv);
-    ASSERT_EQ(result[6].tokenType, TokenType::NUMBER);
+    ASSERT_EQ(result[6].tokenType(), TokenType::NUMBER);
     ASSERT_EQ(result[6].lexical(), "2"sv);
-    ASSERT_EQ(result[7].tokenType, TokenType::RIGHT_CURLY);
+    ASSERT_EQ(result[7].tokenType(), TokenType::RIGHT_CURLY);
     ASSERT_EQ(result[7].lexical(), ")"sv);
-    ASSERT_EQ(result[8].tokenType, TokenType::MUL);
+    ASSERT_EQ(result[8].tokenType(), TokenType::MUL);
     ASSERT_EQ(result[8].lexical(), "*"sv);
-    ASSERT_EQ(result[9].tokenType, TokenType::NUMBER);
+    ASSERT_EQ(result[9].tokenType(), TokenType::NUMBER);
     ASSERT_EQ(result[9].lexical(), "5"sv);
-    ASSERT_EQ(result[10].tokenType, TokenType::SEMICOLON);
+    ASSERT_EQ(result[10].tokenType(), TokenType::SEMICOLON);
     ASSERT_EQ(result[10].lexical(), ";"sv);
-    ASSERT_EQ(result[11].tokenType, TokenType::T_EOF);
+    ASSERT_EQ(result[11].tokenType(), TokenType::T_EOF);
 }
 
 TEST(LexerTest, LexNegNumbers)
@@ -62,29 +68,29 @@ TEST(LexerTest, LexNegNumbers)
     auto result = lexer.tokenize("filename.pas", R"(x := (-1 + 2) * -5;)");
 
     EXPECT_EQ(result.size(), 12);
-    ASSERT_EQ(result[0].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[0].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[0].lexical(), "x"sv);
-    ASSERT_EQ(result[1].tokenType, TokenType::COLON);
+    ASSERT_EQ(result[1].tokenType(), TokenType::COLON);
     ASSERT_EQ(result[1].lexical(), ":"sv);
-    ASSERT_EQ(result[2].tokenType, TokenType::EQUAL);
+    ASSERT_EQ(result[2].tokenType(), TokenType::EQUAL);
     ASSERT_EQ(result[2].lexical(), "="sv);
-    ASSERT_EQ(result[3].tokenType, TokenType::LEFT_CURLY);
+    ASSERT_EQ(result[3].tokenType(), TokenType::LEFT_CURLY);
     ASSERT_EQ(result[3].lexical(), "("sv);
-    ASSERT_EQ(result[4].tokenType, TokenType::NUMBER);
+    ASSERT_EQ(result[4].tokenType(), TokenType::NUMBER);
     ASSERT_EQ(result[4].lexical(), "-1"sv);
-    ASSERT_EQ(result[5].tokenType, TokenType::PLUS);
+    ASSERT_EQ(result[5].tokenType(), TokenType::PLUS);
     ASSERT_EQ(result[5].lexical(), "+"sv);
-    ASSERT_EQ(result[6].tokenType, TokenType::NUMBER);
+    ASSERT_EQ(result[6].tokenType(), TokenType::NUMBER);
     ASSERT_EQ(result[6].lexical(), "2"sv);
-    ASSERT_EQ(result[7].tokenType, TokenType::RIGHT_CURLY);
+    ASSERT_EQ(result[7].tokenType(), TokenType::RIGHT_CURLY);
     ASSERT_EQ(result[7].lexical(), ")"sv);
-    ASSERT_EQ(result[8].tokenType, TokenType::MUL);
+    ASSERT_EQ(result[8].tokenType(), TokenType::MUL);
     ASSERT_EQ(result[8].lexical(), "*"sv);
-    ASSERT_EQ(result[9].tokenType, TokenType::NUMBER);
+    ASSERT_EQ(result[9].tokenType(), TokenType::NUMBER);
     ASSERT_EQ(result[9].lexical(), "-5"sv);
-    ASSERT_EQ(result[10].tokenType, TokenType::SEMICOLON);
+    ASSERT_EQ(result[10].tokenType(), TokenType::SEMICOLON);
     ASSERT_EQ(result[10].lexical(), ";"sv);
-    ASSERT_EQ(result[11].tokenType, TokenType::T_EOF);
+    ASSERT_EQ(result[11].tokenType(), TokenType::T_EOF);
 }
 
 TEST(LexerTest, LexVarDeclaration)
@@ -94,17 +100,17 @@ TEST(LexerTest, LexVarDeclaration)
     auto result = lexer.tokenize("filename.pas", R"(var x :integer;)");
 
     EXPECT_EQ(result.size(), 6);
-    ASSERT_EQ(result[0].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[0].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[0].lexical(), "var"sv);
-    ASSERT_EQ(result[1].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[1].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[1].lexical(), "x"sv);
-    ASSERT_EQ(result[2].tokenType, TokenType::COLON);
+    ASSERT_EQ(result[2].tokenType(), TokenType::COLON);
     ASSERT_EQ(result[2].lexical(), ":"sv);
-    ASSERT_EQ(result[3].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[3].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[3].lexical(), "integer"sv);
-    ASSERT_EQ(result[4].tokenType, TokenType::SEMICOLON);
+    ASSERT_EQ(result[4].tokenType(), TokenType::SEMICOLON);
     ASSERT_EQ(result[4].lexical(), ";"sv);
-    ASSERT_EQ(result[5].tokenType, TokenType::T_EOF);
+    ASSERT_EQ(result[5].tokenType(), TokenType::T_EOF);
 }
 
 TEST(LexerTest, LexProcedureDeclaration)
@@ -117,23 +123,23 @@ TEST(LexerTest, LexProcedureDeclaration)
     END;)");
 
     EXPECT_EQ(result.size(), 7);
-    ASSERT_EQ(result[0].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[0].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[0].lexical(), "procedure"sv);
-    ASSERT_EQ(result[0].row, 1);
-    ASSERT_EQ(result[1].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[0].row(), 1);
+    ASSERT_EQ(result[1].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[1].lexical(), "MyProc"sv);
-    ASSERT_EQ(result[2].tokenType, TokenType::SEMICOLON);
+    ASSERT_EQ(result[2].tokenType(), TokenType::SEMICOLON);
     ASSERT_EQ(result[2].lexical(), ";"sv);
-    ASSERT_EQ(result[3].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[3].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[3].lexical(), "Begin"sv);
-    ASSERT_EQ(result[3].row, 2);
-    ASSERT_EQ(result[4].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[3].row(), 2);
+    ASSERT_EQ(result[4].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[4].lexical(), "END"sv);
-    ASSERT_EQ(result[4].row, 4);
-    ASSERT_EQ(result[5].tokenType, TokenType::SEMICOLON);
+    ASSERT_EQ(result[4].row(), 4);
+    ASSERT_EQ(result[5].tokenType(), TokenType::SEMICOLON);
     ASSERT_EQ(result[5].lexical(), ";"sv);
 
-    ASSERT_EQ(result[6].tokenType, TokenType::T_EOF);
+    ASSERT_EQ(result[6].tokenType(), TokenType::T_EOF);
 }
 
 TEST(LexerTest, LexProcedureDeclarationWithArgs)
@@ -146,41 +152,41 @@ TEST(LexerTest, LexProcedureDeclarationWithArgs)
     END;)");
 
     EXPECT_EQ(result.size(), 16);
-    ASSERT_EQ(result[0].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[0].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[0].lexical(), "procedure"sv);
-    ASSERT_EQ(result[1].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[1].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[1].lexical(), "MyProc"sv);
-    ASSERT_EQ(result[2].tokenType, TokenType::LEFT_CURLY);
+    ASSERT_EQ(result[2].tokenType(), TokenType::LEFT_CURLY);
     ASSERT_EQ(result[2].lexical(), "("sv);
-    ASSERT_EQ(result[3].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[3].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[3].lexical(), "arg1"sv);
-    ASSERT_EQ(result[4].tokenType, TokenType::COLON);
+    ASSERT_EQ(result[4].tokenType(), TokenType::COLON);
     ASSERT_EQ(result[4].lexical(), ":"sv);
-    ASSERT_EQ(result[5].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[5].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[5].lexical(), "integer"sv);
-    ASSERT_EQ(result[6].tokenType, TokenType::SEMICOLON);
+    ASSERT_EQ(result[6].tokenType(), TokenType::SEMICOLON);
     ASSERT_EQ(result[6].lexical(), ";"sv);
 
-    ASSERT_EQ(result[7].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[7].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[7].lexical(), "arg2"sv);
-    ASSERT_EQ(result[8].tokenType, TokenType::COLON);
+    ASSERT_EQ(result[8].tokenType(), TokenType::COLON);
     ASSERT_EQ(result[8].lexical(), ":"sv);
-    ASSERT_EQ(result[9].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[9].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[9].lexical(), "real"sv);
-    ASSERT_EQ(result[10].tokenType, TokenType::RIGHT_CURLY);
+    ASSERT_EQ(result[10].tokenType(), TokenType::RIGHT_CURLY);
     ASSERT_EQ(result[10].lexical(), ")"sv);
 
-    ASSERT_EQ(result[11].tokenType, TokenType::SEMICOLON);
+    ASSERT_EQ(result[11].tokenType(), TokenType::SEMICOLON);
     ASSERT_EQ(result[11].lexical(), ";"sv);
-    ASSERT_EQ(result[12].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[12].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[12].lexical(), "Begin"sv);
 
-    ASSERT_EQ(result[13].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[13].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[13].lexical(), "END"sv);
-    ASSERT_EQ(result[14].tokenType, TokenType::SEMICOLON);
+    ASSERT_EQ(result[14].tokenType(), TokenType::SEMICOLON);
     ASSERT_EQ(result[14].lexical(), ";"sv);
 
-    ASSERT_EQ(result[15].tokenType, TokenType::T_EOF);
+    ASSERT_EQ(result[15].tokenType(), TokenType::T_EOF);
 }
 
 TEST(LexerTest, LexFunctionDeclaration)
@@ -195,38 +201,38 @@ TEST(LexerTest, LexFunctionDeclaration)
     END;)");
 
     EXPECT_EQ(result.size(), 14);
-    ASSERT_EQ(result[0].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[0].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[0].lexical(), "function"sv);
-    ASSERT_EQ(result[1].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[1].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[1].lexical(), "MyFunc"sv);
-    ASSERT_EQ(result[2].tokenType, TokenType::COLON);
+    ASSERT_EQ(result[2].tokenType(), TokenType::COLON);
     ASSERT_EQ(result[2].lexical(), ":"sv);
-    ASSERT_EQ(result[3].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[3].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[3].lexical(), "integer"sv);
 
-    ASSERT_EQ(result[4].tokenType, TokenType::SEMICOLON);
+    ASSERT_EQ(result[4].tokenType(), TokenType::SEMICOLON);
     ASSERT_EQ(result[4].lexical(), ";"sv);
-    ASSERT_EQ(result[5].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[5].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[5].lexical(), "Begin"sv);
-    ASSERT_EQ(result[6].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[6].tokenType(), TokenType::NAMEDTOKEN);
 
     ASSERT_EQ(result[6].lexical(), "MyFunc"sv);
-    ASSERT_EQ(result[7].tokenType, TokenType::COLON);
+    ASSERT_EQ(result[7].tokenType(), TokenType::COLON);
     ASSERT_EQ(result[7].lexical(), ":"sv);
-    ASSERT_EQ(result[8].tokenType, TokenType::EQUAL);
+    ASSERT_EQ(result[8].tokenType(), TokenType::EQUAL);
     ASSERT_EQ(result[8].lexical(), "="sv);
-    ASSERT_EQ(result[9].tokenType, TokenType::NUMBER);
+    ASSERT_EQ(result[9].tokenType(), TokenType::NUMBER);
     ASSERT_EQ(result[9].lexical(), "100"sv);
-    ASSERT_EQ(result[10].tokenType, TokenType::SEMICOLON);
+    ASSERT_EQ(result[10].tokenType(), TokenType::SEMICOLON);
     ASSERT_EQ(result[10].lexical(), ";"sv);
-    ASSERT_EQ(result[11].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[11].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[11].lexical(), "END"sv);
-    ASSERT_EQ(result[11].row, 6);
-    ASSERT_EQ(result[12].tokenType, TokenType::SEMICOLON);
+    ASSERT_EQ(result[11].row(), 6);
+    ASSERT_EQ(result[12].tokenType(), TokenType::SEMICOLON);
     ASSERT_EQ(result[12].lexical(), ";"sv);
-    ASSERT_EQ(result[12].row, 6);
+    ASSERT_EQ(result[12].row(), 6);
 
-    ASSERT_EQ(result[13].tokenType, TokenType::T_EOF);
+    ASSERT_EQ(result[13].tokenType(), TokenType::T_EOF);
 }
 TEST(LexerTest, LexQuotedString)
 {
@@ -235,13 +241,13 @@ TEST(LexerTest, LexQuotedString)
     auto result = lexer.tokenize("filename.pas", R"(str4 := 'this is a ''quoted'' string'; )");
 
     EXPECT_EQ(result.size(), 6);
-    ASSERT_EQ(result[0].tokenType, TokenType::NAMEDTOKEN);
-    ASSERT_EQ(result[1].tokenType, TokenType::COLON);
-    ASSERT_EQ(result[2].tokenType, TokenType::EQUAL);
-    ASSERT_EQ(result[3].tokenType, TokenType::STRING);
+    ASSERT_EQ(result[0].tokenType(), TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[1].tokenType(), TokenType::COLON);
+    ASSERT_EQ(result[2].tokenType(), TokenType::EQUAL);
+    ASSERT_EQ(result[3].tokenType(), TokenType::STRING);
     ASSERT_EQ(result[3].lexical(), "this is a ''quoted'' string"s);
-    ASSERT_EQ(result[4].tokenType, TokenType::SEMICOLON);
-    ASSERT_EQ(result[5].tokenType, TokenType::T_EOF);
+    ASSERT_EQ(result[4].tokenType(), TokenType::SEMICOLON);
+    ASSERT_EQ(result[5].tokenType(), TokenType::T_EOF);
 }
 
 
@@ -253,13 +259,13 @@ TEST(LexerTest, LexEscapedString)
     auto result = lexer.tokenize("filename.pas", R"(str4 := #13#10; )");
 
     EXPECT_EQ(result.size(), 6);
-    ASSERT_EQ(result[0].tokenType, TokenType::NAMEDTOKEN);
-    ASSERT_EQ(result[1].tokenType, TokenType::COLON);
-    ASSERT_EQ(result[2].tokenType, TokenType::EQUAL);
-    ASSERT_EQ(result[3].tokenType, TokenType::ESCAPED_STRING);
+    ASSERT_EQ(result[0].tokenType(), TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[1].tokenType(), TokenType::COLON);
+    ASSERT_EQ(result[2].tokenType(), TokenType::EQUAL);
+    ASSERT_EQ(result[3].tokenType(), TokenType::ESCAPED_STRING);
     ASSERT_EQ(result[3].lexical(), "#13#10"sv);
-    ASSERT_EQ(result[4].tokenType, TokenType::SEMICOLON);
-    ASSERT_EQ(result[5].tokenType, TokenType::T_EOF);
+    ASSERT_EQ(result[4].tokenType(), TokenType::SEMICOLON);
+    ASSERT_EQ(result[5].tokenType(), TokenType::T_EOF);
 }
 
 TEST(LexerTest, LexPointer)
@@ -269,18 +275,18 @@ TEST(LexerTest, LexPointer)
     auto result = lexer.tokenize("filename.pas", R"(ptr := @myvar; )");
 
     EXPECT_EQ(result.size(), 7);
-    ASSERT_EQ(result[0].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[0].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[0].lexical(), "ptr"sv);
-    ASSERT_EQ(result[1].tokenType, TokenType::COLON);
-    ASSERT_EQ(result[2].tokenType, TokenType::EQUAL);
-    ASSERT_EQ(result[3].tokenType, TokenType::AT);
-    ASSERT_EQ(result[3].col, 8);
+    ASSERT_EQ(result[1].tokenType(), TokenType::COLON);
+    ASSERT_EQ(result[2].tokenType(), TokenType::EQUAL);
+    ASSERT_EQ(result[3].tokenType(), TokenType::AT);
+    ASSERT_EQ(result[3].col(), 8);
     ASSERT_EQ(result[3].lexical(), "@"sv);
-    ASSERT_EQ(result[4].tokenType, TokenType::NAMEDTOKEN);
-    ASSERT_EQ(result[4].col, 9);
+    ASSERT_EQ(result[4].tokenType(), TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[4].col(), 9);
     ASSERT_EQ(result[4].lexical(), "myvar"sv);
-    ASSERT_EQ(result[5].tokenType, TokenType::SEMICOLON);
-    ASSERT_EQ(result[6].tokenType, TokenType::T_EOF);
+    ASSERT_EQ(result[5].tokenType(), TokenType::SEMICOLON);
+    ASSERT_EQ(result[6].tokenType(), TokenType::T_EOF);
 }
 
 TEST(LexerTest, LexUnit)
@@ -306,40 +312,40 @@ TEST(LexerTest, LexUnit)
  end.)");
 
     EXPECT_EQ(result.size(), 16);
-    ASSERT_EQ(result[0].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[0].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[0].lexical(), "unit"sv);
-    ASSERT_EQ(result[1].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[1].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[1].lexical(), "unitname"sv);
-    ASSERT_EQ(result[2].tokenType, TokenType::SEMICOLON);
+    ASSERT_EQ(result[2].tokenType(), TokenType::SEMICOLON);
     ASSERT_EQ(result[2].lexical(), ";"sv);
-    ASSERT_EQ(result[3].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[3].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[3].lexical(), "interface"sv);
-    ASSERT_EQ(result[4].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[4].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[4].lexical(), "uses"sv);
-    ASSERT_EQ(result[5].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[5].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[5].lexical(), "myimport"sv);
-    ASSERT_EQ(result[6].tokenType, TokenType::SEMICOLON);
+    ASSERT_EQ(result[6].tokenType(), TokenType::SEMICOLON);
     ASSERT_EQ(result[6].lexical(), ";"sv);
 
-    ASSERT_EQ(result[7].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[7].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[7].lexical(), "implementation"sv);
-    ASSERT_EQ(result[8].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[8].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[8].lexical(), "uses"sv);
-    ASSERT_EQ(result[9].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[9].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[9].lexical(), "import2"sv);
-    ASSERT_EQ(result[10].tokenType, TokenType::SEMICOLON);
+    ASSERT_EQ(result[10].tokenType(), TokenType::SEMICOLON);
     ASSERT_EQ(result[10].lexical(), ";"sv);
-    ASSERT_EQ(result[11].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[11].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[11].lexical(), "initialization"sv);
-    ASSERT_EQ(result[12].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[12].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[12].lexical(), "finalization"sv);
 
-    ASSERT_EQ(result[13].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[13].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[13].lexical(), "end"sv);
-    ASSERT_EQ(result[14].tokenType, TokenType::DOT);
+    ASSERT_EQ(result[14].tokenType(), TokenType::DOT);
     ASSERT_EQ(result[14].lexical(), "."sv);
 
-    ASSERT_EQ(result[15].tokenType, TokenType::T_EOF);
+    ASSERT_EQ(result[15].tokenType(), TokenType::T_EOF);
 }
 
 
@@ -355,21 +361,21 @@ TEST(LexerTest, LexMacroSimple)
 )");
 
     EXPECT_EQ(result.size(), 8);
-    ASSERT_EQ(result[0].tokenType, TokenType::MACRO_START);
+    ASSERT_EQ(result[0].tokenType(), TokenType::MACRO_START);
     ASSERT_EQ(result[0].lexical(), "{$"sv);
-    ASSERT_EQ(result[1].tokenType, TokenType::MACROKEYWORD);
+    ASSERT_EQ(result[1].tokenType(), TokenType::MACROKEYWORD);
     ASSERT_EQ(result[1].lexical(), "ifdef"sv);
-    ASSERT_EQ(result[2].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[2].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[2].lexical(), "UNIX"sv);
-    ASSERT_EQ(result[3].tokenType, TokenType::MACRO_END);
-    ASSERT_EQ(result[4].tokenType, TokenType::MACRO_START);
+    ASSERT_EQ(result[3].tokenType(), TokenType::MACRO_END);
+    ASSERT_EQ(result[4].tokenType(), TokenType::MACRO_START);
     ASSERT_EQ(result[4].lexical(), "{$"sv);
-    ASSERT_EQ(result[5].tokenType, TokenType::MACROKEYWORD);
+    ASSERT_EQ(result[5].tokenType(), TokenType::MACROKEYWORD);
     ASSERT_EQ(result[5].lexical(), "endif"sv);
-    ASSERT_EQ(result[6].tokenType, TokenType::MACRO_END);
+    ASSERT_EQ(result[6].tokenType(), TokenType::MACRO_END);
 
 
-    ASSERT_EQ(result[7].tokenType, TokenType::T_EOF);
+    ASSERT_EQ(result[7].tokenType(), TokenType::T_EOF);
 }
 
 
@@ -385,64 +391,64 @@ begin
 end.)");
 
     EXPECT_EQ(result.size(), 26);
-    ASSERT_EQ(result[0].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[0].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[0].lexical(), "program"sv);
 
-    ASSERT_EQ(result[1].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[1].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[1].lexical(), "test"sv);
 
-    ASSERT_EQ(result[2].tokenType, TokenType::SEMICOLON);
+    ASSERT_EQ(result[2].tokenType(), TokenType::SEMICOLON);
     ASSERT_EQ(result[2].lexical(), ";"sv);
 
-    ASSERT_EQ(result[3].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[3].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[3].lexical(), "begin"sv);
 
-    ASSERT_EQ(result[4].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[4].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[4].lexical(), "for"sv);
 
 
-    ASSERT_EQ(result[5].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[5].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[5].lexical(), "i"sv);
-    ASSERT_EQ(result[5].row, 3);
-    ASSERT_EQ(result[5].col, 9);
+    ASSERT_EQ(result[5].row(), 3);
+    ASSERT_EQ(result[5].col(), 9);
 
-    ASSERT_EQ(result[6].tokenType, TokenType::COLON);
+    ASSERT_EQ(result[6].tokenType(), TokenType::COLON);
     ASSERT_EQ(result[6].lexical(), ":"sv);
-    ASSERT_EQ(result[6].row, 3);
-    ASSERT_EQ(result[6].col, 11);
+    ASSERT_EQ(result[6].row(), 3);
+    ASSERT_EQ(result[6].col(), 11);
 
-    ASSERT_EQ(result[7].tokenType, TokenType::EQUAL);
+    ASSERT_EQ(result[7].tokenType(), TokenType::EQUAL);
     ASSERT_EQ(result[7].lexical(), "="sv);
-    ASSERT_EQ(result[7].row, 3);
-    ASSERT_EQ(result[7].col, 12);
+    ASSERT_EQ(result[7].row(), 3);
+    ASSERT_EQ(result[7].col(), 12);
 
-    ASSERT_EQ(result[8].tokenType, TokenType::NUMBER);
+    ASSERT_EQ(result[8].tokenType(), TokenType::NUMBER);
     ASSERT_EQ(result[8].lexical(), "0"sv);
-    ASSERT_EQ(result[8].row, 3);
-    ASSERT_EQ(result[8].col, 14);
+    ASSERT_EQ(result[8].row(), 3);
+    ASSERT_EQ(result[8].col(), 14);
 
-    ASSERT_EQ(result[9].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[9].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[9].lexical(), "to"sv);
-    ASSERT_EQ(result[9].row, 3);
-    ASSERT_EQ(result[9].col, 16);
+    ASSERT_EQ(result[9].row(), 3);
+    ASSERT_EQ(result[9].col(), 16);
 
-    ASSERT_EQ(result[10].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[10].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[10].lexical(), "high"sv);
-    ASSERT_EQ(result[10].row, 3);
-    ASSERT_EQ(result[10].col, 19);
+    ASSERT_EQ(result[10].row(), 3);
+    ASSERT_EQ(result[10].col(), 19);
 
-    ASSERT_EQ(result[11].tokenType, TokenType::LEFT_CURLY);
+    ASSERT_EQ(result[11].tokenType(), TokenType::LEFT_CURLY);
     ASSERT_EQ(result[11].lexical(), "("sv);
-    ASSERT_EQ(result[11].row, 3);
-    ASSERT_EQ(result[11].col, 23);
+    ASSERT_EQ(result[11].row(), 3);
+    ASSERT_EQ(result[11].col(), 23);
 
-    ASSERT_EQ(result[12].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[12].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[12].lexical(), "arr"sv);
-    ASSERT_EQ(result[12].row, 3);
-    ASSERT_EQ(result[12].col, 24);
-    ASSERT_EQ(result[12].sourceLocation.num_bytes, 3);
+    ASSERT_EQ(result[12].row(), 3);
+    ASSERT_EQ(result[12].col(), 24);
+    ASSERT_EQ(result[12].length, 3);
 
-    // ASSERT_EQ(result[7].tokenType, TokenType::T_EOF);
+    // ASSERT_EQ(result[7].tokenType(), TokenType::T_EOF);
 }
 
 
@@ -455,34 +461,34 @@ TEST(LexerTest, LexFloatNumber)
 )");
     EXPECT_EQ(result.size(), 11);
     size_t i = 0;
-    ASSERT_EQ(result[i].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[i].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[i].lexical(), "myVar"sv);
     i++;
-    ASSERT_EQ(result[i].tokenType, TokenType::COLON);
+    ASSERT_EQ(result[i].tokenType(), TokenType::COLON);
     ASSERT_EQ(result[i].lexical(), ":"sv);
     i++;
-    ASSERT_EQ(result[i].tokenType, TokenType::EQUAL);
+    ASSERT_EQ(result[i].tokenType(), TokenType::EQUAL);
     ASSERT_EQ(result[i].lexical(), "="sv);
     i++;
-    ASSERT_EQ(result[i].tokenType, TokenType::NUMBER);
+    ASSERT_EQ(result[i].tokenType(), TokenType::NUMBER);
     ASSERT_EQ(result[i].lexical(), "2.55"sv);
     i++;
-    ASSERT_EQ(result[i].tokenType, TokenType::SEMICOLON);
+    ASSERT_EQ(result[i].tokenType(), TokenType::SEMICOLON);
     ASSERT_EQ(result[i].lexical(), ";"sv);
     i++;
-    ASSERT_EQ(result[i].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[i].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[i].lexical(), "myVar"sv);
     i++;
-    ASSERT_EQ(result[i].tokenType, TokenType::COLON);
+    ASSERT_EQ(result[i].tokenType(), TokenType::COLON);
     ASSERT_EQ(result[i].lexical(), ":"sv);
     i++;
-    ASSERT_EQ(result[i].tokenType, TokenType::EQUAL);
+    ASSERT_EQ(result[i].tokenType(), TokenType::EQUAL);
     ASSERT_EQ(result[i].lexical(), "="sv);
     i++;
-    ASSERT_EQ(result[i].tokenType, TokenType::NUMBER);
+    ASSERT_EQ(result[i].tokenType(), TokenType::NUMBER);
     ASSERT_EQ(result[i].lexical(), "-3.14"sv);
     i++;
-    ASSERT_EQ(result[i].tokenType, TokenType::SEMICOLON);
+    ASSERT_EQ(result[i].tokenType(), TokenType::SEMICOLON);
     ASSERT_EQ(result[i].lexical(), ";"sv);
 }
 
@@ -495,31 +501,31 @@ TEST(LexerTest, ParseArray)
 )");
     EXPECT_EQ(result.size(), 13);
     size_t i = 0;
-    ASSERT_EQ(result[i].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[i].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[i].lexical(), "buffer"sv);
     i++;
-    ASSERT_EQ(result[i].tokenType, TokenType::COLON);
+    ASSERT_EQ(result[i].tokenType(), TokenType::COLON);
     ASSERT_EQ(result[i].lexical(), ":"sv);
     i++;
-    ASSERT_EQ(result[i].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[i].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[i].lexical(), "array"sv);
     i++;
-    ASSERT_EQ(result[i].tokenType, TokenType::LEFT_SQUAR);
+    ASSERT_EQ(result[i].tokenType(), TokenType::LEFT_SQUAR);
     ASSERT_EQ(result[i].lexical(), "["sv);
     i++;
-    ASSERT_EQ(result[i].tokenType, TokenType::NUMBER);
+    ASSERT_EQ(result[i].tokenType(), TokenType::NUMBER);
     ASSERT_EQ(result[i].lexical(), "0"sv);
     i++;
-    ASSERT_EQ(result[i].tokenType, TokenType::DOT);
+    ASSERT_EQ(result[i].tokenType(), TokenType::DOT);
     ASSERT_EQ(result[i].lexical(), "."sv);
     i++;
-    ASSERT_EQ(result[i].tokenType, TokenType::DOT);
+    ASSERT_EQ(result[i].tokenType(), TokenType::DOT);
     ASSERT_EQ(result[i].lexical(), "."sv);
     i++;
-    ASSERT_EQ(result[i].tokenType, TokenType::NUMBER);
+    ASSERT_EQ(result[i].tokenType(), TokenType::NUMBER);
     ASSERT_EQ(result[i].lexical(), "100"sv);
     i++;
-    ASSERT_EQ(result[i].tokenType, TokenType::RIGHT_SQUAR);
+    ASSERT_EQ(result[i].tokenType(), TokenType::RIGHT_SQUAR);
     ASSERT_EQ(result[i].lexical(), "]"sv);
 }
 
@@ -534,13 +540,429 @@ TEST(LexerTest, CaseTest)
 
     EXPECT_EQ(result.size(), 13);
     size_t i = 0;
-    ASSERT_EQ(result[i].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[i].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[i].lexical(), "case"sv);
     i++;
-    ASSERT_EQ(result[i].tokenType, TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[i].tokenType(), TokenType::NAMEDTOKEN);
     ASSERT_EQ(result[i].lexical(), "color"sv);
     i++;
-    ASSERT_EQ(result[i].tokenType, TokenType::KEYWORD);
+    ASSERT_EQ(result[i].tokenType(), TokenType::KEYWORD);
     ASSERT_EQ(result[i].lexical(), "of"sv);
     i++;
 }
+
+TEST(LexerTest, KeywordsIgnoreTheCase)
+{
+    for (const auto keyword: {"program", "BEGIN", "End", "implementation", "Initialization", "downto", "nil", "in"})
+    {
+        EXPECT_TRUE(Lexer::isKeyword(keyword)) << keyword;
+    }
+    for (const auto identifier: {"programs", "beg", "i", "", "interfaces", "downt", "nill", "implementations"})
+    {
+        EXPECT_FALSE(Lexer::isKeyword(identifier)) << identifier;
+    }
+}
+
+TEST(LexerTest, EmptyCommentsAndEscapedQuotes)
+{
+    Lexer lexer;
+    auto result = lexer.tokenize("filename.pas", "{}x//\ny := '''';\nz := 'a''';");
+
+    ASSERT_EQ(result.size(), 12);
+    size_t i = 0;
+    ASSERT_EQ(result[i].tokenType(), TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[i].lexical(), "x"sv);
+    ASSERT_EQ(result[i].col(), 3);
+    i++;
+    ASSERT_EQ(result[i].tokenType(), TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[i].lexical(), "y"sv);
+    ASSERT_EQ(result[i].row(), 2);
+    i += 3;
+    ASSERT_EQ(result[i].tokenType(), TokenType::STRING);
+    ASSERT_EQ(result[i].lexical(), "''"sv);
+    i += 2;
+    ASSERT_EQ(result[i].tokenType(), TokenType::NAMEDTOKEN);
+    ASSERT_EQ(result[i].lexical(), "z"sv);
+    i += 3;
+    ASSERT_EQ(result[i].tokenType(), TokenType::STRING);
+    ASSERT_EQ(result[i].lexical(), "a''"sv);
+}
+
+TEST(LexerTest, TokensResolvePositionsThroughTheSourceManager)
+{
+    Lexer lexer;
+    auto result = lexer.tokenize("positions.pas", "{ first\n  second } x := 1;\n\ty");
+
+    ASSERT_EQ(result.size(), 7);
+    ASSERT_EQ(result[0].lexical(), "x"sv);
+    ASSERT_EQ(result[0].filename(), "positions.pas");
+    ASSERT_EQ(result[0].row(), 2);
+    ASSERT_EQ(result[0].col(), 12);
+    ASSERT_EQ(result[0].sourceline(), "  second } x := 1;"sv);
+    ASSERT_EQ(result[5].lexical(), "y"sv);
+    ASSERT_EQ(result[5].row(), 3);
+    ASSERT_EQ(result[5].col(), 2);
+
+    // lexing the same file again shares the file of the first run
+    auto again = lexer.tokenize("positions.pas", "{ first\n  second } x := 1;\n\ty");
+    ASSERT_EQ(again[0], result[0]);
+    ASSERT_EQ(Token().row(), 0);
+}
+
+TEST(LexerTest, TokenizesLoadedFilesWithoutCopies)
+{
+    const auto path = std::filesystem::temp_directory_path() / "wirthx_lexer_loaded.pas";
+    {
+        std::ofstream file(path);
+        file << "program loaded;\nbegin\nend.\n";
+    }
+    const auto fileId = SourceManager::instance().loadFile(path);
+    ASSERT_TRUE(fileId.has_value());
+    // loading an unchanged file again keeps its id and its buffer
+    ASSERT_EQ(SourceManager::instance().loadFile(path), fileId);
+    ASSERT_FALSE(SourceManager::instance().loadFile(path.string() + ".missing").has_value());
+
+    Lexer lexer;
+    auto result = lexer.tokenize(*fileId);
+    std::filesystem::remove(path);
+
+    ASSERT_EQ(result.size(), 7);
+    ASSERT_EQ(result[1].lexical(), "loaded"sv);
+    ASSERT_EQ(result[1].filename(), path.string());
+    ASSERT_EQ(result[4].row(), 3);
+    ASSERT_EQ(result[1].text().data(), SourceManager::instance().content(*fileId).data() + 8);
+}
+
+TEST(LexerTest, IdentifiersAreInternedIgnoringTheCase)
+{
+    Lexer lexer;
+    auto result = lexer.tokenize("filename.pas", "Counter := counter + COUNTER2; BEGIN");
+
+    ASSERT_EQ(result.size(), 9);
+    ASSERT_NE(result[0].symbol, IdentifierTable::noSymbol);
+    ASSERT_EQ(result[0].symbol, result[3].symbol);
+    ASSERT_NE(result[0].symbol, result[5].symbol);
+    ASSERT_EQ(IdentifierTable::instance().spelling(result[5].symbol), "counter2"sv);
+    ASSERT_EQ(result[1].symbol, IdentifierTable::noSymbol);
+    ASSERT_EQ(result[7].tokenType(), TokenType::KEYWORD);
+    ASSERT_EQ(result[7].symbol, Lexer::keywordSymbol("begin"));
+    ASSERT_EQ(IdentifierTable::instance().spelling(result[7].symbol), "begin"sv);
+    ASSERT_EQ(IdentifierTable::instance().find("cOuNtEr"), result[0].symbol);
+}
+
+TEST(LexerTest, VectorizedScansMatchThePortableScans)
+{
+    const auto functions = supported_scan_functions();
+    const auto &portable = functions.front();
+    std::mt19937 random(42);
+    const std::string alphabet = "  \t\r\n'}ab";
+    std::string text(300, ' ');
+    for (int round = 0; round < 200; ++round)
+    {
+        // long blank runs and sparse matches cross the 16 and 32 byte blocks
+        const auto variety = random() % alphabet.size() + 1;
+        for (auto &ch: text)
+            ch = random() % 8 == 0 ? alphabet[random() % variety] : alphabet[random() % 2];
+        for (size_t begin = 0; begin < 40; ++begin)
+        {
+            const char *first = text.data() + begin;
+            const char *last = text.data() + text.size() - random() % 40;
+            for (const auto &scan: functions)
+            {
+                SCOPED_TRACE(scan.name);
+                for (const char value: {'\n', '\'', '}'})
+                {
+                    ASSERT_EQ(scan.findByte(first, last, value), portable.findByte(first, last, value));
+                    ASSERT_EQ(scan.countByte(first, last, value), portable.countByte(first, last, value));
+                }
+                ASSERT_EQ(scan.skipBlanks(first, last), portable.skipBlanks(first, last));
+            }
+        }
+    }
+}
+
+TEST(LexerTest, SkipsLongCommentsStringsAndBlanks)
+{
+    Lexer lexer;
+    const std::string padding(100, ' ');
+    const std::string content = "a" + padding + "{" + std::string(70, 'x') + "\n}" + padding + "\t\r\n'" +
+                                std::string(40, 'y') + "''" + std::string(40, 'z') + "'// " + padding + "\nb";
+    auto result = lexer.tokenize("filename.pas", content);
+
+    ASSERT_EQ(result.size(), 4);
+    ASSERT_EQ(result[0].lexical(), "a");
+    ASSERT_EQ(result[1].tokenType(), TokenType::STRING);
+    ASSERT_EQ(result[1].length, 82);
+    ASSERT_EQ(result[2].lexical(), "b");
+    ASSERT_EQ(result[2].row(), 4);
+    ASSERT_EQ(result[2].col(), 1);
+}
+
+TEST(LexerTest, SourceManagerMapsPositionsBothWays)
+{
+    auto &sourceManager = SourceManager::instance();
+    const auto file = sourceManager.addFile("lines.pas", "program a;\r\nbegin\n\n  writeln(1)\nend."sv);
+
+    ASSERT_EQ(sourceManager.lineCount(file), 5);
+    ASSERT_EQ(sourceManager.sourceline(file, 3), "program a;\r");
+    ASSERT_EQ(sourceManager.sourceline(file, 18), "");
+    ASSERT_EQ(sourceManager.sourceline(file, 32), "end.");
+    for (size_t offset = 0; offset < sourceManager.content(file).size(); ++offset)
+    {
+        const auto [row, col] = sourceManager.position(file, offset);
+        ASSERT_EQ(sourceManager.byteOffset(file, row, col), offset);
+    }
+    // positions past the end of a line or of the file are clamped
+    ASSERT_EQ(sourceManager.byteOffset(file, 2, 100), 17);
+    ASSERT_EQ(sourceManager.byteOffset(file, 9, 1), sourceManager.content(file).size());
+}
+
+TEST(LexerTest, SourceManagerReusesTheIdsOfReleasedFiles)
+{
+    auto &sourceManager = SourceManager::instance();
+    const auto file = sourceManager.addFile("released.pas", "program a;"sv);
+    // the same file added again is only removed after both additions were released
+    ASSERT_EQ(sourceManager.addFile("released.pas", "program a;"sv), file);
+    const auto files = sourceManager.fileCount();
+    sourceManager.releaseFile(file);
+    ASSERT_EQ(sourceManager.content(file), "program a;");
+    sourceManager.releaseFile(file);
+    ASSERT_EQ(sourceManager.fileCount(), files - 1);
+
+    const auto next = sourceManager.addFile("released.pas", "program b;"sv);
+    ASSERT_EQ(next, file);
+    ASSERT_EQ(sourceManager.content(next), "program b;");
+    ASSERT_EQ(sourceManager.fileCount(), files);
+    sourceManager.releaseFile(next);
+}
+
+static std::vector<std::string> stream_texts(TokenStream &stream)
+{
+    std::vector<std::string> texts;
+    for (size_t i = 0; stream.hasToken(i); ++i)
+        texts.push_back(stream[i].lexical());
+    return texts;
+}
+
+TEST(LexerTest, TokenStreamEvaluatesConditionals)
+{
+    const auto file = SourceManager::instance().addFile(
+            "conditionals.pas", "a {$ifdef UNIX} b {$ifdef WINDOWS} c {$else} d {$endif} {$else} e {$ifdef UNIX} f "
+                                "{$endif} {$endif} {$ define(POSIX) } {$ifdef POSIX} g {$endif} h"sv);
+    std::vector<ParserError> errors;
+    MacroDefinitions definitions;
+    definitions.define("UNIX");
+    TokenStream stream(file, definitions, &errors);
+
+    ASSERT_EQ(stream_texts(stream), (std::vector<std::string>{"a", "b", "d", "g", "h", ""}));
+    ASSERT_EQ(stream[100].tokenType(), TokenType::T_EOF);
+    ASSERT_TRUE(stream.definitions().isDefined("posix"));
+    ASSERT_TRUE(errors.empty());
+}
+
+TEST(LexerTest, TokenStreamSkipsStringsAndCommentsOfInactiveRegions)
+{
+    const auto file = SourceManager::instance().addFile(
+            "inactive.pas", "{$ifdef X} 'it''s {$endif}' { {$else } // {$endif}\n x {$endif} y {$ifdef X} z"sv);
+    std::vector<ParserError> errors;
+    TokenStream stream(file, {}, &errors);
+
+    ASSERT_EQ(stream_texts(stream), (std::vector<std::string>{"y", ""}));
+    ASSERT_EQ(errors.size(), 1);
+    ASSERT_EQ(errors[0].token.byteOffset, 65);
+}
+
+TEST(LexerTest, TokensLongerThanTheMaximumLengthAreErrors)
+{
+    std::string content = "x := '";
+    content.append(Token::maxLength + 1, 'a');
+    content += "'; y";
+    const auto file = SourceManager::instance().addFile("toolong.pas", std::move(content));
+    Lexer lexer;
+    const auto tokens = lexer.tokenize(file);
+    ASSERT_EQ(tokens.size(), 7);
+    ASSERT_EQ(tokens[3].tokenType(), TokenType::TOO_LONG);
+    ASSERT_EQ(tokens[3].byteOffset, 6);
+
+    std::vector<ParserError> errors;
+    TokenStream stream(file, {}, &errors);
+    ASSERT_EQ(stream_texts(stream), (std::vector<std::string>{"x", ":", "=", ";", "y", ""}));
+    ASSERT_EQ(errors.size(), 1);
+    ASSERT_EQ(errors[0].message, "the token is longer than 16 MiB!");
+    ASSERT_EQ(errors[0].token.byteOffset, 6);
+    SourceManager::instance().releaseFile(file);
+}
+
+TEST(LexerTest, TokenStreamKeepsAWindowOfTheTokens)
+{
+    std::string content;
+    for (int i = 0; i < 1000; ++i)
+        content += "value" + std::to_string(i) + " := " + std::to_string(i) + ";\n";
+    const auto file = SourceManager::instance().addFile("window.pas", content);
+    Lexer lexer;
+    const auto tokens = lexer.tokenize(file);
+    std::vector<ParserError> errors;
+    TokenStream stream(file, {}, &errors);
+
+    for (size_t i = 0; i < tokens.size(); ++i)
+    {
+        // the parser looks a few tokens ahead and goes back by one
+        ASSERT_EQ(stream[i + 3 < tokens.size() ? i + 3 : i], tokens[i + 3 < tokens.size() ? i + 3 : i]);
+        ASSERT_EQ(stream[i], tokens[i]);
+        ASSERT_EQ(stream[i > 0 ? i - 1 : 0], tokens[i > 0 ? i - 1 : 0]);
+    }
+    ASSERT_FALSE(stream.hasToken(tokens.size()));
+    ASSERT_EQ(stream.front(), tokens.front());
+}
+
+TEST(LexerTest, TokenStreamEvaluatesConditionExpressions)
+{
+    const auto file = SourceManager::instance().addFile(
+            "expressions.pas",
+            "{$define Version := 3} {$if defined(UNIX) and (VERSION >= 3)} a {$elseif true} b {$endif}"
+            "{$if not defined WINDOWS and (VERSION <> 2) or UNKNOWN} c {$else} d {$endif}"
+            "{$ifndef UNIX} e {$elseif VERSION = 3} f {$endif} {$undef unix} {$ifdef UNIX} g {$endif}"
+            "{$if VERSION < 3} {$if garbage (} h {$endif} {$elseif VERSION <= 3} i {$endif}"
+            "{$if (VERSION > 1} j {$endif} {$endif} k"sv);
+    std::vector<ParserError> errors;
+    MacroDefinitions definitions;
+    definitions.define("UNIX");
+    TokenStream stream(file, definitions, &errors);
+
+    ASSERT_EQ(stream_texts(stream), (std::vector<std::string>{"a", "c", "f", "i", "k", ""}));
+    ASSERT_EQ(stream.definitions().value("VERSION"), "3"sv);
+    ASSERT_FALSE(stream.definitions().isDefined("UNIX"));
+    ASSERT_EQ(errors.size(), 2);
+    ASSERT_EQ(errors[0].message, "expected token ')' in the condition!");
+    ASSERT_EQ(errors[1].token.lexical(), "endif");
+}
+
+TEST(LexerTest, TokenStreamInsertsIncludedFiles)
+{
+    const auto directory = std::filesystem::temp_directory_path() / "wirthx_includes";
+    std::filesystem::create_directories(directory / "search");
+    {
+        std::ofstream header(directory / "header.inc");
+        header << "b {$ifdef FULL} c {$else} d {$I 'search/nested.inc'} {$endif} e";
+        std::ofstream nested(directory / "search" / "nested.inc");
+        nested << "n {$define NESTED}";
+        std::ofstream recursive(directory / "recursive.inc");
+        recursive << "r {$include recursive.inc}";
+    }
+    const auto file = SourceManager::instance().addFile(
+            (directory / "main.pas").string(),
+            "a {$I header.inc} {$ifdef NESTED} f {$endif} {$I+} {$include missing.inc} {$ifdef X} {$I header.inc} "
+            "{$endif} g"sv);
+    std::vector<ParserError> errors;
+    TokenStream stream(file, {}, &errors);
+
+    ASSERT_EQ(stream_texts(stream), (std::vector<std::string>{"a", "b", "d", "n", "e", "f", "g", ""}));
+    ASSERT_EQ(stream[1].filename(), (directory / "header.inc").string());
+    ASSERT_EQ(stream.includedFiles().size(), 2);
+    ASSERT_EQ(errors.size(), 1);
+    ASSERT_EQ(errors[0].token.lexical(), "include");
+
+    // the tokens of the header are shared with the first stream, a file including itself ends at the maximal depth
+    const auto second = SourceManager::instance().addFile((directory / "second.pas").string(),
+                                                          "{$I header.inc} {$I recursive.inc}"sv);
+    TokenStream secondStream(second, {}, &errors);
+    const auto texts = stream_texts(secondStream);
+    std::filesystem::remove_all(directory);
+
+    ASSERT_EQ(texts.size(), 4 + 16 + 1);
+    ASSERT_EQ(secondStream[0].text().data(), stream[1].text().data());
+    ASSERT_EQ(errors.size(), 2);
+    ASSERT_EQ(errors[1].message, "the include files are nested too deeply!");
+}
+
+TEST(LexerTest, RelexingAnEditMatchesLexingTheWholeFile)
+{
+    const std::vector<std::string> pieces = {"a",  "b1", " ", "\n",  "{",  "}",     "{$", "ifdef", "define", "'",
+                                             "''", "//", "#", "#65", "1",  ".",     "-",  "2.5",   ":=",     ";",
+                                             "begin", "end", "x", "\t", "include"};
+    std::mt19937 random(20);
+    const auto generate = [&](const size_t count)
+    {
+        std::string text;
+        for (size_t i = 0; i < count; ++i)
+            text += pieces[random() % pieces.size()];
+        return text;
+    };
+    Lexer lexer;
+    for (int round = 0; round < 200; ++round)
+    {
+        std::string text = generate(random() % 60);
+        auto file = SourceManager::instance().addFile("relex.pas", text);
+        auto tokens = lexer.tokenize(file);
+        for (int i = 0; i < 20; ++i)
+        {
+            const size_t begin = random() % (text.size() + 1);
+            const size_t end = std::min(text.size(), begin + random() % 8);
+            const auto inserted = generate(random() % 3);
+            text = text.substr(0, begin) + inserted + text.substr(end);
+            file = SourceManager::instance().addFile("relex.pas", text);
+            lexer.relex(tokens, file, TextEdit{.begin = begin, .oldEnd = end, .newEnd = begin + inserted.size()});
+
+            const auto expected = lexer.tokenize(file);
+            ASSERT_EQ(tokens.size(), expected.size()) << text;
+            // the tokens compare their file, offset, length, kind and symbol
+            for (size_t j = 0; j < tokens.size(); ++j)
+                ASSERT_EQ(tokens[j], expected[j]) << text;
+        }
+    }
+}
+
+TEST(LexerTest, TokenStreamStreamsLexedTokens)
+{
+    const auto file = SourceManager::instance().addFile(
+            "lexed.pas", "a {$ifdef X} 'b' {$else} c {$define Y} {$endif} {$ifdef Y} d {$endif} e"sv);
+    Lexer lexer;
+    const auto tokens = std::make_shared<const std::vector<Token>>(lexer.tokenize(file));
+    std::vector<ParserError> errors;
+    TokenStream scanned(file, {}, &errors);
+    TokenStream lexed(file, {}, &errors, tokens);
+
+    ASSERT_EQ(stream_texts(lexed), (std::vector<std::string>{"a", "c", "d", "e", ""}));
+    for (size_t i = 0; scanned.hasToken(i); ++i)
+        ASSERT_EQ(lexed[i], scanned[i]);
+    ASSERT_TRUE(errors.empty());
+}
+
+TEST(LexerTest, TokenStreamResetsToARangeOfTheFile)
+{
+    const std::string_view content = "unit u; {$ifdef X} procedure p; inline; begin x := 1; end; {$endif} end.";
+    const auto file = SourceManager::instance().addFile("range.pas", content);
+    std::vector<ParserError> errors;
+    TokenStream stream(file, {}, &errors);
+    const auto begin = content.find("procedure");
+    const auto end = content.find("end;") + 4;
+    stream.reset(file, {}, begin, end);
+
+    ASSERT_EQ(stream_texts(stream), (std::vector<std::string>{"procedure", "p", ";", "inline", ";", "begin", "x", ":",
+                                                              "=", "1", ";", "end", ";", ""}));
+    ASSERT_EQ(stream[0].byteOffset, begin);
+    // the {$endif} behind the range is not seen
+    ASSERT_TRUE(errors.empty());
+}
+
+TEST(LexerTest, SymbolTableResolvesNamesInTheInnermostScope)
+{
+    SymbolTable<int> symbols;
+    symbols.define("Counter", 1);
+    symbols.define("limit", 2);
+    ASSERT_EQ(*symbols.find("COUNTER"), 1);
+    ASSERT_FALSE(symbols.contains("never_defined_in_any_scope"));
+
+    symbols.enterScope();
+    symbols.define("counter", 3);
+    ASSERT_EQ(symbols.depth(), 1u);
+    ASSERT_EQ(*symbols.find("Counter"), 3);
+    ASSERT_EQ(*symbols.find("Limit"), 2);
+
+    symbols.exitScope();
+    ASSERT_EQ(*symbols.find("counter"), 1);
+    // the global scope is never left
+    symbols.exitScope();
+    ASSERT_EQ(symbols.depth(), 0u);
+    ASSERT_EQ(*symbols.find("limit"), 2);
+}
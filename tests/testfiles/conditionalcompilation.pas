@@ -0,0 +1,30 @@
+program conditionalcompilation;
+{$define VERSION := 3}
+{$define FEATURE}
+
+begin
+{$if (defined(UNIX) or defined(WINDOWS)) and (VERSION >= 3)}
+    writeln('version 3');
+{$elseif defined(UNIX)}
+    writeln('old unix');
+{$else}
+    writeln('other');
+{$endif}
+{$ifndef FEATURE}
+    writeln('no feature');
+{$else}
+    writeln('feature');
+{$endif}
+{$undef FEATURE}
+{$ifdef FEATURE}
+    writeln('still defined');
+{$endif}
+{$if VERSION = 2}
+    writeln('version 2');
+{$elseif not (VERSION <> 3)}
+    writeln('not version 2');
+    {$if UNDEFINED > 0}
+    writeln('undefined macros are 0');
+    {$endif}
+{$endif}
+end.
@@ -0,0 +1,8 @@
+program includefile;
+{$I includeconstants.inc}
+var
+    i : integer;
+begin
+    for i := 1 to MaxItems do
+        writeln(twice(i));
+end.
@@ -0,0 +1,35 @@
+program nestedexpressions;
+
+    function combine(depth : integer): integer;
+    var
+        local : array[0..1] of integer;
+    begin
+        local[0] := depth;
+        local[1] := depth * 2;
+        combine := (((local[0] + local[1]) + (local[1] - local[0])) * 2) + ((local[0] * 3) - (local[1] div 2));
+    end;
+
+    function classify(value : integer) : string;
+    begin
+        case value of
+            0..4: classify := 'small';
+            5..9: classify := 'medium';
+        else
+            classify := 'large';
+        end;
+    end;
+
+var
+    values : array[0..3] of integer;
+    total : integer;
+begin
+    values[0] := 1;
+    values[1] := 2;
+    values[2] := 3;
+    values[3] := 4;
+    total := (((((values[0] + values[1]) * values[2]) - values[3]) +
+              ((values[3] - values[0]) * (values[2] + values[1]))) * 2) - combine(5);
+    writeln('total ', total);
+    writeln(classify(values[2] * 2));
+    writeln(classify((values[3] * values[3]) - (values[0] + (values[1] * (values[2] - values[0])))));
+end.
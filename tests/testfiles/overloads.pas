@@ -0,0 +1,37 @@
+program overloads;
+
+    procedure show(value : integer);
+    begin
+        writeln('integer ', value);
+    end;
+
+    procedure show(value : string);
+    begin
+        writeln('string ', value);
+    end;
+
+    procedure Show(first : integer; second : integer);
+    begin
+        writeln('pair ', first + second);
+    end;
+
+    function convert(value : integer): integer;
+    begin
+        convert := value * 2;
+    end;
+
+    function convert(value : string): string;
+    begin
+        convert := value;
+    end;
+
+var
+    count : integer;
+begin
+    count := 21;
+    show(count);
+    SHOW('text');
+    show(count, 2);
+    Show(CONVERT(count));
+    show(Convert('ab'));
+end.